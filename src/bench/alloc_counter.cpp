@@ -0,0 +1,68 @@
+#include "bench/alloc_counter.h"
+
+#include <cstdlib>
+
+#include <atomic>
+#include <new>
+
+namespace {
+
+std::atomic<uint64_t> allocation_count(0);
+std::atomic<uint64_t> allocated_bytes(0);
+
+void CountAllocation(std::size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+void* CountedAllocate(std::size_t size) {
+  CountAllocation(size);
+  if (void* p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+}  // unnamed namespace
+
+namespace ssf {
+namespace bench {
+
+uint64_t AllocationCount() {
+  return allocation_count.load(std::memory_order_relaxed);
+}
+
+uint64_t AllocatedBytes() {
+  return allocated_bytes.load(std::memory_order_relaxed);
+}
+
+}  // bench
+}  // ssf
+
+void* operator new(std::size_t size) { return CountedAllocate(size); }
+
+void* operator new[](std::size_t size) { return CountedAllocate(size); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  CountAllocation(size);
+  return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  CountAllocation(size);
+  return std::malloc(size ? size : 1);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete[](void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+  std::free(p);
+}
@@ -0,0 +1,21 @@
+#ifndef SSF_BENCH_ALLOC_COUNTER_H_
+#define SSF_BENCH_ALLOC_COUNTER_H_
+
+#include <cstdint>
+
+namespace ssf {
+namespace bench {
+
+// Number of calls to the global operator new since the process started
+// Linking alloc_counter.cpp replaces the global allocation functions of the
+// benchmark executable.
+uint64_t AllocationCount();
+
+// Number of bytes requested from the global operator new since the process
+// started (freed memory is not subtracted)
+uint64_t AllocatedBytes();
+
+}  // bench
+}  // ssf
+
+#endif  // SSF_BENCH_ALLOC_COUNTER_H_
@@ -0,0 +1,199 @@
+#include "bench/bench_environment.h"
+
+#include <chrono>
+#include <functional>
+
+#include <ssf/log/log.h>
+
+#include "common/error/error.h"
+
+#include "tests/tls_config_helper.h"
+
+namespace ssf {
+namespace bench {
+
+BenchEnvironment::BenchEnvironment()
+    : p_server_(nullptr),
+      p_client_(nullptr),
+      user_service_names_(),
+      status_mutex_(),
+      running_(),
+      service_ready_(),
+      running_set_(false),
+      service_ready_set_(false) {}
+
+BenchEnvironment::~BenchEnvironment() { Stop(); }
+
+std::string BenchEnvironment::ProtocolName() {
+#ifdef TLS_OVER_TCP_LINK
+  return "tls";
+#else
+  return "plain";
+#endif
+}
+
+BenchEnvironment::ClientSessionPtr BenchEnvironment::GetSession(
+    boost::system::error_code& ec) {
+  if (!p_client_) {
+    ec.assign(::error::bad_file_descriptor, ::error::get_ssf_category());
+    return nullptr;
+  }
+  return p_client_->GetSession(ec);
+}
+
+void BenchEnvironment::Stop() {
+  boost::system::error_code ec;
+  if (p_client_) {
+    p_client_->Stop(ec);
+    p_client_->Deinit();
+    p_client_.reset();
+  }
+  if (p_server_) {
+    p_server_->Stop();
+    p_server_.reset();
+  }
+}
+
+bool BenchEnvironment::InitConfig(ssf::config::Config* p_config,
+                                  const std::string& services_config,
+                                  bool server) {
+  p_config->Init();
+  if (server) {
+    ssf::tests::SetServerTlsConfig(p_config);
+  } else {
+    ssf::tests::SetClientTlsConfig(p_config);
+  }
+
+  if (services_config.empty()) {
+    return true;
+  }
+
+  boost::system::error_code ec;
+  p_config->UpdateFromString(services_config, ec);
+  if (ec) {
+    SSF_LOG("bench", error, "invalid services configuration {}",
+            services_config);
+    return false;
+  }
+
+  return true;
+}
+
+bool BenchEnvironment::StartServer(const std::string& server_port,
+                                   const std::string& services_config) {
+  ssf::config::Config ssf_config;
+  if (!InitConfig(&ssf_config, services_config, true)) {
+    return false;
+  }
+
+  auto endpoint_query = NetworkProtocol::GenerateServerQuery(
+      "127.0.0.1", server_port, ssf_config);
+
+  p_server_.reset(new Server(ssf_config.services()));
+
+  boost::system::error_code ec;
+  p_server_->Run(endpoint_query, ec);
+  if (ec) {
+    SSF_LOG("bench", error, "could not run server ({})", ec.message());
+    return false;
+  }
+
+  return true;
+}
+
+bool BenchEnvironment::StartClient(
+    const std::string& server_port,
+    const UserServiceParameters& user_service_params,
+    const std::string& services_config) {
+  ssf::config::Config ssf_config;
+  if (!InitConfig(&ssf_config, services_config, false)) {
+    return false;
+  }
+
+  auto endpoint_query = NetworkProtocol::GenerateClientQuery(
+      "127.0.0.1", server_port, ssf_config, {});
+
+  boost::system::error_code ec;
+  p_client_->Init(
+      endpoint_query, 1, 0, true, user_service_params, ssf_config.services(),
+      std::bind(&BenchEnvironment::OnClientStatus, this,
+                std::placeholders::_1),
+      std::bind(&BenchEnvironment::OnClientUserServiceStatus, this,
+                std::placeholders::_1, std::placeholders::_2),
+      ec);
+  if (ec) {
+    SSF_LOG("bench", error, "could not init client ({})", ec.message());
+    return false;
+  }
+
+  p_client_->Run(ec);
+  if (ec) {
+    SSF_LOG("bench", error, "could not run client ({})", ec.message());
+    return false;
+  }
+
+  auto running = running_.get_future();
+  auto service_ready = service_ready_.get_future();
+  if (running.wait_for(std::chrono::seconds(30)) !=
+          std::future_status::ready ||
+      !running.get()) {
+    SSF_LOG("bench", error, "client not running");
+    return false;
+  }
+  if (service_ready.wait_for(std::chrono::seconds(30)) !=
+          std::future_status::ready ||
+      !service_ready.get()) {
+    SSF_LOG("bench", error, "user services not ready");
+    return false;
+  }
+
+  return true;
+}
+
+void BenchEnvironment::OnClientStatus(ssf::Status status) {
+  std::unique_lock<std::mutex> lock(status_mutex_);
+  switch (status) {
+    case ssf::Status::kEndpointNotResolvable:
+    case ssf::Status::kServerUnreachable:
+    case ssf::Status::kServerNotSupported:
+      if (!running_set_) {
+        running_set_ = true;
+        running_.set_value(false);
+      }
+      break;
+    case ssf::Status::kRunning:
+      if (!running_set_) {
+        running_set_ = true;
+        running_.set_value(true);
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+void BenchEnvironment::OnClientUserServiceStatus(
+    UserServicePtr p_user_service, const boost::system::error_code& ec) {
+  std::unique_lock<std::mutex> lock(status_mutex_);
+  auto name = p_user_service->GetName();
+  if (user_service_names_.count(name) == 0 || service_ready_set_) {
+    return;
+  }
+
+  if (ec) {
+    SSF_LOG("bench", error, "user service {} initialization failed ({})",
+            name, ec.message());
+    service_ready_set_ = true;
+    service_ready_.set_value(false);
+    return;
+  }
+
+  user_service_names_.erase(name);
+  if (user_service_names_.empty()) {
+    service_ready_set_ = true;
+    service_ready_.set_value(true);
+  }
+}
+
+}  // bench
+}  // ssf
@@ -0,0 +1,99 @@
+#ifndef SSF_BENCH_BENCH_ENVIRONMENT_H_
+#define SSF_BENCH_BENCH_ENVIRONMENT_H_
+
+#include <future>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+
+#include <boost/system/error_code.hpp>
+
+#include "common/config/config.h"
+
+#include "core/client/client.h"
+#include "core/client/status.h"
+#include "core/network_protocol.h"
+#include "core/server/server.h"
+#include "core/transport_virtual_layer_policies/transport_protocol_policy.h"
+
+#include "services/user_services/parameters.h"
+
+namespace ssf {
+namespace bench {
+
+// SSF server and client running in the benchmark process on loopback
+class BenchEnvironment {
+ public:
+  using NetworkProtocol = ssf::network::NetworkProtocol;
+  using Client = ssf::Client;
+  using ClientSessionPtr = Client::ClientSessionPtr;
+  using Server =
+      ssf::SSFServer<NetworkProtocol::Protocol, ssf::TransportProtocolPolicy>;
+  using Demux = Client::Demux;
+  using UserServicePtr = Client::UserServicePtr;
+
+ public:
+  BenchEnvironment();
+
+  ~BenchEnvironment();
+
+  // Name of the network protocol the environment runs on
+  static std::string ProtocolName();
+
+  // Start the server and connect a client running the given user services,
+  // services_config being the JSON configuration of both sides
+  template <class... UserServices>
+  bool Start(const std::string& server_port,
+             const UserServiceParameters& user_service_params,
+             const std::string& services_config = "") {
+    if (!StartServer(server_port, services_config)) {
+      return false;
+    }
+
+    p_client_.reset(new Client());
+    int registrations[] = {0, (p_client_->Register<UserServices>(),
+                               user_service_names_.insert(
+                                   UserServices::GetParseName()),
+                               0)...};
+    (void)registrations;
+
+    return StartClient(server_port, user_service_params, services_config);
+  }
+
+  // Start the server only, for clients running in other processes
+  bool StartServer(const std::string& server_port,
+                   const std::string& services_config = "");
+
+  ClientSessionPtr GetSession(boost::system::error_code& ec);
+
+  void Stop();
+
+ private:
+  bool InitConfig(ssf::config::Config* p_config,
+                  const std::string& services_config, bool server);
+  bool StartClient(const std::string& server_port,
+                   const UserServiceParameters& user_service_params,
+                   const std::string& services_config);
+
+  void OnClientStatus(ssf::Status status);
+  void OnClientUserServiceStatus(UserServicePtr p_user_service,
+                                 const boost::system::error_code& ec);
+
+ private:
+  std::unique_ptr<Server> p_server_;
+  std::unique_ptr<Client> p_client_;
+  // user services not initialized yet
+  std::set<std::string> user_service_names_;
+
+  std::mutex status_mutex_;
+  std::promise<bool> running_;
+  std::promise<bool> service_ready_;
+  bool running_set_;
+  bool service_ready_set_;
+};
+
+}  // bench
+}  // ssf
+
+#endif  // SSF_BENCH_BENCH_ENVIRONMENT_H_
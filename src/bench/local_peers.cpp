@@ -0,0 +1,194 @@
+#include "bench/local_peers.h"
+
+#include <algorithm>
+
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+
+namespace ssf {
+namespace bench {
+
+class TcpDataSource::Connection
+    : public std::enable_shared_from_this<TcpDataSource::Connection> {
+ public:
+  Connection(boost::asio::io_service& io_service,
+             std::shared_ptr<std::vector<uint8_t>> p_payload)
+      : socket_(io_service), p_payload_(p_payload), remaining_(0) {}
+
+  boost::asio::ip::tcp::socket& socket() { return socket_; }
+
+  void Start() {
+    auto self = shared_from_this();
+    boost::asio::async_read(
+        socket_, boost::asio::buffer(&remaining_, sizeof(remaining_)),
+        [this, self](const boost::system::error_code& ec, std::size_t) {
+          if (ec) {
+            return;
+          }
+          AsyncSend();
+        });
+  }
+
+ private:
+  void AsyncSend() {
+    if (remaining_ == 0) {
+      WaitClose();
+      return;
+    }
+
+    auto size = static_cast<std::size_t>(
+        std::min<uint64_t>(remaining_, p_payload_->size()));
+    auto self = shared_from_this();
+    boost::asio::async_write(
+        socket_, boost::asio::buffer(*p_payload_, size),
+        [this, self](const boost::system::error_code& ec, std::size_t sent) {
+          if (ec) {
+            return;
+          }
+          remaining_ -= sent;
+          AsyncSend();
+        });
+  }
+
+  void WaitClose() {
+    auto self = shared_from_this();
+    socket_.async_read_some(
+        boost::asio::buffer(&remaining_, sizeof(remaining_)),
+        [this, self](const boost::system::error_code& ec, std::size_t) {
+          boost::system::error_code close_ec;
+          socket_.close(close_ec);
+        });
+  }
+
+ private:
+  boost::asio::ip::tcp::socket socket_;
+  std::shared_ptr<std::vector<uint8_t>> p_payload_;
+  uint64_t remaining_;
+};
+
+TcpDataSource::TcpDataSource(uint16_t port)
+    : io_service_(),
+      p_work_(new boost::asio::io_service::work(io_service_)),
+      acceptor_(io_service_),
+      port_(port),
+      p_payload_(std::make_shared<std::vector<uint8_t>>(64 * 1024, 1)),
+      threads_() {}
+
+TcpDataSource::~TcpDataSource() { Stop(); }
+
+void TcpDataSource::Start(boost::system::error_code& ec) {
+  boost::asio::ip::tcp::endpoint endpoint(
+      boost::asio::ip::address_v4::loopback(), port_);
+  acceptor_.open(endpoint.protocol(), ec);
+  if (ec) {
+    return;
+  }
+  acceptor_.set_option(boost::asio::socket_base::reuse_address(true), ec);
+  acceptor_.bind(endpoint, ec);
+  if (ec) {
+    return;
+  }
+  acceptor_.listen(boost::asio::socket_base::max_connections, ec);
+  if (ec) {
+    return;
+  }
+
+  AsyncAccept();
+
+  for (int i = 0; i < 2; ++i) {
+    threads_.emplace_back([this]() { io_service_.run(); });
+  }
+}
+
+void TcpDataSource::Stop() {
+  boost::system::error_code ec;
+  acceptor_.close(ec);
+  p_work_.reset();
+  io_service_.stop();
+  for (auto& thread : threads_) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+  threads_.clear();
+}
+
+void TcpDataSource::AsyncAccept() {
+  auto p_connection = std::make_shared<Connection>(io_service_, p_payload_);
+  acceptor_.async_accept(
+      p_connection->socket(),
+      [this, p_connection](const boost::system::error_code& ec) {
+        if (ec) {
+          return;
+        }
+        p_connection->Start();
+        AsyncAccept();
+      });
+}
+
+UdpEcho::UdpEcho(uint16_t port)
+    : io_service_(), socket_(io_service_), port_(port), sender_(), buffer_() {}
+
+UdpEcho::~UdpEcho() { Stop(); }
+
+void UdpEcho::Start(boost::system::error_code& ec) {
+  boost::asio::ip::udp::endpoint endpoint(
+      boost::asio::ip::address_v4::loopback(), port_);
+  socket_.open(endpoint.protocol(), ec);
+  if (ec) {
+    return;
+  }
+  socket_.bind(endpoint, ec);
+  if (ec) {
+    return;
+  }
+
+  AsyncReceive();
+
+  thread_ = std::thread([this]() { io_service_.run(); });
+}
+
+void UdpEcho::Stop() {
+  boost::system::error_code ec;
+  socket_.close(ec);
+  io_service_.stop();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+void UdpEcho::AsyncReceive() {
+  socket_.async_receive_from(
+      boost::asio::buffer(buffer_), sender_,
+      [this](const boost::system::error_code& ec, std::size_t length) {
+        if (ec) {
+          return;
+        }
+        boost::system::error_code send_ec;
+        socket_.send_to(boost::asio::buffer(buffer_, length), sender_, 0,
+                        send_ec);
+        AsyncReceive();
+      });
+}
+
+bool RequestData(boost::asio::ip::tcp::socket& socket, uint64_t size) {
+  boost::system::error_code ec;
+  boost::asio::write(socket, boost::asio::buffer(&size, sizeof(size)), ec);
+  if (ec) {
+    return false;
+  }
+
+  std::array<uint8_t, 64 * 1024> buffer;
+  uint64_t received = 0;
+  while (received < size) {
+    received += socket.read_some(boost::asio::buffer(buffer), ec);
+    if (ec) {
+      return false;
+    }
+  }
+
+  return received == size;
+}
+
+}  // bench
+}  // ssf
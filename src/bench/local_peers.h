@@ -0,0 +1,75 @@
+#ifndef SSF_BENCH_LOCAL_PEERS_H_
+#define SSF_BENCH_LOCAL_PEERS_H_
+
+#include <cstdint>
+
+#include <array>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ip/udp.hpp>
+#include <boost/system/error_code.hpp>
+
+namespace ssf {
+namespace bench {
+
+// TCP server sending the amount of data requested by its clients
+//   A client sends the requested size as a 64 bits integer, receives that
+//   many bytes and closes the connection.
+class TcpDataSource {
+ public:
+  explicit TcpDataSource(uint16_t port);
+
+  ~TcpDataSource();
+
+  void Start(boost::system::error_code& ec);
+
+  void Stop();
+
+ private:
+  class Connection;
+
+  void AsyncAccept();
+
+ private:
+  boost::asio::io_service io_service_;
+  std::unique_ptr<boost::asio::io_service::work> p_work_;
+  boost::asio::ip::tcp::acceptor acceptor_;
+  uint16_t port_;
+  std::shared_ptr<std::vector<uint8_t>> p_payload_;
+  std::vector<std::thread> threads_;
+};
+
+// UDP server sending back every datagram it receives
+class UdpEcho {
+ public:
+  explicit UdpEcho(uint16_t port);
+
+  ~UdpEcho();
+
+  void Start(boost::system::error_code& ec);
+
+  void Stop();
+
+ private:
+  void AsyncReceive();
+
+ private:
+  boost::asio::io_service io_service_;
+  boost::asio::ip::udp::socket socket_;
+  uint16_t port_;
+  boost::asio::ip::udp::endpoint sender_;
+  std::array<uint8_t, 64 * 1024> buffer_;
+  std::thread thread_;
+};
+
+// Read the requested amount of data from a TcpDataSource connection
+bool RequestData(boost::asio::ip::tcp::socket& socket, uint64_t size);
+
+}  // bench
+}  // ssf
+
+#endif  // SSF_BENCH_LOCAL_PEERS_H_
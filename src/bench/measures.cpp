@@ -0,0 +1,111 @@
+#include "bench/measures.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <boost/chrono/process_cpu_clocks.hpp>
+
+#include "bench/alloc_counter.h"
+
+namespace ssf {
+namespace bench {
+
+Measures::Measures(const std::string& workload)
+    : workload_(workload),
+      mutex_(),
+      bytes_(0),
+      errors_(0),
+      latencies_us_(),
+      start_time_(),
+      duration_(Clock::duration::zero()),
+      start_cpu_ns_(0),
+      cpu_ns_(0),
+      start_allocations_(0),
+      allocations_(0) {}
+
+void Measures::Start() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  bytes_ = 0;
+  errors_ = 0;
+  latencies_us_.clear();
+  start_allocations_ = AllocationCount();
+  start_cpu_ns_ = ProcessCpuNanoseconds();
+  start_time_ = Clock::now();
+}
+
+void Measures::Stop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  duration_ = Clock::now() - start_time_;
+  cpu_ns_ = ProcessCpuNanoseconds() - start_cpu_ns_;
+  allocations_ = AllocationCount() - start_allocations_;
+}
+
+void Measures::AddBytes(uint64_t bytes) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  bytes_ += bytes;
+}
+
+void Measures::AddOperation(Clock::duration latency) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  latencies_us_.push_back(
+      std::chrono::duration<double, std::micro>(latency).count());
+}
+
+void Measures::AddError() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  ++errors_;
+}
+
+Measures::Json Measures::ToJson() const {
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  std::vector<double> sorted_latencies(latencies_us_);
+  std::sort(sorted_latencies.begin(), sorted_latencies.end());
+
+  double seconds = std::chrono::duration<double>(duration_).count();
+  double cpu_seconds = static_cast<double>(cpu_ns_) / 1e9;
+  double gigabytes = static_cast<double>(bytes_) / (1024.0 * 1024.0 * 1024.0);
+  uint64_t operations = sorted_latencies.size();
+
+  Json result;
+  result["workload"] = workload_;
+  result["duration_s"] = seconds;
+  result["bytes"] = bytes_;
+  result["operations"] = operations;
+  result["errors"] = errors_;
+  result["throughput_MBps"] =
+      seconds > 0 ? static_cast<double>(bytes_) / (1024.0 * 1024.0) / seconds
+                  : 0.0;
+  result["operations_per_s"] =
+      seconds > 0 ? static_cast<double>(operations) / seconds : 0.0;
+  result["latency_p50_us"] = LatencyPercentile(sorted_latencies, 0.50);
+  result["latency_p99_us"] = LatencyPercentile(sorted_latencies, 0.99);
+  result["cpu_s"] = cpu_seconds;
+  result["cpu_s_per_GB"] = gigabytes > 0 ? cpu_seconds / gigabytes : 0.0;
+  result["allocations"] = allocations_;
+  result["allocations_per_operation"] =
+      operations > 0 ? static_cast<double>(allocations_) / operations : 0.0;
+
+  return result;
+}
+
+uint64_t Measures::ProcessCpuNanoseconds() {
+  auto times = boost::chrono::process_cpu_clock::now().time_since_epoch();
+  return static_cast<uint64_t>(times.count().user + times.count().system);
+}
+
+double Measures::LatencyPercentile(std::vector<double>& sorted_latencies,
+                                   double percentile) const {
+  if (sorted_latencies.empty()) {
+    return 0.0;
+  }
+
+  auto index = static_cast<std::size_t>(
+      std::ceil(percentile * sorted_latencies.size()));
+  index = std::min(std::max(index, std::size_t(1)), sorted_latencies.size());
+
+  return sorted_latencies[index - 1];
+}
+
+}  // bench
+}  // ssf
@@ -0,0 +1,62 @@
+#ifndef SSF_BENCH_MEASURES_H_
+#define SSF_BENCH_MEASURES_H_
+
+#include <cstdint>
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <json.hpp>
+
+namespace ssf {
+namespace bench {
+
+// Measures of one workload run
+// Bytes, operations and latencies may be recorded from several threads
+// between Start and Stop. CPU time and allocations are measured for the
+// whole process, SSF client and server included.
+class Measures {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using Json = nlohmann::json;
+
+ public:
+  explicit Measures(const std::string& workload);
+
+  void Start();
+  void Stop();
+
+  void AddBytes(uint64_t bytes);
+  void AddOperation(Clock::duration latency);
+  void AddError();
+
+  // One JSON object describing the run
+  Json ToJson() const;
+
+ private:
+  static uint64_t ProcessCpuNanoseconds();
+  double LatencyPercentile(std::vector<double>& sorted_latencies,
+                           double percentile) const;
+
+ private:
+  std::string workload_;
+
+  mutable std::mutex mutex_;
+  uint64_t bytes_;
+  uint64_t errors_;
+  std::vector<double> latencies_us_;
+
+  Clock::time_point start_time_;
+  Clock::duration duration_;
+  uint64_t start_cpu_ns_;
+  uint64_t cpu_ns_;
+  uint64_t start_allocations_;
+  uint64_t allocations_;
+};
+
+}  // bench
+}  // ssf
+
+#endif  // SSF_BENCH_MEASURES_H_
@@ -0,0 +1,239 @@
+#include <cstdint>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/tcp.hpp>
+
+#include "common/boost/fiber/basic_fiber_demux.hpp"
+
+#include "core/factories/service_factory.h"
+#include "core/service_manager/service_manager.h"
+
+#include "services/admin/admin.h"
+#include "services/admin/requests/create_service_request.h"
+#include "services/admin/requests/service_status.h"
+#include "services/admin/requests/stop_service_request.h"
+
+#include "bench/micro/micro_benchmark.h"
+
+namespace {
+
+using ssf::bench::micro::DoNotOptimize;
+using ssf::bench::micro::State;
+
+using Socket = boost::asio::ip::tcp::socket;
+using Demux = boost::asio::fiber::basic_fiber_demux<Socket>;
+using Admin = ssf::services::admin::Admin<Demux>;
+using AdminPtr = std::shared_ptr<Admin>;
+using CreateServiceRequest = ssf::services::admin::CreateServiceRequest<Demux>;
+
+// No microservice is registered with this id: the server replies to its
+// creation requests with an error status
+const uint32_t kUnknownServiceId = 1000;
+
+CreateServiceRequest MakeCreateServiceRequest() {
+  CreateServiceRequest request(kUnknownServiceId);
+  request.add_parameter("local_addr", "127.0.0.1");
+  request.add_parameter("local_port", "9000");
+  request.add_parameter("remote_port", "1234");
+  return request;
+}
+
+void AdminRequestEncode(State& state) {
+  auto request = MakeCreateServiceRequest();
+  while (state.KeepRunning()) {
+    auto serialized = request.OnSending();
+    DoNotOptimize(serialized);
+  }
+}
+SSF_MICRO_BENCHMARK(AdminRequestEncode);
+
+void AdminRequestDecode(State& state) {
+  auto serialized = MakeCreateServiceRequest().OnSending();
+  CreateServiceRequest request;
+  while (state.KeepRunning()) {
+    bool decoded = request.Decode(serialized.data(), serialized.size());
+    DoNotOptimize(decoded);
+  }
+}
+SSF_MICRO_BENCHMARK(AdminRequestDecode);
+
+// Client and server admin services over a loopback TCP connection
+class AdminPair {
+ public:
+  AdminPair()
+      : io_service_(),
+        p_work_(new boost::asio::io_service::work(io_service_)),
+        demux_server_(io_service_),
+        demux_client_(io_service_),
+        threads_() {
+    for (int i = 0; i < 2; ++i) {
+      threads_.emplace_back([this]() {
+        boost::system::error_code ec;
+        io_service_.run(ec);
+      });
+    }
+  }
+
+  ~AdminPair() {
+    if (p_server_manager_) {
+      p_server_manager_->stop_all();
+      p_server_factory_->Destroy();
+    }
+    if (p_client_manager_) {
+      p_client_manager_->stop_all();
+      p_client_factory_->Destroy();
+    }
+    demux_client_.close();
+    demux_server_.close();
+    p_work_.reset();
+    io_service_.stop();
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+  }
+
+  // Connect the demuxes and wait for the client admin to be initialized
+  bool Start() {
+    boost::system::error_code ec;
+    boost::asio::ip::tcp::acceptor acceptor(io_service_);
+    boost::asio::ip::tcp::endpoint endpoint(
+        boost::asio::ip::address_v4::loopback(), 0);
+    acceptor.open(endpoint.protocol(), ec);
+    acceptor.bind(endpoint, ec);
+    acceptor.listen(boost::asio::socket_base::max_connections, ec);
+    if (ec) {
+      return false;
+    }
+
+    Socket server_socket(io_service_);
+    Socket client_socket(io_service_);
+    client_socket.connect(acceptor.local_endpoint(), ec);
+    acceptor.accept(server_socket, ec);
+    if (ec) {
+      return false;
+    }
+    demux_server_.fiberize(std::move(server_socket));
+    demux_client_.fiberize(std::move(client_socket));
+
+    auto p_server_admin =
+        StartAdmin(demux_server_, &p_server_manager_, &p_server_factory_);
+    if (!p_server_admin) {
+      return false;
+    }
+    p_server_admin->SetAsServer();
+    p_server_manager_->start(p_server_admin, ec);
+    if (ec) {
+      return false;
+    }
+
+    p_client_admin_ =
+        StartAdmin(demux_client_, &p_client_manager_, &p_client_factory_);
+    if (!p_client_admin_) {
+      return false;
+    }
+    std::promise<boost::system::error_code> initialized;
+    p_client_admin_->SetAsClient(
+        {}, [](Admin::BaseUserServicePtr, const boost::system::error_code&) {},
+        [&initialized](const boost::system::error_code& init_ec) {
+          initialized.set_value(init_ec);
+        });
+    p_client_manager_->start(p_client_admin_, ec);
+    if (ec) {
+      return false;
+    }
+
+    auto initialized_future = initialized.get_future();
+    return initialized_future.wait_for(std::chrono::seconds(5)) ==
+               std::future_status::ready &&
+           !initialized_future.get();
+  }
+
+  AdminPtr client_admin() { return p_client_admin_; }
+
+ private:
+  AdminPtr StartAdmin(
+      Demux& demux, ssf::ServiceManagerPtr<Demux>* p_manager,
+      std::shared_ptr<ssf::ServiceFactory<Demux>>* p_factory) {
+    *p_manager = std::make_shared<ssf::ServiceManager<Demux>>();
+    *p_factory =
+        ssf::ServiceFactory<Demux>::Create(io_service_, demux, *p_manager);
+
+    auto p_admin = Admin::Create(io_service_, demux, {});
+    if (!p_admin->template RegisterCommand<
+            ssf::services::admin::CreateServiceRequest>() ||
+        !p_admin->template RegisterCommand<
+            ssf::services::admin::StopServiceRequest>() ||
+        !p_admin
+             ->template RegisterCommand<ssf::services::admin::ServiceStatus>()) {
+      return nullptr;
+    }
+
+    return p_admin;
+  }
+
+ private:
+  boost::asio::io_service io_service_;
+  std::unique_ptr<boost::asio::io_service::work> p_work_;
+  Demux demux_server_;
+  Demux demux_client_;
+  ssf::ServiceManagerPtr<Demux> p_server_manager_;
+  ssf::ServiceManagerPtr<Demux> p_client_manager_;
+  std::shared_ptr<ssf::ServiceFactory<Demux>> p_server_factory_;
+  std::shared_ptr<ssf::ServiceFactory<Demux>> p_client_factory_;
+  AdminPtr p_client_admin_;
+  std::vector<std::thread> threads_;
+};
+
+// Service creation requests answered by the server admin, arg requests in
+// flight, one operation per status received by the client
+void AdminCommandRoundTrip(State& state) {
+  auto in_flight = static_cast<uint64_t>(state.arg());
+  uint64_t total = state.iterations();
+
+  // Declared before the admin services so that they outlive the io threads
+  std::atomic<uint64_t> sent(0);
+  std::atomic<uint64_t> answered(0);
+  std::promise<void> all_answered;
+  std::function<void()> send_request;
+
+  AdminPair pair;
+  if (!pair.Start()) {
+    state.SkipWithError("could not start admin services");
+    return;
+  }
+
+  auto p_admin = pair.client_admin();
+  auto request = MakeCreateServiceRequest();
+  send_request = [&]() {
+    if (sent.fetch_add(1) >= total) {
+      return;
+    }
+    p_admin->Command(request, [&](const boost::system::error_code&) {
+      if (answered.fetch_add(1) + 1 == total) {
+        all_answered.set_value();
+        return;
+      }
+      send_request();
+    });
+  };
+
+  state.StartTimer();
+  for (uint64_t i = 0; i < in_flight; ++i) {
+    send_request();
+  }
+  all_answered.get_future().wait();
+  state.StopTimer();
+}
+SSF_MICRO_BENCHMARK(AdminCommandRoundTrip)->Arg(1)->Arg(16)->Arg(256);
+
+}  // unnamed namespace
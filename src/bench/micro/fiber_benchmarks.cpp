@@ -0,0 +1,470 @@
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/write.hpp>
+
+#include "common/boost/fiber/basic_fiber_demux.hpp"
+#include "common/boost/fiber/datagram_fiber.hpp"
+#include "common/boost/fiber/detail/fiber_frames.hpp"
+#include "common/boost/fiber/detail/fiber_header.hpp"
+#include "common/boost/fiber/stream_fiber.hpp"
+
+#include "bench/micro/micro_benchmark.h"
+
+namespace {
+
+using ssf::bench::micro::DoNotOptimize;
+using ssf::bench::micro::State;
+
+using fiber_header = boost::asio::fiber::detail::fiber_header;
+using fiber_frames = boost::asio::fiber::detail::fiber_frames;
+using fiber_id = boost::asio::fiber::detail::fiber_id;
+
+// Push flag of the demux data packets
+const fiber_header::flags_type kFlagPush = 16;
+
+// Default mtu of the demux
+const std::size_t kDemuxMtu = 60 * 1024;
+
+void FiberHeaderEncode(State& state) {
+  fiber_header header(fiber_id(1, 2), kFlagPush, 0);
+  fiber_header::data_size_type size = 0;
+  while (state.KeepRunning()) {
+    header.set_data_size(++size);
+    auto raw = header.get_raw();
+    DoNotOptimize(raw);
+  }
+}
+SSF_MICRO_BENCHMARK(FiberHeaderEncode);
+
+void FiberHeaderEncodeBuffers(State& state) {
+  fiber_header header(fiber_id(1, 2), kFlagPush, 0);
+  fiber_header::data_size_type size = 0;
+  while (state.KeepRunning()) {
+    header.set_data_size(++size);
+    auto buffers = header.const_buffer();
+    DoNotOptimize(buffers);
+  }
+}
+SSF_MICRO_BENCHMARK(FiberHeaderEncodeBuffers);
+
+void FiberHeaderDecode(State& state) {
+  fiber_header header(fiber_id(1, 2), kFlagPush, 1024);
+  auto raw = header.get_raw();
+  std::array<uint8_t, sizeof(raw)> wire;
+  std::memcpy(wire.data(), &raw, sizeof(raw));
+
+  fiber_header decoded;
+  while (state.KeepRunning()) {
+    ++wire[sizeof(raw) - 1];
+    decoded.decode(wire.data());
+    DoNotOptimize(decoded);
+  }
+}
+SSF_MICRO_BENCHMARK(FiberHeaderDecode);
+
+// Split arg bytes into demux packets
+void FiberFramesFill(State& state) {
+  std::vector<uint8_t> payload(static_cast<std::size_t>(state.arg()));
+  fiber_frames frames;
+  std::size_t framed = 0;
+  while (state.KeepRunning()) {
+    framed += frames.fill(fiber_id(1, 2), kFlagPush,
+                          boost::asio::buffer(payload), kDemuxMtu);
+    DoNotOptimize(frames);
+  }
+  state.SetBytesProcessed(framed);
+}
+SSF_MICRO_BENCHMARK(FiberFramesFill)->Arg(64)->Arg(4096)->Arg(256 * 1024);
+
+// Two demuxes over a loopback TCP connection with connected stream fibers,
+// run by threads_count io threads
+class FiberDemuxPair {
+ public:
+  using socket = boost::asio::ip::tcp::socket;
+  using demux = boost::asio::fiber::basic_fiber_demux<socket>;
+  using stream_fiber = boost::asio::fiber::stream_fiber<socket>;
+  using fiber = stream_fiber::socket;
+  using FiberPtr = std::unique_ptr<fiber>;
+
+ public:
+  explicit FiberDemuxPair(std::size_t threads_count = 2)
+      : io_service_(),
+        p_work_(new boost::asio::io_service::work(io_service_)),
+        demux_server_(io_service_),
+        demux_client_(io_service_),
+        threads_() {
+    for (std::size_t i = 0; i < threads_count; ++i) {
+      threads_.emplace_back([this]() {
+        boost::system::error_code ec;
+        io_service_.run(ec);
+      });
+    }
+  }
+
+  ~FiberDemuxPair() {
+    boost::system::error_code ec;
+    for (auto& p_fiber : server_fibers_) {
+      p_fiber->close(ec);
+    }
+    for (auto& p_fiber : client_fibers_) {
+      p_fiber->close(ec);
+    }
+    demux_client_.close();
+    demux_server_.close();
+    p_work_.reset();
+    io_service_.stop();
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+    server_fibers_.clear();
+    client_fibers_.clear();
+  }
+
+  // Connect the demuxes and connect count fiber pairs over them
+  // Return false if a connection fails
+  bool Connect(std::size_t count) {
+    boost::system::error_code ec;
+    boost::asio::ip::tcp::acceptor acceptor(io_service_);
+    boost::asio::ip::tcp::endpoint endpoint(
+        boost::asio::ip::address_v4::loopback(), 0);
+    acceptor.open(endpoint.protocol(), ec);
+    acceptor.bind(endpoint, ec);
+    acceptor.listen(boost::asio::socket_base::max_connections, ec);
+    if (ec) {
+      return false;
+    }
+
+    socket server_socket(io_service_);
+    socket client_socket(io_service_);
+    client_socket.connect(acceptor.local_endpoint(), ec);
+    acceptor.accept(server_socket, ec);
+    if (ec) {
+      return false;
+    }
+    demux_server_.fiberize(std::move(server_socket));
+    demux_client_.fiberize(std::move(client_socket));
+
+    stream_fiber::acceptor fiber_acceptor(io_service_);
+    stream_fiber::endpoint server_endpoint(stream_fiber::v1(), demux_server_,
+                                           1);
+    fiber_acceptor.open(server_endpoint.protocol());
+    fiber_acceptor.bind(server_endpoint, ec);
+    fiber_acceptor.listen();
+    if (ec) {
+      return false;
+    }
+
+    for (std::size_t i = 0; i < count; ++i) {
+      server_fibers_.emplace_back(new fiber(io_service_));
+      client_fibers_.emplace_back(new fiber(io_service_));
+
+      std::promise<boost::system::error_code> accepted;
+      std::promise<boost::system::error_code> connected;
+      fiber_acceptor.async_accept(
+          *server_fibers_.back(),
+          [&accepted](const boost::system::error_code& accept_ec) {
+            accepted.set_value(accept_ec);
+          });
+      stream_fiber::endpoint client_endpoint(stream_fiber::v1(),
+                                             demux_client_, 1);
+      client_fibers_.back()->async_connect(
+          client_endpoint,
+          [&connected](const boost::system::error_code& connect_ec) {
+            connected.set_value(connect_ec);
+          });
+
+      if (accepted.get_future().get() || connected.get_future().get()) {
+        return false;
+      }
+    }
+
+    fiber_acceptor.close(ec);
+    return true;
+  }
+
+  boost::asio::io_service& io_service() { return io_service_; }
+  demux& client_demux() { return demux_client_; }
+
+  std::vector<FiberPtr>& server_fibers() { return server_fibers_; }
+  std::vector<FiberPtr>& client_fibers() { return client_fibers_; }
+
+ private:
+  boost::asio::io_service io_service_;
+  std::unique_ptr<boost::asio::io_service::work> p_work_;
+  demux demux_server_;
+  demux demux_client_;
+  std::vector<FiberPtr> server_fibers_;
+  std::vector<FiberPtr> client_fibers_;
+  std::vector<std::thread> threads_;
+};
+
+// Small packets written round robin on fibers_count fibers and dispatched by
+// the receiving demux, one operation per packet
+void RunDemuxDispatch(State& state, std::size_t fibers_count,
+                      std::size_t threads_count) {
+  const std::size_t packet_size = 256;
+
+  using Handler =
+      std::function<void(const boost::system::error_code&, std::size_t)>;
+
+  // Declared before the demuxes so that they outlive the io threads
+  uint64_t expected = state.iterations() * packet_size;
+  std::atomic<uint64_t> received(0);
+  std::promise<void> all_received;
+  std::vector<std::array<uint8_t, 4096>> read_buffers(fibers_count);
+  std::vector<Handler> read_handlers(fibers_count);
+  std::vector<uint8_t> packet(packet_size, 1);
+  std::vector<Handler> write_handlers(fibers_count);
+  std::vector<uint64_t> remaining(fibers_count,
+                                  state.iterations() / fibers_count);
+  for (uint64_t i = 0; i < state.iterations() % fibers_count; ++i) {
+    ++remaining[i];
+  }
+
+  FiberDemuxPair pair(threads_count);
+  if (!pair.Connect(fibers_count)) {
+    state.SkipWithError("could not connect fibers");
+    return;
+  }
+
+  for (std::size_t i = 0; i < fibers_count; ++i) {
+    auto p_fiber = pair.server_fibers()[i].get();
+    auto p_buffer = &read_buffers[i];
+    auto p_handler = &read_handlers[i];
+    *p_handler = [&received, &all_received, expected, p_fiber, p_buffer,
+                  p_handler](const boost::system::error_code& ec,
+                             std::size_t length) {
+      if (ec) {
+        return;
+      }
+      if (received.fetch_add(length) + length == expected) {
+        all_received.set_value();
+        return;
+      }
+      p_fiber->async_read_some(boost::asio::buffer(*p_buffer), *p_handler);
+    };
+  }
+
+  for (std::size_t i = 0; i < fibers_count; ++i) {
+    auto p_fiber = pair.client_fibers()[i].get();
+    auto p_packets = &remaining[i];
+    auto p_handler = &write_handlers[i];
+    *p_handler = [&packet, p_fiber, p_packets, p_handler](
+        const boost::system::error_code& ec, std::size_t) {
+      if (ec || *p_packets == 0) {
+        return;
+      }
+      --*p_packets;
+      p_fiber->async_write_some(boost::asio::buffer(packet), *p_handler);
+    };
+  }
+
+  state.StartTimer();
+  for (std::size_t i = 0; i < fibers_count; ++i) {
+    pair.server_fibers()[i]->async_read_some(
+        boost::asio::buffer(read_buffers[i]), read_handlers[i]);
+    write_handlers[i](boost::system::error_code(), 0);
+  }
+  all_received.get_future().wait();
+  state.StopTimer();
+  state.SetBytesProcessed(expected);
+}
+
+void FiberDemuxDispatch(State& state) {
+  RunDemuxDispatch(state, static_cast<std::size_t>(state.arg()), 2);
+}
+SSF_MICRO_BENCHMARK(FiberDemuxDispatch)->Arg(1)->Arg(16)->Arg(256);
+
+// Packets of 1024 fibers dispatched by arg io threads: the fibers and the
+// demux send side contend for their strands (formerly their mutexes)
+void FiberDemuxContention(State& state) {
+  RunDemuxDispatch(state, 1024, static_cast<std::size_t>(state.arg()));
+}
+SSF_MICRO_BENCHMARK(FiberDemuxContention)->Arg(2)->Arg(8)->Arg(32);
+
+// Messages of arg bytes echoed by the server fiber, one operation per round
+// trip: measures the latency of small fiber reads and writes
+void FiberEchoLatency(State& state) {
+  auto message_size = static_cast<std::size_t>(state.arg());
+
+  using Handler =
+      std::function<void(const boost::system::error_code&, std::size_t)>;
+
+  // Declared before the demuxes so that they outlive the io threads
+  std::vector<uint8_t> message(message_size, 1);
+  std::vector<uint8_t> echo_buffer(message_size);
+  std::vector<uint8_t> client_buffer(message_size);
+  std::size_t client_received = 0;
+  uint64_t remaining = state.iterations();
+  std::promise<void> all_echoed;
+  Handler on_echo_read;
+  Handler on_echo_written;
+  Handler on_client_read;
+  Handler on_client_written;
+
+  FiberDemuxPair pair;
+  if (!pair.Connect(1)) {
+    state.SkipWithError("could not connect fibers");
+    return;
+  }
+  auto p_server = pair.server_fibers().front().get();
+  auto p_client = pair.client_fibers().front().get();
+
+  on_echo_read = [&](const boost::system::error_code& ec, std::size_t length) {
+    if (ec) {
+      return;
+    }
+    boost::asio::async_write(*p_server,
+                             boost::asio::buffer(echo_buffer.data(), length),
+                             on_echo_written);
+  };
+  on_echo_written = [&](const boost::system::error_code& ec, std::size_t) {
+    if (ec) {
+      return;
+    }
+    p_server->async_read_some(boost::asio::buffer(echo_buffer), on_echo_read);
+  };
+  on_client_written = [](const boost::system::error_code&, std::size_t) {};
+  on_client_read = [&](const boost::system::error_code& ec,
+                       std::size_t length) {
+    if (ec) {
+      return;
+    }
+    client_received += length;
+    if (client_received < message_size) {
+      p_client->async_read_some(
+          boost::asio::buffer(client_buffer.data() + client_received,
+                              message_size - client_received),
+          on_client_read);
+      return;
+    }
+    if (--remaining == 0) {
+      all_echoed.set_value();
+      return;
+    }
+    client_received = 0;
+    p_client->async_read_some(boost::asio::buffer(client_buffer),
+                              on_client_read);
+    boost::asio::async_write(*p_client, boost::asio::buffer(message),
+                             on_client_written);
+  };
+
+  state.StartTimer();
+  p_server->async_read_some(boost::asio::buffer(echo_buffer), on_echo_read);
+  p_client->async_read_some(boost::asio::buffer(client_buffer),
+                            on_client_read);
+  boost::asio::async_write(*p_client, boost::asio::buffer(message),
+                           on_client_written);
+  all_echoed.get_future().wait();
+  state.StopTimer();
+  state.SetBytesProcessed(state.iterations() * message_size);
+}
+SSF_MICRO_BENCHMARK(FiberEchoLatency)->Arg(16)->Arg(256)->Arg(4096);
+
+using datagram_fiber =
+    boost::asio::fiber::datagram_fiber<boost::asio::ip::tcp::socket>;
+using DatagramFiberPtr = std::unique_ptr<datagram_fiber::socket>;
+
+// Construct a datagram fiber and bind it to a local port of the demux
+bool OpenFiber(FiberDemuxPair& pair, uint32_t port,
+               std::vector<DatagramFiberPtr>* p_fibers) {
+  boost::system::error_code ec;
+  p_fibers->emplace_back(new datagram_fiber::socket(pair.io_service()));
+  p_fibers->back()->bind(
+      datagram_fiber::endpoint(datagram_fiber::v1(), pair.client_demux(),
+                               port),
+      ec);
+  return !ec;
+}
+
+void CloseFibers(std::vector<DatagramFiberPtr>* p_fibers) {
+  boost::system::error_code ec;
+  for (auto& p_fiber : *p_fibers) {
+    p_fiber->close(ec);
+  }
+  p_fibers->clear();
+}
+
+// Fibers opened on a demux by batches of arg, one operation per fiber
+// The allocated bytes per operation give the memory held by an open fiber
+// (implementation object and demux bookkeeping)
+void FiberOpen(State& state) {
+  auto batch_size = static_cast<uint64_t>(state.arg());
+
+  FiberDemuxPair pair;
+  if (!pair.Connect(0)) {
+    state.SkipWithError("could not connect demuxes");
+    return;
+  }
+
+  std::vector<DatagramFiberPtr> fibers;
+  fibers.reserve(static_cast<std::size_t>(batch_size));
+  for (uint64_t opened = 0; opened < state.iterations();) {
+    auto batch = std::min(batch_size, state.iterations() - opened);
+    state.StartTimer();
+    for (uint64_t i = 0; i < batch; ++i) {
+      if (!OpenFiber(pair, static_cast<uint32_t>(i + 1), &fibers)) {
+        state.SkipWithError("could not bind fiber");
+        break;
+      }
+    }
+    state.StopTimer();
+    CloseFibers(&fibers);
+    if (!state.error().empty()) {
+      return;
+    }
+    opened += batch;
+  }
+}
+SSF_MICRO_BENCHMARK(FiberOpen)->Arg(1000)->Arg(1000000);
+
+// A fiber opened and closed while arg other fibers are open on the demux,
+// one operation per open/close cycle
+void FiberOpenClose(State& state) {
+  auto open_count = static_cast<uint32_t>(state.arg());
+
+  FiberDemuxPair pair;
+  if (!pair.Connect(0)) {
+    state.SkipWithError("could not connect demuxes");
+    return;
+  }
+
+  std::vector<DatagramFiberPtr> open_fibers;
+  open_fibers.reserve(open_count);
+  for (uint32_t i = 0; i < open_count; ++i) {
+    if (!OpenFiber(pair, i + 1, &open_fibers)) {
+      state.SkipWithError("could not bind fiber");
+      CloseFibers(&open_fibers);
+      return;
+    }
+  }
+
+  std::vector<DatagramFiberPtr> fibers;
+  fibers.reserve(1);
+  state.StartTimer();
+  for (uint64_t i = 0; i < state.iterations(); ++i) {
+    if (!OpenFiber(pair, open_count + 1, &fibers)) {
+      state.SkipWithError("could not bind fiber");
+      break;
+    }
+    CloseFibers(&fibers);
+  }
+  state.StopTimer();
+
+  CloseFibers(&open_fibers);
+}
+SSF_MICRO_BENCHMARK(FiberOpenClose)->Arg(0)->Arg(1000)->Arg(1000000);
+
+}  // unnamed namespace
@@ -0,0 +1,399 @@
+#include <cstdint>
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/udp.hpp>
+#include <boost/asio/write.hpp>
+
+#include "ssf/error/error.h"
+#include "ssf/layer/congestion/drop_tail_policy.h"
+#include "ssf/layer/multiplexing/basic_demultiplexer.h"
+#include "ssf/layer/multiplexing/basic_multiplexer_protocol.h"
+#include "ssf/layer/multiplexing/port_multiplex_id.h"
+#include "ssf/layer/parameters.h"
+#include "ssf/layer/physical/tlsotcp.h"
+#include "ssf/layer/physical/udp.h"
+#include "ssf/layer/queue/async_queue.h"
+#include "ssf/layer/queue/commutator.h"
+#include "ssf/layer/routing/basic_routing_table.h"
+
+#include "tests/virtual_network_helpers.h"
+
+#include "bench/micro/micro_benchmark.h"
+
+namespace {
+
+using ssf::bench::micro::DoNotOptimize;
+using ssf::bench::micro::State;
+
+// Loopback ports used by the benchmarks opening sockets
+// A different port is used by each run so that sockets of the previous run
+// do not prevent binding.
+std::string NextPort() {
+  static std::atomic<uint32_t> run(0);
+  return std::to_string(18100 + (run++ % 100));
+}
+
+// io_service run by background threads for the lifetime of the object
+class BackgroundIoService {
+ public:
+  explicit BackgroundIoService(std::size_t threads_count)
+      : io_service_(),
+        p_work_(new boost::asio::io_service::work(io_service_)),
+        threads_() {
+    for (std::size_t i = 0; i < threads_count; ++i) {
+      threads_.emplace_back([this]() {
+        boost::system::error_code ec;
+        io_service_.run(ec);
+      });
+    }
+  }
+
+  ~BackgroundIoService() {
+    p_work_.reset();
+    io_service_.stop();
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+  }
+
+  boost::asio::io_service& get() { return io_service_; }
+
+ private:
+  boost::asio::io_service io_service_;
+  std::unique_ptr<boost::asio::io_service::work> p_work_;
+  std::vector<std::thread> threads_;
+};
+
+// Reads of arg bytes from a TLS stream buffered by TLSStreamBufferer while
+// the peer writes continuously, one operation per read
+void TlsBuffererRead(State& state) {
+  using TlsProtocol = ssf::layer::physical::TLSboTCPPhysicalLayer;
+
+  std::vector<uint8_t> read_buffer(static_cast<std::size_t>(state.arg()));
+  std::vector<uint8_t> write_buffer(64 * 1024, 1);
+  std::atomic<bool> reading(true);
+  uint64_t reads = 0;
+  uint64_t received = 0;
+  std::promise<boost::system::error_code> done;
+  std::promise<boost::system::error_code> accepted;
+  std::promise<boost::system::error_code> connected;
+  // Declared before the io threads so that they outlive them
+  std::function<void(const boost::system::error_code&, std::size_t)> written;
+  std::function<void(const boost::system::error_code&, std::size_t)> read;
+
+  BackgroundIoService io_service(2);
+  TlsProtocol::socket client(io_service.get());
+  TlsProtocol::socket server(io_service.get());
+  TlsProtocol::acceptor acceptor(io_service.get());
+  TlsProtocol::resolver resolver(io_service.get());
+
+  auto port = NextPort();
+  ssf::layer::ParameterStack acceptor_parameters;
+  acceptor_parameters.push_back(
+      tests::virtual_network_helpers::GetServerTLSParametersAsBuffer());
+  acceptor_parameters.push_back({{"port", port}});
+  ssf::layer::ParameterStack client_parameters;
+  client_parameters.push_back(
+      tests::virtual_network_helpers::GetClientTLSParametersAsBuffer());
+  client_parameters.push_back({{"addr", "127.0.0.1"}, {"port", port}});
+
+  boost::system::error_code ec;
+  TlsProtocol::endpoint acceptor_endpoint(
+      *resolver.resolve(acceptor_parameters, ec));
+  TlsProtocol::endpoint remote_endpoint(
+      *resolver.resolve(client_parameters, ec));
+  acceptor.open();
+  acceptor.set_option(boost::asio::socket_base::reuse_address(true), ec);
+  acceptor.bind(acceptor_endpoint, ec);
+  acceptor.listen(100, ec);
+  if (ec) {
+    state.SkipWithError("could not listen: " + ec.message());
+    return;
+  }
+
+  acceptor.async_accept(server, [&](const boost::system::error_code& ec) {
+    accepted.set_value(ec);
+  });
+  client.async_connect(remote_endpoint,
+                       [&](const boost::system::error_code& ec) {
+                         connected.set_value(ec);
+                       });
+  if (accepted.get_future().get() || connected.get_future().get()) {
+    state.SkipWithError("could not connect TLS sockets");
+    return;
+  }
+
+  written = [&](const boost::system::error_code& ec, std::size_t) {
+    if (ec || !reading) {
+      return;
+    }
+    boost::asio::async_write(server, boost::asio::buffer(write_buffer),
+                             written);
+  };
+
+  read = [&](const boost::system::error_code& ec, std::size_t length) {
+    if (ec) {
+      done.set_value(ec);
+      return;
+    }
+    received += length;
+    if (++reads == state.iterations()) {
+      reading = false;
+      done.set_value(ec);
+      return;
+    }
+    client.async_read_some(boost::asio::buffer(read_buffer), read);
+  };
+
+  written(boost::system::error_code(), 0);
+
+  state.StartTimer();
+  client.async_read_some(boost::asio::buffer(read_buffer), read);
+  auto read_ec = done.get_future().get();
+  state.StopTimer();
+  state.SetBytesProcessed(received);
+
+  if (read_ec) {
+    state.SkipWithError("read failed: " + read_ec.message());
+  }
+
+  client.close(ec);
+  server.close(ec);
+  acceptor.close(ec);
+}
+SSF_MICRO_BENCHMARK(TlsBuffererRead)->Arg(1024)->Arg(16 * 1024)->Arg(
+    64 * 1024);
+
+// Datagrams sent round robin to arg sockets bound on a demultiplexer, one
+// operation per datagram dispatched to its socket queue
+void DemultiplexerDispatch(State& state) {
+  using CongestionPolicy = ssf::layer::congestion::DropTailPolicy<1024>;
+  using Protocol = ssf::layer::multiplexing::basic_MultiplexedProtocol<
+      ssf::layer::physical::UDPPhysicalLayer,
+      ssf::layer::multiplexing::PortMultiplexID, CongestionPolicy>;
+  using Demultiplexer =
+      ssf::layer::multiplexing::basic_Demultiplexer<Protocol,
+                                                     CongestionPolicy>;
+  using NextSocket = Protocol::next_layer_protocol::socket;
+  using SocketContextPtr = std::shared_ptr<Protocol::socket_context>;
+
+  const std::size_t payload_size = 64;
+  const uint64_t window = 256;
+  auto sockets_count = static_cast<uint16_t>(state.arg());
+
+  BackgroundIoService io_service(1);
+  boost::system::error_code ec;
+
+  auto port = NextPort();
+  ssf::layer::ParameterStack parameters;
+  parameters.push_back({{"addr", "127.0.0.1"}, {"port", port}});
+  Protocol::next_layer_protocol::resolver resolver(io_service.get());
+  Protocol::next_layer_protocol::endpoint endpoint(
+      *resolver.resolve(parameters, ec));
+
+  auto p_next_socket = std::make_shared<NextSocket>(io_service.get());
+  p_next_socket->open();
+  p_next_socket->bind(endpoint, ec);
+  if (ec) {
+    state.SkipWithError("could not bind: " + ec.message());
+    return;
+  }
+
+  auto p_demultiplexer = Demultiplexer::Create(p_next_socket);
+  std::vector<SocketContextPtr> contexts;
+  for (uint16_t i = 1; i <= sockets_count; ++i) {
+    auto p_context = std::make_shared<Protocol::socket_context>();
+    p_context->local_id = Protocol::endpoint_context_type(i);
+    p_demultiplexer->Bind(p_context);
+    contexts.push_back(p_context);
+  }
+  p_demultiplexer->Start();
+
+  boost::asio::io_service sender_io_service;
+  boost::asio::ip::udp::socket sender(sender_io_service);
+  sender.connect(
+      boost::asio::ip::udp::endpoint(boost::asio::ip::address_v4::loopback(),
+                                     static_cast<uint16_t>(std::stoul(port))),
+      ec);
+
+  // Datagram header: remote id then local id
+  std::vector<uint8_t> datagram(2 * sizeof(uint16_t) + payload_size, 1);
+  uint16_t remote_id = 1;
+  std::memcpy(datagram.data(), &remote_id, sizeof(remote_id));
+
+  auto drain = [&contexts]() {
+    uint64_t dispatched = 0;
+    for (auto& p_context : contexts) {
+      std::unique_lock<std::recursive_mutex> lock(p_context->mutex);
+      while (!p_context->datagram_queue.empty()) {
+        p_context->datagram_queue.pop();
+        p_context->next_endpoint_queue.pop();
+        ++dispatched;
+      }
+    }
+    return dispatched;
+  };
+
+  uint64_t sent = 0;
+  uint64_t dispatched = 0;
+  uint64_t lost = 0;
+  state.StartTimer();
+  while (dispatched + lost < state.iterations()) {
+    while (sent < state.iterations() && sent - dispatched - lost < window) {
+      uint16_t local_id = static_cast<uint16_t>(sent % sockets_count + 1);
+      std::memcpy(datagram.data() + sizeof(remote_id), &local_id,
+                  sizeof(local_id));
+      sender.send(boost::asio::buffer(datagram), 0, ec);
+      ++sent;
+    }
+
+    auto wait_start = State::Clock::now();
+    uint64_t newly_dispatched = 0;
+    while ((newly_dispatched = drain()) == 0) {
+      if (State::Clock::now() - wait_start > std::chrono::seconds(1)) {
+        // Datagrams dropped by the kernel
+        lost = sent - dispatched;
+        break;
+      }
+      std::this_thread::yield();
+    }
+    dispatched += newly_dispatched;
+  }
+  state.StopTimer();
+
+  if (lost) {
+    state.SkipWithError(std::to_string(lost) + " datagrams lost");
+  }
+
+  p_demultiplexer->Stop();
+  p_next_socket->close(ec);
+}
+SSF_MICRO_BENCHMARK(DemultiplexerDispatch)->Arg(1)->Arg(16)->Arg(256);
+
+struct RoutingProtocol {
+  using endpoint_context_type = uint32_t;
+};
+
+// Lookups in a routing table holding arg routes
+void RoutingTableResolve(State& state) {
+  ssf::layer::routing::basic_RoutingTable<RoutingProtocol> table;
+  auto routes = static_cast<uint32_t>(state.arg());
+
+  boost::system::error_code ec;
+  for (uint32_t prefix = 0; prefix < routes; ++prefix) {
+    table.AddRoute(prefix, prefix + 1, ec);
+  }
+
+  uint32_t prefix = 0;
+  while (state.KeepRunning()) {
+    auto network_address = table.Resolve(prefix, ec);
+    DoNotOptimize(network_address);
+    prefix = (prefix + 7919) % routes;
+  }
+}
+SSF_MICRO_BENCHMARK(RoutingTableResolve)->Arg(16)->Arg(1024)->Arg(65536);
+
+// Synchronous push and get
+void AsyncQueuePushGet(State& state) {
+  boost::asio::io_service io_service;
+  ssf::layer::queue::basic_async_queue<uint64_t> queue(io_service);
+
+  boost::system::error_code ec;
+  uint64_t value = 0;
+  while (state.KeepRunning()) {
+    queue.push(value++, ec);
+    auto element = queue.get(ec);
+    DoNotOptimize(element);
+  }
+}
+SSF_MICRO_BENCHMARK(AsyncQueuePushGet);
+
+// Pending async_get completed by a push, completion handler run included
+void AsyncQueueAsyncGet(State& state) {
+  boost::asio::io_service io_service;
+  ssf::layer::queue::basic_async_queue<uint64_t> queue(io_service);
+
+  boost::system::error_code ec;
+  uint64_t value = 0;
+  uint64_t sum = 0;
+  auto on_get = [&sum](const boost::system::error_code& ec,
+                       uint64_t element) { sum += element; };
+  while (state.KeepRunning()) {
+    queue.async_get(on_get);
+    queue.push(value++, ec);
+    io_service.poll();
+    io_service.reset();
+  }
+  DoNotOptimize(sum);
+}
+SSF_MICRO_BENCHMARK(AsyncQueueAsyncGet);
+
+struct ModuloSelector {
+  bool operator()(uint32_t* p_id, uint64_t* p_element) const {
+    *p_id = static_cast<uint32_t>(*p_element % outputs);
+    return true;
+  }
+
+  uint32_t outputs;
+};
+
+// Elements read from one input and commuted to arg outputs, one operation
+// per element delivered to its output
+void CommutatorCommute(State& state) {
+  using Commutator =
+      ssf::layer::queue::Commutator<uint32_t, uint64_t, ModuloSelector>;
+
+  boost::asio::io_service io_service;
+  ModuloSelector selector = {static_cast<uint32_t>(state.arg())};
+  auto p_commutator = Commutator::Create(io_service, selector);
+
+  uint64_t produced = 0;
+  uint64_t delivered = 0;
+  auto input = [&](Commutator::InputHandler handler) {
+    if (produced == state.iterations()) {
+      io_service.post([handler]() {
+        handler(boost::system::error_code(ssf::error::interrupted,
+                                          ssf::error::get_ssf_category()),
+                0);
+      });
+      return;
+    }
+    auto element = produced++;
+    io_service.post([handler, element]() {
+      handler(boost::system::error_code(), element);
+    });
+  };
+  auto output = [&](uint64_t element, Commutator::OutputHandler handler) {
+    ++delivered;
+    handler(boost::system::error_code());
+  };
+
+  for (uint32_t id = 0; id < selector.outputs; ++id) {
+    p_commutator->RegisterOutput(id, output);
+  }
+
+  state.StartTimer();
+  p_commutator->RegisterInput(selector.outputs, input);
+  io_service.run();
+  state.StopTimer();
+
+  if (delivered != state.iterations()) {
+    state.SkipWithError("elements not delivered");
+  }
+
+  boost::system::error_code ec;
+  p_commutator->close(ec);
+}
+SSF_MICRO_BENCHMARK(CommutatorCommute)->Arg(1)->Arg(16)->Arg(256);
+
+}  // unnamed namespace
@@ -0,0 +1,145 @@
+#include "bench/micro/micro_benchmark.h"
+
+#include <algorithm>
+
+#include "bench/alloc_counter.h"
+
+namespace ssf {
+namespace bench {
+namespace micro {
+
+namespace {
+
+const uint64_t kMaxIterations = 1000000000;
+
+std::vector<std::unique_ptr<Benchmark>>& Benchmarks() {
+  static std::vector<std::unique_ptr<Benchmark>> benchmarks;
+  return benchmarks;
+}
+
+}  // unnamed namespace
+
+State::State(uint64_t iterations, int64_t arg)
+    : iterations_(iterations),
+      arg_(arg),
+      done_(0),
+      started_(false),
+      running_(false),
+      start_time_(),
+      elapsed_(Clock::duration::zero()),
+      start_allocations_(0),
+      allocations_(0),
+      start_allocated_bytes_(0),
+      allocated_bytes_(0),
+      bytes_processed_(0),
+      error_() {}
+
+bool State::KeepRunning() {
+  if (!started_) {
+    started_ = true;
+    StartTimer();
+  }
+
+  if (done_ < iterations_ && error_.empty()) {
+    ++done_;
+    return true;
+  }
+
+  StopTimer();
+  return false;
+}
+
+void State::StartTimer() {
+  if (running_) {
+    return;
+  }
+  running_ = true;
+  start_allocations_ = AllocationCount();
+  start_allocated_bytes_ = AllocatedBytes();
+  start_time_ = Clock::now();
+}
+
+void State::StopTimer() {
+  if (!running_) {
+    return;
+  }
+  elapsed_ += Clock::now() - start_time_;
+  allocations_ += AllocationCount() - start_allocations_;
+  allocated_bytes_ += AllocatedBytes() - start_allocated_bytes_;
+  running_ = false;
+}
+
+Benchmark::Benchmark(const std::string& name, Function function)
+    : name_(name), function_(std::move(function)), args_() {}
+
+Benchmark* Benchmark::Arg(int64_t arg) {
+  args_.push_back(arg);
+  return this;
+}
+
+std::vector<Benchmark::Json> Benchmark::Run(double min_time) const {
+  std::vector<Json> results;
+  if (args_.empty()) {
+    results.push_back(RunArg(0, false, min_time));
+    return results;
+  }
+
+  for (auto arg : args_) {
+    results.push_back(RunArg(arg, true, min_time));
+  }
+  return results;
+}
+
+Benchmark::Json Benchmark::RunArg(int64_t arg, bool has_arg,
+                                  double min_time) const {
+  // Grow the iteration count until a run lasts at least min_time
+  uint64_t iterations = 1;
+  while (true) {
+    State state(iterations, arg);
+    function_(state);
+    state.StopTimer();
+
+    double seconds = std::chrono::duration<double>(state.elapsed()).count();
+    if (!state.error().empty() || seconds >= min_time ||
+        iterations >= kMaxIterations) {
+      Json result;
+      result["benchmark"] = has_arg ? name_ + "/" + std::to_string(arg) : name_;
+      result["iterations"] = iterations;
+      if (!state.error().empty()) {
+        result["error"] = state.error();
+        return result;
+      }
+      result["ns_per_op"] = seconds * 1e9 / iterations;
+      result["allocations_per_op"] =
+          static_cast<double>(state.allocations()) / iterations;
+      result["allocated_bytes_per_op"] =
+          static_cast<double>(state.allocated_bytes()) / iterations;
+      if (state.bytes_processed()) {
+        result["throughput_MBps"] =
+            seconds > 0 ? static_cast<double>(state.bytes_processed()) /
+                              (1024.0 * 1024.0) / seconds
+                        : 0.0;
+      }
+      return result;
+    }
+
+    double multiplier = seconds > 0 ? 1.4 * min_time / seconds : 10.0;
+    multiplier = std::min(std::max(multiplier, 2.0), 10.0);
+    iterations = std::min<uint64_t>(
+        static_cast<uint64_t>(iterations * multiplier), kMaxIterations);
+  }
+}
+
+Benchmark* RegisterBenchmark(const std::string& name,
+                             Benchmark::Function function) {
+  Benchmarks().emplace_back(new Benchmark(name, std::move(function)));
+  return Benchmarks().back().get();
+}
+
+const std::vector<std::unique_ptr<Benchmark>>& GetBenchmarks() {
+  return Benchmarks();
+}
+
+}  // micro
+}  // bench
+}  // ssf
@@ -0,0 +1,119 @@
+#ifndef SSF_BENCH_MICRO_MICRO_BENCHMARK_H_
+#define SSF_BENCH_MICRO_MICRO_BENCHMARK_H_
+
+#include <cstdint>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <json.hpp>
+
+namespace ssf {
+namespace bench {
+namespace micro {
+
+// Iteration state of a micro benchmark run
+// Synchronous benchmarks loop on KeepRunning(). Asynchronous ones do their
+// setup, then surround the processing of iterations() operations with
+// StartTimer() and StopTimer(). Time and allocations (count and bytes) are
+// only measured while the timer runs.
+class State {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+ public:
+  State(uint64_t iterations, int64_t arg);
+
+  bool KeepRunning();
+
+  void StartTimer();
+  void StopTimer();
+
+  void SetBytesProcessed(uint64_t bytes) { bytes_processed_ = bytes; }
+  void SkipWithError(const std::string& error) { error_ = error; }
+
+  uint64_t iterations() const { return iterations_; }
+  int64_t arg() const { return arg_; }
+
+  Clock::duration elapsed() const { return elapsed_; }
+  uint64_t allocations() const { return allocations_; }
+  uint64_t allocated_bytes() const { return allocated_bytes_; }
+  uint64_t bytes_processed() const { return bytes_processed_; }
+  const std::string& error() const { return error_; }
+
+ private:
+  uint64_t iterations_;
+  int64_t arg_;
+  uint64_t done_;
+  bool started_;
+  bool running_;
+
+  Clock::time_point start_time_;
+  Clock::duration elapsed_;
+  uint64_t start_allocations_;
+  uint64_t allocations_;
+  uint64_t start_allocated_bytes_;
+  uint64_t allocated_bytes_;
+  uint64_t bytes_processed_;
+  std::string error_;
+};
+
+class Benchmark {
+ public:
+  using Function = std::function<void(State&)>;
+  using Json = nlohmann::json;
+
+ public:
+  Benchmark(const std::string& name, Function function);
+
+  // Run the benchmark once per argument, with the argument in its name
+  Benchmark* Arg(int64_t arg);
+
+  const std::string& name() const { return name_; }
+
+  // Run each argument for at least min_time seconds and report one JSON
+  // object per argument
+  std::vector<Json> Run(double min_time) const;
+
+ private:
+  Json RunArg(int64_t arg, bool has_arg, double min_time) const;
+
+ private:
+  std::string name_;
+  Function function_;
+  std::vector<int64_t> args_;
+};
+
+Benchmark* RegisterBenchmark(const std::string& name,
+                             Benchmark::Function function);
+
+// Prevent the compiler from discarding the computation of value
+template <class T>
+inline void DoNotOptimize(const T& value) {
+#if defined(__GNUC__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static_cast<void>(*reinterpret_cast<const volatile char*>(&value));
+#endif
+}
+
+const std::vector<std::unique_ptr<Benchmark>>& GetBenchmarks();
+
+}  // micro
+}  // bench
+}  // ssf
+
+#define SSF_MICRO_BENCHMARK_CONCAT(name, line) name##line
+#define SSF_MICRO_BENCHMARK_VARIABLE(line) \
+  SSF_MICRO_BENCHMARK_CONCAT(ssf_micro_benchmark_, line)
+
+// Register a void(State&) function as a micro benchmark
+#define SSF_MICRO_BENCHMARK(function)                   \
+  static ::ssf::bench::micro::Benchmark*               \
+      SSF_MICRO_BENCHMARK_VARIABLE(__LINE__) =         \
+          ::ssf::bench::micro::RegisterBenchmark(#function, function)
+
+#endif  // SSF_BENCH_MICRO_MICRO_BENCHMARK_H_
@@ -0,0 +1,86 @@
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include <cxxopts.hpp>
+#include <json.hpp>
+
+#include <ssf/log/log.h>
+
+#include "bench/micro/micro_benchmark.h"
+
+#include "versions.h"
+
+// Micro benchmarks of the network layer templates
+//   Each benchmark reports ns/op and allocations/op as one JSON object per
+//   line (appended to the output file when one is given) so that results can
+//   be tracked across commits.
+
+int main(int argc, char** argv) {
+  cxxopts::Options opts(argv[0], "SSF micro benchmarks " SSF_VERSION_STRING);
+  opts.add_options()("h,help", "Show help");
+  opts.add_options()("v,verbose", "Enable SSF logs");
+  opts.add_options()("f,filter",
+                     "Only run benchmarks whose name contains the filter",
+                     cxxopts::value<std::string>()->default_value(""));
+  opts.add_options()("t,min-time", "Minimum run time of a benchmark (s)",
+                     cxxopts::value<double>()->default_value("0.5"));
+  opts.add_options()("o,output", "Append results to file",
+                     cxxopts::value<std::string>()->default_value(""));
+  opts.add_options()("l,label", "Label added to results (e.g. commit id)",
+                     cxxopts::value<std::string>()->default_value(""));
+
+  try {
+    opts.parse(argc, argv);
+  } catch (const std::exception& e) {
+    std::cerr << "cannot parse options: " << e.what() << std::endl;
+    return 1;
+  }
+
+  if (opts.count("help")) {
+    std::cerr << opts.help() << std::endl;
+    return 0;
+  }
+
+  SetLogLevel(opts.count("verbose") ? spdlog::level::info
+                                    : spdlog::level::off);
+
+  auto min_time = opts["min-time"].as<double>();
+  if (min_time <= 0) {
+    std::cerr << "invalid minimum time " << min_time << std::endl;
+    return 1;
+  }
+
+  std::ofstream output;
+  auto output_path = opts["output"].as<std::string>();
+  if (!output_path.empty()) {
+    output.open(output_path, std::ios::out | std::ios::app);
+    if (!output.is_open()) {
+      std::cerr << "cannot open " << output_path << std::endl;
+      return 1;
+    }
+  }
+
+  auto filter = opts["filter"].as<std::string>();
+  int result = 0;
+  for (const auto& p_benchmark : ssf::bench::micro::GetBenchmarks()) {
+    if (p_benchmark->name().find(filter) == std::string::npos) {
+      continue;
+    }
+
+    for (auto& json : p_benchmark->Run(min_time)) {
+      if (json.count("error")) {
+        result = 1;
+      }
+      json["version"] = SSF_VERSION_STRING;
+      json["label"] = opts["label"].as<std::string>();
+
+      std::cout << json.dump() << std::endl;
+      if (output.is_open()) {
+        output << json.dump() << std::endl;
+      }
+    }
+  }
+
+  return result;
+}
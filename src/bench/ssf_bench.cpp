@@ -0,0 +1,227 @@
+#include <cstdint>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <cxxopts.hpp>
+#include <json.hpp>
+
+#include <ssf/log/log.h>
+
+#include "bench/bench_environment.h"
+#include "bench/measures.h"
+#include "bench/workloads.h"
+
+#include "versions.h"
+
+// In process end to end benchmarks
+//   Each workload starts a SSF server and a client on loopback, then prints
+//   its measures as one JSON object per line (appended to the output file
+//   when one is given) so that results can be tracked across commits.
+
+namespace {
+
+std::vector<std::string> SplitWorkloads(const std::string& workloads) {
+  std::vector<std::string> result;
+  std::istringstream stream(workloads);
+  std::string workload;
+  while (std::getline(stream, workload, ',')) {
+    if (!workload.empty()) {
+      result.push_back(workload);
+    }
+  }
+  return result;
+}
+
+bool IsSelected(const std::vector<std::string>& selected,
+                const std::string& workload) {
+  if (selected.empty()) {
+    return true;
+  }
+  for (const auto& name : selected) {
+    if (name == workload) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // unnamed namespace
+
+int main(int argc, char** argv) {
+  ssf::bench::WorkloadOptions options;
+
+  cxxopts::Options opts(argv[0], "SSF benchmarks " SSF_VERSION_STRING);
+  opts.add_options()("h,help", "Show help");
+  opts.add_options()("v,verbose", "Enable SSF logs");
+  opts.add_options()("w,workloads",
+                     "Comma separated workloads (tcp_forward, "
+                     "tcp_forward_baseline, socks, udp, udp_churn, "
+                     "copy_large, copy_small, copy_startup, shell, "
+                     "shell_bulk, shell_sessions, exec_tar), all by default",
+                     cxxopts::value<std::string>()->default_value(""));
+  opts.add_options()("p,port", "Base port, the next three ports are also used",
+                     cxxopts::value<int>()->default_value(
+                         std::to_string(options.base_port)));
+  opts.add_options()("o,output", "Append results to file",
+                     cxxopts::value<std::string>()->default_value(""));
+  opts.add_options()("l,label", "Label added to results (e.g. commit id)",
+                     cxxopts::value<std::string>()->default_value(""));
+  opts.add_options()("bulk-size", "Bytes downloaded by tcp_forward",
+                     cxxopts::value<uint64_t>()->default_value(
+                         std::to_string(options.bulk_size)));
+  opts.add_options()("bulk-connections", "Connections used by tcp_forward",
+                     cxxopts::value<uint32_t>()->default_value(
+                         std::to_string(options.bulk_connections)));
+  opts.add_options()("forward-buffer-size",
+                     "Forwarding buffer size of tcp_forward",
+                     cxxopts::value<uint32_t>()->default_value(
+                         std::to_string(options.forward_buffer_size)));
+  opts.add_options()("forward-buffers",
+                     "Forwarding buffers per direction of tcp_forward",
+                     cxxopts::value<uint32_t>()->default_value(
+                         std::to_string(options.forward_buffers)));
+  opts.add_options()("forward-zero-copy",
+                     "Send tcp_forward writes without a copy (Linux)");
+  opts.add_options()("socks-connections", "Connections opened by socks",
+                     cxxopts::value<uint32_t>()->default_value(
+                         std::to_string(options.socks_connections)));
+  opts.add_options()("socks-parallel", "Concurrent connections of socks",
+                     cxxopts::value<uint32_t>()->default_value(
+                         std::to_string(options.socks_parallel)));
+  opts.add_options()("udp-datagrams", "Datagrams echoed by udp",
+                     cxxopts::value<uint32_t>()->default_value(
+                         std::to_string(options.udp_datagrams)));
+  opts.add_options()("udp-size", "Datagram size of udp",
+                     cxxopts::value<uint32_t>()->default_value(
+                         std::to_string(options.udp_datagram_size)));
+  opts.add_options()("udp-flows", "Flows opened by udp_churn",
+                     cxxopts::value<uint32_t>()->default_value(
+                         std::to_string(options.udp_flows)));
+  opts.add_options()("copy-large-size", "File size of copy_large",
+                     cxxopts::value<uint64_t>()->default_value(
+                         std::to_string(options.copy_large_size)));
+  opts.add_options()("copy-small-count", "File count of copy_small",
+                     cxxopts::value<uint32_t>()->default_value(
+                         std::to_string(options.copy_small_count)));
+  opts.add_options()("copy-small-size", "File size of copy_small",
+                     cxxopts::value<uint32_t>()->default_value(
+                         std::to_string(options.copy_small_size)));
+  opts.add_options()("shell-commands", "Commands run by shell",
+                     cxxopts::value<uint32_t>()->default_value(
+                         std::to_string(options.shell_commands)));
+  opts.add_options()("shell-sessions", "Sessions opened by shell_sessions",
+                     cxxopts::value<uint32_t>()->default_value(
+                         std::to_string(options.shell_sessions)));
+  opts.add_options()("shell-pool", "Shell pool size of shell_sessions",
+                     cxxopts::value<uint32_t>()->default_value(
+                         std::to_string(options.shell_pool_size)));
+  opts.add_options()("exec-size", "File size archived by exec_tar",
+                     cxxopts::value<uint64_t>()->default_value(
+                         std::to_string(options.exec_output_size)));
+  opts.add_options()("exec-runs", "Commands run by exec_tar",
+                     cxxopts::value<uint32_t>()->default_value(
+                         std::to_string(options.exec_runs)));
+  opts.add_options()("ssfcp", "ssfcp binary run by copy_startup",
+                     cxxopts::value<std::string>()->default_value(""));
+  opts.add_options()("startup-runs", "ssfcp processes run by copy_startup",
+                     cxxopts::value<uint32_t>()->default_value(
+                         std::to_string(options.startup_runs)));
+  opts.add_options()("startup-size", "File size of copy_startup",
+                     cxxopts::value<uint32_t>()->default_value(
+                         std::to_string(options.startup_file_size)));
+
+  try {
+    opts.parse(argc, argv);
+  } catch (const std::exception& e) {
+    std::cerr << "cannot parse options: " << e.what() << std::endl;
+    return 1;
+  }
+
+  if (opts.count("help")) {
+    std::cerr << opts.help() << std::endl;
+    return 0;
+  }
+
+  SetLogLevel(opts.count("verbose") ? spdlog::level::info
+                                    : spdlog::level::off);
+
+  int port = opts["port"].as<int>();
+  if (port <= 0 || port > 65533) {
+    std::cerr << "invalid base port " << port << std::endl;
+    return 1;
+  }
+  options.base_port = static_cast<uint16_t>(port);
+  options.bulk_size = opts["bulk-size"].as<uint64_t>();
+  options.bulk_connections = opts["bulk-connections"].as<uint32_t>();
+  options.forward_buffer_size = opts["forward-buffer-size"].as<uint32_t>();
+  options.forward_buffers = opts["forward-buffers"].as<uint32_t>();
+  options.forward_zero_copy = opts.count("forward-zero-copy") > 0;
+  options.socks_connections = opts["socks-connections"].as<uint32_t>();
+  options.socks_parallel = opts["socks-parallel"].as<uint32_t>();
+  options.udp_datagrams = opts["udp-datagrams"].as<uint32_t>();
+  options.udp_datagram_size = opts["udp-size"].as<uint32_t>();
+  options.udp_flows = opts["udp-flows"].as<uint32_t>();
+  options.copy_large_size = opts["copy-large-size"].as<uint64_t>();
+  options.copy_small_count = opts["copy-small-count"].as<uint32_t>();
+  options.copy_small_size = opts["copy-small-size"].as<uint32_t>();
+  options.shell_commands = opts["shell-commands"].as<uint32_t>();
+  options.shell_sessions = opts["shell-sessions"].as<uint32_t>();
+  options.shell_pool_size = opts["shell-pool"].as<uint32_t>();
+  options.exec_output_size = opts["exec-size"].as<uint64_t>();
+  options.exec_runs = opts["exec-runs"].as<uint32_t>();
+  options.ssfcp_path = opts["ssfcp"].as<std::string>();
+  options.startup_runs = opts["startup-runs"].as<uint32_t>();
+  options.startup_file_size = opts["startup-size"].as<uint32_t>();
+
+  auto selected = SplitWorkloads(opts["workloads"].as<std::string>());
+  for (const auto& name : selected) {
+    bool known = false;
+    for (const auto& workload : ssf::bench::GetWorkloads()) {
+      known = known || workload.first == name;
+    }
+    if (!known) {
+      std::cerr << "unknown workload " << name << std::endl;
+      return 1;
+    }
+  }
+
+  std::ofstream output;
+  auto output_path = opts["output"].as<std::string>();
+  if (!output_path.empty()) {
+    output.open(output_path, std::ios::out | std::ios::app);
+    if (!output.is_open()) {
+      std::cerr << "cannot open " << output_path << std::endl;
+      return 1;
+    }
+  }
+
+  int result = 0;
+  for (const auto& workload : ssf::bench::GetWorkloads()) {
+    if (!IsSelected(selected, workload.first)) {
+      continue;
+    }
+
+    ssf::bench::Measures measures(workload.first);
+    bool success = workload.second(options, &measures);
+    if (!success) {
+      result = 1;
+    }
+
+    auto json = measures.ToJson();
+    json["success"] = success;
+    json["protocol"] = ssf::bench::BenchEnvironment::ProtocolName();
+    json["version"] = SSF_VERSION_STRING;
+    json["label"] = opts["label"].as<std::string>();
+
+    std::cout << json.dump() << std::endl;
+    if (output.is_open()) {
+      output << json.dump() << std::endl;
+    }
+  }
+
+  return result;
+}
@@ -0,0 +1,871 @@
+#include "bench/workloads.h"
+
+#include <cstdlib>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include <boost/asio/deadline_timer.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/read_until.hpp>
+#include <boost/asio/streambuf.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/filesystem.hpp>
+
+#include <json.hpp>
+
+#include <ssf/log/log.h>
+
+#include "bench/bench_environment.h"
+#include "bench/local_peers.h"
+
+#include "services/copy/copy_client.h"
+#include "services/copy/packet/control.h"
+#include "services/exec/frame.h"
+#include "services/user_services/copy.h"
+#include "services/user_services/exec.h"
+#include "services/user_services/port_forwarding.h"
+#include "services/user_services/shell.h"
+#include "services/user_services/socks.h"
+#include "services/user_services/udp_port_forwarding.h"
+
+#include "tests/tls_config_helper.h"
+
+namespace ssf {
+namespace bench {
+
+namespace {
+
+using Clock = Measures::Clock;
+using Demux = BenchEnvironment::Demux;
+using tcp = boost::asio::ip::tcp;
+using udp = boost::asio::ip::udp;
+
+const char kCopyConfig[] = R"RAWSTRING(
+{
+    "ssf": {
+        "services" : {
+            "copy": { "enable": true }
+        }
+    }
+}
+)RAWSTRING";
+
+const char kExecConfig[] = R"RAWSTRING(
+{
+    "ssf": {
+        "services" : {
+            "exec": { "enable": true }
+        }
+    }
+}
+)RAWSTRING";
+
+const char kShellConfig[] = R"RAWSTRING(
+{
+    "ssf": {
+        "services" : {
+            "shell": { "enable": true }
+        }
+    }
+}
+)RAWSTRING";
+
+const uint32_t kUdpClients = 4;
+const uint32_t kSocksPayloadSize = 64;
+const uint64_t kBackgroundRequestSize = 16 * 1024 * 1024;
+
+// Run operations from a pool of threads, each operation being identified
+// by its index
+void RunParallel(uint32_t threads_count, uint32_t operations_count,
+                 const std::function<void(uint32_t)>& operation) {
+  std::atomic<uint32_t> next_operation(0);
+  std::vector<std::thread> threads;
+  for (uint32_t i = 0; i < threads_count; ++i) {
+    threads.emplace_back([&]() {
+      uint32_t index;
+      while ((index = next_operation++) < operations_count) {
+        operation(index);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+std::string PortString(const WorkloadOptions& options, uint16_t offset) {
+  return std::to_string(options.base_port + offset);
+}
+
+bool Connect(tcp::socket& socket, uint16_t port) {
+  boost::system::error_code ec;
+  socket.connect(tcp::endpoint(boost::asio::ip::address_v4::loopback(), port),
+                 ec);
+  return !ec;
+}
+
+// Minimal SOCKS5 CONNECT without authentication to 127.0.0.1:port
+bool SocksConnect(tcp::socket& socket, uint16_t port) {
+  boost::system::error_code ec;
+  std::array<uint8_t, 3> greeting = {{0x05, 0x01, 0x00}};
+  std::array<uint8_t, 2> method;
+  boost::asio::write(socket, boost::asio::buffer(greeting), ec);
+  boost::asio::read(socket, boost::asio::buffer(method), ec);
+  if (ec || method[0] != 0x05 || method[1] != 0x00) {
+    return false;
+  }
+
+  std::array<uint8_t, 10> request = {
+      {0x05, 0x01, 0x00, 0x01, 127, 0, 0, 1, static_cast<uint8_t>(port >> 8),
+       static_cast<uint8_t>(port & 0xFF)}};
+  std::array<uint8_t, 10> reply;
+  boost::asio::write(socket, boost::asio::buffer(request), ec);
+  boost::asio::read(socket, boost::asio::buffer(reply), ec);
+
+  return !ec && reply[0] == 0x05 && reply[1] == 0x00;
+}
+
+// Receive one datagram, giving up after one second
+bool ReceiveFrom(udp::socket& socket, boost::asio::mutable_buffers_1 buffer,
+                 std::size_t* p_length) {
+  auto& io_service = socket.get_io_service();
+  boost::asio::deadline_timer timer(io_service);
+  bool received = false;
+
+  io_service.reset();
+  socket.async_receive(buffer, [&](const boost::system::error_code& ec,
+                                   std::size_t length) {
+    boost::system::error_code cancel_ec;
+    timer.cancel(cancel_ec);
+    received = !ec;
+    *p_length = length;
+  });
+  timer.expires_from_now(boost::posix_time::seconds(1));
+  timer.async_wait([&](const boost::system::error_code& ec) {
+    if (!ec) {
+      boost::system::error_code cancel_ec;
+      socket.cancel(cancel_ec);
+    }
+  });
+  io_service.run();
+
+  return received;
+}
+
+bool EchoDatagram(udp::socket& socket, std::vector<uint8_t>& datagram,
+                  std::vector<uint8_t>& reply) {
+  boost::system::error_code ec;
+  socket.send(boost::asio::buffer(datagram), 0, ec);
+  if (ec) {
+    return false;
+  }
+  std::size_t length = 0;
+  return ReceiveFrom(socket, boost::asio::buffer(reply), &length) &&
+         length == datagram.size();
+}
+
+// Run a command echoing a marker in the shell and wait for the marker
+//   The marker is computed by the shell so that the echo of the command line
+//   by the terminal does not match it
+bool ShellEcho(tcp::socket& socket, boost::asio::streambuf& output,
+               uint32_t index) {
+  boost::system::error_code ec;
+  auto value = 1000000 + index;
+  auto command = "echo ssf_$((" + std::to_string(value) + "+1))\n";
+  auto marker = "ssf_" + std::to_string(value + 1);
+  boost::asio::write(socket, boost::asio::buffer(command), ec);
+  if (ec) {
+    return false;
+  }
+  auto length = boost::asio::read_until(socket, output, marker, ec);
+  output.consume(length);
+  return !ec;
+}
+
+// Measure shell echoes once a first one shows that the shell is ready
+bool MeasureShellEchoes(const WorkloadOptions& options, uint16_t shell_port,
+                        Measures* p_measures) {
+  boost::asio::io_service io_service;
+  tcp::socket socket(io_service);
+  if (!Connect(socket, shell_port)) {
+    SSF_LOG("bench", error, "could not connect to shell");
+    return false;
+  }
+
+  boost::asio::streambuf output;
+  if (!ShellEcho(socket, output, 0)) {
+    SSF_LOG("bench", error, "shell not responding");
+    return false;
+  }
+
+  p_measures->Start();
+  for (uint32_t i = 1; i <= options.shell_commands; ++i) {
+    auto start = Clock::now();
+    if (!ShellEcho(socket, output, i)) {
+      p_measures->AddError();
+      break;
+    }
+    p_measures->AddOperation(Clock::now() - start);
+  }
+  p_measures->Stop();
+
+  return true;
+}
+
+// Temporary directory removed on destruction
+class TemporaryDirectory {
+ public:
+  TemporaryDirectory()
+      : path_(boost::filesystem::temp_directory_path() /
+              boost::filesystem::unique_path("ssf_bench_%%%%-%%%%-%%%%")) {
+    boost::filesystem::create_directories(path_ / "input");
+    boost::filesystem::create_directories(path_ / "output");
+  }
+
+  ~TemporaryDirectory() {
+    boost::system::error_code ec;
+    boost::filesystem::remove_all(path_, ec);
+  }
+
+  boost::filesystem::path input() const { return path_ / "input"; }
+  boost::filesystem::path output() const { return path_ / "output"; }
+
+ private:
+  boost::filesystem::path path_;
+};
+
+bool GenerateFile(const boost::filesystem::path& path, uint64_t size) {
+  std::ofstream file(path.string(), std::ios::binary | std::ios::trunc);
+  std::vector<char> chunk(1024 * 1024, 'a');
+  while (size > 0 && file.good()) {
+    auto chunk_size =
+        static_cast<std::size_t>(std::min<uint64_t>(size, chunk.size()));
+    file.write(chunk.data(), chunk_size);
+    size -= chunk_size;
+  }
+  return file.good();
+}
+
+// Copy every file of the input directory to the output directory, one
+// operation being recorded per copied file
+bool RunCopy(const WorkloadOptions& options, const TemporaryDirectory& dir,
+             uint64_t total_size, uint32_t max_parallel_copies,
+             Measures* p_measures) {
+  using Copy = ssf::services::Copy<Demux>;
+  using CopyClient = ssf::services::copy::CopyClient;
+
+  boost::system::error_code ec;
+  UserServiceParameters params = {
+      {Copy::GetParseName(), {Copy::CreateUserServiceParameters(ec)}}};
+
+  BenchEnvironment environment;
+  if (!environment.Start<Copy>(PortString(options, 0), params, kCopyConfig)) {
+    return false;
+  }
+
+  auto p_session = environment.GetSession(ec);
+  if (ec) {
+    SSF_LOG("bench", error, "no client session ({})", ec.message());
+    return false;
+  }
+
+  std::mutex last_copied_mutex;
+  auto last_copied = Clock::now();
+  std::promise<bool> finished;
+  auto on_file_status = [](ssf::services::copy::CopyContext* context,
+                           const boost::system::error_code& ec) {};
+  auto on_file_copied = [&](ssf::services::copy::CopyContext* context,
+                            const boost::system::error_code& ec) {
+    if (ec) {
+      p_measures->AddError();
+      return;
+    }
+    std::unique_lock<std::mutex> lock(last_copied_mutex);
+    auto now = Clock::now();
+    p_measures->AddOperation(now - last_copied);
+    last_copied = now;
+  };
+  auto on_copy_finished = [&finished](uint64_t files_count,
+                                      uint64_t errors_count,
+                                      const boost::system::error_code& ec) {
+    finished.set_value(!ec && errors_count == 0);
+  };
+
+  auto p_copy_client = CopyClient::Create(p_session, on_file_status,
+                                          on_file_copied, on_copy_finished, ec);
+  if (ec) {
+    SSF_LOG("bench", error, "could not create copy client ({})",
+            ec.message());
+    return false;
+  }
+
+  ssf::services::copy::CopyRequest request(
+      false, false, false, false, max_parallel_copies,
+      (dir.input() / "*").string(), dir.output().string());
+
+  auto copy_finished = finished.get_future();
+  p_measures->Start();
+  last_copied = Clock::now();
+  p_copy_client->AsyncCopyToServer(request);
+  copy_finished.wait();
+  p_measures->Stop();
+  p_measures->AddBytes(total_size);
+
+  p_copy_client->Stop();
+
+  return copy_finished.get();
+}
+
+bool RunTcpForwardWith(const WorkloadOptions& options, uint32_t buffer_size,
+                       uint32_t buffers, bool zero_copy,
+                       Measures* p_measures) {
+  using PortForwarding = ssf::services::PortForwarding<Demux>;
+
+  uint16_t listen_port = options.base_port + 1;
+  uint16_t target_port = options.base_port + 2;
+
+  boost::system::error_code ec;
+  TcpDataSource data_source(target_port);
+  data_source.Start(ec);
+  if (ec) {
+    SSF_LOG("bench", error, "could not start TCP data source ({})",
+            ec.message());
+    return false;
+  }
+
+  UserServiceParameters params = {
+      {PortForwarding::GetParseName(),
+       {{{"from_addr", ""},
+         {"from_port", PortString(options, 1)},
+         {"to_addr", "127.0.0.1"},
+         {"to_port", PortString(options, 2)}}}}};
+
+  // both sides forward through the same buffers
+  nlohmann::json services_config;
+  services_config["ssf"]["services"]["stream_forwarder"] = {
+      {"enable", true},
+      {"buffer_size", buffer_size},
+      {"buffers", buffers},
+      {"zero_copy", zero_copy}};
+  services_config["ssf"]["services"]["stream_listener"] = {
+      {"enable", true}, {"buffer_size", buffer_size}, {"buffers", buffers}};
+
+  BenchEnvironment environment;
+  if (!environment.Start<PortForwarding>(PortString(options, 0), params,
+                                         services_config.dump())) {
+    return false;
+  }
+
+  uint32_t connections = std::max<uint32_t>(options.bulk_connections, 1);
+  uint64_t connection_size = options.bulk_size / connections;
+
+  p_measures->Start();
+  RunParallel(connections, connections, [&](uint32_t) {
+    boost::asio::io_service io_service;
+    tcp::socket socket(io_service);
+    auto start = Clock::now();
+    if (!Connect(socket, listen_port) ||
+        !RequestData(socket, connection_size)) {
+      p_measures->AddError();
+      return;
+    }
+    p_measures->AddOperation(Clock::now() - start);
+    p_measures->AddBytes(connection_size);
+  });
+  p_measures->Stop();
+
+  return true;
+}
+
+}  // unnamed namespace
+
+bool RunTcpForward(const WorkloadOptions& options, Measures* p_measures) {
+  return RunTcpForwardWith(options, options.forward_buffer_size,
+                           options.forward_buffers, options.forward_zero_copy,
+                           p_measures);
+}
+
+bool RunTcpForwardBaseline(const WorkloadOptions& options,
+                           Measures* p_measures) {
+  return RunTcpForwardWith(options, 50 * 1024, 1, false, p_measures);
+}
+
+bool RunSocks(const WorkloadOptions& options, Measures* p_measures) {
+  using Socks = ssf::services::Socks<Demux>;
+
+  uint16_t socks_port = options.base_port + 1;
+  uint16_t target_port = options.base_port + 2;
+
+  boost::system::error_code ec;
+  TcpDataSource data_source(target_port);
+  data_source.Start(ec);
+  if (ec) {
+    SSF_LOG("bench", error, "could not start TCP data source ({})",
+            ec.message());
+    return false;
+  }
+
+  UserServiceParameters params = {
+      {Socks::GetParseName(),
+       {{{"addr", ""}, {"port", PortString(options, 1)}}}}};
+
+  BenchEnvironment environment;
+  if (!environment.Start<Socks>(PortString(options, 0), params)) {
+    return false;
+  }
+
+  p_measures->Start();
+  RunParallel(std::max<uint32_t>(options.socks_parallel, 1),
+              options.socks_connections, [&](uint32_t) {
+                boost::asio::io_service io_service;
+                tcp::socket socket(io_service);
+                auto start = Clock::now();
+                if (!Connect(socket, socks_port) ||
+                    !SocksConnect(socket, target_port) ||
+                    !RequestData(socket, kSocksPayloadSize)) {
+                  p_measures->AddError();
+                  return;
+                }
+                p_measures->AddOperation(Clock::now() - start);
+                p_measures->AddBytes(kSocksPayloadSize);
+              });
+  p_measures->Stop();
+
+  return true;
+}
+
+bool RunUdp(const WorkloadOptions& options, Measures* p_measures) {
+  using UdpPortForwarding = ssf::services::UdpPortForwarding<Demux>;
+
+  uint16_t listen_port = options.base_port + 1;
+  uint16_t target_port = options.base_port + 2;
+
+  boost::system::error_code ec;
+  UdpEcho echo(target_port);
+  echo.Start(ec);
+  if (ec) {
+    SSF_LOG("bench", error, "could not start UDP echo ({})", ec.message());
+    return false;
+  }
+
+  UserServiceParameters params = {
+      {UdpPortForwarding::GetParseName(),
+       {{{"from_addr", ""},
+         {"from_port", PortString(options, 1)},
+         {"to_addr", "127.0.0.1"},
+         {"to_port", PortString(options, 2)}}}}};
+
+  BenchEnvironment environment;
+  if (!environment.Start<UdpPortForwarding>(PortString(options, 0), params)) {
+    return false;
+  }
+
+  udp::endpoint listen_endpoint(boost::asio::ip::address_v4::loopback(),
+                                listen_port);
+
+  p_measures->Start();
+  RunParallel(kUdpClients, kUdpClients, [&](uint32_t) {
+    boost::asio::io_service io_service;
+    udp::socket socket(io_service);
+    boost::system::error_code connect_ec;
+    socket.connect(listen_endpoint, connect_ec);
+    if (connect_ec) {
+      p_measures->AddError();
+      return;
+    }
+
+    std::vector<uint8_t> datagram(options.udp_datagram_size, 1);
+    std::vector<uint8_t> reply(options.udp_datagram_size);
+    uint32_t datagrams = options.udp_datagrams / kUdpClients;
+    for (uint32_t i = 0; i < datagrams; ++i) {
+      auto start = Clock::now();
+      if (!EchoDatagram(socket, datagram, reply)) {
+        p_measures->AddError();
+        continue;
+      }
+      p_measures->AddOperation(Clock::now() - start);
+      p_measures->AddBytes(2 * datagram.size());
+    }
+  });
+  p_measures->Stop();
+
+  return true;
+}
+
+bool RunUdpChurn(const WorkloadOptions& options, Measures* p_measures) {
+  using UdpPortForwarding = ssf::services::UdpPortForwarding<Demux>;
+
+  uint16_t listen_port = options.base_port + 1;
+  uint16_t target_port = options.base_port + 2;
+
+  boost::system::error_code ec;
+  UdpEcho echo(target_port);
+  echo.Start(ec);
+  if (ec) {
+    SSF_LOG("bench", error, "could not start UDP echo ({})", ec.message());
+    return false;
+  }
+
+  UserServiceParameters params = {
+      {UdpPortForwarding::GetParseName(),
+       {{{"from_addr", ""},
+         {"from_port", PortString(options, 1)},
+         {"to_addr", "127.0.0.1"},
+         {"to_port", PortString(options, 2)}}}}};
+
+  BenchEnvironment environment;
+  if (!environment.Start<UdpPortForwarding>(PortString(options, 0), params)) {
+    return false;
+  }
+
+  udp::endpoint listen_endpoint(boost::asio::ip::address_v4::loopback(),
+                                listen_port);
+
+  p_measures->Start();
+  RunParallel(kUdpClients, options.udp_flows, [&](uint32_t) {
+    boost::asio::io_service io_service;
+    udp::socket socket(io_service);
+    std::vector<uint8_t> datagram(options.udp_datagram_size, 1);
+    std::vector<uint8_t> reply(options.udp_datagram_size);
+
+    auto start = Clock::now();
+    boost::system::error_code connect_ec;
+    socket.connect(listen_endpoint, connect_ec);
+    if (connect_ec || !EchoDatagram(socket, datagram, reply)) {
+      p_measures->AddError();
+      return;
+    }
+    p_measures->AddOperation(Clock::now() - start);
+    p_measures->AddBytes(2 * datagram.size());
+  });
+  p_measures->Stop();
+
+  return true;
+}
+
+bool RunCopyLarge(const WorkloadOptions& options, Measures* p_measures) {
+  TemporaryDirectory dir;
+  if (!GenerateFile(dir.input() / "large_file.bin", options.copy_large_size)) {
+    SSF_LOG("bench", error, "could not generate input file");
+    return false;
+  }
+
+  return RunCopy(options, dir, options.copy_large_size, 1, p_measures);
+}
+
+bool RunCopySmall(const WorkloadOptions& options, Measures* p_measures) {
+  TemporaryDirectory dir;
+  for (uint32_t i = 0; i < options.copy_small_count; ++i) {
+    auto filename = "small_file_" + std::to_string(i) + ".bin";
+    if (!GenerateFile(dir.input() / filename, options.copy_small_size)) {
+      SSF_LOG("bench", error, "could not generate input files");
+      return false;
+    }
+  }
+
+  return RunCopy(options, dir,
+                 static_cast<uint64_t>(options.copy_small_count) *
+                     options.copy_small_size,
+                 8, p_measures);
+}
+
+bool RunCopyStartup(const WorkloadOptions& options, Measures* p_measures) {
+  if (options.ssfcp_path.empty()) {
+    SSF_LOG("bench", warn, "no ssfcp binary given, copy_startup skipped");
+    return true;
+  }
+
+  TemporaryDirectory dir;
+  auto input_file = dir.input() / "startup_file.bin";
+  if (!GenerateFile(input_file, options.startup_file_size)) {
+    SSF_LOG("bench", error, "could not generate input file");
+    return false;
+  }
+
+  // ssfcp reads its TLS configuration from a file
+  nlohmann::json client_config;
+  client_config["ssf"]["tls"] = {{"ca_cert_buffer", ssf::tests::GetCaCert()},
+                                 {"cert_buffer", ssf::tests::GetClientCert()},
+                                 {"key_buffer", ssf::tests::GetClientKey()}};
+  auto config_file = dir.output().parent_path() / "client_config.json";
+  {
+    std::ofstream config(config_file.string(), std::ios::trunc);
+    config << client_config.dump();
+    if (!config.good()) {
+      SSF_LOG("bench", error, "could not write client configuration");
+      return false;
+    }
+  }
+
+  BenchEnvironment environment;
+  if (!environment.StartServer(PortString(options, 0), kCopyConfig)) {
+    return false;
+  }
+
+  std::string command = "\"" + options.ssfcp_path + "\" -c \"" +
+                        config_file.string() + "\" -p " +
+                        PortString(options, 0) + " \"" +
+                        input_file.string() + "\" 127.0.0.1@\"" +
+                        dir.output().string() + "\"";
+
+  p_measures->Start();
+  for (uint32_t i = 0; i < options.startup_runs; ++i) {
+    auto start = Clock::now();
+    int status = std::system(command.c_str());
+    if (status != 0) {
+      SSF_LOG("bench", error, "ssfcp exited with status {}", status);
+      p_measures->AddError();
+      continue;
+    }
+    p_measures->AddOperation(Clock::now() - start);
+    p_measures->AddBytes(options.startup_file_size);
+  }
+  p_measures->Stop();
+
+  return true;
+}
+
+bool RunShell(const WorkloadOptions& options, Measures* p_measures) {
+  using Shell = ssf::services::Shell<Demux>;
+
+  uint16_t shell_port = options.base_port + 1;
+
+  UserServiceParameters params = {
+      {Shell::GetParseName(),
+       {{{"addr", ""}, {"port", PortString(options, 1)}}}}};
+
+  BenchEnvironment environment;
+  if (!environment.Start<Shell>(PortString(options, 0), params,
+                                kShellConfig)) {
+    return false;
+  }
+
+  return MeasureShellEchoes(options, shell_port, p_measures);
+}
+
+bool RunShellUnderBulk(const WorkloadOptions& options, Measures* p_measures) {
+  using PortForwarding = ssf::services::PortForwarding<Demux>;
+  using Shell = ssf::services::Shell<Demux>;
+
+  uint16_t shell_port = options.base_port + 1;
+  uint16_t listen_port = options.base_port + 2;
+  uint16_t target_port = options.base_port + 3;
+
+  boost::system::error_code ec;
+  TcpDataSource data_source(target_port);
+  data_source.Start(ec);
+  if (ec) {
+    SSF_LOG("bench", error, "could not start TCP data source ({})",
+            ec.message());
+    return false;
+  }
+
+  UserServiceParameters params = {
+      {Shell::GetParseName(),
+       {{{"addr", ""}, {"port", PortString(options, 1)}}}},
+      {PortForwarding::GetParseName(),
+       {{{"from_addr", ""},
+         {"from_port", PortString(options, 2)},
+         {"to_addr", "127.0.0.1"},
+         {"to_port", PortString(options, 3)}}}}};
+
+  BenchEnvironment environment;
+  if (!environment.Start<Shell, PortForwarding>(PortString(options, 0), params,
+                                                kShellConfig)) {
+    return false;
+  }
+
+  // Downloads keep the session busy until the echoes are measured, the bulk
+  // bytes are reported with the echo latencies
+  std::atomic<bool> stop_bulk(false);
+  std::vector<std::thread> bulk_threads;
+  for (uint32_t i = 0; i < std::max<uint32_t>(options.bulk_connections, 1);
+       ++i) {
+    bulk_threads.emplace_back([&]() {
+      while (!stop_bulk) {
+        boost::asio::io_service io_service;
+        tcp::socket socket(io_service);
+        if (!Connect(socket, listen_port) ||
+            !RequestData(socket, kBackgroundRequestSize)) {
+          return;
+        }
+        if (!stop_bulk) {
+          p_measures->AddBytes(kBackgroundRequestSize);
+        }
+      }
+    });
+  }
+
+  bool result = MeasureShellEchoes(options, shell_port, p_measures);
+
+  stop_bulk = true;
+  for (auto& thread : bulk_threads) {
+    thread.join();
+  }
+
+  return result;
+}
+
+bool RunShellSessions(const WorkloadOptions& options, Measures* p_measures) {
+  using Shell = ssf::services::Shell<Demux>;
+
+  uint16_t shell_port = options.base_port + 1;
+
+  nlohmann::json services_config;
+  services_config["ssf"]["services"]["shell"] = {
+      {"enable", true}, {"pool_size", options.shell_pool_size}};
+
+  UserServiceParameters params = {
+      {Shell::GetParseName(),
+       {{{"addr", ""}, {"port", PortString(options, 1)}}}}};
+
+  BenchEnvironment environment;
+  if (!environment.Start<Shell>(PortString(options, 0), params,
+                                services_config.dump())) {
+    return false;
+  }
+
+  auto open_session = [shell_port](uint32_t index) {
+    boost::asio::io_service io_service;
+    tcp::socket socket(io_service);
+    boost::asio::streambuf output;
+    return Connect(socket, shell_port) && ShellEcho(socket, output, index);
+  };
+
+  // the first session shows that the shell is ready (and fills the pool)
+  if (!open_session(0)) {
+    SSF_LOG("bench", error, "shell not responding");
+    return false;
+  }
+
+  p_measures->Start();
+  for (uint32_t i = 1; i <= options.shell_sessions; ++i) {
+    auto start = Clock::now();
+    if (!open_session(i)) {
+      p_measures->AddError();
+      continue;
+    }
+    p_measures->AddOperation(Clock::now() - start);
+  }
+  p_measures->Stop();
+
+  return true;
+}
+
+// Run a command through the exec service, stdout bytes are added to the
+// measures
+bool RunExecCommand(uint16_t exec_port, const std::string& command,
+                    Measures* p_measures) {
+  using ssf::services::exec::FrameHeader;
+  using ssf::services::exec::FrameType;
+
+  boost::asio::io_service io_service;
+  tcp::socket socket(io_service);
+  if (!Connect(socket, exec_port)) {
+    SSF_LOG("bench", error, "could not connect to exec");
+    return false;
+  }
+
+  boost::system::error_code ec;
+  boost::asio::write(socket, boost::asio::buffer(command + "\n"), ec);
+  if (ec) {
+    return false;
+  }
+
+  std::vector<uint8_t> payload(256 * 1024);
+  while (true) {
+    FrameHeader header;
+    boost::asio::read(socket, header.GetMutBuf(), ec);
+    if (ec) {
+      return false;
+    }
+    uint32_t remaining = header.length();
+    while (remaining > 0) {
+      auto length = boost::asio::read(
+          socket, boost::asio::buffer(payload.data(),
+                                      std::min<std::size_t>(remaining,
+                                                            payload.size())),
+          ec);
+      if (ec) {
+        return false;
+      }
+      remaining -= static_cast<uint32_t>(length);
+    }
+
+    switch (header.type()) {
+      case FrameType::kStdout:
+        p_measures->AddBytes(header.length());
+        break;
+      case FrameType::kStderr:
+        break;
+      case FrameType::kExitStatus:
+        return header.length() == 4 &&
+               FrameHeader::DecodeUint32(payload.data()) == 0;
+      default:
+        return false;
+    }
+  }
+}
+
+bool RunExecTar(const WorkloadOptions& options, Measures* p_measures) {
+  using Exec = ssf::services::Exec<Demux>;
+
+  uint16_t exec_port = options.base_port + 1;
+
+  TemporaryDirectory dir;
+  if (!GenerateFile(dir.input() / "large_file.bin", options.exec_output_size)) {
+    SSF_LOG("bench", error, "could not generate input file");
+    return false;
+  }
+
+  UserServiceParameters params = {
+      {Exec::GetParseName(),
+       {{{"addr", ""}, {"port", PortString(options, 1)}}}}};
+
+  BenchEnvironment environment;
+  if (!environment.Start<Exec>(PortString(options, 0), params, kExecConfig)) {
+    return false;
+  }
+
+  auto command = "tar c -C '" + dir.input().string() + "' large_file.bin";
+
+  p_measures->Start();
+  for (uint32_t i = 0; i < options.exec_runs; ++i) {
+    auto start = Clock::now();
+    if (!RunExecCommand(exec_port, command, p_measures)) {
+      p_measures->AddError();
+      continue;
+    }
+    p_measures->AddOperation(Clock::now() - start);
+  }
+  p_measures->Stop();
+
+  return true;
+}
+
+const std::vector<std::pair<std::string, Workload>>& GetWorkloads() {
+  static const std::vector<std::pair<std::string, Workload>> workloads = {
+      {"tcp_forward", &RunTcpForward},
+      {"tcp_forward_baseline", &RunTcpForwardBaseline},
+      {"socks", &RunSocks},
+      {"udp", &RunUdp},
+      {"udp_churn", &RunUdpChurn},
+      {"copy_large", &RunCopyLarge},
+      {"copy_small", &RunCopySmall},
+      {"copy_startup", &RunCopyStartup},
+      {"shell", &RunShell},
+      {"shell_bulk", &RunShellUnderBulk},
+      {"shell_sessions", &RunShellSessions},
+      {"exec_tar", &RunExecTar}};
+
+  return workloads;
+}
+
+}  // bench
+}  // ssf
@@ -0,0 +1,130 @@
+#ifndef SSF_BENCH_WORKLOADS_H_
+#define SSF_BENCH_WORKLOADS_H_
+
+#include <cstdint>
+
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bench/measures.h"
+
+namespace ssf {
+namespace bench {
+
+struct WorkloadOptions {
+  WorkloadOptions()
+      : base_port(18011),
+        bulk_size(256 * 1024 * 1024),
+        bulk_connections(4),
+        forward_buffer_size(50 * 1024),
+        forward_buffers(2),
+        forward_zero_copy(false),
+        socks_connections(2000),
+        socks_parallel(16),
+        udp_datagrams(100000),
+        udp_datagram_size(512),
+        udp_flows(20000),
+        copy_large_size(512 * 1024 * 1024),
+        copy_small_count(2000),
+        copy_small_size(4 * 1024),
+        shell_commands(200),
+        shell_sessions(200),
+        shell_pool_size(8),
+        exec_output_size(256 * 1024 * 1024),
+        exec_runs(4),
+        ssfcp_path(""),
+        startup_runs(20),
+        startup_file_size(1024) {}
+
+  // SSF server port, local services listen on the following ports
+  uint16_t base_port;
+
+  uint64_t bulk_size;
+  uint32_t bulk_connections;
+  // Forwarding buffers of the stream services used by tcp_forward
+  uint32_t forward_buffer_size;
+  uint32_t forward_buffers;
+  bool forward_zero_copy;
+
+  uint32_t socks_connections;
+  uint32_t socks_parallel;
+
+  uint32_t udp_datagrams;
+  uint32_t udp_datagram_size;
+  uint32_t udp_flows;
+
+  uint64_t copy_large_size;
+  uint32_t copy_small_count;
+  uint32_t copy_small_size;
+
+  uint32_t shell_commands;
+  uint32_t shell_sessions;
+  // Shells started ahead of shell_sessions connections (0: no pool)
+  uint32_t shell_pool_size;
+
+  // Size of the file archived by exec_tar
+  uint64_t exec_output_size;
+  uint32_t exec_runs;
+
+  // ssfcp binary run by copy_startup (skipped if empty)
+  std::string ssfcp_path;
+  uint32_t startup_runs;
+  uint32_t startup_file_size;
+};
+
+using Workload =
+    std::function<bool(const WorkloadOptions& options, Measures* p_measures)>;
+
+// Bulk download through a TCP port forwarding, one operation per connection
+bool RunTcpForward(const WorkloadOptions& options, Measures* p_measures);
+
+// tcp_forward with a single 50 KB buffer per direction and no zero copy, the
+// forwarding of previous versions
+bool RunTcpForwardBaseline(const WorkloadOptions& options,
+                           Measures* p_measures);
+
+// Short lived connections through the SOCKS service, one operation per
+// handshake and round trip
+bool RunSocks(const WorkloadOptions& options, Measures* p_measures);
+
+// UDP echo through a UDP port forwarding, one operation per round trip
+bool RunUdp(const WorkloadOptions& options, Measures* p_measures);
+
+// Short UDP flows through a UDP port forwarding, one operation per flow (new
+// source port, one echo)
+bool RunUdpChurn(const WorkloadOptions& options, Measures* p_measures);
+
+// Copy of a single large file from client to server
+bool RunCopyLarge(const WorkloadOptions& options, Measures* p_measures);
+
+// Copy of many small files from client to server
+bool RunCopySmall(const WorkloadOptions& options, Measures* p_measures);
+
+// Wall time of ssfcp processes copying a small file to the server, one
+// operation per process (startup included)
+bool RunCopyStartup(const WorkloadOptions& options, Measures* p_measures);
+
+// Command echo latency through the shell service
+bool RunShell(const WorkloadOptions& options, Measures* p_measures);
+
+// Command echo latency through the shell service while bulk downloads run
+// through a TCP port forwarding of the same session
+bool RunShellUnderBulk(const WorkloadOptions& options, Measures* p_measures);
+
+// Shell sessions opened one after the other, one operation per connection
+// until the first command echo
+bool RunShellSessions(const WorkloadOptions& options, Measures* p_measures);
+
+// tar archives of a large file streamed by the exec service (POSIX), one
+// operation per command
+bool RunExecTar(const WorkloadOptions& options, Measures* p_measures);
+
+// Named workloads, in execution order
+const std::vector<std::pair<std::string, Workload>>& GetWorkloads();
+
+}  // bench
+}  // ssf
+
+#endif  // SSF_BENCH_WORKLOADS_H_
@@ -1,3 +1,9 @@
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include <boost/asio/io_service.hpp>
 #include <boost/asio/signal_set.hpp>
 #include <boost/system/error_code.hpp>
@@ -6,12 +12,17 @@
 
 #include "common/config/config.h"
 
+#include "core/async_engine.h"
 #include "core/client/client.h"
 #include "core/client/client_helper.h"
+#include "core/client/control_api.h"
+#include "core/client/control_master.h"
 #include "core/command_line/standard/command_line.h"
 #include "core/command_line/user_service_option_factory.h"
 
 #include "services/user_services/base_user_service.h"
+#include "services/user_services/copy.h"
+#include "services/user_services/exec.h"
 #include "services/user_services/parameters.h"
 #include "services/user_services/port_forwarding.h"
 #include "services/user_services/shell.h"
@@ -24,11 +35,47 @@
 
 using Demux = ssf::Client::Demux;
 
+// map the status of a client to the process exit code
+void UpdateExitStatus(ssf::Status status, boost::system::error_code* p_exit_ec);
+
+// run the sessions of the config file in this process, one client per server
+// sharing the same engine
+//   api_path (may be empty) serves one control API over every session
+void RunSessions(
+    const ssf::config::Config& ssf_config, const std::string& config_file,
+    const ssf::UserServiceOptionFactory& user_service_option_factory,
+    const std::string& api_path, boost::system::error_code& exit_ec);
+
 // register supported user services (port forwarding, SOCKS, shell...)
-void RegisterUserServices(
-    ssf::Client* client,
+void RegisterUserServices(ssf::Client* client);
+
+// register the CLI options of the supported user services
+void RegisterUserServiceOptions(
     ssf::UserServiceOptionFactory* user_service_option_factory);
 
+// reload the user services and the microservices configuration from the
+// config file (SIGHUP)
+void ReloadUserServices(
+    ssf::Client* client, const ssf::command_line::StandardCommandLine& cmd,
+    const ssf::UserServiceOptionFactory& user_service_option_factory,
+    const ssf::UserServiceParameters& cli_user_service_parameters);
+
+// reload the user services of each session from the sessions of the config
+// file (SIGHUP)
+//   sessions are matched by their index, added or removed sessions need a
+//   restart
+void ReloadSessions(
+    const std::vector<ssf::Client*>& clients,
+    const std::vector<const ssf::command_line::StandardCommandLine*>& cmds,
+    const std::string& config_file,
+    const ssf::UserServiceOptionFactory& user_service_option_factory);
+
+// apply reloaded user services parameters and config to a running client
+void ApplyReload(ssf::Client* client,
+                 const ssf::command_line::StandardCommandLine& cmd,
+                 const ssf::config::Services& services_config,
+                 ssf::UserServiceParameters user_service_parameters);
+
 void Run(int argc, char** argv, boost::system::error_code& exit_ec);
 
 int main(int argc, char** argv) {
@@ -42,11 +89,10 @@ int main(int argc, char** argv) {
 }
 
 void Run(int argc, char** argv, boost::system::error_code& exit_ec) {
-  ssf::Client client;
   ssf::UserServiceOptionFactory user_service_option_factory;
   ssf::UserServiceParameters user_service_parameters;
 
-  RegisterUserServices(&client, &user_service_option_factory);
+  RegisterUserServiceOptions(&user_service_option_factory);
 
   // CLI options
   ssf::command_line::StandardCommandLine cmd;
@@ -60,6 +106,7 @@ void Run(int argc, char** argv, boost::system::error_code& exit_ec) {
     SSF_LOG("ssf", error, "invalid command line arguments");
     return;
   }
+  auto cli_user_service_parameters = user_service_parameters;
 
   SetLogLevel(cmd.log_level());
 
@@ -88,6 +135,12 @@ void Run(int argc, char** argv, boost::system::error_code& exit_ec) {
     ssf_config.LogStatus();
   }
 
+  if (ssf_config.GetSessionsCount() > 0) {
+    RunSessions(ssf_config, cmd.config_file(), user_service_option_factory,
+                cmd.api_path(), exit_ec);
+    return;
+  }
+
   if (!cmd.host_set()) {
     SSF_LOG("ssf", error, "no server host provided");
     exit_ec.assign(::error::destination_address_required,
@@ -107,32 +160,20 @@ void Run(int argc, char** argv, boost::system::error_code& exit_ec) {
 
   ssf_config.services().SetGatewayPorts(cmd.gateway_ports());
 
+  ssf::Client client;
+  RegisterUserServices(&client);
+
+  // the control master runs copies requested by ssfcp over the session
+  if (!cmd.control_path().empty()) {
+    using CopyService = ssf::services::Copy<Demux>;
+    client.Register<CopyService>();
+    user_service_parameters[CopyService::GetParseName()] = {
+        CopyService::CreateUserServiceParameters(exit_ec)};
+  }
+
   // initialize and run client
-  auto on_status = [&client, &exit_ec](ssf::Status status) {
-    switch (status) {
-      case ssf::Status::kEndpointNotResolvable:
-        exit_ec.assign(::error::address_not_available,
-                       ::error::get_ssf_category());
-        break;
-      case ssf::Status::kServerUnreachable:
-        exit_ec.assign(::error::host_unreachable, ::error::get_ssf_category());
-        break;
-      case ssf::Status::kServerNotSupported:
-        exit_ec.assign(::error::protocol_error,
-                       ::error::get_ssf_category());
-        break;
-      case ssf::Status::kConnected:
-      case ssf::Status::kRunning:
-        exit_ec.assign(::error::success, ::error::get_ssf_category());
-        break;
-      case ssf::Status::kDisconnected:
-        if (exit_ec.value() != ::error::interrupted) {
-          exit_ec.assign(::error::broken_pipe, ::error::get_ssf_category());
-        }
-        break;
-      default:
-        break;
-    }
+  auto on_status = [&exit_ec](ssf::Status status) {
+    UpdateExitStatus(status, &exit_ec);
   };
   auto on_user_service_status = [&client, &cmd, &exit_ec](
       ssf::Client::UserServicePtr service,
@@ -163,6 +204,25 @@ void Run(int argc, char** argv, boost::system::error_code& exit_ec) {
         client.Stop(stop_ec);
       });
 
+#if defined(SIGHUP)
+  // reload user services on SIGHUP, the session is kept
+  boost::asio::signal_set reload_signal(client.get_io_service(), SIGHUP);
+  std::function<void()> async_wait_reload;
+  async_wait_reload = [&]() {
+    reload_signal.async_wait(
+        [&](const boost::system::error_code& ec, int signum) {
+          if (ec) {
+            return;
+          }
+
+          ReloadUserServices(&client, cmd, user_service_option_factory,
+                             cli_user_service_parameters);
+          async_wait_reload();
+        });
+  };
+  async_wait_reload();
+#endif  // defined(SIGHUP)
+
   client.Run(exit_ec);
   if (exit_ec) {
     SSF_LOG("ssf", error, "error happened when running client: {}",
@@ -170,20 +230,390 @@ void Run(int argc, char** argv, boost::system::error_code& exit_ec) {
     return;
   }
 
-  // blocks until signal or max reconnection attempts
+  ssf::ControlMaster::ControlMasterPtr p_control_master;
+  if (!cmd.control_path().empty()) {
+    p_control_master = ssf::ControlMaster::Create(&client, cmd.control_path());
+    p_control_master->Start(exit_ec);
+    if (exit_ec) {
+      SSF_LOG("ssf", error, "cannot start control master ({})",
+              exit_ec.message());
+    }
+  }
+
+  // the control API adds and removes user services on the live session
+  ssf::ControlApi::ControlApiPtr p_control_api;
+  if (!exit_ec && !cmd.api_path().empty()) {
+    p_control_api = ssf::ControlApi::Create(
+        &client, &user_service_option_factory, cmd.api_path());
+    p_control_api->Start(exit_ec);
+    if (exit_ec) {
+      SSF_LOG("ssf", error, "cannot start control API ({})",
+              exit_ec.message());
+    }
+  }
+
   boost::system::error_code stop_ec;
-  client.WaitStop(stop_ec);
+  if (exit_ec) {
+    // the session cannot be controlled as requested
+    client.Stop(stop_ec);
+  } else {
+    // blocks until signal or max reconnection attempts
+    client.WaitStop(stop_ec);
+  }
 
   SSF_LOG("ssf", debug, "stop");
   signal.cancel(stop_ec);
+#if defined(SIGHUP)
+  reload_signal.cancel(stop_ec);
+#endif  // defined(SIGHUP)
+
+  if (p_control_master) {
+    p_control_master->Stop();
+  }
+
+  if (p_control_api) {
+    p_control_api->Stop();
+  }
 
   client.Deinit();
 }
 
-void RegisterUserServices(
-    ssf::Client* client,
-    ssf::UserServiceOptionFactory* user_service_option_factory) {
-  // client user services
+void UpdateExitStatus(ssf::Status status,
+                      boost::system::error_code* p_exit_ec) {
+  switch (status) {
+    case ssf::Status::kEndpointNotResolvable:
+      p_exit_ec->assign(::error::address_not_available,
+                        ::error::get_ssf_category());
+      break;
+    case ssf::Status::kServerUnreachable:
+      p_exit_ec->assign(::error::host_unreachable,
+                        ::error::get_ssf_category());
+      break;
+    case ssf::Status::kServerNotSupported:
+      p_exit_ec->assign(::error::protocol_error, ::error::get_ssf_category());
+      break;
+    case ssf::Status::kConnected:
+    case ssf::Status::kRunning:
+      p_exit_ec->assign(::error::success, ::error::get_ssf_category());
+      break;
+    case ssf::Status::kDisconnected:
+      if (p_exit_ec->value() != ::error::interrupted) {
+        p_exit_ec->assign(::error::broken_pipe, ::error::get_ssf_category());
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+void RunSessions(
+    const ssf::config::Config& ssf_config, const std::string& config_file,
+    const ssf::UserServiceOptionFactory& user_service_option_factory,
+    const std::string& api_path, boost::system::error_code& exit_ec) {
+  // one client per server, its own reconnection policy and user services
+  struct SessionClient {
+    explicit SessionClient(ssf::AsyncEngine* p_async_engine)
+        : client(p_async_engine), cmd(), exit_ec(), p_control_master() {}
+
+    ssf::Client client;
+    ssf::command_line::StandardCommandLine cmd;
+    boost::system::error_code exit_ec;
+    ssf::ControlMaster::ControlMasterPtr p_control_master;
+  };
+  using SessionClientPtr = std::unique_ptr<SessionClient>;
+
+  // the engine threads are shared by the sessions, each session keeps its own
+  // fibers demultiplexer, quotas and reconnection timer
+  ssf::AsyncEngine async_engine;
+  std::vector<SessionClientPtr> sessions;
+
+  for (std::size_t i = 0; i < ssf_config.GetSessionsCount(); ++i) {
+    SessionClientPtr p_session(new SessionClient(&async_engine));
+    auto& cmd = p_session->cmd;
+    auto argv = ssf_config.GetSessionArgv(i);
+    auto user_service_parameters =
+        cmd.Parse(static_cast<int>(argv.size() - 1), argv.data(),
+                  user_service_option_factory, exit_ec);
+    if (exit_ec) {
+      SSF_LOG("ssf", error, "session {}: invalid arguments", i);
+      break;
+    }
+
+    if (!cmd.host_set() || !cmd.port_set()) {
+      SSF_LOG("ssf", error, "session {}: no server address provided", i);
+      exit_ec.assign(::error::destination_address_required,
+                     ::error::get_ssf_category());
+      break;
+    }
+
+    if (!cmd.api_path().empty()) {
+      SSF_LOG("ssf", warn,
+              "session {}: API path ignored, the API path of the command "
+              "line controls every session",
+              i);
+    }
+
+    auto endpoint_query = ssf::GenerateNetworkQuery(
+        cmd.host(), std::to_string(cmd.port()), ssf_config);
+    auto services_config = ssf_config.services();
+    services_config.SetGatewayPorts(cmd.gateway_ports());
+
+    RegisterUserServices(&p_session->client);
+
+    // ssfcp copies through the control path of the session of their server
+    if (!cmd.control_path().empty()) {
+      using CopyService = ssf::services::Copy<Demux>;
+      p_session->client.Register<CopyService>();
+      user_service_parameters[CopyService::GetParseName()] = {
+          CopyService::CreateUserServiceParameters(exit_ec)};
+    }
+
+    auto p_session_exit_ec = &p_session->exit_ec;
+    auto on_status = [p_session_exit_ec](ssf::Status status) {
+      UpdateExitStatus(status, p_session_exit_ec);
+    };
+    auto on_user_service_status = [](ssf::Client::UserServicePtr service,
+                                     const boost::system::error_code& ec) {};
+
+    p_session->client.Init(endpoint_query, cmd.max_connection_attempts(),
+                           cmd.reconnection_timeout(), cmd.no_reconnection(),
+                           user_service_parameters, services_config, on_status,
+                           on_user_service_status, exit_ec);
+    if (exit_ec) {
+      SSF_LOG("ssf", error, "session {}: cannot init client", i);
+      break;
+    }
+
+    SSF_LOG("ssf", info, "session {}: connecting to <{}:{}>", i, cmd.host(),
+            cmd.port());
+    p_session->client.Run(exit_ec);
+    sessions.push_back(std::move(p_session));
+    if (exit_ec) {
+      SSF_LOG("ssf", error, "session {}: cannot run client ({})", i,
+              exit_ec.message());
+      break;
+    }
+
+    if (!cmd.control_path().empty()) {
+      auto& session = *sessions.back();
+      session.p_control_master =
+          ssf::ControlMaster::Create(&session.client, cmd.control_path());
+      session.p_control_master->Start(exit_ec);
+      if (exit_ec) {
+        SSF_LOG("ssf", error, "session {}: cannot start control master ({})",
+                i, exit_ec.message());
+        break;
+      }
+    }
+  }
+
+  // one control API and metrics surface over all the sessions
+  ssf::ControlApi::ControlApiPtr p_control_api;
+  if (!exit_ec && !api_path.empty() && !sessions.empty()) {
+    std::vector<ssf::Client*> clients;
+    for (auto& p_session : sessions) {
+      clients.push_back(&p_session->client);
+    }
+    p_control_api = ssf::ControlApi::Create(
+        std::move(clients), &user_service_option_factory, api_path);
+    p_control_api->Start(exit_ec);
+    if (exit_ec) {
+      SSF_LOG("ssf", error, "cannot start control API ({})",
+              exit_ec.message());
+    }
+  }
+
+  boost::system::error_code stop_ec;
+  if (!exit_ec) {
+    SSF_LOG("ssf", info, "running {} sessions (Ctrl + C to stop)",
+            sessions.size());
+
+    // stop the sessions on SIGINT or SIGTERM
+    bool interrupted = false;
+    boost::asio::signal_set signal(async_engine.get_io_service(), SIGINT,
+                                   SIGTERM);
+    signal.async_wait(
+        [&sessions, &interrupted](const boost::system::error_code& ec, int) {
+          if (ec) {
+            return;
+          }
+
+          interrupted = true;
+          for (auto& p_session : sessions) {
+            p_session->exit_ec.assign(::error::interrupted,
+                                      ::error::get_ssf_category());
+            boost::system::error_code session_stop_ec;
+            p_session->client.Stop(session_stop_ec);
+          }
+        });
+
+#if defined(SIGHUP)
+    // reload the user services of each session on SIGHUP, the sessions are
+    // kept
+    std::vector<ssf::Client*> clients;
+    std::vector<const ssf::command_line::StandardCommandLine*> cmds;
+    for (auto& p_session : sessions) {
+      clients.push_back(&p_session->client);
+      cmds.push_back(&p_session->cmd);
+    }
+    boost::asio::signal_set reload_signal(async_engine.get_io_service(),
+                                          SIGHUP);
+    std::function<void()> async_wait_reload;
+    async_wait_reload = [&]() {
+      reload_signal.async_wait(
+          [&](const boost::system::error_code& ec, int signum) {
+            if (ec) {
+              return;
+            }
+
+            ReloadSessions(clients, cmds, config_file,
+                           user_service_option_factory);
+            async_wait_reload();
+          });
+    };
+    async_wait_reload();
+#endif  // defined(SIGHUP)
+
+    // blocks until every session is stopped
+    for (auto& p_session : sessions) {
+      p_session->client.WaitStop(stop_ec);
+    }
+    signal.cancel(stop_ec);
+#if defined(SIGHUP)
+    reload_signal.cancel(stop_ec);
+#endif  // defined(SIGHUP)
+
+    if (interrupted) {
+      exit_ec.assign(::error::interrupted, ::error::get_ssf_category());
+    } else {
+      for (auto& p_session : sessions) {
+        if (p_session->exit_ec) {
+          exit_ec = p_session->exit_ec;
+          break;
+        }
+      }
+    }
+  }
+
+  SSF_LOG("ssf", debug, "stop");
+  if (p_control_api) {
+    p_control_api->Stop();
+  }
+  for (auto& p_session : sessions) {
+    if (p_session->p_control_master) {
+      p_session->p_control_master->Stop();
+    }
+    p_session->client.Stop(stop_ec);
+  }
+  async_engine.Stop();
+  for (auto& p_session : sessions) {
+    p_session->client.Deinit();
+  }
+}
+
+void ReloadUserServices(
+    ssf::Client* client, const ssf::command_line::StandardCommandLine& cmd,
+    const ssf::UserServiceOptionFactory& user_service_option_factory,
+    const ssf::UserServiceParameters& cli_user_service_parameters) {
+  SSF_LOG("ssf", info, "reloading config file");
+
+  boost::system::error_code ec;
+  ssf::config::Config ssf_config;
+  ssf_config.Init();
+  ssf_config.UpdateFromFile(cmd.config_file(), ec);
+  if (ec) {
+    SSF_LOG("ssf", error, "reload: invalid config file format");
+    return;
+  }
+
+  auto user_service_parameters = cli_user_service_parameters;
+  ssf::command_line::StandardCommandLine reload_cmd;
+  if (ssf_config.GetArgc() > 0) {
+    user_service_parameters =
+        reload_cmd.Parse(ssf_config.GetArgc(), ssf_config.GetArgv().data(),
+                         user_service_option_factory, ec);
+    if (ec) {
+      SSF_LOG("ssf", error, "reload: invalid command line arguments");
+      return;
+    }
+    if ((reload_cmd.host_set() && reload_cmd.host() != cmd.host()) ||
+        (reload_cmd.port_set() && reload_cmd.port() != cmd.port())) {
+      SSF_LOG("ssf", warn, "reload: new server endpoint needs a restart");
+    }
+  }
+
+  ApplyReload(client, cmd, ssf_config.services(),
+              std::move(user_service_parameters));
+}
+
+void ReloadSessions(
+    const std::vector<ssf::Client*>& clients,
+    const std::vector<const ssf::command_line::StandardCommandLine*>& cmds,
+    const std::string& config_file,
+    const ssf::UserServiceOptionFactory& user_service_option_factory) {
+  SSF_LOG("ssf", info, "reloading config file");
+
+  boost::system::error_code ec;
+  ssf::config::Config ssf_config;
+  ssf_config.Init();
+  ssf_config.UpdateFromFile(config_file, ec);
+  if (ec) {
+    SSF_LOG("ssf", error, "reload: invalid config file format");
+    return;
+  }
+
+  std::size_t sessions_count = ssf_config.GetSessionsCount();
+  if (sessions_count != clients.size()) {
+    SSF_LOG("ssf", warn,
+            "reload: {} sessions in the config file, {} running: added or "
+            "removed sessions need a restart",
+            sessions_count, clients.size());
+  }
+
+  for (std::size_t i = 0; i < std::min(sessions_count, clients.size()); ++i) {
+    const auto& cmd = *cmds[i];
+    ssf::command_line::StandardCommandLine reload_cmd;
+    auto argv = ssf_config.GetSessionArgv(i);
+    auto user_service_parameters =
+        reload_cmd.Parse(static_cast<int>(argv.size() - 1), argv.data(),
+                         user_service_option_factory, ec);
+    if (ec) {
+      SSF_LOG("ssf", error, "reload: session {}: invalid arguments", i);
+      continue;
+    }
+    if ((reload_cmd.host_set() && reload_cmd.host() != cmd.host()) ||
+        (reload_cmd.port_set() && reload_cmd.port() != cmd.port())) {
+      SSF_LOG("ssf", warn,
+              "reload: session {}: new server endpoint needs a restart", i);
+    }
+
+    ApplyReload(clients[i], cmd, ssf_config.services(),
+                std::move(user_service_parameters));
+  }
+}
+
+void ApplyReload(ssf::Client* client,
+                 const ssf::command_line::StandardCommandLine& cmd,
+                 const ssf::config::Services& services_config,
+                 ssf::UserServiceParameters user_service_parameters) {
+  boost::system::error_code ec;
+  if (!cmd.control_path().empty()) {
+    using CopyService = ssf::services::Copy<Demux>;
+    user_service_parameters[CopyService::GetParseName()] = {
+        CopyService::CreateUserServiceParameters(ec)};
+  }
+
+  // the gateway ports option belongs to the command line of the client
+  auto client_services_config = services_config;
+  client_services_config.SetGatewayPorts(cmd.gateway_ports());
+
+  client->Reload(user_service_parameters, client_services_config, ec);
+  if (ec) {
+    SSF_LOG("ssf", error, "reload failed ({})", ec.message());
+  }
+}
+
+void RegisterUserServices(ssf::Client* client) {
   client->Register<ssf::services::PortForwarding<Demux>>();
   client->Register<ssf::services::RemotePortForwarding<Demux>>();
   client->Register<ssf::services::Socks<Demux>>();
@@ -192,8 +622,11 @@ void RegisterUserServices(
   client->Register<ssf::services::RemoteUdpPortForwarding<Demux>>();
   client->Register<ssf::services::Shell<Demux>>();
   client->Register<ssf::services::RemoteShell<Demux>>();
+  client->Register<ssf::services::Exec<Demux>>();
+}
 
-  // user service CLI options
+void RegisterUserServiceOptions(
+    ssf::UserServiceOptionFactory* user_service_option_factory) {
   user_service_option_factory->Register<ssf::services::PortForwarding<Demux>>();
   user_service_option_factory
       ->Register<ssf::services::RemotePortForwarding<Demux>>();
@@ -205,4 +638,5 @@ void RegisterUserServices(
       ->Register<ssf::services::RemoteUdpPortForwarding<Demux>>();
   user_service_option_factory->Register<ssf::services::Shell<Demux>>();
   user_service_option_factory->Register<ssf::services::RemoteShell<Demux>>();
+  user_service_option_factory->Register<ssf::services::Exec<Demux>>();
 }
@@ -1,3 +1,4 @@
+#include <chrono>
 #include <type_traits>
 
 #include <boost/asio/io_service.hpp>
@@ -10,6 +11,7 @@
 
 #include "core/client/client.h"
 #include "core/client/client_helper.h"
+#include "core/client/control_client.h"
 #include "core/command_line/copy/command_line.h"
 #include "core/network_protocol.h"
 #include "core/transport_virtual_layer_policies/transport_protocol_policy.h"
@@ -44,6 +46,14 @@ int main(int argc, char** argv) {
 void Run(int argc, char** argv, boost::system::error_code& exit_ec) {
   boost::system::error_code stop_ec;
 
+  // startup time instrumentation
+  auto start_time = std::chrono::steady_clock::now();
+  auto log_startup_step = [&start_time](const char* step) {
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start_time);
+    SSF_LOG("ssfcp", debug, "startup: {} after {}us", step, elapsed.count());
+  };
+
   ssf::Client client;
 
   CopyClientPtr copy_client;
@@ -83,6 +93,7 @@ void Run(int argc, char** argv, boost::system::error_code& exit_ec) {
   }
 
   ssf_config.Log();
+  log_startup_step("config loaded");
 
   // create and initialize copy user service
   ssf::UserServiceParameters copy_params = {
@@ -113,8 +124,22 @@ void Run(int argc, char** argv, boost::system::error_code& exit_ec) {
       cmd.check_file_integrity(), cmd.max_parallel_copies(),
       cmd.input_pattern(), cmd.output_pattern());
 
+  // reuse the session of a running ssf client when possible
+  if (!cmd.control_path().empty()) {
+    boost::system::error_code control_ec;
+    if (ssf::CopyThroughControlMaster(cmd.control_path(),
+                                      cmd.from_client_to_server(), req,
+                                      exit_ec, control_ec)) {
+      log_startup_step("copy done by control master");
+      return;
+    }
+    SSF_LOG("ssfcp", info, "control master not available ({}), connecting",
+            control_ec.message());
+  }
+
   auto endpoint_query = ssf::GenerateNetworkQuery(
       cmd.host(), std::to_string(cmd.port()), ssf_config);
+  log_startup_step("network query generated");
 
   // initialize and run client
   auto on_status = [&client, &exit_ec](ssf::Status status) {
@@ -170,6 +195,7 @@ void Run(int argc, char** argv, boost::system::error_code& exit_ec) {
     SSF_LOG("ssfcp", error, "cannot init client ({})", exit_ec.message());
     return;
   }
+  log_startup_step("client initialized");
 
   SSF_LOG("ssfcp", info, "connecting to <{}:{}>", cmd.host(), cmd.port());
   SSF_LOG("ssfcp", info, "running (Ctrl + C to stop)");
@@ -20,6 +20,7 @@
 
 #include "common/boost/fiber/basic_fiber_demux_service.hpp"
 #include "common/boost/fiber/detail/fiber_id.hpp"
+#include "common/boost/fiber/detail/fiber_quotas.hpp"
 #include "common/boost/fiber/detail/io_fiber_accept_op.hpp"
 
 #include <boost/asio/detail/push_options.hpp>
@@ -65,6 +66,13 @@ class basic_fiber_demux : private boost::noncopyable {
   /// port)
   typedef typename Service::fiber_id fiber_id;
 
+  /// Type of the limits on the resources used by the peer
+  typedef boost::asio::fiber::detail::fiber_quota_limits quota_limits_type;
+
+  /// Type of a pointer to the resources used by the peer
+  typedef std::shared_ptr<boost::asio::fiber::detail::fiber_quotas>
+      quotas_ptr_type;
+
  private:
   typedef boost::asio::fiber::detail::basic_pending_accept_operation<
       StreamSocket>
@@ -102,21 +110,35 @@ class basic_fiber_demux : private boost::noncopyable {
   * This function is used to initiate the demultiplexing on the stream socket
   *
   * @param socket The stream socket on which to demultiplex.
+  * @param limits The limits on the resources used by the peer.
   *
   * @note Once this function has been called, the socket should not be directly
   * read from or written to by the user.
   */
   void fiberize(StreamSocket socket, close_handler_type close = []() {},
-                size_t mtu = 60 * 1024) {
+                size_t mtu = 60 * 1024,
+                const quota_limits_type& limits = quota_limits_type()) {
     if (mtu > 60 * 1024) {
       SSF_LOG("demux", warn, "MTU too big, replaced with MAX_VALUE");
       mtu = 60 * 1024;
     }
 
-    impl_ = implementation_deref_type::create(std::move(socket), close, mtu);
+    impl_ = implementation_deref_type::create(std::move(socket), close, mtu,
+                                              limits);
     service_.fiberize(impl_);
   }
 
+  /// Return the resources used by the peer and their limits
+  /**
+  * @return A null pointer if the demux has not been fiberized.
+  */
+  quotas_ptr_type quotas() {
+    return impl_.get() ? impl_->p_quotas : quotas_ptr_type();
+  }
+
+  /// Return the number of connected fibers (acceptors excluded)
+  std::size_t connected_fibers() { return service_.connected_fibers(impl_); }
+
   /// Bind a fiber acceptor to the given local fiber port.
   /**
   * This function binds a fiber acceptor to the specified local fiber port
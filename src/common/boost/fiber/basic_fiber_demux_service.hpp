@@ -21,6 +21,7 @@
 #include "common/boost/fiber/detail/fiber_id.hpp"
 #include "common/boost/fiber/detail/fiber_buffer.hpp"
 #include "common/boost/fiber/detail/io_fiber_accept_op.hpp"
+#include "common/boost/fiber/detail/io_fiber_write_op.hpp"
 
 #include <boost/asio/detail/push_options.hpp>
 
@@ -143,6 +144,12 @@ public:
   */
   void unbind(implementation_type impl, const fiber_id& id);
 
+  /// Count the connected fibers on a given demux (acceptors excluded).
+  /**
+  * @param impl A pointer to the implementation of a demux.
+  */
+  std::size_t connected_fibers(implementation_type impl);
+
   /// Notify the service that a fiber acceptor is listening on a fiber port.
   /**
   * @param impl A pointer to the implementation of a demux.
@@ -251,7 +258,9 @@ private:
   void handle_syn(implementation_type impl, p_fiber_buffer p_fiber_buff);
   void handle_rst(implementation_type impl, p_fiber_buffer p_fiber_buff);
 
+  /// Write the next queued packets on the socket (on the send strand)
   void async_push_packets(implementation_type impl);
+  void dispatch_received_packets(implementation_type impl);
   void dispatch_buffer(implementation_type impl, p_fiber_buffer p_fiber_buff);
 
   local_port_type get_available_local_port(implementation_type impl);
@@ -261,10 +270,6 @@ private:
                   ConstBufferSequence& buffers, Handler handler,
                   uint8_t priority = 0);
 
-  template <typename ConstBufferSequence>
-  std::vector<boost::asio::const_buffer> get_partial_buffer_sequence(
-    ConstBufferSequence buffers, size_t length);
-
   void close_all_fibers(implementation_type impl);
 
 private:
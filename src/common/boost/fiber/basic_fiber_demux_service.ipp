@@ -76,11 +76,7 @@ void basic_fiber_demux_service<S>::bind(implementation_type impl,
       impl->bound[receiving_id] = fib_impl;
       impl->used_ports.insert(id.local_port());
 
-      {
-        std::unique_lock<std::recursive_mutex> lock_state(
-            fib_impl->state_mutex);
-        fib_impl->closed = false;
-      }
+      fib_impl->set_opened();
 
       ec.assign(::error::success, ::error::get_ssf_category());
     } else {
@@ -116,6 +112,30 @@ void basic_fiber_demux_service<S>::unbind(implementation_type impl,
 
   impl->bound.erase(id.returning_id());
   impl->used_ports.erase(id.local_port());
+
+  // The send queues are only touched on the send strand
+  impl->send_strand.post([impl, id]() { impl->queued_ops.erase(id); });
+}
+
+template <typename S>
+std::size_t basic_fiber_demux_service<S>::connected_fibers(
+    implementation_type impl) {
+  if (!impl) {
+    return 0;
+  }
+
+  std::unique_lock<std::recursive_mutex> lock(impl->bound_mutex);
+  std::size_t count = 0;
+  for (auto& fiber : impl->bound) {
+    if (fiber.second->id.remote_port() == 0) {
+      // fiber acceptor
+      continue;
+    }
+    if (fiber.second->is_connected()) {
+      ++count;
+    }
+  }
+  return count;
 }
 
 template <typename S>
@@ -175,19 +195,16 @@ void basic_fiber_demux_service<S>::stop_listening(implementation_type impl,
 template <typename S>
 void basic_fiber_demux_service<S>::async_poll_packets(
     implementation_type impl) {
-  auto p_fiber_buff =
-      std::make_shared<boost::asio::fiber::detail::fiber_buffer>();
-
   /////////////////// BEGIN HANDLER ///////////////////////////////
-  auto dispatch_handler = [this, p_fiber_buff, impl](
-      const boost::system::error_code& ec, std::size_t bytes_transferred) {
-    std::unique_lock<std::recursive_mutex> lock(impl->closing_mutex);
+  auto dispatch_handler = [this, impl](const boost::system::error_code& ec,
+                                       std::size_t bytes_transferred) {
     if (impl->closing) {
       return;
     }
 
     if (!ec) {
-      this->dispatch_buffer(impl, p_fiber_buff);
+      impl->receive_buffer.commit(bytes_transferred);
+      this->dispatch_received_packets(impl);
       this->async_poll_packets(impl);
     } else {
       SSF_LOG("demux", debug,
@@ -198,35 +215,75 @@ void basic_fiber_demux_service<S>::async_poll_packets(
   };
   //////////////////// END HANDLER ///////////////////////////////
 
-  std::unique_lock<std::recursive_mutex> lock(impl->closing_mutex);
+  std::unique_lock<std::mutex> lock(impl->socket_mutex);
   if (!impl->closing) {
-    async_read_fiber_buffer(impl->socket, *p_fiber_buff, dispatch_handler);
+    impl->socket.async_read_some(impl->receive_buffer.prepare(),
+                                 dispatch_handler);
+  }
+}
+
+template <typename S>
+void basic_fiber_demux_service<S>::dispatch_received_packets(
+    implementation_type impl) {
+  fiber_header header;
+  const uint8_t* p_payload = nullptr;
+
+  // Only one read is pending at a time, the receive buffer is not shared
+  while (impl->receive_buffer.next_packet(header, p_payload)) {
+    if (impl->closing) {
+      return;
+    }
+
+    dispatch_buffer(impl, std::make_shared<fiber_buffer>(
+                              header, p_payload, header.data_size()));
   }
 }
 
 template <typename S>
 void basic_fiber_demux_service<S>::async_push_packets(
     implementation_type impl) {
-  std::unique_lock<std::recursive_mutex> lock(impl->send_mutex);
-  const auto& to_send_priority = impl->toSendPriority.front();
-
-  auto handler = [this, impl, to_send_priority](
-      const boost::system::error_code& ec, size_t transferred_bytes) {
-    std::unique_lock<std::recursive_mutex> lock(impl->send_mutex);
-    impl->toSendPriority.pop();
-    impl->socket.get_io_service().post(
-        std::bind(to_send_priority.handler, ec, transferred_bytes));
-    if (!impl->toSendPriority.empty()) {
-      impl->socket.get_io_service().post(std::bind(
-          &basic_fiber_demux_service<S>::async_push_packets, this, impl));
+  // Packets of high priority fibers (e.g. interactive shells) go first
+  detail::basic_pending_write_operation* p_op;
+  if (!impl->priority_send_op_queue.empty()) {
+    p_op = impl->priority_send_op_queue.front();
+    impl->priority_send_op_queue.pop();
+  } else {
+    p_op = impl->send_op_queue.front();
+    impl->send_op_queue.pop();
+    if (!impl->queued_ops.empty()) {
+      auto queued_it = impl->queued_ops.find(p_op->id());
+      if (queued_it != impl->queued_ops.end() && queued_it->second > 0) {
+        --queued_it->second;
+      }
     }
+  }
+  impl->p_sending_op = p_op;
+
+  auto handler = [this, impl](const boost::system::error_code& ec,
+                              size_t transferred_bytes) {
+    auto p_sent_op = impl->p_sending_op;
+    impl->p_sending_op = nullptr;
+
+    // Keep the socket busy before running the user handler
+    if (!impl->priority_send_op_queue.empty() ||
+        !impl->send_op_queue.empty()) {
+      this->async_push_packets(impl);
+    }
+
+    // User handlers run outside of the send strand, a slow handler must not
+    // hold up the writes of the other fibers
+    auto complete_sent_op = [p_sent_op, ec]() {
+      p_sent_op->complete(ec, ec ? 0 : p_sent_op->frames().payload_size());
+    };
+    impl->socket.get_io_service().post(complete_sent_op);
   };
 
-  std::unique_lock<std::recursive_mutex> lock2(impl->closing_mutex);
+  std::unique_lock<std::mutex> lock(impl->socket_mutex);
   if (!impl->closing) {
-    boost::asio::async_write(impl->socket, to_send_priority.buffer, handler);
+    boost::asio::async_write(impl->socket, p_op->frames().buffers(),
+                             impl->send_strand.wrap(handler));
   } else {
-    impl->socket.get_io_service().post(std::bind(
+    impl->send_strand.post(std::bind(
         handler, boost::system::error_code(::error::connection_aborted,
                                            ::error::get_ssf_category()),
         0));
@@ -274,18 +331,18 @@ void basic_fiber_demux_service<S>::handle_dgr(implementation_type impl,
   std::unique_lock<std::recursive_mutex> lock(impl->bound_mutex);
 
   if (impl->bound.count(full_id) != 0) {
-    if (impl->bound[full_id]->accepts_dgr) {
-      auto on_new_packet = impl->bound[full_id]->access_receive_dgr_handler();
-      on_new_packet(p_fiber_buff->take_data(),
-                    p_fiber_buff->header().id().local_port(),
-                    p_fiber_buff->data_size());
+    auto p_fib_impl = impl->bound[full_id];
+    if (p_fib_impl->accepts_dgr()) {
+      p_fib_impl->on_receive_dgr(p_fiber_buff->take_data(),
+                                 p_fiber_buff->header().id().local_port(),
+                                 p_fiber_buff->data_size());
     }
   } else if (impl->bound.count(half_id) != 0) {
-    if (impl->bound[half_id]->accepts_dgr) {
-      auto on_new_packet = impl->bound[half_id]->access_receive_dgr_handler();
-      on_new_packet(p_fiber_buff->take_data(),
-                    p_fiber_buff->header().id().local_port(),
-                    p_fiber_buff->data_size());
+    auto p_fib_impl = impl->bound[half_id];
+    if (p_fib_impl->accepts_dgr()) {
+      p_fib_impl->on_receive_dgr(p_fiber_buff->take_data(),
+                                 p_fiber_buff->header().id().local_port(),
+                                 p_fiber_buff->data_size());
     }
   }
 }
@@ -298,8 +355,9 @@ void basic_fiber_demux_service<S>::handle_push(implementation_type impl,
   std::unique_lock<std::recursive_mutex> lock(impl->bound_mutex);
 
   if (impl->bound.count(header.id()) != 0) {
-    auto on_new_packet = impl->bound[header.id()]->access_receive_handler();
-    on_new_packet(p_fiber_buff->take_data(), p_fiber_buff->data_size());
+    auto p_fib_impl = impl->bound[header.id()];
+    p_fib_impl->on_receive(p_fiber_buff->take_data(),
+                           p_fiber_buff->data_size());
   } else {
     async_send_rst(impl, header.id().returning_id(), []() {});
   }
@@ -316,13 +374,10 @@ void basic_fiber_demux_service<S>::handle_ack(implementation_type impl,
     auto p_fib_impl = impl->bound[header.id()];
     p_fib_impl->toggle_out();
 
-    std::unique_lock<std::recursive_mutex> lock_state(p_fib_impl->state_mutex);
-
-    if (p_fib_impl->connecting) {
-      p_fib_impl->set_connected();
-      auto on_ack = p_fib_impl->access_connect_handler();
-      on_ack(boost::system::error_code(::error::success,
-                                       ::error::get_ssf_category()));
+    if (p_fib_impl->transition(fiber_impl_deref_type::kConnecting,
+                               fiber_impl_deref_type::kConnected)) {
+      p_fib_impl->on_connect(boost::system::error_code(
+          ::error::success, ::error::get_ssf_category()));
     }
   } else {
     async_send_rst(impl, header.id().returning_id(), []() {});
@@ -338,9 +393,17 @@ void basic_fiber_demux_service<S>::handle_syn(implementation_type impl,
   std::unique_lock<std::recursive_mutex> lock_bound(impl->bound_mutex);
 
   if (impl->listening.count(header.id().remote_port())) {
-    auto on_new_fiber = impl->bound[fiber_id(header.id().remote_port())]
-                            ->access_accept_handler();
-    io_service_.post(std::bind(on_new_fiber, header.id().local_port()));
+    if (!impl->p_quotas->admit_fiber(impl->bound.size())) {
+      SSF_LOG("demux", debug, "syn on port {} rejected by quotas",
+              header.id().remote_port());
+      async_send_rst(impl, header.id().returning_id(), []() {});
+      return;
+    }
+
+    auto p_acceptor = impl->bound[fiber_id(header.id().remote_port())];
+    auto remote_port = header.id().local_port();
+    io_service_.post(
+        [p_acceptor, remote_port]() { p_acceptor->on_accept(remote_port); });
   } else {
     async_send_rst(impl, header.id().returning_id(), []() {});
   }
@@ -355,28 +418,22 @@ void basic_fiber_demux_service<S>::handle_rst(implementation_type impl,
   std::unique_lock<std::recursive_mutex> lock_bound(impl->bound_mutex);
   if ((impl->bound).count(header.id())) {
     auto p_fib_impl = impl->bound[header.id()];
-    auto on_close = p_fib_impl->access_close_handler();
-
-    std::unique_lock<std::recursive_mutex> lock_state(p_fib_impl->state_mutex);
-
-    if (p_fib_impl->connecting || p_fib_impl->connected) {
-      if (p_fib_impl->connecting) {
-        p_fib_impl->set_disconnected();
-        auto on_connection = p_fib_impl->access_connect_handler();
-        on_connection(boost::system::error_code(::error::connection_refused,
-                                                ::error::get_ssf_category()));
-      } else {
-        p_fib_impl->set_disconnected();
-        auto rst_sent = [this, impl, returning_id, p_fib_impl]() {
-          this->unbind(impl, returning_id);
-          p_fib_impl->access_close_handler()();
-        };
-        async_send_rst(impl, returning_id, std::move(rst_sent));
-      }
-    } else if (p_fib_impl->disconnecting) {
-      p_fib_impl->set_disconnected();
+
+    if (p_fib_impl->transition(fiber_impl_deref_type::kConnecting,
+                               fiber_impl_deref_type::kDisconnected)) {
+      p_fib_impl->on_connect(boost::system::error_code(
+          ::error::connection_refused, ::error::get_ssf_category()));
+    } else if (p_fib_impl->transition(fiber_impl_deref_type::kConnected,
+                                      fiber_impl_deref_type::kDisconnected)) {
+      auto rst_sent = [this, impl, returning_id, p_fib_impl]() {
+        this->unbind(impl, returning_id);
+        p_fib_impl->on_close();
+      };
+      async_send_rst(impl, returning_id, std::move(rst_sent));
+    } else if (p_fib_impl->transition(fiber_impl_deref_type::kDisconnecting,
+                                      fiber_impl_deref_type::kDisconnected)) {
       unbind(impl, returning_id);
-      on_close();
+      p_fib_impl->on_close();
     }
   }
 }
@@ -391,8 +448,9 @@ void basic_fiber_demux_service<S>::async_send_push(implementation_type impl,
 
   if (impl->bound.count(id.returning_id())) {
     auto p_fiber_impl = impl->bound[id.returning_id()];
-    if (p_fiber_impl->ready_out) {
-      async_send(impl, id, kFlagPush, buffer, handler, p_fiber_impl->priority);
+    if (p_fiber_impl->ready_out()) {
+      async_send(impl, id, kFlagPush, buffer, std::move(handler),
+                 p_fiber_impl->priority);
     } else {
       auto p_timer = std::make_shared<boost::asio::steady_timer>(io_service_);
       p_timer->expires_from_now(std::chrono::milliseconds(10));
@@ -432,9 +490,9 @@ void basic_fiber_demux_service<S>::async_send_dgr(implementation_type impl,
   }
 
   if (impl->bound.count(fib_impl->id.returning_id())) {
-    if (fib_impl->ready_out) {
+    if (fib_impl->ready_out()) {
       async_send(impl, fiber_id(remote_port, fib_impl->id.local_port()),
-                 kFlagDatagram, buffer, handler, fib_impl->priority);
+                 kFlagDatagram, buffer, std::move(handler), fib_impl->priority);
     } else {
       auto p_timer = std::make_shared<boost::asio::steady_timer>(io_service_);
       p_timer->expires_from_now(std::chrono::milliseconds(10));
@@ -500,16 +558,15 @@ void basic_fiber_demux_service<S>::async_send_syn(implementation_type impl,
     auto p_fib_impl = impl->bound[id.returning_id()];
     SSF_LOG("demux", trace, "async send syn");
 
-    std::unique_lock<std::recursive_mutex> lock_state(p_fib_impl->state_mutex);
-
-    if (!p_fib_impl->connecting) {
-      p_fib_impl->set_connecting();
+    if (p_fib_impl->transition(fiber_impl_deref_type::kConnectionStates &
+                                   ~fiber_impl_deref_type::kConnecting,
+                               fiber_impl_deref_type::kConnecting)) {
       auto handler = [impl, p_fib_impl](const boost::system::error_code& ec,
                                         std::size_t) {
         if (ec) {
           SSF_LOG("demux", debug, "syn error {}", ec.message());
           auto connection_failed = [p_fib_impl, ec]() {
-            p_fib_impl->access_connect_handler()(ec);
+            p_fib_impl->on_connect(ec);
           };
           impl->socket.get_io_service().post(connection_failed);
         } else {
@@ -580,7 +637,7 @@ void basic_fiber_demux_service<S>::async_connect(
   bind(impl, 0, fib_impl, ec);
 
   if (ec) {
-    auto connection_failed = [=]() { fib_impl->access_connect_handler()(ec); };
+    auto connection_failed = [=]() { fib_impl->on_connect(ec); };
     impl->socket.get_io_service().post(connection_failed);
   } else {
     async_send_syn(impl, fib_impl->id);
@@ -595,100 +652,97 @@ void basic_fiber_demux_service<S>::async_send(
     ConstBufferSequence& buffers, Handler handler, uint8_t priority) {
   auto buffers_size = boost::asio::buffer_size(buffers);
 
-  if (buffers_size > impl->mtu) {
-    if (flags & kFlagDatagram) {
-      io_service_.post(std::bind(
-          handler, boost::system::error_code(::error::message_too_long,
-                                             ::error::get_ssf_category()),
-          0));
-      return;
-    }
-    buffers_size = impl->mtu;
+  if ((flags & kFlagDatagram) && buffers_size > impl->mtu) {
+    io_service_.post(std::bind(
+        handler, boost::system::error_code(::error::message_too_long,
+                                           ::error::get_ssf_category()),
+        0));
+    return;
   }
 
-  auto new_buffers =
-      get_partial_buffer_sequence<ConstBufferSequence>(buffers, buffers_size);
-
-  fiber_header header(id, flags, (uint16_t)buffers_size);
-
-  auto p_fiber_buffer = std::make_shared<fiber_buffer>();
-  p_fiber_buffer->set_header(header);
-  auto raw_buffer_to_send = p_fiber_buffer->const_buffer(new_buffers);
-
-  auto do_user_handler = [p_fiber_buffer, handler](
-      const boost::system::error_code& ec, size_t transferred_bytes) mutable {
-    handler(ec, transferred_bytes - fiber_header::pod_size());
-  };
-
-  detail::extended_raw_fiber_buffer toSend(raw_buffer_to_send, do_user_handler,
-                                           priority);
-
-  auto do_push_packets = [this, toSend, impl]() {
-    std::unique_lock<std::recursive_mutex> lock(impl->send_mutex);
-    impl->toSendPriority.push(toSend);
+  typedef detail::pending_write_operation<Handler> op;
+  typename op::ptr p = {
+      boost::asio::detail::addressof(handler),
+      boost_asio_handler_alloc_helpers::allocate(sizeof(op), handler), 0};
+
+  p.p = new (p.v) op(handler, id, priority);
+
+  // Stream payloads larger than the mtu are split in several packets written
+  // at once, a datagram is always sent whole in a single packet
+  auto& frames = p.p->frames();
+  auto payload_size =
+      frames.fill(id, flags, buffers, impl->mtu,
+                  (flags & kFlagDatagram) ? 1 : detail::fiber_frames::max_frames);
+
+  if ((flags & kFlagDatagram) && payload_size != buffers_size) {
+    auto p_op = p.p;
+    p.v = p.p = 0;
+    io_service_.post([p_op]() {
+      p_op->complete(boost::system::error_code(::error::message_too_long,
+                                               ::error::get_ssf_category()),
+                     0);
+    });
+    return;
+  }
 
-    if (impl->toSendPriority.size() > 1) {
-      return;
+  SSF_LOG("demux", trace, "sending {} {} {} {} in {} packet(s)",
+          id.remote_port(), id.local_port(), static_cast<uint32_t>(flags),
+          payload_size, frames.frame_count());
+
+  // The send queues are only touched on the send strand
+  auto p_op = p.p;
+  p.v = p.p = 0;
+  impl->send_strand.dispatch([this, impl, p_op, id, priority]() {
+    bool idle = impl->p_sending_op == nullptr &&
+                impl->priority_send_op_queue.empty() &&
+                impl->send_op_queue.empty();
+    auto queued_it = impl->queued_ops.find(id);
+    if (priority > 0 && queued_it == impl->queued_ops.end()) {
+      // First high priority operation of the fiber: count its queued ones
+      std::size_t queued = 0;
+      for (auto p_queued = impl->send_op_queue.front(); p_queued;
+           p_queued = boost::asio::detail::op_queue_access::next(p_queued)) {
+        if (p_queued->id().remote_port() == id.remote_port() &&
+            p_queued->id().local_port() == id.local_port()) {
+          ++queued;
+        }
+      }
+      queued_it = impl->queued_ops.emplace(id, queued).first;
     }
 
-    this->async_push_packets(impl);
-  };
-
-  auto& header_b = p_fiber_buffer->header();
-  auto flags_b = header_b.flags();
-
-  SSF_LOG("demux", trace, "sending {} {} {} {} {}",
-          static_cast<uint32_t>(header_b.version()),
-          header_b.id().remote_port(), header_b.id().local_port(),
-          static_cast<uint32_t>(flags_b), header_b.data_size());
-
-  impl->socket.get_io_service().post(do_push_packets);
-}
-
-template <typename S>
-template <typename ConstBufferSequence>
-std::vector<boost::asio::const_buffer>
-basic_fiber_demux_service<S>::get_partial_buffer_sequence(
-    ConstBufferSequence buffers, size_t length) {
-  std::vector<boost::asio::const_buffer> new_buffers;
-
-  for (auto& buffer : buffers) {
-    auto buffer_size = boost::asio::buffer_size(buffer);
-    if (length >= buffer_size) {
-      new_buffers.push_back(buffer);
-      length -= buffer_size;
+    if (priority > 0 && queued_it->second == 0) {
+      impl->priority_send_op_queue.push(p_op);
     } else {
-      const unsigned char* p1 =
-          boost::asio::buffer_cast<const unsigned char*>(buffer);
-      new_buffers.push_back(boost::asio::const_buffer(p1, length));
-      length = 0;
-      break;
+      impl->send_op_queue.push(p_op);
+      if (queued_it != impl->queued_ops.end()) {
+        ++queued_it->second;
+      }
     }
-  }
 
-  return new_buffers;
+    if (idle) {
+      this->async_push_packets(impl);
+    }
+  });
 }
 
 template <typename S>
 void basic_fiber_demux_service<S>::close_fiber(implementation_type impl,
                                                fiber_impl_type fib_impl) {
-  std::unique_lock<std::recursive_mutex> lock_state(fib_impl->state_mutex);
-  auto on_close = fib_impl->access_close_handler();
+  auto on_close = [fib_impl]() { fib_impl->on_close(); };
 
   if (fib_impl->id.remote_port() == 0) {
     // fiber acceptor
-    if (!fib_impl->closed) {
+    if (!fib_impl->is_closed()) {
       stop_listening(impl, fib_impl->id.local_port());
       unbind(impl, fib_impl->id);
       impl->socket.get_io_service().post(on_close);
     }
   } else {
     // fiber
-    if (!fib_impl->disconnecting && !fib_impl->disconnected) {
-      if (fib_impl->connecting || fib_impl->connected) {
-        fib_impl->set_disconnecting();
-        async_send_rst(impl, fib_impl->id, [impl, fib_impl, on_close] { on_close(); });
-      }
+    if (fib_impl->transition(fiber_impl_deref_type::kConnecting |
+                                 fiber_impl_deref_type::kConnected,
+                             fiber_impl_deref_type::kDisconnecting)) {
+      async_send_rst(impl, fib_impl->id, on_close);
     }
   }
 }
@@ -709,9 +763,7 @@ void basic_fiber_demux_service<S>::close_all_fibers(implementation_type impl) {
 template <typename S>
 void basic_fiber_demux_service<S>::close(implementation_type impl) {
   if (impl) {
-    std::unique_lock<std::recursive_mutex> lock(impl->closing_mutex);
-    if (!impl->closing) {
-      impl->closing = true;
+    if (!impl->closing.exchange(true)) {
       close_all_fibers(impl);
       auto close_handler = [impl]() {
         impl->close_handler();
@@ -720,6 +772,7 @@ void basic_fiber_demux_service<S>::close(implementation_type impl) {
       };
       impl->socket.get_io_service().post(close_handler);
       // not enough: have to close socket...
+      std::unique_lock<std::mutex> lock(impl->socket_mutex);
       boost::system::error_code ec;
       impl->socket.close(ec);
     }
@@ -12,7 +12,6 @@
 # pragma once
 #endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
 
-#include <mutex>
 
 #include <boost/asio/detail/config.hpp>
 #include <cstddef>
@@ -26,6 +25,7 @@
 #include "common/boost/fiber/basic_fiber_demux.hpp"
 #include "common/boost/fiber/detail/fiber_id.hpp"
 #include "common/boost/fiber/basic_endpoint.hpp"
+#include "common/boost/fiber/datagram_queue.hpp"
 #include "common/boost/fiber/detail/basic_fiber_impl.hpp"
 
 #include <boost/asio/detail/push_options.hpp>
@@ -88,8 +88,8 @@ public:
   /// Construct a new datagram socket implementation.
   void construct(implementation_type& impl)
   {
-    impl = implementation_deref_type::create();
-    impl->accepts_dgr = true;
+    impl = implementation_deref_type::create(this->get_io_service());
+    impl->set_accepts_dgr();
   }
 
   void move_construct(implementation_type& impl, implementation_type& other) {
@@ -118,8 +118,7 @@ public:
   /// Determine whether the fiber is open.
   bool is_open(const implementation_type& impl) const
   {
-    std::unique_lock<std::recursive_mutex> lock_state(impl->state_mutex);
-    return !impl->closed;
+    return !impl->is_closed();
   }
 
   /// Close a datagram fiber implementation.
@@ -146,6 +145,41 @@ public:
     return impl;
   }
 
+  /// Bound the queue of the datagrams received by the fiber.
+  boost::system::error_code set_option(implementation_type& impl,
+                                       const datagram_queue& option,
+                                       boost::system::error_code& ec)
+  {
+    if (!impl->set_datagram_queue(option))
+    {
+      ec.assign(::error::operation_not_supported,
+                ::error::get_ssf_category());
+      return ec;
+    }
+    ec.assign(::error::success, ::error::get_ssf_category());
+    return ec;
+  }
+
+  /// Get the bound of the queue of the datagrams received by the fiber.
+  boost::system::error_code get_option(const implementation_type& impl,
+                                       datagram_queue& option,
+                                       boost::system::error_code& ec) const
+  {
+    option = impl->get_datagram_queue();
+    ec.assign(::error::success, ::error::get_ssf_category());
+    return ec;
+  }
+
+  /// Get the drop and latency counters of the fiber datagram queue.
+  boost::system::error_code get_option(const implementation_type& impl,
+                                       datagram_queue_stats& option,
+                                       boost::system::error_code& ec) const
+  {
+    option = impl->get_datagram_queue_stats();
+    ec.assign(::error::success, ::error::get_ssf_category());
+    return ec;
+  }
+
   /// Cancel all asynchronous operations associated with the datagram fiber.
   boost::system::error_code cancel(implementation_type& impl,
                                    boost::system::error_code& ec)
@@ -159,7 +193,7 @@ public:
                                   const endpoint_type& endpoint,
                                   boost::system::error_code& ec)
   {
-    impl->p_fib_demux = &(endpoint.demux());
+    impl->set_demux(&(endpoint.demux()));
     impl->p_fib_demux->bind(endpoint.port(), impl, ec);
 
     return ec;
@@ -177,7 +211,7 @@ public:
       ConnectHandler, void(boost::system::error_code)> init(
         BOOST_ASIO_MOVE_CAST(ConnectHandler)(handler));
 
-    impl->p_fib_demux = &(peer_endpoint.demux());
+    impl->set_demux(&(peer_endpoint.demux()));
     impl->id.set_remote_port(peer_endpoint.port());
     auto handler_to_post = [init]() mutable {
       init.handler(boost::system::error_code());
@@ -270,16 +304,10 @@ public:
     boost::asio::detail::async_result_init<
       WriteHandler, void(boost::system::error_code, std::size_t)> init(
       BOOST_ASIO_MOVE_CAST(WriteHandler)(handler));
-    {
-      std::unique_lock<std::recursive_mutex> lock_state(impl->state_mutex);
-      if (impl->closed) 
-      {
-        impl->closed = false;
-      }
-    }
+    impl->set_opened();
     if (!impl->p_fib_demux)
     {
-      impl->p_fib_demux = &(destination.demux());
+      impl->set_demux(&(destination.demux()));
     }
     if (!impl->id.local_port() && (impl->id.remote_port() &&
         (impl->id.remote_port() != destination.port())))
@@ -327,13 +355,7 @@ public:
     boost::asio::detail::async_result_init<
       ReadHandler, void(boost::system::error_code, std::size_t)> init(
       BOOST_ASIO_MOVE_CAST(ReadHandler)(handler));
-    {
-      std::unique_lock<std::recursive_mutex> lock_state(impl->state_mutex);
-      if (impl->closed)
-      {
-        impl->closed = false;
-      }
-    }
+    impl->set_opened();
     if (!impl->id.local_port())
     {
       auto handler_to_post = [init]() mutable {
@@ -367,12 +389,9 @@ public:
 
         p.p = new (p.v) op(buffers, init.handler);
 
-        {
-          std::unique_lock<std::recursive_mutex> lock(impl->read_dgr_op_queue_mutex);
-          impl->read_dgr_op_queue.push(p.p);
-        }
+        auto p_op = p.p;
         p.v = p.p = 0;
-        impl->r_dgr_queues_handler();
+        impl->push_dgr_read_op(p_op);
       }
     }
 
@@ -392,13 +411,7 @@ public:
     boost::asio::detail::async_result_init<
       ReadHandler, void(boost::system::error_code, std::size_t)> init(
       BOOST_ASIO_MOVE_CAST(ReadHandler)(handler));
-    {
-      std::unique_lock<std::recursive_mutex> lock_state(impl->state_mutex);
-      if (impl->closed)
-      {
-        impl->closed = false;
-      }
-    }
+    impl->set_opened();
     if (!impl->id.local_port())
     {
       auto handler_to_post = [init]() mutable {
@@ -431,12 +444,9 @@ public:
 
         p.p = new (p.v) op(buffers, init.handler, &(sender_endpoint.port()));
 
-        {
-          std::unique_lock<std::recursive_mutex> lock(impl->read_dgr_op_queue_mutex);
-          impl->read_dgr_op_queue.push(p.p);
-        }
+        auto p_op = p.p;
         p.v = p.p = 0;
-        impl->r_dgr_queues_handler();
+        impl->push_dgr_read_op(p_op);
       }
     }
 
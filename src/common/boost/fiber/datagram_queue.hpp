@@ -0,0 +1,115 @@
+//
+// fiber/datagram_queue.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2014-2015
+//
+
+#ifndef SSF_COMMON_BOOST_ASIO_FIBER_DATAGRAM_QUEUE_HPP_
+#define SSF_COMMON_BOOST_ASIO_FIBER_DATAGRAM_QUEUE_HPP_
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#pragma once
+#endif  // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <cstdint>
+
+namespace boost {
+namespace asio {
+namespace fiber {
+
+/// Datagram fiber option bounding its queue of received datagrams
+/**
+* Once max_datagrams datagrams wait to be read, a new datagram either
+* replaces the oldest one (drop_oldest, fresh data matters most for real-time
+* traffic) or is discarded (drop_newest). A bound of 0 only keeps the demux
+* buffered bytes quota. Datagrams are always discarded while the demux is
+* over that quota.
+*
+* @code
+* fiber.set_option(boost::asio::fiber::datagram_queue(
+*     64, boost::asio::fiber::datagram_queue::drop_oldest));
+* @endcode
+*/
+class datagram_queue {
+ public:
+  enum policy_type : uint8_t { drop_newest = 0, drop_oldest = 1 };
+
+  enum : uint32_t { default_max_datagrams = 1024 };
+
+ public:
+  explicit datagram_queue(uint32_t max_datagrams = default_max_datagrams,
+                          policy_type policy = drop_oldest)
+      : max_datagrams_(max_datagrams), policy_(policy) {}
+
+  /// Get the maximum number of queued datagrams (0: no bound)
+  uint32_t max_datagrams() const { return max_datagrams_; }
+
+  /// Get the policy applied when the queue is full
+  policy_type policy() const { return policy_; }
+
+ private:
+  uint32_t max_datagrams_;
+  policy_type policy_;
+};
+
+/// Datagram fiber counters, read with get_option
+/**
+* The delays are measured from the reception of a datagram by the fiber to
+* its delivery to a read operation.
+*
+* @code
+* boost::asio::fiber::datagram_queue_stats stats;
+* fiber.get_option(stats);
+* @endcode
+*/
+class datagram_queue_stats {
+ public:
+  datagram_queue_stats()
+      : received_(0),
+        dropped_(0),
+        delivered_(0),
+        total_delay_us_(0),
+        max_delay_us_(0) {}
+
+  datagram_queue_stats(uint64_t received, uint64_t dropped, uint64_t delivered,
+                       uint64_t total_delay_us, uint64_t max_delay_us)
+      : received_(received),
+        dropped_(dropped),
+        delivered_(delivered),
+        total_delay_us_(total_delay_us),
+        max_delay_us_(max_delay_us) {}
+
+  /// Datagrams received by the fiber
+  uint64_t received() const { return received_; }
+
+  /// Datagrams discarded by the bound or the demux quota
+  uint64_t dropped() const { return dropped_; }
+
+  /// Datagrams handed to read operations
+  uint64_t delivered() const { return delivered_; }
+
+  /// Sum of the queueing delays of the delivered datagrams (microseconds)
+  uint64_t total_delay_us() const { return total_delay_us_; }
+
+  /// Longest queueing delay of a delivered datagram (microseconds)
+  uint64_t max_delay_us() const { return max_delay_us_; }
+
+  /// Mean queueing delay of the delivered datagrams (microseconds)
+  uint64_t average_delay_us() const {
+    return delivered_ ? total_delay_us_ / delivered_ : 0;
+  }
+
+ private:
+  uint64_t received_;
+  uint64_t dropped_;
+  uint64_t delivered_;
+  uint64_t total_delay_us_;
+  uint64_t max_delay_us_;
+};
+
+}  // namespace fiber
+}  // namespace asio
+}  // namespace boost
+
+#endif  // SSF_COMMON_BOOST_ASIO_FIBER_DATAGRAM_QUEUE_HPP_
@@ -12,13 +12,19 @@
 #pragma once
 #endif  // defined(_MSC_VER) && (_MSC_VER >= 1200)
 
+#include <atomic>
 #include <functional>
 #include <map>
 #include <mutex>
-#include <queue>
 #include <set>
 
+#include <boost/asio/detail/op_queue.hpp>
+#include <boost/asio/strand.hpp>
+
 #include "common/boost/fiber/detail/fiber_id.hpp"
+#include "common/boost/fiber/detail/fiber_quotas.hpp"
+#include "common/boost/fiber/detail/fiber_receive_buffer.hpp"
+#include "common/boost/fiber/detail/io_operation.hpp"
 
 namespace boost {
 namespace asio {
@@ -28,25 +34,6 @@ namespace detail {
 template <typename StreamSocket>
 class basic_fiber_impl;
 
-/// Class used to handle QoS in fiber sendings
-template <typename Buffer, typename Handler>
-struct extended_buffer {
-  extended_buffer(const Buffer& b, const Handler& h, uint8_t p)
-      : buffer(b), handler(h), priority(p) {}
-
-  bool operator<(const extended_buffer& rhs) const {
-    return priority < rhs.priority;
-  }
-
-  Buffer buffer;
-  Handler handler;
-  uint8_t priority;
-};
-
-typedef extended_buffer<std::vector<boost::asio::const_buffer>,
-                        std::function<void(const boost::system::error_code&,
-                                           size_t)>> extended_raw_fiber_buffer;
-
 /// Implementation class of the fiber demultiplexer
 template <typename StreamSocket>
 class basic_fiber_demux_impl : public std::enable_shared_from_this<
@@ -63,22 +50,34 @@ class basic_fiber_demux_impl : public std::enable_shared_from_this<
   typedef std::function<void()> close_handler_type;
 
  private:
-  basic_fiber_demux_impl(StreamSocket s, close_handler_type close, size_t a_mtu)
+  basic_fiber_demux_impl(StreamSocket s, close_handler_type close, size_t a_mtu,
+                         const fiber_quota_limits& limits)
       : bound(),
         listening(),
         used_ports(),
         socket(std::move(s)),
+        socket_mutex(),
         closing(false),
+        send_strand(socket.get_io_service()),
         mtu(a_mtu),
-        close_handler(close) {}
+        close_handler(close),
+        receive_buffer(),
+        send_op_queue(),
+        priority_send_op_queue(),
+        queued_ops(),
+        p_sending_op(nullptr),
+        p_quotas(std::make_shared<fiber_quotas>()) {
+    p_quotas->set_limits(limits);
+  }
 
  public:
   ~basic_fiber_demux_impl() {}
 
  public:
-  static p_impl create(StreamSocket s, close_handler_type close, size_t mtu) {
-    return p_impl(
-        new basic_fiber_demux_impl<StreamSocket>(std::move(s), close, mtu));
+  static p_impl create(StreamSocket s, close_handler_type close, size_t mtu,
+                       const fiber_quota_limits& limits) {
+    return p_impl(new basic_fiber_demux_impl<StreamSocket>(std::move(s), close,
+                                                           mtu, limits));
   }
 
   void set_socket(StreamSocket s) { socket = std::move(s); }
@@ -97,18 +96,38 @@ class basic_fiber_demux_impl : public std::enable_shared_from_this<
 
   StreamSocket socket;
 
-  std::recursive_mutex closing_mutex;
-  bool closing;
+  /// Serialize the start of socket operations with the socket closing
+  std::mutex socket_mutex;
+  std::atomic<bool> closing;
 
-  std::recursive_mutex send_mutex;
+  /// Serialize the send queues and the socket writes
+  boost::asio::io_service::strand send_strand;
 
   /// maximum size of the payload of one packet
   size_t mtu;
 
   close_handler_type close_handler;
 
-  // std::priority_queue<extended_raw_fiber_buffer> toSendPriority;
-  std::queue<extended_raw_fiber_buffer> toSendPriority;
+  /// Raw data received from the socket and not yet dispatched
+  fiber_receive_buffer receive_buffer;
+
+  /// Write operations waiting for the socket (on the send strand)
+  boost::asio::detail::op_queue<basic_pending_write_operation> send_op_queue;
+
+  /// Write operations of high priority fibers, written before send_op_queue
+  boost::asio::detail::op_queue<basic_pending_write_operation>
+      priority_send_op_queue;
+
+  /// Number of operations in send_op_queue of the fibers which sent with a
+  /// high priority (a fiber keeps its order: its priority operations wait
+  /// behind its queued ones). Other fibers are not tracked.
+  std::map<fiber_id, std::size_t> queued_ops;
+
+  /// Write operation being written on the socket
+  basic_pending_write_operation* p_sending_op;
+
+  /// Resources used by the peer and their limits
+  std::shared_ptr<fiber_quotas> p_quotas;
 };
 
 }  // namespace detail
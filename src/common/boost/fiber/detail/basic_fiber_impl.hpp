@@ -12,16 +12,23 @@
 #pragma once
 #endif  // defined(_MSC_VER) && (_MSC_VER >= 1200)
 
+#include <atomic>
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <queue>
 
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/strand.hpp>
+
 #include <ssf/log/log.h>
 
 #include "common/boost/fiber/basic_fiber_demux.hpp"
+#include "common/boost/fiber/datagram_queue.hpp"
 #include "common/boost/fiber/detail/fiber_header.hpp"
 #include "common/boost/fiber/detail/fiber_id.hpp"
+#include "common/boost/fiber/detail/fiber_quotas.hpp"
 #include "common/boost/fiber/detail/io_fiber_accept_op.hpp"
 #include "common/boost/fiber/detail/io_fiber_dgr_read_op.hpp"
 #include "common/boost/fiber/detail/io_fiber_read_op.hpp"
@@ -44,6 +51,20 @@ struct make_queue {
   typedef T value_type;
 };
 
+/// Implementation object of a fiber
+/**
+* A fiber is kept small enough to hold millions of them on a demux:
+*  - its state and flow control flags live in a single atomic word
+*  - the receive queues are allocated with the first data or port received
+*  - only datagram fibers hold a datagram queue bound and counters
+*  - the demux calls its handlers directly (on_accept, on_receive...)
+*
+* The pending operations and the received data are only touched on the fiber
+* strand: the demux and the fiber services hand them over with on_* and
+* push_*_op calls instead of locking the fiber. The received stream data is
+* also guarded by receive_mutex so that a new read may take it directly
+* (try_read) when no other read is pending.
+*/
 template <typename StreamSocket>
 class basic_fiber_impl
     : public std::enable_shared_from_this<basic_fiber_impl<StreamSocket>> {
@@ -82,255 +103,502 @@ class basic_fiber_impl
   /// Type for the structure used to store the data received
   typedef boost::asio::streambuf data_queue_type;
 
-  typedef make_queue<std::vector<uint8_t>>::type dgr_data_queue_type;
+  /// Type of the clock timing the datagrams in the queue
+  typedef std::chrono::steady_clock dgr_clock;
+
+  /// Datagram waiting to be read
+  struct queued_datagram {
+    std::vector<uint8_t> data;
+    remote_port_type remote_port;
+    dgr_clock::time_point received_at;
+  };
+
+  typedef typename make_queue<queued_datagram>::type dgr_data_queue_type;
 
   /// Type for the queue storing the pending accept requests
   typedef typename make_asio_queue<accept_op>::type accept_op_queue_type;
 
-  /// Type for to store remote fiber ports (for accepting or datagrams)
+  /// Type for to store remote fiber ports (for accepting)
   typedef make_queue<remote_port_type>::type remote_port_queue_type;
 
-  /// Type of the handler used when accepting a new fiber
-  typedef std::function<void(local_port_type)> accept_handler_type;
-
-  /// Type of the handler used when connecting a new fiber
-  typedef std::function<void(boost::system::error_code)> connect_handler_type;
-
   /// Type of the handler provided by the user when connecting a new fiber
   typedef std::function<void(const boost::system::error_code&)>
       connect_user_handler_type;
 
-  /// Type of the handler used when receiving a new packet
-  typedef std::function<void(std::vector<uint8_t>&&, std::size_t)>
-      receive_handler_type;
+  /// Received data and remote ports, allocated on first use
+  struct receive_queues {
+    /// Store the received data
+    data_queue_type data_queue;
 
-  /// Type of the handler used when receiving a new datagram
-  typedef std::function<void(std::vector<uint8_t>&&,
-                             remote_port_type remote_port, std::size_t)>
-      receive_dgr_handler_type;
+    /// Store the dgr received data with their senders
+    dgr_data_queue_type dgr_data_queue;
 
-  /// Type of the handler used when closing a fiber
-  typedef std::function<void()> close_handler_type;
+    /// Store the connecting remote ports (acceptor)
+    remote_port_queue_type port_queue;
+  };
 
-  /// Type of the handler provided by the user when closing a fiber
-  typedef std::function<void(const boost::system::error_code&)>
-      close_user_handler_type;
+  /// Datagram queue bound and counters of a datagram fiber
+  /**
+  * The bound is only read on the strand, the counters may be read from any
+  * thread.
+  */
+  struct datagram_state {
+    datagram_state()
+        : max_datagrams(datagram_queue::default_max_datagrams),
+          policy(datagram_queue::drop_oldest),
+          received(0),
+          dropped(0),
+          delivered(0),
+          total_delay_us(0),
+          max_delay_us(0) {}
+
+    std::atomic<uint32_t> max_datagrams;
+    std::atomic<uint8_t> policy;
+
+    std::atomic<uint64_t> received;
+    std::atomic<uint64_t> dropped;
+    std::atomic<uint64_t> delivered;
+    std::atomic<uint64_t> total_delay_us;
+    std::atomic<uint64_t> max_delay_us;
+  };
 
-  /// Type of the handler used when an unknown error occurs
-  typedef std::function<void(boost::system::error_code)> error_handler_type;
+ public:
+  /// Bits of the fiber state word
+  enum state_flags : uint32_t {
+    kClosed = 1 << 0,
+    kConnecting = 1 << 1,
+    kConnected = 1 << 2,
+    kDisconnecting = 1 << 3,
+    kDisconnected = 1 << 4,
+    kReadyIn = 1 << 5,
+    kReadyOut = 1 << 6,
+    kAcceptsDgr = 1 << 7
+  };
+
+  /// Exactly one of these bits is set in the state word
+  static const uint32_t kConnectionStates =
+      kConnecting | kConnected | kDisconnecting | kDisconnected;
 
  private:
   /// Constructor for a fiber implementation object
   /**
+  * @param io_service The io_service running the fiber handlers
   * @param f_demux The demultiplexer used for this fiber
   * @param remote_port The remote port to chich the fiber is to be bound
-  * @param prio (Unused) The priority for this fiber on the demultiplexer
+  * @param prio The priority for this fiber on the demultiplexer
   * @param dgr The fiber accepts datagrams
   */
-  basic_fiber_impl(fiber_demux_type* p_f_demux, remote_port_type remote_port,
+  basic_fiber_impl(boost::asio::io_service& io_service,
+                   fiber_demux_type* p_f_demux, remote_port_type remote_port,
                    uint8_t prio, bool dgr)
       : id(remote_port),
         p_fib_demux(p_f_demux),
-        ready_in(true),
-        ready_out(true),
         priority(prio),
-        state_mutex(),
-        closed(true),
-        connecting(false),
-        connected(false),
-        disconnecting(false),
-        disconnected(true),
-        read_op_queue_mutex(),
-        read_op_queue(),
-        data_queue_mutex(),
-        data_queue(),
-        dgr_data_queue_(),
-        accept_op_queue_mutex(),
-        accept_op_queue(),
-        port_queue_mutex(),
-        port_queue(),
-        connect_user_handler([](const boost::system::error_code&) {}),
-        accepts_dgr(dgr) {}
-
-  basic_fiber_impl()
-      : id(0),
-        p_fib_demux(nullptr),
-        ready_in(true),
-        ready_out(true),
-        priority(0),
-        state_mutex(),
-        closed(true),
-        connecting(false),
-        connected(false),
-        disconnecting(false),
-        disconnected(true),
-        read_op_queue_mutex(),
+        strand(io_service),
+        receive_mutex(),
         read_op_queue(),
-        data_queue_mutex(),
-        data_queue(),
-        dgr_data_queue_(),
-        accept_op_queue_mutex(),
+        read_dgr_op_queue(),
         accept_op_queue(),
-        port_queue_mutex(),
-        port_queue(),
-        connect_user_handler([](const boost::system::error_code&) {}),
-        accepts_dgr() {}
+        p_quotas(p_f_demux ? p_f_demux->quotas() : nullptr),
+        quota_bytes(0),
+        connect_user_handler(),
+        state_(kClosed | kDisconnected | kReadyIn | kReadyOut |
+               (dgr ? kAcceptsDgr : 0)),
+        pending_reads_(0),
+        p_receive_queues_(),
+        p_dgr_state_(dgr ? new datagram_state() : nullptr) {}
+
+  explicit basic_fiber_impl(boost::asio::io_service& io_service)
+      : basic_fiber_impl(io_service, nullptr, 0, 0, false) {}
 
  public:
   /// Destructor
-  ~basic_fiber_impl() {}
+  ~basic_fiber_impl() {
+    std::size_t bytes = quota_bytes.load();
+    if (p_quotas && bytes) {
+      p_quotas->remove_buffered(bytes);
+    }
+  }
 
  public:
-  /// Initialize the fiber impl by setting all its handler
-  void init() {
-    accept_handler = [this](remote_port_type remote_port) {
-      {
-        std::unique_lock<std::recursive_mutex> lock(this->port_queue_mutex);
-        this->port_queue.push(remote_port);
-      }
-      this->a_queues_handler();
-    };
+  /// Create a new shared pointer to a fiber impl
+  /**
+  * @param f_demux The demultiplexer used for this fiber
+  * @param remote_port The remote port to chich the fiber is to be bound
+  * @param prio The priority for this fiber on the demultiplexer
+  * @param dgr The fiber accepts datagrams
+  */
+  static p_impl create(fiber_demux_type* p_f_demux,
+                       remote_port_type remote_port, uint8_t prio = 0,
+                       bool dgr = false) {
+    return p_impl(new basic_fiber_impl<StreamSocket>(
+        p_f_demux->get_io_service(), p_f_demux, remote_port, prio, dgr));
+  }
+
+  /// Create a new shared pointer to a fiber impl
+  /**
+  * @param io_service The io_service running the fiber handlers
+  */
+  static p_impl create(boost::asio::io_service& io_service) {
+    return p_impl(new basic_fiber_impl<StreamSocket>(io_service));
+  }
 
-    connect_handler = [this](boost::system::error_code ec) {
-      this->set_opened();
+  /// Handle a new connection on an acceptor
+  /**
+  * @param remote_port The remote port of the connecting fiber
+  */
+  void on_accept(remote_port_type remote_port) {
+    auto self = this->shared_from_this();
+    strand.dispatch([this, self, remote_port]() {
+      queues().port_queue.push(remote_port);
+      a_queues_handler();
+    });
+  }
 
-      this->init_connect_in_out();
+  /// Handle the end of a connection attempt
+  /**
+  * @param ec The result of the connection
+  */
+  void on_connect(const boost::system::error_code& ec) {
+    set_opened();
+    init_connect_in_out();
 
+    auto self = this->shared_from_this();
+    strand.dispatch([this, self, ec]() {
       // reset connect handler
-      auto con_user_handler = this->connect_user_handler;
-
-      this->connect_user_handler = [](const boost::system::error_code&) {};
-      con_user_handler(ec);
-    };
+      connect_user_handler_type user_handler;
+      user_handler.swap(connect_user_handler);
+      if (user_handler) {
+        user_handler(ec);
+      }
+    });
+  }
 
-    receive_handler = [this](std::vector<uint8_t>&& data,
-                             std::size_t bytes_transfered) {
+  /// Handle a new packet
+  /**
+  * @param data The packet payload
+  * @param bytes_transfered The payload size
+  */
+  void on_receive(std::vector<uint8_t>&& data, std::size_t bytes_transfered) {
+    auto self = this->shared_from_this();
+    strand.dispatch([this, self, data = std::move(data), bytes_transfered]() {
       {
-        std::unique_lock<std::recursive_mutex> lock(this->data_queue_mutex);
+        std::unique_lock<std::mutex> lock(receive_mutex);
+        auto& data_queue = queues().data_queue;
         boost::asio::streambuf::mutable_buffers_type buffers =
-            this->data_queue.prepare(bytes_transfered);
+            data_queue.prepare(bytes_transfered);
 
         boost::asio::buffer_copy(buffers, boost::asio::buffer(data));
-        this->data_queue.commit(bytes_transfered);
+        data_queue.commit(bytes_transfered);
+        add_quota_bytes(bytes_transfered);
       }
-      this->r_queues_handler();
-    };
+      r_queues_handler();
+    });
+  }
 
-    receive_dgr_handler = [this](std::vector<uint8_t>&& data,
-                                 remote_port_type remote_port,
-                                 std::size_t bytes_transfered) {
-      {
-        std::unique_lock<std::recursive_mutex> lock1(this->data_queue_mutex);
-        std::unique_lock<std::recursive_mutex> lock2(this->port_queue_mutex);
-        this->port_queue.push(remote_port);
-        data.resize(bytes_transfered);
-        this->dgr_data_queue_.push(data);
+  /// Handle a new datagram
+  /**
+  * @param data The datagram payload
+  * @param remote_port The port of the sender
+  * @param bytes_transfered The payload size
+  */
+  void on_receive_dgr(std::vector<uint8_t>&& data, remote_port_type remote_port,
+                      std::size_t bytes_transfered) {
+    data.resize(bytes_transfered);
+    queued_datagram datagram{std::move(data), remote_port, dgr_clock::now()};
+    auto self = this->shared_from_this();
+    auto queue_datagram = [this, self,
+                           datagram = std::move(datagram)]() mutable {
+      ++p_dgr_state_->received;
+      if (buffered_over_quota()) {
+        // Datagrams may be lost, drop it rather than buffer more
+        count_dropped_datagram();
+        return;
       }
-      this->r_dgr_queues_handler();
-    };
 
-    close_handler = [this]() {
-      SSF_LOG("fiber_impl", trace, "close handler {}:{}",
-              this->id.remote_port(), this->id.local_port());
-      this->set_closed();
+      auto& dgr_data_queue = queues().dgr_data_queue;
+      uint32_t max_datagrams = p_dgr_state_->max_datagrams.load();
+      if (max_datagrams && dgr_data_queue.size() >= max_datagrams) {
+        count_dropped_datagram();
+        if (p_dgr_state_->policy.load() == datagram_queue::drop_newest) {
+          return;
+        }
+        remove_quota_bytes(dgr_data_queue.front().data.size());
+        dgr_data_queue.pop();
+      }
 
-      boost::system::error_code ec(::error::connection_reset,
-                                   ::error::get_ssf_category());
-      cancel_operations(ec);
-      auto connect_handler = this->access_connect_handler();
-      connect_handler(ec);
+      add_quota_bytes(datagram.data.size());
+      dgr_data_queue.push(std::move(datagram));
+      r_dgr_queues_handler();
     };
+    strand.dispatch(std::move(queue_datagram));
+  }
 
-    error_handler = [](boost::system::error_code) {};
+  /// Handle the closing of the fiber
+  void on_close() {
+    SSF_LOG("fiber_impl", trace, "close handler {}:{}", id.remote_port(),
+            id.local_port());
+    set_closed();
+
+    boost::system::error_code ec(::error::connection_reset,
+                                 ::error::get_ssf_category());
+    cancel_operations(ec);
+    on_connect(ec);
   }
 
-  /// Accessor for the accept handler
-  accept_handler_type access_accept_handler() {
-    auto self = this->shared_from_this();
-    auto lambda = [self, this](remote_port_type remote_port) {
-      this->accept_handler(remote_port);
-    };
-    return lambda;
+  /// Copy received data into the buffers of a new read
+  /**
+  * This is the fast path of a read: it only succeeds when no other read is
+  * pending and the strand is not handling the received data. The caller then
+  * posts the completion itself.
+  *
+  * @param buffers The buffers of the read
+  *
+  * @return The number of bytes copied (0: queue a read operation)
+  */
+  template <typename MutableBufferSequence>
+  std::size_t try_read(const MutableBufferSequence& buffers) {
+    if (pending_reads_.load() != 0) {
+      return 0;
+    }
+
+    std::unique_lock<std::mutex> lock(receive_mutex, std::try_to_lock);
+    if (!lock.owns_lock() || !p_receive_queues_ ||
+        !p_receive_queues_->data_queue.size()) {
+      return 0;
+    }
+
+    auto& data_queue = p_receive_queues_->data_queue;
+    std::size_t copied = boost::asio::buffer_copy(buffers, data_queue.data());
+    data_queue.consume(copied);
+    remove_quota_bytes(copied);
+    lock.unlock();
+
+    if (!ready_in()) {
+      // Receiving was paused, the strand decides whether to resume it
+      auto self = this->shared_from_this();
+      strand.post([this, self]() { r_queues_handler(); });
+    }
+
+    return copied;
   }
 
-  /// Accessor for the connect handler
-  connect_handler_type access_connect_handler() {
+  /// Queue a user read operation
+  void push_read_op(read_op* op) {
+    ++pending_reads_;
     auto self = this->shared_from_this();
-    auto lambda = [self, this](boost::system::error_code ec) {
-      this->connect_handler(ec);
-    };
-    return lambda;
+    strand.dispatch([this, self, op]() {
+      read_op_queue.push(op);
+      r_queues_handler();
+    });
   }
 
-  /// Accessor for the receive handler
-  receive_handler_type access_receive_handler() {
+  /// Queue a user datagram read operation
+  void push_dgr_read_op(dgr_read_op* op) {
     auto self = this->shared_from_this();
-    auto lambda = [self, this](std::vector<uint8_t>&& data,
-                               std::size_t bytes_transfered) {
-      this->receive_handler(std::move(data), bytes_transfered);
-    };
-    return lambda;
+    strand.dispatch([this, self, op]() {
+      read_dgr_op_queue.push(op);
+      r_dgr_queues_handler();
+    });
   }
 
-  /// Accessor for the receive handler for datagrams
-  receive_dgr_handler_type access_receive_dgr_handler() {
+  /// Queue a user accept operation
+  void push_accept_op(accept_op* op) {
     auto self = this->shared_from_this();
-    auto lambda = [self, this](std::vector<uint8_t>&& data,
-                               remote_port_type remote_port,
-                               std::size_t bytes_transfered) {
-      this->receive_dgr_handler(std::move(data), remote_port, bytes_transfered);
-    };
-    return lambda;
+    strand.dispatch([this, self, op]() {
+      accept_op_queue.push(op);
+      a_queues_handler();
+    });
   }
 
-  /// Accessor for the close handler
-  close_handler_type access_close_handler() {
+  /// Cancel all pending operations
+  /**
+  * @param ec The error code that will be given to the pending operations
+  */
+  void cancel_operations(
+      boost::system::error_code ec = boost::system::error_code(
+          ::error::interrupted, ::error::get_ssf_category())) {
     auto self = this->shared_from_this();
-    auto lambda = [self, this]() { this->close_handler(); };
-    return lambda;
+    strand.dispatch([this, self, ec]() {
+      r_queues_handler(ec);
+      r_dgr_queues_handler(ec);
+      a_queues_handler(ec);
+    });
   }
 
-  /// Accessor for the error handler
-  error_handler_type access_error_handler() {
-    auto self = this->shared_from_this();
-    auto lambda = [self, this]() { this->error_handler(); };
-    return lambda;
+  /// Make the fiber able to send and unable to receive
+  void init_accept_in_out() {
+    update_state(
+        [](uint32_t state) { return (state & ~kReadyIn) | kReadyOut; });
   }
 
-  /// Create a new shared pointer to a fiber impl
+  /// Make the fiber able to send and receive
+  void init_connect_in_out() {
+    update_state([](uint32_t state) { return state | kReadyIn | kReadyOut; });
+  }
+
+  /// Toggle the fiber ability to receive
+  void toggle_in() { state_.fetch_xor(kReadyIn); }
+
+  /// Toggle the fiber ability to send
+  void toggle_out() { state_.fetch_xor(kReadyOut); }
+
+  bool ready_in() const { return (state_.load() & kReadyIn) != 0; }
+
+  bool ready_out() const { return (state_.load() & kReadyOut) != 0; }
+
+  bool accepts_dgr() const { return (state_.load() & kAcceptsDgr) != 0; }
+
+  /// Make the fiber accept datagrams (before it is shared)
+  void set_accepts_dgr() {
+    state_.fetch_or(kAcceptsDgr);
+    if (!p_dgr_state_) {
+      p_dgr_state_.reset(new datagram_state());
+    }
+  }
+
+  /// Bound the queue of received datagrams
   /**
-  * @param f_demux The demultiplexer used for this fiber
-  * @param remote_port The remote port to chich the fiber is to be bound
-  * @param prio (Unused) The priority for this fiber on the demultiplexer
-  * @param dgr The fiber accepts datagrams
+  * A shorter bound applies to the next received datagram: the datagrams
+  * already queued stay until they are read.
+  *
+  * @return false if the fiber does not accept datagrams
   */
-  static p_impl create(fiber_demux_type* p_f_demux,
-                       remote_port_type remote_port, uint8_t prio = 0,
-                       bool dgr = false) {
-    p_impl res = p_impl(
-        new basic_fiber_impl<StreamSocket>(p_f_demux, remote_port, prio, dgr));
-    res->init();
+  bool set_datagram_queue(const datagram_queue& option) {
+    if (!p_dgr_state_) {
+      return false;
+    }
+    p_dgr_state_->max_datagrams = option.max_datagrams();
+    p_dgr_state_->policy = option.policy();
+    return true;
+  }
 
-    return res;
+  /// Get the bound of the queue of received datagrams
+  datagram_queue get_datagram_queue() const {
+    if (!p_dgr_state_) {
+      return datagram_queue(0);
+    }
+    return datagram_queue(
+        p_dgr_state_->max_datagrams.load(),
+        static_cast<datagram_queue::policy_type>(p_dgr_state_->policy.load()));
   }
 
-  /// Create a new shared pointer to a fiber impl
-  static p_impl create() {
-    p_impl res = p_impl(new basic_fiber_impl<StreamSocket>());
-    res->init();
+  /// Get the datagram counters of the fiber
+  datagram_queue_stats get_datagram_queue_stats() const {
+    if (!p_dgr_state_) {
+      return datagram_queue_stats();
+    }
+    return datagram_queue_stats(
+        p_dgr_state_->received.load(), p_dgr_state_->dropped.load(),
+        p_dgr_state_->delivered.load(), p_dgr_state_->total_delay_us.load(),
+        p_dgr_state_->max_delay_us.load());
+  }
+
+  bool is_closed() const { return (state_.load() & kClosed) != 0; }
 
-    return res;
+  bool is_connecting() const { return (state_.load() & kConnecting) != 0; }
+
+  bool is_connected() const { return (state_.load() & kConnected) != 0; }
+
+  bool is_disconnecting() const {
+    return (state_.load() & kDisconnecting) != 0;
   }
 
-  /// Handle the accept operations
+  bool is_disconnected() const { return (state_.load() & kDisconnected) != 0; }
+
+  void set_opened() { state_.fetch_and(~kClosed); }
+
+  void set_closed() { state_.fetch_or(kClosed); }
+
+  /// Atomically switch the connection state
   /**
-  * @param ec The error code corresponding to the previous call to this function
+  * Reaching the connected state opens the fiber, reaching the disconnected
+  * state closes it.
+  *
+  * @param from The connection states from which the transition is allowed
+  * @param to The new connection state
+  *
+  * @return false if the fiber was not in one of the from states
+  */
+  bool transition(uint32_t from, uint32_t to) {
+    bool allowed = false;
+    update_state([from, to, &allowed](uint32_t state) {
+      allowed = (state & from) != 0;
+      if (!allowed) {
+        return state;
+      }
+      state = (state & ~kConnectionStates) | to;
+      if (to == kConnected) {
+        state &= ~kClosed;
+      } else if (to == kDisconnected) {
+        state |= kClosed;
+      }
+      return state;
+    });
+    return allowed;
+  }
+
+  /// Set implementation in connecting state
+  void set_connecting() { transition(kConnectionStates, kConnecting); }
+
+  /// Set implementation in connected state
+  void set_connected() { transition(kConnectionStates, kConnected); }
+
+  /// Set implementation in disconnecting state
+  void set_disconnecting() { transition(kConnectionStates, kDisconnecting); }
+
+  /// Set implementation in disconnected state
+  void set_disconnected() { transition(kConnectionStates, kDisconnected); }
+
+  /// Bind the fiber to a demux and to its quotas
+  /**
+  * Called before the fiber is registered in the demux: no data can be
+  * received yet.
+  *
+  * @param p_demux The demultiplexer used for this fiber
+  */
+  void set_demux(fiber_demux_type* p_demux) {
+    p_fib_demux = p_demux;
+    p_quotas = p_demux ? p_demux->quotas() : nullptr;
+  }
+
+  fiber_id id;
+
+  fiber_demux_type* p_fib_demux;
+
+  std::atomic<uint8_t> priority;
+
+  /// Serialize the handlers touching the operations and the received data
+  boost::asio::io_service::strand strand;
+
+  /// Guard the received stream data (strand and try_read)
+  std::mutex receive_mutex;
+
+  /// Store the pending read requests
+  read_op_queue_type read_op_queue;
+
+  /// Store the pending read requests for datagrams
+  read_dgr_op_queue_type read_dgr_op_queue;
+
+  /// Store the pending accept operation
+  accept_op_queue_type accept_op_queue;
+
+  /// Quotas of the demux, set when the fiber is bound to it
+  std::shared_ptr<fiber_quotas> p_quotas;
+
+  /// Received bytes accounted in the demux quotas (strand and try_read)
+  std::atomic<std::size_t> quota_bytes;
+
+  /// Connect user handler
+  connect_user_handler_type connect_user_handler;
+
+ private:
+  /// Handle the accept operations (on the strand)
+  /**
+  * @param ec The error given to the pending operations, if any
   */
   void a_queues_handler(
       boost::system::error_code ec = boost::system::error_code()) {
-    std::unique_lock<std::recursive_mutex> lock1(accept_op_queue_mutex);
-    std::unique_lock<std::recursive_mutex> lock2(port_queue_mutex);
-
     if (ec) {
       while (!accept_op_queue.empty()) {
         auto op = accept_op_queue.front();
@@ -340,9 +608,10 @@ class basic_fiber_impl
       return;
     }
 
-    if (!accept_op_queue.empty() && !port_queue.empty()) {
-      auto remote_port = port_queue.front();
-      port_queue.pop();
+    while (!accept_op_queue.empty() && p_receive_queues_ &&
+           !p_receive_queues_->port_queue.empty()) {
+      auto remote_port = p_receive_queues_->port_queue.front();
+      p_receive_queues_->port_queue.pop();
       auto op = accept_op_queue.front();
       accept_op_queue.pop();
       op->set_remote_port(remote_port);
@@ -353,278 +622,195 @@ class basic_fiber_impl
 
       SSF_LOG("fiber_impl", debug,
               "fiber impl: new connection from remote port: {}", remote_port);
-
-      auto self = this->shared_from_this();
-      auto accept_queue_handler = [this, self]() { a_queues_handler(); };
-      p_fib_demux->get_io_service().dispatch(accept_queue_handler);
     }
   }
 
-  /// Handle the read operations
+  /// Handle the read operations (on the strand)
   /**
-  * @param ec The error code corresponding to the previous call to this function
+  * @param ec The error given to the pending operations, if any
+  *
+  * The completions are always posted: this handler may run inside a read
+  * initiating function or in the demux receive loop.
   */
   void r_queues_handler(
       boost::system::error_code ec = boost::system::error_code()) {
-    std::unique_lock<std::recursive_mutex> lock1(read_op_queue_mutex);
-    std::unique_lock<std::recursive_mutex> lock2(data_queue_mutex);
-
+    std::unique_lock<std::mutex> lock(receive_mutex);
+    std::size_t data_size =
+        p_receive_queues_ ? p_receive_queues_->data_queue.size() : 0;
     {
-      std::unique_lock<std::recursive_mutex> lock(in_mutex);
-      if (((data_queue.size() > 60 * 1024 * 1024) && ready_in) ||
-          ((data_queue.size() < 40 * 1024 * 1024) && !ready_in)) {
+      // A fiber holding received data stops receiving while the demux is over
+      // its buffered bytes quota. It resumes once its data has been read.
+      bool in = ready_in();
+      bool over_quota = data_size && buffered_over_quota();
+      if (((data_size > 60 * 1024 * 1024 || over_quota) && in) ||
+          ((data_size < 40 * 1024 * 1024 && !over_quota) && !in)) {
+        if (over_quota) {
+          p_quotas->count_throttled_fiber();
+        }
         p_fib_demux->async_send_ack(this->shared_from_this(), nullptr);
       }
     }
 
     SSF_LOG("fiber_impl", trace, "queue empty: {} | queue size {} | ec {}",
-            read_op_queue.empty(), data_queue.size(), ec.value());
+            read_op_queue.empty(), data_size, ec.value());
     if (ec) {
       while (!read_op_queue.empty()) {
         auto op = read_op_queue.front();
         read_op_queue.pop();
+        --pending_reads_;
 
-        if (data_queue.size()) {
-          size_t copied = op->fill_buffers(data_queue);
-          op->complete(boost::system::error_code(), copied);
-        } else {
-          op->complete(ec, 0);
+        size_t copied = 0;
+        if (p_receive_queues_ && p_receive_queues_->data_queue.size()) {
+          copied = op->fill_buffers(p_receive_queues_->data_queue);
+          remove_quota_bytes(copied);
         }
+
+        auto op_ec = copied ? boost::system::error_code() : ec;
+        auto do_complete = [op, op_ec, copied]() {
+          op->complete(op_ec, copied);
+        };
+        strand.get_io_service().post(do_complete);
       }
       return;
     }
 
-    if (!read_op_queue.empty() && data_queue.size()) {
+    while (!read_op_queue.empty() && p_receive_queues_ &&
+           p_receive_queues_->data_queue.size()) {
       auto op = read_op_queue.front();
       read_op_queue.pop();
+      --pending_reads_;
 
-      size_t copied = op->fill_buffers(data_queue);
+      size_t copied = op->fill_buffers(p_receive_queues_->data_queue);
+      remove_quota_bytes(copied);
 
       auto do_complete = [op, copied]() {
         op->complete(boost::system::error_code(), copied);
       };
-      p_fib_demux->get_io_service().post(do_complete);
-
-      auto self = this->shared_from_this();
-      auto read_queue_handler = [this, self]() { r_queues_handler(); };
-      p_fib_demux->get_io_service().dispatch(read_queue_handler);
+      strand.get_io_service().post(do_complete);
     }
   }
 
-  /// Handle the read operations for datagrams
+  /// Handle the read operations for datagrams (on the strand)
   /**
-  * @param ec The error code corresponding to the previous call to this function
+  * @param ec The error given to the pending operations, if any
   */
   void r_dgr_queues_handler(
       boost::system::error_code ec = boost::system::error_code()) {
-    std::unique_lock<std::recursive_mutex> lock1(read_op_queue_mutex);
-    std::unique_lock<std::recursive_mutex> lock2(data_queue_mutex);
-    std::unique_lock<std::recursive_mutex> lock3(port_queue_mutex);
-    SSF_LOG("fiber_impl", trace,
-            "queue empty: {} | port queue empty: {} | queue size {} | dgr "
-            "queue size {} | ec {}",
-            read_op_queue.empty(), port_queue.empty(), data_queue.size(),
-            dgr_data_queue_.size(), ec.value());
+    SSF_LOG("fiber_impl", trace, "queue empty: {} | dgr queue size {} | ec {}",
+            read_dgr_op_queue.empty(),
+            p_receive_queues_ ? p_receive_queues_->dgr_data_queue.size() : 0,
+            ec.value());
     if (ec) {
       while (!read_dgr_op_queue.empty()) {
         auto op = read_dgr_op_queue.front();
         read_dgr_op_queue.pop();
 
-        if (!port_queue.empty() && !dgr_data_queue_.empty()) {
-          auto remote_port = port_queue.front();
-          port_queue.pop();
-
-          auto data = dgr_data_queue_.front();
-          dgr_data_queue_.pop();
-
-          size_t copied = op->fill_buffers(data);
-
-          op->set_remote_port(remote_port);
-
-          op->complete(boost::system::error_code(), copied);
-        } else {
-          op->complete(ec, 0);
-        }
+        bool received = has_datagram();
+        size_t copied = received ? pop_datagram(op) : 0;
+        auto op_ec = received ? boost::system::error_code() : ec;
+        auto do_complete = [op, op_ec, copied]() {
+          op->complete(op_ec, copied);
+        };
+        strand.get_io_service().post(do_complete);
       }
       return;
     }
 
-    if (!read_dgr_op_queue.empty() && !port_queue.empty() &&
-        !dgr_data_queue_.empty()) {
+    while (!read_dgr_op_queue.empty() && has_datagram()) {
       auto op = read_dgr_op_queue.front();
       read_dgr_op_queue.pop();
 
-      auto remote_port = port_queue.front();
-      port_queue.pop();
-
-      auto data = dgr_data_queue_.front();
-      dgr_data_queue_.pop();
+      size_t copied = pop_datagram(op);
 
-      size_t copied = op->fill_buffers(data);
-
-      op->set_remote_port(remote_port);
-
-      auto do_complete = [=]() {
+      // User handlers run outside of the strand
+      auto do_complete = [op, copied]() {
         op->complete(boost::system::error_code(), copied);
       };
-      p_fib_demux->get_io_service().post(do_complete);
-
-      auto self = this->shared_from_this();
-      auto read_queue_handler = [this, self]() { r_dgr_queues_handler(); };
-      p_fib_demux->get_io_service().dispatch(read_queue_handler);
+      strand.get_io_service().post(do_complete);
     }
   }
 
-  /// Cancel all pending operations immediatly
-  /**
-  * @param ec The error code that will be given to the pending operations
-  */
-  void cancel_operations(
-      boost::system::error_code ec = boost::system::error_code(
-          ::error::interrupted, ::error::get_ssf_category())) {
-    r_queues_handler(ec);
-    r_dgr_queues_handler(ec);
-    a_queues_handler(ec);
-  }
-
-  /// Make the fiber able to send and unable to receive
-  void init_accept_in_out() {
-    std::unique_lock<std::recursive_mutex> lock1(in_mutex);
-    std::unique_lock<std::recursive_mutex> lock2(out_mutex);
-
-    ready_in = false;
-    ready_out = true;
+  /// Apply an update to the state word until no other thread interleaves
+  template <typename Update>
+  void update_state(Update update) {
+    uint32_t current = state_.load();
+    while (!state_.compare_exchange_weak(current, update(current))) {
+    }
   }
 
-  /// Make the fiber able to send and receive
-  void init_connect_in_out() {
-    std::unique_lock<std::recursive_mutex> lock1(in_mutex);
-    std::unique_lock<std::recursive_mutex> lock2(out_mutex);
-
-    ready_in = true;
-    ready_out = true;
+  /// Receive queues, allocated on first use (on the strand)
+  receive_queues& queues() {
+    if (!p_receive_queues_) {
+      p_receive_queues_.reset(new receive_queues());
+    }
+    return *p_receive_queues_;
   }
 
-  /// Toggle the fiber ability to receive
-  void toggle_in() {
-    std::unique_lock<std::recursive_mutex> lock(in_mutex);
-    ready_in = !ready_in;
+  bool has_datagram() const {
+    return p_receive_queues_ && !p_receive_queues_->dgr_data_queue.empty();
   }
 
-  /// Toggle the fiber ability to send
-  void toggle_out() {
-    std::unique_lock<std::recursive_mutex> lock(out_mutex);
-    ready_out = !ready_out;
-  }
+  /// Fill a datagram read operation with the oldest datagram (on the strand)
+  std::size_t pop_datagram(dgr_read_op* op) {
+    auto datagram = std::move(p_receive_queues_->dgr_data_queue.front());
+    p_receive_queues_->dgr_data_queue.pop();
+    remove_quota_bytes(datagram.data.size());
+
+    size_t copied = op->fill_buffers(datagram.data);
+    op->set_remote_port(datagram.remote_port);
+
+    uint64_t delay_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                            dgr_clock::now() - datagram.received_at)
+                            .count();
+    ++p_dgr_state_->delivered;
+    p_dgr_state_->total_delay_us += delay_us;
+    if (delay_us > p_dgr_state_->max_delay_us.load()) {
+      // Only the strand writes the maximum
+      p_dgr_state_->max_delay_us = delay_us;
+    }
 
-  void set_opened() {
-    std::unique_lock<std::recursive_mutex> lock_state(state_mutex);
-    closed = false;
+    return copied;
   }
 
-  void set_closed() {
-    std::unique_lock<std::recursive_mutex> lock_state(state_mutex);
-    closed = true;
+  /// Count a discarded datagram on the fiber and its demux (on the strand)
+  void count_dropped_datagram() {
+    ++p_dgr_state_->dropped;
+    if (p_quotas) {
+      p_quotas->count_dropped_datagram();
+    }
   }
 
-  /// Set implementation in connecting state
-  void set_connecting() {
-    std::unique_lock<std::recursive_mutex> lock_state(state_mutex);
-    connecting = true;
-    connected = false;
-    disconnecting = false;
-    disconnected = false;
+  /// Account received bytes in the demux quotas (on the strand)
+  void add_quota_bytes(std::size_t size) {
+    if (p_quotas) {
+      p_quotas->add_buffered(size);
+      quota_bytes += size;
+    }
   }
 
-  /// Set implementation in connected state
-  void set_connected() {
-    std::unique_lock<std::recursive_mutex> lock_state(state_mutex);
-    connecting = false;
-    connected = true;
-    closed = false;
-    disconnecting = false;
-    disconnected = false;
+  /// Release read bytes from the demux quotas (strand or try_read)
+  void remove_quota_bytes(std::size_t size) {
+    if (p_quotas) {
+      p_quotas->remove_buffered(size);
+      quota_bytes -= size;
+    }
   }
 
-  /// Set implementation in disconnecting state
-  void set_disconnecting() {
-    std::unique_lock<std::recursive_mutex> lock_state(state_mutex);
-    connecting = false;
-    connected = false;
-    disconnecting = true;
-    disconnected = false;
+  bool buffered_over_quota() {
+    return p_quotas && p_quotas->buffered_over_limit();
   }
 
-  /// Set implementation in disconnected state
-  void set_disconnected() {
-    std::unique_lock<std::recursive_mutex> lock_state(state_mutex);
-    connecting = false;
-    connected = false;
-    closed = true;
-    disconnecting = false;
-    disconnected = true;
-  }
-
-  fiber_id id;
-
-  fiber_demux_type* p_fib_demux;
-
-  std::recursive_mutex in_mutex;
-  std::recursive_mutex out_mutex;
-  bool ready_in;
-  bool ready_out;
-
-  uint8_t priority;
-
-  std::recursive_mutex state_mutex;
-  // States of the fiber
-  bool closed;
-  bool connecting;
-  bool connected;
-  bool disconnecting;
-  bool disconnected;
-
-  std::recursive_mutex read_op_queue_mutex;
-
-  /// Store the pending read requests
-  read_op_queue_type read_op_queue;
-
-  std::recursive_mutex read_dgr_op_queue_mutex;
-
-  /// Store the pending read requests for datagrams
-  read_dgr_op_queue_type read_dgr_op_queue;
-
-  std::recursive_mutex data_queue_mutex;
-
-  /// Store the received data
-  data_queue_type data_queue;
-
-  /// Store the dgr received data
-  dgr_data_queue_type dgr_data_queue_;
-
-  std::recursive_mutex accept_op_queue_mutex;
-
-  /// Store the pending accept operation
-  accept_op_queue_type accept_op_queue;
+ private:
+  /// Connection state and flow control flags (state_flags)
+  std::atomic<uint32_t> state_;
 
-  std::recursive_mutex port_queue_mutex;
+  /// Read operations queued or on their way to the strand
+  std::atomic<uint32_t> pending_reads_;
 
-  /// Store the connecting remote port
-  remote_port_queue_type port_queue;
+  std::unique_ptr<receive_queues> p_receive_queues_;
 
-  /// Connect user handler
-  connect_user_handler_type connect_user_handler;
-
-  /// Fiber accepts datagram
-  bool accepts_dgr;
-
- private:
-  accept_handler_type accept_handler;
-  connect_handler_type connect_handler;
-  receive_handler_type receive_handler;
-  receive_dgr_handler_type receive_dgr_handler;
-  close_handler_type close_handler;
-  error_handler_type error_handler;
+  /// Datagram queue bound and counters, null for stream fibers and acceptors
+  std::unique_ptr<datagram_state> p_dgr_state_;
 };
 
 }  // namespace detail
@@ -12,7 +12,6 @@
 #pragma once
 #endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
 
-#include <boost/asio/coroutine.hpp>
 #include <boost/asio.hpp>
 #include <memory>
 #include <vector>
@@ -31,6 +30,18 @@ public:
   /// Constructor for an empty fiber buffer of size 4096 bytes.
   fiber_buffer() : data_(4096), data_bytes_transferred_(0) {}
 
+  /// Constructor for a fiber buffer holding a received packet.
+  /**
+  * @param header The decoded header of the packet
+  * @param data A pointer to the payload of the packet
+  * @param size The size of the payload
+  */
+  fiber_buffer(const fiber_header& header, const uint8_t* data,
+               std::size_t size)
+    : header_(header), data_(data, data + size), data_bytes_transferred_(size)
+  {
+  }
+
   /// Get the header part of the fiber buffer in order to fill it.
   fiber_header& header()
   {
@@ -90,139 +101,15 @@ public:
     data_.resize(new_size);
   }
 
-  /// Get the fiber buffer buffers for sending
-  /**
-  * @param buffers The buffers containing the payload for the fiber buffer.
-  */
-  template <typename ConstBufferSequence>
-  std::vector<boost::asio::const_buffer> const_buffer(
-    ConstBufferSequence buffers)
-  {
-    std::vector<boost::asio::const_buffer> buf;
-
-    raw_ = header_.get_raw();
-    buf.push_back(boost::asio::buffer((void*)&raw_, sizeof(raw_)));
-
-    // header_.fill_const_buffer(buf);
-
-    for (auto itor = buffers.begin(); itor != buffers.end(); ++itor)
-    {
-      buf.push_back(*itor);
-    }
-
-    return buf;
-  }
-
-  /// Get the fiber buffer buffer sequence for receiving.
-  std::vector<boost::asio::mutable_buffer> buffer()
-  {
-    std::vector<boost::asio::mutable_buffer> buf;
-
-    header_.fill_buffer(buf);
-    buf.push_back(boost::asio::buffer(&data_, data_.size()));
-
-    return buf;
-  }
-
 private:
   fiber_header header_;
   std::vector<uint8_t> data_;
 
   std::size_t data_bytes_transferred_;
-
-  fiber_header::raw_fiber_header raw_;
 };
 
 typedef std::shared_ptr<fiber_buffer> p_fiber_buffer;
 
-/// Coroutine class to receive a fiber buffer from a stream
-/**
-* @tparam StreamSocket The stream type to receive from
-* @tparam ReadHandler The type for the callback handler to call upon reception
-*/
-template <typename StreamSocket, typename ReadHandler>
-class read_fiber_buf_op : public boost::asio::coroutine
-{
-public:
-  /// Constructor
-  /**
-  * @param stream The stream to receive from
-  * @param buffer The fiber buffer to receive into
-  * @param handler The handler to be called upon reception
-  */
-  read_fiber_buf_op(StreamSocket& stream, fiber_buffer& buffer,
-                    ReadHandler& handler)
-                    : stream_(stream),
-                    buffer_(buffer),
-                    handler_(handler),
-                    total_transferred_(0),
-                    data_transferred_(0)
-  {
-  }
-
-#include <boost/asio/yield.hpp>  // NOLINT
-  void operator()(const boost::system::error_code& ec, std::size_t length)
-  {
-    auto& header = buffer_.header();
-
-    if (!ec) reenter(this)
-    {
-      // Receive the header
-      yield boost::asio::async_read(stream_, header.buffer(),
-                                    std::move(*this));
-      total_transferred_ += length;
-
-      // Resize the buffer if needed
-      if (header.data_size() > buffer_.cdata().size())
-      {
-        buffer_.resize(header.data_size());
-      }
-
-      // Receive the payload
-      yield boost::asio::async_read(
-        stream_, boost::asio::buffer(buffer_.data(), header.data_size()),
-        std::move(*this));
-
-      data_transferred_ = length;
-      total_transferred_ += data_transferred_;
-      buffer_.set_bytes_transferred(data_transferred_);
-      buffer_.set_id(header.id());
-
-      handler_(ec, total_transferred_);
-    }
-    else
-    {
-      handler_(ec, total_transferred_);
-    }
-  }
-#include <boost/asio/unyield.hpp>  // NOLINT
-
-private:
-  StreamSocket& stream_;
-  fiber_buffer& buffer_;
-  ReadHandler handler_;
-  std::size_t total_transferred_;
-  std::size_t data_transferred_;
-};
-
-/// Helper to receive a fiber packet in a fiber buffer
-/**
-* @tparam StreamSocket The stream type to receive from
-* @tparam ReadHandler The type for the callback handler to call upon reception
-*
-* @param stream The stream to receive from
-* @param buffer The fiber buffer to receive into
-* @param handler The handler to be called upon reception
-*/
-template <typename StreamSocket, typename ReadHandler>
-void async_read_fiber_buffer(StreamSocket& stream, fiber_buffer& buffer,
-                              ReadHandler& handler)
-{
-  // Start the coroutine
-  read_fiber_buf_op<StreamSocket, ReadHandler>(stream, buffer, handler)(
-    boost::system::error_code(), 0);
-}
-
 } // namespace detail
 } // namespace fiber
 } // namespace asio
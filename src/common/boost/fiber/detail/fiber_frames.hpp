@@ -0,0 +1,196 @@
+//
+// fiber/detail/fiber_frames.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2014-2015
+//
+
+#ifndef SSF_COMMON_BOOST_ASIO_FIBER_DETAIL_FIBER_FRAMES_HPP_
+#define SSF_COMMON_BOOST_ASIO_FIBER_DETAIL_FIBER_FRAMES_HPP_
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+
+#include <boost/asio/buffer.hpp>
+
+#include "common/boost/fiber/detail/fiber_header.hpp"
+#include "common/boost/fiber/detail/fiber_id.hpp"
+
+namespace boost {
+namespace asio {
+namespace fiber {
+namespace detail {
+
+/// Buffer sequence with a fixed capacity stored in place
+/**
+* @tparam Capacity The maximum number of buffers in the sequence
+*/
+template <std::size_t Capacity>
+class fixed_const_buffer_sequence
+{
+public:
+  typedef boost::asio::const_buffer value_type;
+  typedef const boost::asio::const_buffer* const_iterator;
+
+public:
+  fixed_const_buffer_sequence() : size_(0) {}
+
+  const_iterator begin() const { return buffers_.data(); }
+
+  const_iterator end() const { return buffers_.data() + size_; }
+
+  std::size_t size() const { return size_; }
+
+  static std::size_t capacity() { return Capacity; }
+
+  boost::asio::const_buffer& operator[](std::size_t index)
+  {
+    return buffers_[index];
+  }
+
+  /// Append a buffer
+  /**
+  * @param buffer The buffer to append. The sequence must not be full.
+  */
+  void push_back(const boost::asio::const_buffer& buffer)
+  {
+    buffers_[size_++] = buffer;
+  }
+
+  void clear() { size_ = 0; }
+
+private:
+  std::array<boost::asio::const_buffer, Capacity> buffers_;
+  std::size_t size_;
+};
+
+/// Fiber packets built in place from user buffers
+/**
+* The headers of the packets are stored in the object and the payloads refer
+* to the user buffers, so that the whole write is gathered in a single
+* buffer sequence without copying nor allocating.
+*
+* The object must not move while its buffers are in use.
+*/
+class fiber_frames
+{
+public:
+  /// Maximum number of packets built from one send
+  enum { max_frames = 8 };
+
+  /// Type of the buffer sequence holding headers and payloads
+  typedef fixed_const_buffer_sequence<3 * max_frames> buffers_type;
+
+public:
+  fiber_frames() : frame_count_(0), payload_size_(0) {}
+
+  fiber_frames(const fiber_frames&) = delete;
+  fiber_frames& operator=(const fiber_frames&) = delete;
+
+  /// Split user buffers into packets
+  /**
+  * Each packet carries up to mtu bytes. Packets are built until the user
+  * buffers are consumed, frame_limit packets are built or the buffer
+  * sequence is full. A packet with an empty payload is built from empty user
+  * buffers.
+  *
+  * @param id The fiber id to put in the headers
+  * @param flags The flags to put in the headers
+  * @param user_buffers The payload to send
+  * @param mtu The maximum payload size of one packet
+  * @param frame_limit The maximum number of packets to build
+  *
+  * @return the number of payload bytes put in the packets
+  */
+  template <typename ConstBufferSequence>
+  std::size_t fill(const fiber_id& id, fiber_header::flags_type flags,
+                   const ConstBufferSequence& user_buffers, std::size_t mtu,
+                   std::size_t frame_limit = max_frames)
+  {
+    frame_count_ = 0;
+    payload_size_ = 0;
+    buffers_.clear();
+
+    auto it = user_buffers.begin();
+    auto end = user_buffers.end();
+    std::size_t offset = 0;
+
+    frame_limit = (std::min)(frame_limit, std::size_t(max_frames));
+
+    do
+    {
+      std::size_t header_index = buffers_.size();
+      buffers_.push_back(boost::asio::const_buffer());
+
+      std::size_t frame_size = 0;
+      while (it != end && frame_size < mtu &&
+             buffers_.size() < buffers_type::capacity())
+      {
+        boost::asio::const_buffer buffer(*it);
+        std::size_t available = boost::asio::buffer_size(buffer) - offset;
+        std::size_t taken = (std::min)(available, mtu - frame_size);
+
+        if (taken)
+        {
+          buffers_.push_back(boost::asio::buffer(buffer + offset, taken));
+          frame_size += taken;
+          offset += taken;
+        }
+
+        if (offset == boost::asio::buffer_size(buffer))
+        {
+          ++it;
+          offset = 0;
+        }
+      }
+
+      fiber_header header(id, flags,
+                          static_cast<fiber_header::data_size_type>(
+                            frame_size));
+      headers_[frame_count_] = header.get_raw();
+      buffers_[header_index] = boost::asio::buffer(
+        &headers_[frame_count_], sizeof(fiber_header::raw_fiber_header));
+
+      ++frame_count_;
+      payload_size_ += frame_size;
+
+      // Skip the empty buffers left so that they do not produce a packet
+      while (it != end && boost::asio::buffer_size(*it) == offset)
+      {
+        ++it;
+        offset = 0;
+      }
+    } while (it != end && frame_count_ < frame_limit &&
+             buffers_.size() + 2 <= buffers_type::capacity());
+
+    return payload_size_;
+  }
+
+  /// Get the buffers to write
+  const buffers_type& buffers() const { return buffers_; }
+
+  /// Get the number of packets built
+  std::size_t frame_count() const { return frame_count_; }
+
+  /// Get the number of payload bytes in the packets
+  std::size_t payload_size() const { return payload_size_; }
+
+private:
+  std::array<fiber_header::raw_fiber_header, max_frames> headers_;
+  buffers_type buffers_;
+  std::size_t frame_count_;
+  std::size_t payload_size_;
+};
+
+} // namespace detail
+} // namespace fiber
+} // namespace asio
+} // namespace boost
+
+#endif  // SSF_COMMON_BOOST_ASIO_FIBER_DETAIL_FIBER_FRAMES_HPP_
@@ -13,6 +13,7 @@
 #endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
 
 #include <cstdint>
+#include <cstring>
 #include <vector>
 
 #include "common/boost/fiber/detail/fiber_id.hpp"
@@ -151,17 +152,22 @@ public:
       sizeof(data_size_type);
   }
 
-  /// Get a buffer to receive a header
-  std::vector<boost::asio::mutable_buffer> buffer()
+  /// Decode a header from its fixed wire layout
+  /**
+  * The wire layout is the packed raw_fiber_header: version, local port,
+  * remote port, flags and data size, in host byte order.
+  *
+  * @param data A pointer to at least pod_size() bytes of received data
+  */
+  void decode(const uint8_t* data)
   {
-    std::vector<boost::asio::mutable_buffer> buf;
-
-    buf.push_back(boost::asio::buffer(&version_, sizeof(version_)));
-    id_.fill_buffer(buf);
-    buf.push_back(boost::asio::buffer(&flags_, sizeof(flags_)));
-    buf.push_back(boost::asio::buffer(&data_size_, sizeof(data_size_)));
-
-    return buf;
+    std::memcpy(&version_, data, sizeof(version_));
+    data += sizeof(version_);
+    id_.decode(data);
+    data += fiber_id::pod_size();
+    std::memcpy(&flags_, data, sizeof(flags_));
+    data += sizeof(flags_);
+    std::memcpy(&data_size_, data, sizeof(data_size_));
   }
 
   /// Get a buffer to send a header
@@ -177,18 +183,6 @@ public:
     return buf;
   }
 
-  /// Fill the given buffer vector with the fiber header fields
-  /**
-  * @param buffers The vector of buffers to fill
-  */
-  void fill_buffer(std::vector<boost::asio::mutable_buffer>& buffers)
-  {
-    buffers.push_back(boost::asio::buffer(&version_, sizeof(version_)));
-    id_.fill_buffer(buffers);
-    buffers.push_back(boost::asio::buffer(&flags_, sizeof(flags_)));
-    buffers.push_back(boost::asio::buffer(&data_size_, sizeof(data_size_)));
-  }
-
   /// Fill the given buffer vector with the fiber header fields
   /**
   * @param buffers The vector of buffers to fill
@@ -13,6 +13,7 @@
 #endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
 
 #include <cstdint>
+#include <cstring>
 #include <array>
 #include <vector>
 
@@ -161,6 +162,16 @@ public:
     buffers.push_back(boost::asio::buffer(&remote_port_, sizeof(remote_port_)));
   }
 
+  /// Decode the fiber id fields from their fixed wire layout
+  /**
+  * @param data A pointer to at least pod_size() bytes of received data
+  */
+  void decode(const uint8_t* data)
+  {
+    std::memcpy(&local_port_, data, sizeof(local_port_));
+    std::memcpy(&remote_port_, data + sizeof(local_port_), sizeof(remote_port_));
+  }
+
   /// Get the size of a fiber ID
   static uint16_t pod_size()
   {
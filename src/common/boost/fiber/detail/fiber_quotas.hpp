@@ -0,0 +1,223 @@
+//
+// fiber/detail/fiber_quotas.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2014-2015
+//
+
+#ifndef SSF_COMMON_BOOST_ASIO_FIBER_DETAIL_FIBER_QUOTAS_HPP_
+#define SSF_COMMON_BOOST_ASIO_FIBER_DETAIL_FIBER_QUOTAS_HPP_
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#pragma once
+#endif  // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <cstdint>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+namespace boost {
+namespace asio {
+namespace fiber {
+namespace detail {
+
+/// Limits on the resources one peer can use through a demux
+/**
+* A limit set to 0 is disabled.
+*/
+struct fiber_quota_limits {
+  fiber_quota_limits()
+      : max_fibers(0),
+        max_buffered_bytes(0),
+        max_syn_per_second(0),
+        max_outbound_sockets(0) {}
+
+  /// Maximum number of fibers bound on the demux (acceptors included)
+  uint32_t max_fibers;
+
+  /// Maximum number of received bytes waiting to be read, across all fibers
+  uint64_t max_buffered_bytes;
+
+  /// Maximum number of connection requests accepted per second
+  uint32_t max_syn_per_second;
+
+  /// Maximum number of sockets opened by services on behalf of the peer
+  uint32_t max_outbound_sockets;
+};
+
+/// Resource usage of one demux checked against its limits
+/**
+* Checks only use atomic counters so that they can run on the receive path.
+* Every rejection is counted.
+*/
+class fiber_quotas {
+ private:
+  typedef std::chrono::steady_clock clock;
+
+ public:
+  fiber_quotas()
+      : max_fibers_(0),
+        max_buffered_bytes_(0),
+        max_syn_per_second_(0),
+        max_outbound_sockets_(0),
+        buffered_bytes_(0),
+        outbound_sockets_(0),
+        syn_window_(0),
+        syn_window_count_(0),
+        rejected_fibers_(0),
+        rejected_syns_(0),
+        throttled_fibers_(0),
+        dropped_datagrams_(0),
+        rejected_outbound_sockets_(0) {}
+
+  void set_limits(const fiber_quota_limits& limits) {
+    max_fibers_ = limits.max_fibers;
+    max_buffered_bytes_ = limits.max_buffered_bytes;
+    max_syn_per_second_ = limits.max_syn_per_second;
+    max_outbound_sockets_ = limits.max_outbound_sockets;
+  }
+
+  fiber_quota_limits limits() const {
+    fiber_quota_limits limits;
+    limits.max_fibers = max_fibers_;
+    limits.max_buffered_bytes = max_buffered_bytes_;
+    limits.max_syn_per_second = max_syn_per_second_;
+    limits.max_outbound_sockets = max_outbound_sockets_;
+    return limits;
+  }
+
+  /// Check a connection request received while fibers_count fibers are bound
+  bool admit_fiber(std::size_t fibers_count) {
+    uint32_t max_fibers = max_fibers_;
+    if (max_fibers && fibers_count >= max_fibers) {
+      ++rejected_fibers_;
+      return false;
+    }
+
+    uint32_t max_syn_per_second = max_syn_per_second_;
+    if (!max_syn_per_second) {
+      return true;
+    }
+
+    // Fixed one second windows
+    int64_t window = std::chrono::duration_cast<std::chrono::seconds>(
+                         clock::now().time_since_epoch())
+                         .count();
+    int64_t current_window = syn_window_;
+    if (current_window != window &&
+        syn_window_.compare_exchange_strong(current_window, window)) {
+      syn_window_count_ = 0;
+    }
+    if (++syn_window_count_ > max_syn_per_second) {
+      ++rejected_syns_;
+      return false;
+    }
+
+    return true;
+  }
+
+  void add_buffered(std::size_t size) { buffered_bytes_ += size; }
+
+  void remove_buffered(std::size_t size) { buffered_bytes_ -= size; }
+
+  /// Check if the received bytes waiting to be read exceed the limit
+  bool buffered_over_limit() const {
+    uint64_t max_buffered_bytes = max_buffered_bytes_;
+    return max_buffered_bytes && buffered_bytes_ > max_buffered_bytes;
+  }
+
+  void count_throttled_fiber() { ++throttled_fibers_; }
+
+  void count_dropped_datagram() { ++dropped_datagrams_; }
+
+  /// Reserve an outbound socket
+  /**
+  * @return false if the limit is reached. Otherwise the socket must be
+  * released with release_outbound_socket.
+  */
+  bool acquire_outbound_socket() {
+    uint32_t max_outbound_sockets = max_outbound_sockets_;
+    if (++outbound_sockets_ > max_outbound_sockets && max_outbound_sockets) {
+      --outbound_sockets_;
+      ++rejected_outbound_sockets_;
+      return false;
+    }
+    return true;
+  }
+
+  void release_outbound_socket() { --outbound_sockets_; }
+
+  uint64_t buffered_bytes() const { return buffered_bytes_; }
+  uint32_t outbound_sockets() const { return outbound_sockets_; }
+
+  uint64_t rejected_fibers() const { return rejected_fibers_; }
+  uint64_t rejected_syns() const { return rejected_syns_; }
+  uint64_t throttled_fibers() const { return throttled_fibers_; }
+  uint64_t dropped_datagrams() const { return dropped_datagrams_; }
+  uint64_t rejected_outbound_sockets() const {
+    return rejected_outbound_sockets_;
+  }
+
+ private:
+  std::atomic<uint32_t> max_fibers_;
+  std::atomic<uint64_t> max_buffered_bytes_;
+  std::atomic<uint32_t> max_syn_per_second_;
+  std::atomic<uint32_t> max_outbound_sockets_;
+
+  std::atomic<uint64_t> buffered_bytes_;
+  std::atomic<uint32_t> outbound_sockets_;
+  std::atomic<int64_t> syn_window_;
+  std::atomic<uint32_t> syn_window_count_;
+
+  std::atomic<uint64_t> rejected_fibers_;
+  std::atomic<uint64_t> rejected_syns_;
+  std::atomic<uint64_t> throttled_fibers_;
+  std::atomic<uint64_t> dropped_datagrams_;
+  std::atomic<uint64_t> rejected_outbound_sockets_;
+};
+
+/// Outbound socket reserved on a demux, released on destruction
+class outbound_socket_reservation {
+ public:
+  typedef std::shared_ptr<outbound_socket_reservation> pointer;
+
+ public:
+  ~outbound_socket_reservation() {
+    if (p_quotas_) {
+      p_quotas_->release_outbound_socket();
+    }
+  }
+
+  /// Reserve an outbound socket
+  /**
+  * @param p_quotas The quotas of the demux (no limit if null)
+  *
+  * @return A null pointer if the limit is reached
+  */
+  static pointer acquire(std::shared_ptr<fiber_quotas> p_quotas) {
+    if (p_quotas && !p_quotas->acquire_outbound_socket()) {
+      return pointer();
+    }
+    return pointer(new outbound_socket_reservation(std::move(p_quotas)));
+  }
+
+ private:
+  explicit outbound_socket_reservation(std::shared_ptr<fiber_quotas> p_quotas)
+      : p_quotas_(std::move(p_quotas)) {}
+
+  outbound_socket_reservation(const outbound_socket_reservation&) = delete;
+  outbound_socket_reservation& operator=(const outbound_socket_reservation&) =
+      delete;
+
+ private:
+  std::shared_ptr<fiber_quotas> p_quotas_;
+};
+
+}  // namespace detail
+}  // namespace fiber
+}  // namespace asio
+}  // namespace boost
+
+#endif  // SSF_COMMON_BOOST_ASIO_FIBER_DETAIL_FIBER_QUOTAS_HPP_
@@ -0,0 +1,139 @@
+//
+// fiber/detail/fiber_receive_buffer.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2014-2015
+//
+
+#ifndef SSF_COMMON_BOOST_ASIO_FIBER_DETAIL_FIBER_RECEIVE_BUFFER_HPP_
+#define SSF_COMMON_BOOST_ASIO_FIBER_DETAIL_FIBER_RECEIVE_BUFFER_HPP_
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include <boost/asio/buffer.hpp>
+
+#include "common/boost/fiber/detail/fiber_header.hpp"
+
+namespace boost {
+namespace asio {
+namespace fiber {
+namespace detail {
+
+/// Buffer receiving raw demux data and splitting it into fiber packets
+/**
+* The demux reads as much data as the stream socket can provide into the free
+* space at the end of the buffer, then extracts every complete packet from
+* it. The bytes of a packet spanning two reads stay in the buffer and are
+* moved back to its front once the free space can no longer hold a maximum
+* sized packet.
+*/
+class fiber_receive_buffer
+{
+public:
+  /// Default capacity of the buffer
+  enum { default_capacity = 256 * 1024 };
+
+public:
+  /// Constructor
+  /**
+  * @param capacity The size of the buffer. It must be greater than the size
+  * of a maximum sized packet (header and 64KB payload).
+  */
+  explicit fiber_receive_buffer(std::size_t capacity = default_capacity)
+    : data_(capacity), begin_(0), end_(0)
+  {
+  }
+
+  /// Get the free part of the buffer to read into
+  boost::asio::mutable_buffers_1 prepare()
+  {
+    if (data_.size() - end_ < max_packet_size())
+    {
+      compact();
+    }
+
+    return boost::asio::mutable_buffers_1(&data_[end_], data_.size() - end_);
+  }
+
+  /// Mark bytes read into the free part of the buffer as received
+  /**
+  * @param size The number of bytes read
+  */
+  void commit(std::size_t size) { end_ += size; }
+
+  /// Extract the next complete packet
+  /**
+  * @param header The header to decode the packet header into
+  * @param p_payload Set to the beginning of the packet payload. It stays
+  * valid until the next call to prepare().
+  *
+  * @return true if a complete packet was extracted
+  */
+  bool next_packet(fiber_header& header, const uint8_t*& p_payload)
+  {
+    const std::size_t header_size = fiber_header::pod_size();
+
+    if (size() < header_size)
+    {
+      return false;
+    }
+
+    header.decode(&data_[begin_]);
+
+    if (size() < header_size + header.data_size())
+    {
+      return false;
+    }
+
+    p_payload = &data_[begin_ + header_size];
+    begin_ += header_size + header.data_size();
+
+    if (begin_ == end_)
+    {
+      begin_ = end_ = 0;
+    }
+
+    return true;
+  }
+
+  /// Get the number of received bytes not yet extracted
+  std::size_t size() const { return end_ - begin_; }
+
+private:
+  static std::size_t max_packet_size()
+  {
+    return fiber_header::pod_size() +
+           std::numeric_limits<fiber_header::data_size_type>::max();
+  }
+
+  void compact()
+  {
+    if (begin_ == 0)
+    {
+      return;
+    }
+
+    std::memmove(&data_[0], &data_[begin_], size());
+    end_ -= begin_;
+    begin_ = 0;
+  }
+
+private:
+  std::vector<uint8_t> data_;
+  std::size_t begin_;
+  std::size_t end_;
+};
+
+} // namespace detail
+} // namespace fiber
+} // namespace asio
+} // namespace boost
+
+#endif  // SSF_COMMON_BOOST_ASIO_FIBER_DETAIL_FIBER_RECEIVE_BUFFER_HPP_
@@ -0,0 +1,112 @@
+//
+// fiber/detail/io_fiber_write_op.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2014-2015
+//
+
+#ifndef SSF_COMMON_BOOST_ASIO_FIBER_DETAIL_IO_FIBER_WRITE_OP_HPP_
+#define SSF_COMMON_BOOST_ASIO_FIBER_DETAIL_IO_FIBER_WRITE_OP_HPP_
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <utility>
+
+#include <boost/asio/detail/config.hpp>
+
+#include <boost/asio/detail/addressof.hpp>
+#include <boost/asio/detail/bind_handler.hpp>
+#include <boost/asio/detail/fenced_block.hpp>
+#include <boost/asio/detail/handler_alloc_helpers.hpp>
+#include <boost/asio/detail/handler_invoke_helpers.hpp>
+#include <boost/asio/error.hpp>
+
+#include "common/boost/fiber/detail/io_operation.hpp"
+
+#include <boost/asio/detail/push_options.hpp>
+
+namespace boost {
+namespace asio {
+namespace fiber {
+namespace detail {
+
+/// Class to store the packets and the handler of a write on the demux
+/**
+* The handler is moved in the operation, which is allocated with the handler
+* allocation hooks and queued as is until the packets are written.
+*
+* @tparam Handler The type of the handler to be called upon completion
+*/
+template <typename Handler>
+class pending_write_operation : public basic_pending_write_operation
+{
+public:
+  BOOST_ASIO_DEFINE_HANDLER_PTR(pending_write_operation);
+
+  /// Constructor
+  /**
+  * @param handler The handler to call upon completion
+  * @param id The id of the fiber sending the packets
+  * @param priority The priority of the packets to send
+  */
+  pending_write_operation(Handler& handler, const fiber_id& id,
+                          uint8_t priority)
+    : basic_pending_write_operation(&pending_write_operation::do_complete, id,
+                                    priority),
+      handler_(std::move(handler))
+  {
+  }
+
+  /// Implementation of the completion callback
+  /**
+  * @param base A pointer to the base class
+  * @param destroy A boolean to decide if the op should be destroyed
+  * @param result_ec The error_code of the operation
+  * @param bytes_transferred The number of payload bytes sent
+  */
+  static void do_complete(basic_pending_io_operation* base, bool destroy,
+                          const boost::system::error_code& result_ec,
+                          std::size_t bytes_transferred)
+  {
+    boost::system::error_code ec(result_ec);
+
+    // Take ownership of the operation object.
+    pending_write_operation* o(static_cast<pending_write_operation*>(base));
+
+    ptr p = { boost::asio::detail::addressof(o->handler_), o, o };
+
+    BOOST_ASIO_HANDLER_COMPLETION((o));
+
+    // Move the handler out so that the memory can be deallocated before the
+    // upcall is made.
+    boost::asio::detail::binder2<Handler,
+                                 boost::system::error_code,
+                                 std::size_t> handler(
+      o->handler_, ec, bytes_transferred);
+    p.h = boost::asio::detail::addressof(handler.handler_);
+    p.reset();
+
+    // Make the upcall if required.
+    if (!destroy)
+    {
+      boost::asio::detail::fenced_block b(boost::asio::detail::fenced_block::half);
+      BOOST_ASIO_HANDLER_INVOCATION_BEGIN((handler.arg1_, handler.arg2_));
+      boost_asio_handler_invoke_helpers::invoke(handler, handler.handler_);
+      BOOST_ASIO_HANDLER_INVOCATION_END;
+    }
+  }
+
+private:
+  Handler handler_;
+};
+
+} // namespace detail
+} // namespace fiber
+} // namespace asio
+} // namespace boost
+
+#include <boost/asio/detail/pop_options.hpp>
+
+#endif  // SSF_COMMON_BOOST_ASIO_FIBER_DETAIL_IO_FIBER_WRITE_OP_HPP_
@@ -19,6 +19,7 @@
 
 #include <vector>
 
+#include "common/boost/fiber/detail/fiber_frames.hpp"
 #include "common/boost/fiber/detail/fiber_id.hpp"
 
 namespace boost {
@@ -228,6 +229,38 @@ private:
   fiber_id::remote_port_type* p_remote_port_;
 };
 
+/// Base class for pending write operations on the demux socket
+class basic_pending_write_operation : public basic_pending_io_operation
+{
+protected:
+  /// Constructor
+  /**
+  * @param func The completion handler
+  * @param id The id of the fiber sending the packets
+  * @param priority The priority of the packets to send
+  */
+  basic_pending_write_operation(basic_pending_io_operation::func_type func,
+                                const fiber_id& id, uint8_t priority)
+    : basic_pending_io_operation(func), frames_(), id_(id), priority_(priority)
+  {
+  }
+
+public:
+  /// Get the packets to send
+  fiber_frames& frames() { return frames_; }
+
+  /// Get the id of the fiber sending the packets
+  const fiber_id& id() const { return id_; }
+
+  /// Get the priority of the packets to send
+  uint8_t priority() const { return priority_; }
+
+private:
+  fiber_frames frames_;
+  fiber_id id_;
+  uint8_t priority_;
+};
+
 /// Base class for pending ssl read operations
 class basic_pending_ssl_operation : public basic_pending_io_operation
 {
@@ -12,7 +12,6 @@
 #pragma once
 #endif  // defined(_MSC_VER) && (_MSC_VER >= 1200)
 
-#include <mutex>
 
 #include <boost/asio/basic_socket.hpp>
 #include <boost/asio/detail/type_traits.hpp>
@@ -78,7 +77,7 @@ class fiber_acceptor_service
 
   /// Construct a new fiber acceptor implementation.
   void construct(implementation_type& impl) {
-    impl = implementation_deref_type::create();
+    impl = implementation_deref_type::create(this->get_io_service());
   }
 
   void move_construct(implementation_type& impl, implementation_type& other) {
@@ -104,8 +103,7 @@ class fiber_acceptor_service
 
   /// Determine whether the acceptor is open.
   bool is_open(const implementation_type& impl) const {
-    std::unique_lock<std::recursive_mutex> lock_state(impl->state_mutex);
-    return !impl->closed;
+    return !impl->is_closed();
   }
 
   /// Cancel all asynchronous operations associated with the acceptor.
@@ -119,7 +117,7 @@ class fiber_acceptor_service
   boost::system::error_code bind(implementation_type& impl,
                                  const endpoint_type& endpoint,
                                  boost::system::error_code& ec) {
-    impl->p_fib_demux = &(endpoint.demux());
+    impl->set_demux(&(endpoint.demux()));
     impl->p_fib_demux->bind(endpoint.port(), impl, ec);
 
     return ec;
@@ -168,23 +166,20 @@ class fiber_acceptor_service
     boost::asio::detail::async_result_init<AcceptHandler,
                                            void(boost::system::error_code)>
         init(BOOST_ASIO_MOVE_CAST(AcceptHandler)(handler));
-    {
-      std::unique_lock<std::recursive_mutex> lock_state(impl->state_mutex);
-      if (impl->closed) {
-        auto handler_to_post = [init]() mutable {
-          init.handler(boost::system::error_code(::error::not_connected,
-                                                 ::error::get_ssf_category()));
-        };
-        this->get_io_service().post(handler_to_post);
-
-        return init.result.get();
-      }
+    if (impl->is_closed()) {
+      auto handler_to_post = [init]() mutable {
+        init.handler(boost::system::error_code(::error::not_connected,
+                                               ::error::get_ssf_category()));
+      };
+      this->get_io_service().post(handler_to_post);
+
+      return init.result.get();
     }
 
     boost::system::error_code ec;
 
     auto fiber_impl = peer.native_handle();
-    fiber_impl->p_fib_demux = impl->p_fib_demux;
+    fiber_impl->set_demux(impl->p_fib_demux);
     fiber_impl->id.set_local_port(impl->id.local_port());
 
     SSF_LOG("fiber_acceptor", debug, "local port set {}",
@@ -199,12 +194,9 @@ class fiber_acceptor_service
 
     p.p = new (p.v)
         op(peer.native_handle(), &(peer.native_handle()->id), init.handler);
-    {
-      std::unique_lock<std::recursive_mutex> lock(impl->accept_op_queue_mutex);
-      impl->accept_op_queue.push(p.p);
-    }
+    auto p_op = p.p;
     p.v = p.p = 0;
-    impl->a_queues_handler();
+    impl->push_accept_op(p_op);
 
     return init.result.get();
   }
@@ -0,0 +1,50 @@
+//
+// fiber/fiber_priority.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2014-2015
+//
+
+#ifndef SSF_COMMON_BOOST_ASIO_FIBER_FIBER_PRIORITY_HPP_
+#define SSF_COMMON_BOOST_ASIO_FIBER_FIBER_PRIORITY_HPP_
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#pragma once
+#endif  // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <cstdint>
+
+namespace boost {
+namespace asio {
+namespace fiber {
+
+/// Fiber option setting the priority of its packets on the demultiplexer
+/**
+* The packets of a high priority fiber are written on the demux socket before
+* the packets queued by normal fibers, e.g. to keep interactive sessions
+* responsive under bulk transfers. The packets of one fiber stay in order.
+*
+* @code
+* fiber.set_option(boost::asio::fiber::priority(
+*     boost::asio::fiber::priority::high));
+* @endcode
+*/
+class priority {
+ public:
+  enum : uint8_t { normal = 0, high = 1 };
+
+ public:
+  explicit priority(uint8_t value = normal) : value_(value) {}
+
+  /// Get the priority value
+  uint8_t value() const { return value_; }
+
+ private:
+  uint8_t value_;
+};
+
+}  // namespace fiber
+}  // namespace asio
+}  // namespace boost
+
+#endif  // SSF_COMMON_BOOST_ASIO_FIBER_FIBER_PRIORITY_HPP_
@@ -16,7 +16,6 @@
 
 #include <functional>
 #include <memory>
-#include <mutex>
 
 #include <boost/asio/async_result.hpp>
 #include <boost/asio/detail/config.hpp>
@@ -31,6 +30,7 @@
 #include "common/boost/fiber/basic_fiber_demux.hpp"
 #include "common/boost/fiber/detail/basic_fiber_impl.hpp"
 #include "common/boost/fiber/detail/fiber_id.hpp"
+#include "common/boost/fiber/fiber_priority.hpp"
 
 #include <boost/asio/detail/push_options.hpp>
 
@@ -98,7 +98,7 @@ class stream_fiber_service
 
   /// Construct a new fiber implementation.
   void construct(implementation_type& impl) {
-    impl = implementation_deref_type::create();
+    impl = implementation_deref_type::create(this->get_io_service());
   }
 
   void move_construct(implementation_type& impl, implementation_type& other) {
@@ -124,8 +124,7 @@ class stream_fiber_service
 
   /// Determine whether the fiber is open.
   bool is_open(const implementation_type& impl) const {
-    std::unique_lock<std::recursive_mutex> lock_state(impl->state_mutex);
-    return !impl->closed;
+    return !impl->is_closed();
   }
 
   /// Close a fiber implementation.
@@ -150,7 +149,7 @@ class stream_fiber_service
   boost::system::error_code bind(implementation_type& impl,
                                  const endpoint_type& endpoint,
                                  boost::system::error_code& ec) {
-    impl->p_fib_demux = &(endpoint.demux());
+    impl->set_demux(&(endpoint.demux()));
     impl->p_fib_demux->bind(endpoint.port(), impl, ec);
 
     return ec;
@@ -166,7 +165,7 @@ class stream_fiber_service
         init(BOOST_ASIO_MOVE_CAST(ConnectHandler)(handler));
 
     impl->connect_user_handler = init.handler;
-    impl->p_fib_demux = &(peer_endpoint.demux());
+    impl->set_demux(&(peer_endpoint.demux()));
     impl->p_fib_demux->async_connect(peer_endpoint.port(), impl);
 
     return init.result.get();
@@ -190,6 +189,24 @@ class stream_fiber_service
   /// Get the native socket implementation.
   native_handle_type native_handle(implementation_type& impl) { return impl; }
 
+  /// Set the priority of the fiber packets on the demultiplexer.
+  boost::system::error_code set_option(implementation_type& impl,
+                                       const priority& option,
+                                       boost::system::error_code& ec) {
+    impl->priority = option.value();
+    ec.assign(::error::success, ::error::get_ssf_category());
+    return ec;
+  }
+
+  /// Get the priority of the fiber packets on the demultiplexer.
+  boost::system::error_code get_option(const implementation_type& impl,
+                                       priority& option,
+                                       boost::system::error_code& ec) const {
+    option = priority(impl->priority.load());
+    ec.assign(::error::success, ::error::get_ssf_category());
+    return ec;
+  }
+
   /// Start an asynchronous send.
   template <typename ConstBufferSequence, typename WriteHandler>
   BOOST_ASIO_INITFN_RESULT_TYPE(WriteHandler,
@@ -209,17 +226,14 @@ class stream_fiber_service
       };
       this->get_io_service().post(handler_to_post);
     } else {
-      {
-        std::unique_lock<std::recursive_mutex> lock_state(impl->state_mutex);
-        if (!impl->connected) {
-          auto handler_to_post = [init]() mutable {
-            init.handler(boost::system::error_code(::error::not_connected,
-                                                   ::error::get_ssf_category()),
-                         0);
-          };
-          this->get_io_service().post(handler_to_post);
-          return init.result.get();
-        }
+      if (!impl->is_connected()) {
+        auto handler_to_post = [init]() mutable {
+          init.handler(boost::system::error_code(::error::not_connected,
+                                                 ::error::get_ssf_category()),
+                       0);
+        };
+        this->get_io_service().post(handler_to_post);
+        return init.result.get();
       }
 
       // Call handler immediatly if buffer size at 0
@@ -250,17 +264,14 @@ class stream_fiber_service
         ReadHandler, void(boost::system::error_code, std::size_t)>
         init(BOOST_ASIO_MOVE_CAST(ReadHandler)(handler));
 
-    {
-      std::unique_lock<std::recursive_mutex> lock_state(impl->state_mutex);
-      if (!impl->connected) {
-        auto handler_to_post = [init]() mutable {
-          init.handler(boost::system::error_code(::error::not_connected,
-                                                 ::error::get_ssf_category()),
-                       0);
-        };
-        this->get_io_service().post(handler_to_post);
-        return init.result.get();
-      }
+    if (!impl->is_connected()) {
+      auto handler_to_post = [init]() mutable {
+        init.handler(boost::system::error_code(::error::not_connected,
+                                               ::error::get_ssf_category()),
+                     0);
+      };
+      this->get_io_service().post(handler_to_post);
+      return init.result.get();
     }
 
     // Call handler immediatly if buffer size at 0
@@ -271,6 +282,13 @@ class stream_fiber_service
                      0);
       };
       this->get_io_service().post(handler_to_post);
+    } else if (auto copied = impl->try_read(buffers)) {
+      // Data was already received: the read is done, only its completion is
+      // deferred (a handler is never called from the initiating function)
+      auto handler_to_post = [init, copied]() mutable {
+        init.handler(boost::system::error_code(), copied);
+      };
+      this->get_io_service().post(handler_to_post);
     } else {
       typedef detail::pending_read_operation<MutableBufferSequence, ReadHandler>
           op;
@@ -281,12 +299,9 @@ class stream_fiber_service
 
       p.p = new (p.v) op(buffers, init.handler);
 
-      {
-        std::unique_lock<std::recursive_mutex> lock(impl->read_op_queue_mutex);
-        impl->read_op_queue.push(p.p);
-      }
+      auto p_op = p.p;
       p.v = p.p = 0;
-      impl->r_queues_handler();
+      impl->push_read_op(p_op);
     }
 
     return init.result.get();
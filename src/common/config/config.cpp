@@ -15,7 +15,7 @@
 namespace ssf {
 namespace config {
 
-Config::Config() : tls_(), http_proxy_(), services_() {}
+Config::Config() : tls_(), http_proxy_(), services_(), quotas_() {}
 
 void Config::Init() {
   boost::system::error_code ec;
@@ -79,15 +79,22 @@ void Config::Log() const {
   http_proxy_.Log();
   socks_proxy_.Log();
   services_.Log();
+  quotas_.Log();
   circuit_.Log();
 }
 
 void Config::LogStatus() const { services_.LogServiceStatus(); }
 
-std::vector<char*> Config::GetArgv() const {
-  std::vector<char*> res_argv(argv_.size() + 1);
+std::vector<char*> Config::GetArgv() const { return ToArgv(argv_); }
+
+std::vector<char*> Config::GetSessionArgv(std::size_t index) const {
+  return ToArgv(sessions_argv_.at(index));
+}
+
+std::vector<char*> Config::ToArgv(const std::list<std::string>& arguments) {
+  std::vector<char*> res_argv(arguments.size() + 1);
   auto res_arg_it = res_argv.begin();
-  for (const auto& arg : argv_) {
+  for (const auto& arg : arguments) {
     *res_arg_it = const_cast<char*>(arg.data());
     ++res_arg_it;
   }
@@ -106,8 +113,10 @@ void Config::UpdateFromJson(const Json& json) {
   UpdateHttpProxy(ssf_config);
   UpdateSocksProxy(ssf_config);
   UpdateServices(ssf_config);
+  UpdateQuotas(ssf_config);
   UpdateCircuit(ssf_config);
   UpdateArguments(ssf_config);
+  UpdateSessions(ssf_config);
 }
 
 void Config::UpdateTls(const Json& json) {
@@ -146,6 +155,15 @@ void Config::UpdateServices(const Json& json) {
   services_.Update(json.at("services"));
 }
 
+void Config::UpdateQuotas(const Json& json) {
+  if (json.count("quotas") == 0) {
+    SSF_LOG("config", debug, "update quotas: configuration not found");
+    return;
+  }
+
+  quotas_.Update(json.at("quotas"));
+}
+
 void Config::UpdateCircuit(const Json& json) {
   if (json.count("circuit") == 0) {
     SSF_LOG("config", debug, "update circuit: configuration not found");
@@ -161,27 +179,45 @@ void Config::UpdateArguments(const Json& json) {
     return;
   }
 
-  // basic arguments parsing
   std::string arguments(json.at("arguments").get<std::string>());
   if (arguments.empty()) {
     return;
   }
-  argv_.clear();
+  argv_ = SplitArguments(arguments);
+}
 
-  argv_.push_back("bin");
+void Config::UpdateSessions(const Json& json) {
+  if (json.count("sessions") == 0) {
+    SSF_LOG("config", debug, "update sessions: configuration not found");
+    return;
+  }
+
+  sessions_argv_.clear();
+  for (const auto& session : json.at("sessions")) {
+    sessions_argv_.push_back(SplitArguments(session.get<std::string>()));
+  }
+}
+
+std::list<std::string> Config::SplitArguments(const std::string& arguments) {
+  std::list<std::string> argv;
+
+  // basic arguments parsing
+  argv.push_back("bin");
   // quoted arg or arg between space
   std::regex argv_regex("(\"[^\"]+\"|[^\\s\"]+)");
   auto argv_it =
       std::sregex_iterator(arguments.begin(), arguments.end(), argv_regex);
   auto argv_end = std::sregex_iterator();
   while (argv_it != argv_end) {
-    auto argv = argv_it->str();
+    auto arg = argv_it->str();
     // trim double quotes
-    boost::trim_if(argv, boost::is_any_of("\""));
-    boost::trim(argv);
-    argv_.push_back(argv);
+    boost::trim_if(arg, boost::is_any_of("\""));
+    boost::trim(arg);
+    argv.push_back(arg);
     ++argv_it;
   }
+
+  return argv;
 }
 
 }  // config
@@ -10,6 +10,7 @@
 
 #include "common/config/circuit.h"
 #include "common/config/proxy.h"
+#include "common/config/quotas.h"
 #include "common/config/services.h"
 #include "common/config/tls.h"
 
@@ -72,8 +73,15 @@ class Config {
    *       },
    *       "socks": { "enable": true }
    *     },
+   *     "quotas": {
+   *       "max_fibers": 0,
+   *       "max_buffered_bytes": 0,
+   *       "max_syn_per_second": 0,
+   *       "max_outbound_sockets": 0
+   *     },
    *     "circuit": [],
-   *     "arguments": ""
+   *     "arguments": "",
+   *     "sessions": []
    *   }
    * }
    */
@@ -118,20 +126,33 @@ class Config {
   const Services& services() const { return services_; }
   Services& services() { return services_; }
 
+  const Quotas& quotas() const { return quotas_; }
+  Quotas& quotas() { return quotas_; }
+
   const Circuit& circuit() const { return circuit_; }
   Circuit& circuit() { return circuit_; }
 
   uint32_t GetArgc() const { return static_cast<uint32_t>(argv_.size()); };
   std::vector<char*> GetArgv() const;
 
+  // Client sessions run by one process, each one with its own arguments
+  // (server address, services, reconnection policy)
+  std::size_t GetSessionsCount() const { return sessions_argv_.size(); }
+  std::vector<char*> GetSessionArgv(std::size_t index) const;
+
  private:
   void UpdateFromJson(const Json& json);
   void UpdateTls(const Json& json);
   void UpdateHttpProxy(const Json& json);
   void UpdateSocksProxy(const Json& json);
   void UpdateServices(const Json& json);
+  void UpdateQuotas(const Json& json);
   void UpdateCircuit(const Json& json);
   void UpdateArguments(const Json& json);
+  void UpdateSessions(const Json& json);
+
+  static std::list<std::string> SplitArguments(const std::string& arguments);
+  static std::vector<char*> ToArgv(const std::list<std::string>& arguments);
 
  private:
   static const char* default_config_;
@@ -139,8 +160,10 @@ class Config {
   HttpProxy http_proxy_;
   SocksProxy socks_proxy_;
   Services services_;
+  Quotas quotas_;
   Circuit circuit_;
   std::list<std::string> argv_;
+  std::vector<std::list<std::string>> sessions_argv_;
 };
 
 }  // config
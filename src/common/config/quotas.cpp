@@ -0,0 +1,42 @@
+#include "common/config/quotas.h"
+
+#include <ssf/log/log.h>
+
+namespace ssf {
+namespace config {
+
+Quotas::Quotas()
+    : max_fibers_(0),
+      max_buffered_bytes_(0),
+      max_syn_per_second_(0),
+      max_outbound_sockets_(0) {}
+
+void Quotas::Update(const Json& quotas_prop) {
+  if (quotas_prop.count("max_fibers") == 1) {
+    max_fibers_ = quotas_prop.at("max_fibers").get<uint32_t>();
+  }
+
+  if (quotas_prop.count("max_buffered_bytes") == 1) {
+    max_buffered_bytes_ = quotas_prop.at("max_buffered_bytes").get<uint64_t>();
+  }
+
+  if (quotas_prop.count("max_syn_per_second") == 1) {
+    max_syn_per_second_ = quotas_prop.at("max_syn_per_second").get<uint32_t>();
+  }
+
+  if (quotas_prop.count("max_outbound_sockets") == 1) {
+    max_outbound_sockets_ =
+        quotas_prop.at("max_outbound_sockets").get<uint32_t>();
+  }
+}
+
+void Quotas::Log() const {
+  SSF_LOG("config", info,
+          "[quotas] max fibers: <{}> | max buffered bytes: <{}> | max syn per "
+          "second: <{}> | max outbound sockets: <{}>",
+          max_fibers_, max_buffered_bytes_, max_syn_per_second_,
+          max_outbound_sockets_);
+}
+
+}  // config
+}  // ssf
@@ -0,0 +1,48 @@
+#ifndef SSF_COMMON_CONFIG_QUOTAS_H_
+#define SSF_COMMON_CONFIG_QUOTAS_H_
+
+#include <cstdint>
+
+#include <json.hpp>
+
+namespace ssf {
+namespace config {
+
+// Limits on the resources each client can use on the server (0 for no limit)
+class Quotas {
+ public:
+  using Json = nlohmann::json;
+
+ public:
+  Quotas();
+
+ public:
+  void Update(const Json& json);
+
+  void Log() const;
+
+  inline uint32_t max_fibers() const { return max_fibers_; }
+
+  inline uint64_t max_buffered_bytes() const { return max_buffered_bytes_; }
+
+  inline uint32_t max_syn_per_second() const { return max_syn_per_second_; }
+
+  inline uint32_t max_outbound_sockets() const {
+    return max_outbound_sockets_;
+  }
+
+ private:
+  // Fibers open on the client connection (service acceptors included)
+  uint32_t max_fibers_;
+  // Received bytes not yet read by the services, across all fibers
+  uint64_t max_buffered_bytes_;
+  // New fibers accepted per second
+  uint32_t max_syn_per_second_;
+  // Sockets opened by the services on behalf of the client
+  uint32_t max_outbound_sockets_;
+};
+
+}  // config
+}  // ssf
+
+#endif  // SSF_COMMON_CONFIG_QUOTAS_H_
@@ -11,6 +11,7 @@ Services::Services()
     : datagram_forwarder_(),
       datagram_listener_(),
       copy_(),
+      exec_(),
       shell_(),
       socks_(),
       stream_forwarder_(),
@@ -20,6 +21,7 @@ Services::Services(const Services& services)
     : datagram_forwarder_(services.datagram_forwarder_),
       datagram_listener_(services.datagram_listener_),
       copy_(services.copy_),
+      exec_(services.exec_),
       shell_(services.shell_),
       socks_(services.socks_),
       stream_forwarder_(services.stream_forwarder_),
@@ -32,6 +34,7 @@ void Services::Update(const Json& json) {
   UpdateStreamListener(json);
 
   UpdateShell(json);
+  UpdateExec(json);
   UpdateSocks(json);
   UpdateCopy(json);
 }
@@ -48,11 +51,22 @@ void Services::Log() const {
               "[microservices][datagram_listener] gateway ports allowed");
     }
   }
+  if (stream_forwarder_.enabled()) {
+    SSF_LOG("config", info,
+            "[microservices][stream_forwarder] buffers: {} x {} bytes",
+            stream_forwarder_.buffers(), stream_forwarder_.buffer_size());
+    if (stream_forwarder_.zero_copy()) {
+      SSF_LOG("config", info, "[microservices][stream_forwarder] zero copy on");
+    }
+  }
   if (stream_listener_.enabled()) {
     if (stream_listener_.gateway_ports()) {
       SSF_LOG("config", warn,
               "[microservices][stream_listener] gateway ports allowed");
     }
+    SSF_LOG("config", info,
+            "[microservices][stream_listener] buffers: {} x {} bytes",
+            stream_listener_.buffers(), stream_listener_.buffer_size());
   }
   if (shell_.enabled()) {
     SSF_LOG("config", info, "[microservices][shell] path: <{}>",
@@ -61,6 +75,16 @@ void Services::Log() const {
     if (!args.empty()) {
       SSF_LOG("config", info, "[microservices][shell] args: <{}>", args);
     }
+    if (!process().interactive()) {
+      SSF_LOG("config", info, "[microservices][shell] interactive mode off");
+    }
+    if (process().pool_size() > 0) {
+      SSF_LOG("config", info, "[microservices][shell] pool size: {}",
+              process().pool_size());
+    }
+  }
+  if (exec_.enabled()) {
+    SSF_LOG("config", info, "[microservices][exec] path: <{}>", exec_.path());
   }
 }
 
@@ -77,6 +101,8 @@ void Services::LogServiceStatus() const {
           (copy_.enabled() ? "On" : "Off"));
   SSF_LOG("status", info, "[microservices][shell]: {}",
           (shell_.enabled() ? "On" : "Off"));
+  SSF_LOG("status", info, "[microservices][exec]: {}",
+          (exec_.enabled() ? "On" : "Off"));
   SSF_LOG("status", info, "[microservices][socks]: {}",
           (socks_.enabled() ? "On" : "Off"));
 }
@@ -139,6 +165,31 @@ void Services::UpdateShell(const Json& json) {
     boost::trim(shell_args);
     shell_.set_args(shell_args);
   }
+
+  if (shell_prop.count("interactive") == 1) {
+    shell_.set_interactive(shell_prop.at("interactive").get<bool>());
+  }
+
+  if (shell_prop.count("pool_size") == 1) {
+    shell_.set_pool_size(shell_prop.at("pool_size").get<uint32_t>());
+  }
+}
+
+void Services::UpdateExec(const Json& json) {
+  if (json.count("exec") == 0) {
+    SSF_LOG("config", debug, "update exec service: configuration not found");
+    return;
+  }
+
+  auto& exec_prop = json.at("exec");
+
+  exec_.set_enabled(IsServiceEnabled(exec_prop, exec_.enabled()));
+
+  if (exec_prop.count("path") == 1) {
+    std::string exec_path(exec_prop.at("path").get<std::string>());
+    boost::trim(exec_path);
+    exec_.set_path(exec_path);
+  }
 }
 
 void Services::UpdateSocks(const Json& json) {
@@ -157,8 +208,25 @@ void Services::UpdateStreamForwarder(const Json& json) {
     return;
   }
 
-  stream_forwarder_.set_enabled(IsServiceEnabled(json.at("stream_forwarder"),
-                                                 stream_forwarder_.enabled()));
+  auto& stream_forwarder_prop = json.at("stream_forwarder");
+
+  stream_forwarder_.set_enabled(
+      IsServiceEnabled(stream_forwarder_prop, stream_forwarder_.enabled()));
+
+  if (stream_forwarder_prop.count("buffer_size") == 1) {
+    stream_forwarder_.set_buffer_size(
+        stream_forwarder_prop.at("buffer_size").get<uint32_t>());
+  }
+
+  if (stream_forwarder_prop.count("buffers") == 1) {
+    stream_forwarder_.set_buffers(
+        stream_forwarder_prop.at("buffers").get<uint32_t>());
+  }
+
+  if (stream_forwarder_prop.count("zero_copy") == 1) {
+    stream_forwarder_.set_zero_copy(
+        stream_forwarder_prop.at("zero_copy").get<bool>());
+  }
 }
 
 void Services::UpdateStreamListener(const Json& json) {
@@ -177,6 +245,16 @@ void Services::UpdateStreamListener(const Json& json) {
     stream_listener_.set_gateway_ports(
         stream_listener_prop.at("gateway_ports").get<bool>());
   }
+
+  if (stream_listener_prop.count("buffer_size") == 1) {
+    stream_listener_.set_buffer_size(
+        stream_listener_prop.at("buffer_size").get<uint32_t>());
+  }
+
+  if (stream_listener_prop.count("buffers") == 1) {
+    stream_listener_.set_buffers(
+        stream_listener_prop.at("buffers").get<uint32_t>());
+  }
 }
 
 bool Services::IsServiceEnabled(const Json& service_json, bool default_value) {
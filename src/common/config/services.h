@@ -6,6 +6,7 @@
 
 #include "services/copy/config.h"
 #include "services/datagrams_to_fibers/config.h"
+#include "services/exec/config.h"
 #include "services/fibers_to_sockets/config.h"
 #include "services/fibers_to_datagrams/config.h"
 #include "services/process/config.h"
@@ -22,6 +23,7 @@ class Services {
   using DatagramForwarderConfig = ssf::services::fibers_to_datagrams::Config;
   using DatagramListenerConfig = ssf::services::datagrams_to_fibers::Config;
   using CopyConfig = ssf::services::copy::Config;
+  using ExecConfig = ssf::services::exec::Config;
   using ShellConfig = ssf::services::process::Config;
   using SocksConfig = ssf::services::socks::Config;
   using StreamForwarderConfig = ssf::services::fibers_to_sockets::Config;
@@ -59,6 +61,10 @@ class Services {
 
   CopyConfig* mutable_copy() { return &copy_; }
 
+  const ExecConfig& exec() const { return exec_; }
+
+  ExecConfig* mutable_exec() { return &exec_; }
+
   const StreamForwarderConfig& stream_forwarder() const {
     return stream_forwarder_;
   }
@@ -86,6 +92,7 @@ class Services {
   void UpdateDatagramForwarder(const Json& json);
   void UpdateDatagramListener(const Json& json);
   void UpdateCopy(const Json& json);
+  void UpdateExec(const Json& json);
   void UpdateShell(const Json& json);
   void UpdateSocks(const Json& json);
   void UpdateStreamForwarder(const Json& json);
@@ -97,6 +104,7 @@ class Services {
   DatagramForwarderConfig datagram_forwarder_;
   DatagramListenerConfig datagram_listener_;
   CopyConfig copy_;
+  ExecConfig exec_;
   ShellConfig shell_;
   SocksConfig socks_;
   StreamForwarderConfig stream_forwarder_;
@@ -5,6 +5,7 @@ const char* ssf::config::Config::default_config_ = R"RAWSTRING(
   "ssf": {
     "arguments": "",
     "circuit": [],
+    "sessions": [],
     "tls": {
       "ca_cert_path": "./certs/trusted/ca.crt",
       "cert_path": "./certs/certificate.crt",
@@ -36,18 +37,37 @@ const char* ssf::config::Config::default_config_ = R"RAWSTRING(
         "enable": true,
         "gateway_ports": false
       },
-      "stream_forwarder": { "enable": true },
+      "stream_forwarder": {
+        "enable": true,
+        "buffer_size": 51200,
+        "buffers": 2,
+        "zero_copy": false
+      },
       "stream_listener": {
         "enable": true,
-        "gateway_ports": false
+        "gateway_ports": false,
+        "buffer_size": 51200,
+        "buffers": 2
       },
       "copy": { "enable": false },
       "shell": {
         "enable": false,
         "path": "C:\\windows\\system32\\cmd.exe",
-        "args": ""
+        "args": "",
+        "interactive": true,
+        "pool_size": 0
+      },
+      "exec": {
+        "enable": false,
+        "path": ""
       },
       "socks": { "enable": true }
+    },
+    "quotas": {
+      "max_fibers": 0,
+      "max_buffered_bytes": 0,
+      "max_syn_per_second": 0,
+      "max_outbound_sockets": 0
     }
   }
 }
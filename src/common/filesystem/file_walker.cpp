@@ -0,0 +1,259 @@
+#include "common/filesystem/file_walker.h"
+
+#if !defined(WIN32)
+#include <dirent.h>
+#endif
+
+#include <algorithm>
+#include <thread>
+
+#include <boost/filesystem.hpp>
+
+#include <ssf/log/log.h>
+
+namespace ssf {
+
+namespace {
+
+enum class EntryType { kFile, kDirectory, kOther };
+
+EntryType GetEntryType(const boost::filesystem::file_status& status) {
+  if (boost::filesystem::is_regular_file(status)) {
+    return EntryType::kFile;
+  }
+  if (boost::filesystem::is_directory(status)) {
+    return EntryType::kDirectory;
+  }
+  return EntryType::kOther;
+}
+
+// Follows symbolic links like the previous stat based listing
+EntryType StatEntryType(const Path& path) {
+  boost::system::error_code ec;
+  return GetEntryType(boost::filesystem::status(path.GetString(), ec));
+}
+
+}  // unnamed namespace
+
+FileWalker::FileWalkerPtr FileWalker::Create(const Path& filepath_pattern,
+                                             bool recursive,
+                                             uint32_t threads_count) {
+  if (threads_count == 0) {
+    threads_count = std::max(
+        1u, std::min(4u, static_cast<uint32_t>(
+                             std::thread::hardware_concurrency())));
+  }
+  return FileWalkerPtr(
+      new FileWalker(filepath_pattern, recursive, threads_count));
+}
+
+FileWalker::FileWalker(const Path& filepath_pattern, bool recursive,
+                       uint32_t threads_count)
+    : base_dir_(filepath_pattern),
+      matcher_(filepath_pattern.GetString()),
+      recursive_(recursive),
+      threads_count_(threads_count),
+      mutex_(),
+      directories_cv_(),
+      directories_(),
+      busy_workers_(0),
+      running_workers_(0),
+      stopped_(false),
+      ec_(),
+      callbacks_mutex_(),
+      on_files_(),
+      on_done_() {
+  boost::system::error_code ec;
+  if (!boost::filesystem::is_directory(base_dir_.GetString(), ec)) {
+    base_dir_ = filepath_pattern.GetParent();
+  }
+}
+
+FileWalker::~FileWalker() {}
+
+void FileWalker::Start(OnFiles on_files, OnDone on_done) {
+  {
+    std::unique_lock<std::mutex> lock(callbacks_mutex_);
+    on_files_ = std::move(on_files);
+    on_done_ = std::move(on_done);
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  directories_.push_back(Path(""));
+  running_workers_ = threads_count_;
+  for (uint32_t i = 0; i < threads_count_; ++i) {
+    // Workers keep the walker alive and exit on their own (Stop does not
+    // need to join them)
+    auto self = shared_from_this();
+    std::thread([self]() { self->Work(); }).detach();
+  }
+}
+
+void FileWalker::Stop() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    stopped_ = true;
+    directories_.clear();
+  }
+  directories_cv_.notify_all();
+
+  std::unique_lock<std::mutex> lock(callbacks_mutex_);
+  on_files_ = OnFiles();
+  on_done_ = OnDone();
+}
+
+void FileWalker::Work() {
+  std::vector<Path> batch;
+  while (true) {
+    Path relative_dir;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      directories_cv_.wait(lock, [this]() {
+        return stopped_ || !directories_.empty() || busy_workers_ == 0;
+      });
+      if (stopped_ || directories_.empty()) {
+        // No directory left and no busy worker to queue one
+        break;
+      }
+      relative_dir = directories_.front();
+      directories_.pop_front();
+      ++busy_workers_;
+    }
+
+    boost::system::error_code ec;
+    WalkDirectory(relative_dir, &batch, ec);
+
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      // Only the base directory failure is reported, like the previous
+      // listing
+      if (ec && relative_dir.IsEmpty() && !ec_) {
+        ec_ = ec;
+      }
+      --busy_workers_;
+    }
+    directories_cv_.notify_all();
+  }
+
+  NotifyFiles(&batch);
+
+  bool last_worker = false;
+  boost::system::error_code ec;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    last_worker = (--running_workers_ == 0);
+    ec = ec_;
+  }
+  if (!last_worker) {
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(callbacks_mutex_);
+  auto on_done = std::move(on_done_);
+  on_files_ = OnFiles();
+  on_done_ = OnDone();
+  if (on_done) {
+    on_done(ec);
+  }
+}
+
+void FileWalker::WalkDirectory(const Path& relative_dir,
+                               std::vector<Path>* p_batch,
+                               boost::system::error_code& ec) {
+  Path current_dir = base_dir_ / relative_dir;
+
+  auto on_entry = [this, &relative_dir, &current_dir, p_batch](
+      const std::string& name, EntryType type) {
+    Path entry_path = current_dir / name;
+    if (type == EntryType::kFile) {
+      if (matcher_.Match(entry_path.GetString())) {
+        p_batch->emplace_back(relative_dir / name);
+        if (p_batch->size() >= kBatchSize) {
+          NotifyFiles(p_batch);
+        }
+      }
+    } else if (type == EntryType::kDirectory && recursive_) {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (stopped_) {
+          return;
+        }
+        directories_.push_back(relative_dir / name);
+      }
+      directories_cv_.notify_one();
+    }
+  };
+
+#if !defined(WIN32)
+  DIR* p_dir = ::opendir(current_dir.GetString().c_str());
+  if (!p_dir) {
+    ec.assign(errno, boost::system::system_category());
+    return;
+  }
+  while (struct dirent* p_entry = ::readdir(p_dir)) {
+    std::string name(p_entry->d_name);
+    if (name == "." || name == "..") {
+      continue;
+    }
+    EntryType type = EntryType::kOther;
+#if defined(_DIRENT_HAVE_D_TYPE) || defined(DT_DIR)
+    switch (p_entry->d_type) {
+      case DT_REG:
+        type = EntryType::kFile;
+        break;
+      case DT_DIR:
+        type = EntryType::kDirectory;
+        break;
+      case DT_LNK:
+      case DT_UNKNOWN:
+        type = StatEntryType(current_dir / name);
+        break;
+      default:
+        break;
+    }
+#else
+    type = StatEntryType(current_dir / name);
+#endif
+    on_entry(name, type);
+    if (stopped_) {
+      break;
+    }
+  }
+  ::closedir(p_dir);
+#else
+  boost::filesystem::directory_iterator directory_it(current_dir.GetString(),
+                                                     ec);
+  if (ec) {
+    return;
+  }
+  for (; directory_it != boost::filesystem::directory_iterator();
+       ++directory_it) {
+    // the status is cached by the directory listing
+    boost::system::error_code status_ec;
+    on_entry(directory_it->path().filename().string(),
+             GetEntryType(directory_it->status(status_ec)));
+    if (stopped_) {
+      break;
+    }
+  }
+#endif
+
+  if (p_batch->size() > 0) {
+    NotifyFiles(p_batch);
+  }
+}
+
+void FileWalker::NotifyFiles(std::vector<Path>* p_batch) {
+  if (p_batch->empty()) {
+    return;
+  }
+  std::vector<Path> files;
+  files.swap(*p_batch);
+
+  std::unique_lock<std::mutex> lock(callbacks_mutex_);
+  if (on_files_) {
+    on_files_(std::move(files));
+  }
+}
+
+}  // ssf
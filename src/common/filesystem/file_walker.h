@@ -0,0 +1,84 @@
+#ifndef SSF_COMMON_FILESYSTEM_FILE_WALKER_H_
+#define SSF_COMMON_FILESYSTEM_FILE_WALKER_H_
+
+#include <cstdint>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <boost/system/error_code.hpp>
+
+#include "common/filesystem/glob_matcher.h"
+#include "common/filesystem/path.h"
+
+namespace ssf {
+
+// Enumerates the files matching a path pattern on worker threads
+//   Directories are walked in parallel and files are reported by batches as
+//   soon as they are found, relative to the base directory of the pattern.
+//   Entry types come from the directory listing when the system provides
+//   them (no stat per entry).
+class FileWalker : public std::enable_shared_from_this<FileWalker> {
+ public:
+  using FileWalkerPtr = std::shared_ptr<FileWalker>;
+  using OnFiles = std::function<void(std::vector<Path> files)>;
+  using OnDone = std::function<void(const boost::system::error_code& ec)>;
+
+  enum { kBatchSize = 256 };
+
+ public:
+  static FileWalkerPtr Create(const Path& filepath_pattern, bool recursive,
+                              uint32_t threads_count = 0);
+
+  ~FileWalker();
+
+  // on_files and on_done are called from the worker threads, on_done once
+  // every file was reported (or the walker was stopped)
+  void Start(OnFiles on_files, OnDone on_done);
+
+  // No callback is called once Stop returns
+  void Stop();
+
+  // Directory whose content is walked
+  Path base_directory() const { return base_dir_; }
+
+ private:
+  FileWalker(const Path& filepath_pattern, bool recursive,
+             uint32_t threads_count);
+
+  void Work();
+
+  // Walk one directory (relative to base_dir_), queue its subdirectories
+  void WalkDirectory(const Path& relative_dir, std::vector<Path>* p_batch,
+                     boost::system::error_code& ec);
+
+  void NotifyFiles(std::vector<Path>* p_batch);
+
+ private:
+  Path base_dir_;
+  GlobMatcher matcher_;
+  bool recursive_;
+  uint32_t threads_count_;
+
+  std::mutex mutex_;
+  std::condition_variable directories_cv_;
+  std::deque<Path> directories_;
+  uint32_t busy_workers_;
+  uint32_t running_workers_;
+  std::atomic<bool> stopped_;
+  boost::system::error_code ec_;
+
+  // held while calling back so that Stop waits for the current call
+  std::mutex callbacks_mutex_;
+  OnFiles on_files_;
+  OnDone on_done_;
+};
+
+}  // ssf
+
+#endif  // SSF_COMMON_FILESYSTEM_FILE_WALKER_H_
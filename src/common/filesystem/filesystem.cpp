@@ -1,10 +1,13 @@
 #include "common/filesystem/filesystem.h"
 
-#include <boost/algorithm/string/replace.hpp>
+#include <future>
+#include <mutex>
+#include <vector>
 
 #include <ssf/log/log.h>
 
 #include "common/error/error.h"
+#include "common/filesystem/file_walker.h"
 
 namespace ssf {
 
@@ -51,63 +54,26 @@ bool Filesystem::RemoveAll(const Path& path,
   return boost::filesystem::remove_all(path.GetString(), ec);
 }
 
-std::list<Path> Filesystem::ListFiles(const Path& filepath_pattern, bool recursive,
+std::list<Path> Filesystem::ListFiles(const Path& filepath_pattern,
+                                      bool recursive,
                                       boost::system::error_code& ec) const {
+  std::mutex files_mutex;
   std::list<Path> result;
+  std::promise<boost::system::error_code> done;
 
-  ssf::Path input_dir(filepath_pattern);
-  if (!IsDirectory(input_dir, ec)) {
-    input_dir = filepath_pattern.GetParent();
-  }
-  ec.clear();
-
-  // convert pattern to regex
-  std::regex filepath_regex;
-  try {
-    std::regex special_chars_regex("[.^$\\[\\]{}+\\\\]");
-    std::string filepath_filter = std::regex_replace(
-      filepath_pattern.GetString(), special_chars_regex, "[&]",
-      std::regex_constants::match_default | std::regex_constants::format_sed);
+  auto on_files = [&files_mutex, &result](std::vector<Path> files) {
+    std::unique_lock<std::mutex> lock(files_mutex);
+    result.insert(result.end(), files.begin(), files.end());
+  };
+  auto on_done = [&done](const boost::system::error_code& ec) {
+    done.set_value(ec);
+  };
 
-    boost::replace_all(filepath_filter, "?", "*");
-    boost::replace_all(filepath_filter, "*", ".*");
-
-    filepath_regex = std::regex(filepath_filter.c_str(), std::regex::extended |
-	                                               std::regex::optimize);
-  }
-  catch(const std::exception&) {
-    SSF_LOG("filesystem", debug, "cannot create filepattern regex");
-    return {};
-  }
-
-  ListFilesRec(input_dir, Path(""), recursive, filepath_regex, result,  ec);
+  auto p_walker = FileWalker::Create(filepath_pattern, recursive);
+  p_walker->Start(on_files, on_done);
+  ec = done.get_future().get();
 
   return result;
 }
 
-void Filesystem::ListFilesRec(const Path& input_dir,
-                              const Path& base_dir,
-                              bool recursive,
-                              const std::regex& filepath_regex,
-                              std::list<Path>& files,
-                              boost::system::error_code& ec) const {
-  Path cur_dir = input_dir / base_dir;
-
-  boost::filesystem::directory_iterator directory_it(cur_dir.GetString(), ec);
-  if (ec)
-    return;
-
-  while (directory_it != boost::filesystem::directory_iterator()) {
-    Path p = directory_it->path();
-
-    if (IsFile(p, ec) && std::regex_search(p.GetString(), filepath_regex)) {
-      files.emplace_back(base_dir / p.GetFilename());
-    } else if (recursive && IsDirectory(directory_it->path(), ec)) {
-      ListFilesRec(input_dir, base_dir / p.GetFilename(), recursive, filepath_regex, files, ec);
-    }
-
-    ++directory_it;
-  }
-}
-
 }  // ssf
@@ -2,7 +2,6 @@
 #define SSF_COMMON_FILESYSTEM_FILESYSTEM_H_
 
 #include <list>
-#include <regex>
 
 #include <boost/system/error_code.hpp>
 
@@ -30,16 +29,9 @@ class Filesystem {
 
   bool RemoveAll(const Path& path, boost::system::error_code& ec) const;
 
+  // Blocking listing, see FileWalker to process files as they are found
   std::list<Path> ListFiles(const Path& path, bool recursive,
                             boost::system::error_code& ec) const;
-
- private:
-  void ListFilesRec(const Path& input_dir,
-                    const Path& base_dir,
-                    bool recursive,
-                    const std::regex& filepath_regex,
-                    std::list<Path>& files,
-                    boost::system::error_code& ec) const;
 };
 
 }  // ssf
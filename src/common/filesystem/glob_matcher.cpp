@@ -0,0 +1,36 @@
+#include "common/filesystem/glob_matcher.h"
+
+namespace ssf {
+
+GlobMatcher::GlobMatcher(const std::string& pattern) : literals_() {
+  std::string literal;
+  for (char c : pattern) {
+    if (c == '*' || c == '?') {
+      if (!literal.empty()) {
+        literals_.push_back(literal);
+        literal.clear();
+      }
+    } else {
+      literal.push_back(c);
+    }
+  }
+  if (!literal.empty()) {
+    literals_.push_back(literal);
+  }
+}
+
+bool GlobMatcher::Match(const std::string& path) const {
+  // Every wildcard matches any sequence, so finding the leftmost occurrence
+  // of each literal is enough
+  std::string::size_type position = 0;
+  for (const auto& literal : literals_) {
+    position = path.find(literal, position);
+    if (position == std::string::npos) {
+      return false;
+    }
+    position += literal.size();
+  }
+  return true;
+}
+
+}  // ssf
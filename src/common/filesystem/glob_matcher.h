@@ -0,0 +1,26 @@
+#ifndef SSF_COMMON_FILESYSTEM_GLOB_MATCHER_H_
+#define SSF_COMMON_FILESYSTEM_GLOB_MATCHER_H_
+
+#include <string>
+#include <vector>
+
+namespace ssf {
+
+// Path pattern compiled once and matched against many paths
+//   '*' and '?' match any sequence of characters (path separators included),
+//   other characters match literally. Like a search, the pattern may match
+//   any part of the path.
+class GlobMatcher {
+ public:
+  explicit GlobMatcher(const std::string& pattern);
+
+  bool Match(const std::string& path) const;
+
+ private:
+  // literal parts of the pattern, found in order in a matching path
+  std::vector<std::string> literals_;
+};
+
+}  // ssf
+
+#endif  // SSF_COMMON_FILESYSTEM_GLOB_MATCHER_H_
@@ -1,5 +1,7 @@
 #include "core/client/client.h"
 
+#include <algorithm>
+
 #include <ssf/log/log.h>
 
 #include "common/error/error.h"
@@ -8,12 +10,20 @@
 
 namespace ssf {
 
-Client::Client()
-    : async_engine_(),
+Client::Client() : Client(nullptr) {}
+
+Client::Client(AsyncEngine* p_async_engine)
+    : p_own_async_engine_(p_async_engine ? nullptr : new AsyncEngine()),
+      p_async_engine_(p_async_engine ? p_async_engine
+                                     : p_own_async_engine_.get()),
+      initialized_(false),
       connection_attempts_(1),
       max_connection_attempts_(1),
       reconnection_timeout_(0),
-      timer_(async_engine_.get_io_service()),
+      timer_(p_async_engine_->get_io_service()),
+      sessions_count_(0),
+      session_id_(0),
+      next_session_id_(0),
       stopped_(false) {}
 
 Client::~Client() {
@@ -30,7 +40,7 @@ void Client::Init(const NetworkQuery& network_query,
                   OnUserServiceStatusCb on_user_service_status,
                   boost::system::error_code& ec) {
   SSF_LOG("client", debug, "init");
-  if (async_engine_.IsStarted()) {
+  if (initialized_) {
     ec.assign(::error::device_or_resource_busy, ::error::get_ssf_category());
     SSF_LOG("client", error, "already initialized");
     return;
@@ -51,12 +61,16 @@ void Client::Init(const NetworkQuery& network_query,
     return;
   }
 
-  async_engine_.Start();
+  initialized_ = true;
+  p_async_engine_->Start();
 }
 
 void Client::Deinit() {
   SSF_LOG("client", debug, "deinit");
-  async_engine_.Stop();
+  if (p_own_async_engine_) {
+    p_own_async_engine_->Stop();
+  }
+  initialized_ = false;
 }
 
 void Client::Run(boost::system::error_code& ec) { RunSession(ec); }
@@ -81,10 +95,17 @@ void Client::Stop(boost::system::error_code& ec) {
   timer_.cancel(ec);
   ec.clear();
 
+  std::unique_lock<std::recursive_mutex> lock(sessions_mutex_);
+  if (next_session_) {
+    boost::system::error_code next_session_ec;
+    next_session_->Stop(next_session_ec);
+    next_session_.reset();
+  }
   if (session_) {
     session_->Stop(ec);
     session_.reset();
   }
+  lock.unlock();
   if (ec) {
     SSF_LOG("client", debug, "error while closing session: {}", ec.message());
   }
@@ -93,11 +114,199 @@ void Client::Stop(boost::system::error_code& ec) {
 }
 
 boost::asio::io_service& Client::get_io_service() {
-  return async_engine_.get_io_service();
+  return p_async_engine_->get_io_service();
 }
 
-Client::UserServices Client::CreateUserServices(boost::system::error_code& ec) {
-  UserServices user_services;
+void Client::Reload(UserServiceParameters user_service_params,
+                    const ssf::config::Services& user_services_config,
+                    boost::system::error_code& ec) {
+  std::unique_lock<std::recursive_mutex> lock(sessions_mutex_);
+  if (stopped_) {
+    ec.assign(::error::operation_canceled, ::error::get_ssf_category());
+    return;
+  }
+
+  // check the new user services before touching the sessions
+  auto previous_params = user_service_params_;
+  user_service_params_ = std::move(user_service_params);
+  CreateUserServices(ec);
+  if (ec) {
+    SSF_LOG("client", error, "reload: invalid services, nothing changed");
+    user_service_params_ = std::move(previous_params);
+    return;
+  }
+
+  user_services_config_ = user_services_config;
+
+  UpdateSessionServices(session_, &session_services_, true);
+  UpdateSessionServices(next_session_, &next_session_services_, false);
+}
+
+void Client::AddUserService(const std::string& name,
+                            const UserServiceParameterBag& parameters,
+                            boost::system::error_code& ec) {
+  std::unique_lock<std::recursive_mutex> lock(sessions_mutex_);
+  if (stopped_) {
+    ec.assign(::error::operation_canceled, ::error::get_ssf_category());
+    return;
+  }
+
+  // check the parameters before touching the sessions
+  auto p_user_service =
+      user_service_factory_.CreateUserService(name, parameters, ec);
+  if (ec) {
+    return;
+  }
+
+  user_service_params_[name].push_back(parameters);
+
+  UserServiceKey key(name, parameters);
+  if (session_) {
+    session_services_.emplace_back(key, p_user_service);
+    session_->UpdateUserServices({p_user_service}, {});
+  }
+  if (next_session_) {
+    boost::system::error_code next_ec;
+    auto p_next_user_service =
+        user_service_factory_.CreateUserService(name, parameters, next_ec);
+    next_session_services_.emplace_back(key, p_next_user_service);
+    next_session_->UpdateUserServices({p_next_user_service}, {});
+  }
+}
+
+void Client::RemoveUserService(const std::string& name,
+                               const UserServiceParameterBag& parameters,
+                               boost::system::error_code& ec) {
+  std::unique_lock<std::recursive_mutex> lock(sessions_mutex_);
+  auto params_it = user_service_params_.find(name);
+  if (params_it == user_service_params_.end()) {
+    ec.assign(::error::service_not_found, ::error::get_ssf_category());
+    return;
+  }
+
+  auto& bags = params_it->second;
+  auto bag_it = std::find(bags.begin(), bags.end(), parameters);
+  if (bag_it == bags.end()) {
+    ec.assign(::error::service_not_found, ::error::get_ssf_category());
+    return;
+  }
+  bags.erase(bag_it);
+  if (bags.empty()) {
+    user_service_params_.erase(params_it);
+  }
+
+  UserServiceKey key(name, parameters);
+  RemoveSessionService(session_, &session_services_, key);
+  RemoveSessionService(next_session_, &next_session_services_, key);
+}
+
+std::vector<Client::UserServiceInfo> Client::GetUserServices() {
+  std::unique_lock<std::recursive_mutex> lock(sessions_mutex_);
+  std::vector<UserServiceInfo> user_services;
+  if (!session_) {
+    for (const auto& service : user_service_params_) {
+      for (const auto& parameters : service.second) {
+        user_services.push_back(
+            {service.first, parameters, UserServiceState::kPending});
+      }
+    }
+    return user_services;
+  }
+
+  for (const auto& session_service : session_services_) {
+    auto state = UserServiceState::kPending;
+    auto status_it = user_service_statuses_.find(session_service.second);
+    if (status_it != user_service_statuses_.end()) {
+      state = status_it->second ? UserServiceState::kFailed
+                                : UserServiceState::kRunning;
+    }
+    user_services.push_back(
+        {session_service.first.first, session_service.first.second, state});
+  }
+
+  return user_services;
+}
+
+void Client::RemoveSessionService(ClientSessionPtr session,
+                                  KeyedUserServices* p_session_services,
+                                  const UserServiceKey& key) {
+  if (!session) {
+    return;
+  }
+
+  auto service_it = std::find_if(
+      p_session_services->begin(), p_session_services->end(),
+      [&key](const KeyedUserServices::value_type& session_service) {
+        return session_service.first == key;
+      });
+  if (service_it == p_session_services->end()) {
+    return;
+  }
+
+  auto p_user_service = service_it->second;
+  p_session_services->erase(service_it);
+  user_service_statuses_.erase(p_user_service);
+  session->UpdateUserServices({}, {p_user_service});
+}
+
+void Client::ForgetUserServiceStatuses(const KeyedUserServices& user_services) {
+  for (const auto& user_service : user_services) {
+    user_service_statuses_.erase(user_service.second);
+  }
+}
+
+void Client::UpdateSessionServices(ClientSessionPtr session,
+                                   KeyedUserServices* p_session_services,
+                                   bool log_changes) {
+  if (!session) {
+    return;
+  }
+
+  boost::system::error_code ec;
+  auto wanted_services = CreateUserServices(ec);
+
+  // keep the running services still wanted, stop the others
+  KeyedUserServices kept_services;
+  UserServices removed;
+  for (auto& session_service : *p_session_services) {
+    auto wanted_it = std::find_if(
+        wanted_services.begin(), wanted_services.end(),
+        [&session_service](const KeyedUserServices::value_type& wanted) {
+          return wanted.first == session_service.first;
+        });
+    if (wanted_it == wanted_services.end()) {
+      removed.push_back(session_service.second);
+      user_service_statuses_.erase(session_service.second);
+      continue;
+    }
+
+    wanted_services.erase(wanted_it);
+    kept_services.push_back(session_service);
+  }
+
+  // start the remaining wanted services
+  UserServices added;
+  for (auto& wanted : wanted_services) {
+    added.push_back(wanted.second);
+    kept_services.push_back(wanted);
+  }
+
+  if (log_changes) {
+    SSF_LOG("client", info,
+            "reload: {} service(s) started, {} stopped, {} unchanged",
+            added.size(), removed.size(),
+            kept_services.size() - added.size());
+  }
+
+  *p_session_services = std::move(kept_services);
+  if (!added.empty() || !removed.empty()) {
+    session->UpdateUserServices(added, removed);
+  }
+}
+
+Client::KeyedUserServices Client::CreateUserServices(
+    boost::system::error_code& ec) {
+  KeyedUserServices user_services;
   // create CLI services (socks, port forwarding)
   for (const auto& service : user_service_params_) {
     for (const auto& service_param : service.second) {
@@ -105,7 +314,8 @@ Client::UserServices Client::CreateUserServices(boost::system::error_code& ec) {
       auto user_service = user_service_factory_.CreateUserService(
           service.first, service_param, parse_ec);
       if (!parse_ec) {
-        user_services.push_back(user_service);
+        user_services.emplace_back(
+            UserServiceKey(service.first, service_param), user_service);
       } else {
         SSF_LOG("client", error, "invalid option value for service<{}> ({})",
                 service.first, parse_ec.message());
@@ -119,7 +329,7 @@ Client::UserServices Client::CreateUserServices(boost::system::error_code& ec) {
 
 void Client::AsyncWaitReconnection() {
   if (connection_attempts_ > max_connection_attempts_ || no_reconnection_) {
-    async_engine_.get_io_service().post([this]() {
+    p_async_engine_->get_io_service().post([this]() {
       boost::system::error_code stop_ec;
       Stop(stop_ec);
     });
@@ -137,7 +347,7 @@ void Client::RunSession(const boost::system::error_code& ec) {
   {
     std::lock_guard<std::mutex> lock(stop_mutex_);
     if (ec || stopped_ || connection_attempts_ > max_connection_attempts_) {
-      async_engine_.get_io_service().post([this]() {
+      p_async_engine_->get_io_service().post([this]() {
         boost::system::error_code stop_ec;
         Stop(stop_ec);
       });
@@ -150,13 +360,45 @@ void Client::RunSession(const boost::system::error_code& ec) {
 
   ++connection_attempts_;
 
+  std::unique_lock<std::recursive_mutex> lock(sessions_mutex_);
   boost::system::error_code create_session_ec;
-  auto user_services = CreateUserServices(create_session_ec);
+  auto session_id = ++sessions_count_;
+  KeyedUserServices session_services;
+  auto session = CreateSession(session_id, &session_services,
+                               create_session_ec);
+  if (create_session_ec) {
+    return;
+  }
+
+  session_id_ = session_id;
+  session_ = session;
+  ForgetUserServiceStatuses(session_services_);
+  session_services_ = std::move(session_services);
+
+  session->Start(network_query_, create_session_ec);
   if (create_session_ec) {
+    boost::system::error_code stop_ec;
+    session->Stop(stop_ec);
     return;
   }
+}
+
+Client::ClientSessionPtr Client::CreateSession(
+    uint64_t session_id, KeyedUserServices* p_session_services,
+    boost::system::error_code& ec) {
+  *p_session_services = CreateUserServices(ec);
+  if (ec) {
+    return nullptr;
+  }
+
+  UserServices user_services;
+  for (auto& session_service : *p_session_services) {
+    user_services.push_back(session_service.second);
+  }
 
-  auto on_session_status = [this](Status status) { OnSessionStatus(status); };
+  auto on_session_status = [this, session_id](Status status) {
+    OnSessionStatus(session_id, status);
+  };
 
   auto on_user_service_status = [this](UserServicePtr user_service,
                                        const boost::system::error_code& ec) {
@@ -164,26 +406,30 @@ void Client::RunSession(const boost::system::error_code& ec) {
   };
 
   auto session = ClientSession::Create(
-      async_engine_.get_io_service(), user_services, user_services_config_,
-      on_session_status, on_user_service_status, create_session_ec);
-
-  if (create_session_ec) {
-    return;
+      p_async_engine_->get_io_service(), user_services, user_services_config_,
+      on_session_status, on_user_service_status, ec);
+  if (ec) {
+    return nullptr;
   }
 
-  session_ = session;
-
-  session->Start(network_query_, create_session_ec);
-  if (create_session_ec) {
-    boost::system::error_code stop_ec;
-    session->Stop(stop_ec);
-    return;
-  }
+  return session;
 }
 
-void Client::OnSessionStatus(Status status) {
+void Client::OnSessionStatus(uint64_t session_id, Status status) {
   boost::system::error_code stop_ec;
 
+  {
+    std::unique_lock<std::recursive_mutex> lock(sessions_mutex_);
+    if (next_session_ && session_id == next_session_id_) {
+      OnNextSessionStatus(status);
+      return;
+    }
+    if (session_id != session_id_) {
+      // Closed session
+      return;
+    }
+  }
+
   on_status_(status);
 
   if (stopped_) {
@@ -219,6 +465,9 @@ void Client::OnSessionStatus(Status status) {
       if (session_) {
         session_->Stop(stop_ec);
       }
+      if (ResumeNextSession()) {
+        break;
+      }
       AsyncWaitReconnection();
       break;
     case Status::kRunning:
@@ -226,11 +475,86 @@ void Client::OnSessionStatus(Status status) {
       connection_attempts_ = 1;
       SSF_LOG("client", info, "running");
       break;
+    case Status::kDraining:
+      RunNextSession();
+      break;
     default:
       break;
   }
 }
 
+void Client::OnNextSessionStatus(Status status) {
+  boost::system::error_code stop_ec;
+
+  switch (status) {
+    case Status::kConnected:
+      SSF_LOG("client", info, "next connection ready");
+      break;
+    case Status::kEndpointNotResolvable:
+    case Status::kServerUnreachable:
+    case Status::kServerNotSupported:
+    case Status::kDisconnected:
+      // Reconnect as usual once the current session is closed
+      SSF_LOG("client", info, "next connection failed");
+      next_session_->Stop(stop_ec);
+      next_session_.reset();
+      break;
+    default:
+      break;
+  }
+}
+
+// Open the next connection while the server drains the current one
+//   The next session is held after the SSF handshake so that the user
+//   services are only started once the current session is closed
+void Client::RunNextSession() {
+  std::unique_lock<std::recursive_mutex> lock(sessions_mutex_);
+  if (next_session_ || stopped_) {
+    return;
+  }
+
+  SSF_LOG("client", info, "server draining, opening the next connection");
+
+  boost::system::error_code create_session_ec;
+  auto session_id = ++sessions_count_;
+  KeyedUserServices session_services;
+  auto session = CreateSession(session_id, &session_services,
+                               create_session_ec);
+  if (create_session_ec) {
+    return;
+  }
+
+  session->Hold();
+  next_session_id_ = session_id;
+  next_session_ = session;
+  next_session_services_ = std::move(session_services);
+
+  session->Start(network_query_, create_session_ec);
+  if (create_session_ec && next_session_) {
+    boost::system::error_code stop_ec;
+    next_session_->Stop(stop_ec);
+    next_session_.reset();
+  }
+}
+
+bool Client::ResumeNextSession() {
+  std::unique_lock<std::recursive_mutex> lock(sessions_mutex_);
+  if (!next_session_) {
+    return false;
+  }
+
+  SSF_LOG("client", info, "switching to the next connection");
+  session_id_ = next_session_id_;
+  session_ = next_session_;
+  ForgetUserServiceStatuses(session_services_);
+  session_services_ = std::move(next_session_services_);
+  next_session_.reset();
+  next_session_services_.clear();
+  session_->Resume();
+
+  return true;
+}
+
 void Client::OnUserServiceStatus(UserServicePtr user_service,
                                  const boost::system::error_code& ec) {
   if (user_service == nullptr) {
@@ -242,6 +566,11 @@ void Client::OnUserServiceStatus(UserServicePtr user_service,
   } else {
     SSF_LOG("client", info, "service <{}> OK", user_service->GetName());
   }
+
+  {
+    std::unique_lock<std::recursive_mutex> lock(sessions_mutex_);
+    user_service_statuses_[user_service] = ec;
+  }
   on_user_service_status_(user_service, ec);
 }
 
@@ -1,13 +1,18 @@
 #ifndef SSF_CORE_CLIENT_CLIENT_H_
 #define SSF_CORE_CLIENT_CLIENT_H_
 
+#include <cstdint>
+
 #include <chrono>
 #include <condition_variable>
 #include <functional>
 #include <future>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <boost/asio/io_service.hpp>
 #include <boost/asio/signal_set.hpp>
@@ -39,13 +44,31 @@ class Client {
   using UserServiceFactory = ssf::UserServiceFactory<Demux>;
   using UserServicePtr = UserServiceFactory::UserServicePtr;
   using UserServices = std::vector<UserServicePtr>;
+  // User service with the parameters which created it
+  using UserServiceKey = std::pair<std::string, UserServiceParameterBag>;
+  using KeyedUserServices =
+      std::vector<std::pair<UserServiceKey, UserServicePtr>>;
 
   using OnStatusCb = ClientSession::OnStatusCb;
   using OnUserServiceStatusCb = ClientSession::OnUserServiceStatusCb;
 
+  enum class UserServiceState { kPending, kRunning, kFailed };
+
+  // User service of the current session
+  struct UserServiceInfo {
+    std::string name;
+    UserServiceParameterBag parameters;
+    UserServiceState state;
+  };
+
  public:
   Client();
 
+  // Run the sessions on a shared engine (several clients in one process)
+  //   The engine is not stopped by Deinit, it must be stopped before the
+  //   client is destroyed.
+  explicit Client(AsyncEngine* p_async_engine);
+
   ~Client();
 
   template <class UserService>
@@ -70,6 +93,28 @@ class Client {
 
   void Stop(boost::system::error_code& ec);
 
+  // Apply new user services parameters to the running sessions
+  //   Only the added and removed user services are started and stopped, the
+  //   others keep running. The microservices configuration applies to the
+  //   next sessions.
+  void Reload(UserServiceParameters user_service_params,
+              const ssf::config::Services& user_services_config,
+              boost::system::error_code& ec);
+
+  // Start a user service on the running sessions and the next ones
+  void AddUserService(const std::string& name,
+                      const UserServiceParameterBag& parameters,
+                      boost::system::error_code& ec);
+
+  // Stop a user service started with the same name and parameters
+  void RemoveUserService(const std::string& name,
+                         const UserServiceParameterBag& parameters,
+                         boost::system::error_code& ec);
+
+  // User services of the current session (or the wanted ones while
+  // reconnecting)
+  std::vector<UserServiceInfo> GetUserServices();
+
   ClientSessionPtr GetSession(boost::system::error_code& ec) {
     if (!session_) {
       ec.assign(::error::broken_pipe, ::error::get_ssf_category());
@@ -81,15 +126,30 @@ class Client {
   boost::asio::io_service& get_io_service();
 
  private:
-  UserServices CreateUserServices(boost::system::error_code& ec);
+  KeyedUserServices CreateUserServices(boost::system::error_code& ec);
+  void UpdateSessionServices(ClientSessionPtr session,
+                             KeyedUserServices* p_session_services,
+                             bool log_changes);
+  void RemoveSessionService(ClientSessionPtr session,
+                            KeyedUserServices* p_session_services,
+                            const UserServiceKey& key);
+  void ForgetUserServiceStatuses(const KeyedUserServices& user_services);
   void AsyncWaitReconnection();
   void RunSession(const boost::system::error_code& ec);
-  void OnSessionStatus(Status status);
+  ClientSessionPtr CreateSession(uint64_t session_id,
+                                 KeyedUserServices* p_session_services,
+                                 boost::system::error_code& ec);
+  void OnSessionStatus(uint64_t session_id, Status status);
+  void OnNextSessionStatus(Status status);
+  void RunNextSession();
+  bool ResumeNextSession();
   void OnUserServiceStatus(UserServicePtr user_service,
                            const boost::system::error_code& ec);
 
  private:
-  AsyncEngine async_engine_;
+  std::unique_ptr<AsyncEngine> p_own_async_engine_;
+  AsyncEngine* p_async_engine_;
+  bool initialized_;
   NetworkQuery network_query_;
   UserServiceFactory user_service_factory_;
   UserServiceParameters user_service_params_;
@@ -101,7 +161,17 @@ class Client {
   OnStatusCb on_status_;
   OnUserServiceStatusCb on_user_service_status_;
   boost::asio::steady_timer timer_;
+  std::recursive_mutex sessions_mutex_;
+  uint64_t sessions_count_;
+  uint64_t session_id_;
   ClientSessionPtr session_;
+  KeyedUserServices session_services_;
+  // Session opened while the server drains, resumed when session_ is closed
+  uint64_t next_session_id_;
+  ClientSessionPtr next_session_;
+  KeyedUserServices next_session_services_;
+  // Last status of the user services of the sessions
+  std::map<UserServicePtr, boost::system::error_code> user_service_statuses_;
   std::condition_variable cv_wait_stop_;
   std::mutex stop_mutex_;
   bool stopped_;
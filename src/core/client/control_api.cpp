@@ -0,0 +1,550 @@
+#include "core/client/control_api.h"
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+#include <sys/stat.h>
+#endif
+
+#include <cerrno>
+#include <cstring>
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/read_until.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/streambuf.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/filesystem.hpp>
+
+#include <ssf/log/log.h>
+
+#include "common/error/error.h"
+
+namespace ssf {
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+
+// Requests and replies of one controller
+class ControlApi::Connection
+    : public std::enable_shared_from_this<Connection> {
+ public:
+  enum {
+    kMaxRequestSize = 64 * 1024,
+    // A controller which does not read its replies is disconnected
+    kMaxPendingRepliesSize = 4 * 1024 * 1024,
+    kDefaultWatchInterval = 1000,
+    kMinWatchInterval = 10
+  };
+
+ public:
+  Connection(ControlApiPtr p_api, boost::asio::io_service& io_service)
+      : p_api_(std::move(p_api)),
+        socket_(io_service),
+        request_buffer_(kMaxRequestSize),
+        mutex_(),
+        pending_replies_(),
+        sending_replies_(),
+        writing_(false),
+        closed_(false),
+        watch_timer_(io_service),
+        watch_interval_(0) {}
+
+  Socket& socket() { return socket_; }
+
+  void Start() { AsyncReadRequest(); }
+
+  // Queue a JSON line, the queued lines are sent in one write
+  void Send(const Json& message) {
+    std::unique_lock<std::recursive_mutex> lock(mutex_);
+    if (closed_) {
+      return;
+    }
+
+    pending_replies_ += message.dump();
+    pending_replies_ += '\n';
+    if (pending_replies_.size() > kMaxPendingRepliesSize) {
+      SSF_LOG("control_api", warn, "controller does not read its replies");
+      Close();
+      return;
+    }
+
+    if (!writing_) {
+      SendPending();
+    }
+  }
+
+  void Watch(std::chrono::milliseconds interval) {
+    std::unique_lock<std::recursive_mutex> lock(mutex_);
+    watch_interval_ = interval;
+    boost::system::error_code ec;
+    watch_timer_.cancel(ec);
+    AsyncWaitWatch();
+  }
+
+  void Unwatch() {
+    std::unique_lock<std::recursive_mutex> lock(mutex_);
+    watch_interval_ = std::chrono::milliseconds(0);
+    boost::system::error_code ec;
+    watch_timer_.cancel(ec);
+  }
+
+  void Close() {
+    std::unique_lock<std::recursive_mutex> lock(mutex_);
+    if (closed_) {
+      return;
+    }
+    closed_ = true;
+
+    boost::system::error_code ec;
+    watch_timer_.cancel(ec);
+    socket_.shutdown(boost::asio::socket_base::shutdown_both, ec);
+    socket_.close(ec);
+  }
+
+ private:
+  void AsyncReadRequest() {
+    auto self = shared_from_this();
+    boost::asio::async_read_until(
+        socket_, request_buffer_, '\n',
+        [this, self](const boost::system::error_code& ec, std::size_t) {
+          OnRequests(ec);
+        });
+  }
+
+  // Execute every complete request line of the buffer before reading again
+  void OnRequests(const boost::system::error_code& ec) {
+    if (ec) {
+      if (ec == boost::asio::error::not_found) {
+        SSF_LOG("control_api", warn, "request too long");
+      }
+      p_api_->OnConnectionClosed(shared_from_this());
+      return;
+    }
+
+    auto self = shared_from_this();
+    while (true) {
+      auto data = request_buffer_.data();
+      auto p_data = boost::asio::buffer_cast<const char*>(data);
+      auto size = boost::asio::buffer_size(data);
+      auto p_end = static_cast<const char*>(std::memchr(p_data, '\n', size));
+      if (p_end == nullptr) {
+        break;
+      }
+
+      std::string line(p_data, p_end);
+      request_buffer_.consume(p_end - p_data + 1);
+      if (line.empty() || line == "\r") {
+        continue;
+      }
+
+      Json request;
+      try {
+        request = Json::parse(line);
+      } catch (const std::exception&) {
+        Send({{"ok", false}, {"error", "invalid request"}});
+        continue;
+      }
+      Send(p_api_->HandleRequest(self, request));
+    }
+
+    std::unique_lock<std::recursive_mutex> lock(mutex_);
+    if (!closed_) {
+      AsyncReadRequest();
+    }
+  }
+
+  void SendPending() {
+    writing_ = true;
+    sending_replies_.clear();
+    sending_replies_.swap(pending_replies_);
+
+    auto self = shared_from_this();
+    boost::asio::async_write(
+        socket_, boost::asio::buffer(sending_replies_),
+        [this, self](const boost::system::error_code& ec, std::size_t) {
+          std::unique_lock<std::recursive_mutex> lock(mutex_);
+          writing_ = false;
+          if (ec) {
+            Close();
+            return;
+          }
+          if (!closed_ && !pending_replies_.empty()) {
+            SendPending();
+          }
+        });
+  }
+
+  void AsyncWaitWatch() {
+    if (closed_ || watch_interval_.count() == 0) {
+      return;
+    }
+
+    auto self = shared_from_this();
+    watch_timer_.expires_from_now(watch_interval_);
+    watch_timer_.async_wait([this, self](const boost::system::error_code& ec) {
+      if (ec) {
+        return;
+      }
+
+      Send({{"event", "metrics"}, {"metrics", p_api_->Metrics(nullptr)}});
+      std::unique_lock<std::recursive_mutex> lock(mutex_);
+      AsyncWaitWatch();
+    });
+  }
+
+ private:
+  ControlApiPtr p_api_;
+  Socket socket_;
+  boost::asio::streambuf request_buffer_;
+
+  std::recursive_mutex mutex_;
+  std::string pending_replies_;
+  std::string sending_replies_;
+  bool writing_;
+  bool closed_;
+
+  boost::asio::steady_timer watch_timer_;
+  std::chrono::milliseconds watch_interval_;
+};
+
+#endif
+
+ControlApi::ControlApiPtr ControlApi::Create(
+    Client* p_client, const UserServiceOptionFactory* p_option_factory,
+    const std::string& path) {
+  return Create(std::vector<Client*>{p_client}, p_option_factory, path);
+}
+
+ControlApi::ControlApiPtr ControlApi::Create(
+    std::vector<Client*> clients,
+    const UserServiceOptionFactory* p_option_factory,
+    const std::string& path) {
+  return ControlApiPtr(
+      new ControlApi(std::move(clients), p_option_factory, path));
+}
+
+ControlApi::ControlApi(std::vector<Client*> clients,
+                       const UserServiceOptionFactory* p_option_factory,
+                       const std::string& path)
+    : clients_(std::move(clients)),
+      p_option_factory_(p_option_factory),
+      path_(path),
+      mutex_(),
+      stopped_(false)
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+      ,
+      acceptor_(clients_.front()->get_io_service()),
+      connections_()
+#endif
+{
+}
+
+ControlApi::~ControlApi() { Stop(); }
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+
+void ControlApi::Start(boost::system::error_code& ec) {
+  std::unique_lock<std::recursive_mutex> lock(mutex_);
+
+  // Replace the socket file of a dead client, refuse to steal a live one
+  boost::system::error_code fs_ec;
+  if (boost::filesystem::exists(path_, fs_ec)) {
+    Socket probe(clients_.front()->get_io_service());
+    boost::system::error_code probe_ec;
+    probe.connect(Protocol::endpoint(path_), probe_ec);
+    if (!probe_ec) {
+      SSF_LOG("control_api", error, "a client already listens on {}", path_);
+      ec.assign(::error::device_or_resource_busy, ::error::get_ssf_category());
+      return;
+    }
+    boost::filesystem::remove(path_, fs_ec);
+  }
+
+  acceptor_.open(Protocol(), ec);
+  if (!ec) {
+    acceptor_.bind(Protocol::endpoint(path_), ec);
+  }
+  if (!ec) {
+    // Only the owner may control the client, never listen without it
+    if (::chmod(path_.c_str(), S_IRUSR | S_IWUSR) != 0) {
+      ec.assign(errno, boost::system::system_category());
+      boost::filesystem::remove(path_, fs_ec);
+    }
+  }
+  if (!ec) {
+    acceptor_.listen(boost::asio::socket_base::max_connections, ec);
+  }
+  if (ec) {
+    SSF_LOG("control_api", error, "cannot listen on {} ({})", path_,
+            ec.message());
+    boost::system::error_code close_ec;
+    acceptor_.close(close_ec);
+    return;
+  }
+
+  SSF_LOG("control_api", info, "listening on {}", path_);
+  AsyncAccept();
+}
+
+void ControlApi::Stop() {
+  std::set<ConnectionPtr> connections;
+  {
+    std::unique_lock<std::recursive_mutex> lock(mutex_);
+    if (stopped_) {
+      return;
+    }
+    stopped_ = true;
+
+    boost::system::error_code ec;
+    if (acceptor_.is_open()) {
+      acceptor_.close(ec);
+      boost::filesystem::remove(path_, ec);
+    }
+    connections.swap(connections_);
+  }
+
+  for (auto& p_connection : connections) {
+    p_connection->Close();
+  }
+}
+
+void ControlApi::AsyncAccept() {
+  auto self = shared_from_this();
+  auto p_connection =
+      std::make_shared<Connection>(self, clients_.front()->get_io_service());
+  acceptor_.async_accept(
+      p_connection->socket(),
+      [this, self, p_connection](const boost::system::error_code& ec) {
+        if (ec) {
+          if (ec != boost::asio::error::operation_aborted) {
+            SSF_LOG("control_api", debug, "accept failed ({})", ec.message());
+          }
+          return;
+        }
+
+        std::unique_lock<std::recursive_mutex> lock(mutex_);
+        if (stopped_) {
+          p_connection->Close();
+          return;
+        }
+        connections_.insert(p_connection);
+        p_connection->Start();
+        AsyncAccept();
+      });
+}
+
+void ControlApi::OnConnectionClosed(ConnectionPtr p_connection) {
+  p_connection->Close();
+
+  std::unique_lock<std::recursive_mutex> lock(mutex_);
+  connections_.erase(p_connection);
+}
+
+ControlApi::Json ControlApi::HandleRequest(ConnectionPtr p_connection,
+                                           const Json& request) {
+  Json reply = Json::object();
+  if (!request.is_object()) {
+    reply["ok"] = false;
+    reply["error"] = "invalid request";
+    return reply;
+  }
+
+  auto id_it = request.find("id");
+  if (id_it != request.end()) {
+    reply["id"] = *id_it;
+  }
+
+  std::string op;
+  auto op_it = request.find("op");
+  if (op_it != request.end() && op_it->is_string()) {
+    op = op_it->get<std::string>();
+  }
+
+  boost::system::error_code ec;
+  if (op == "add" || op == "remove") {
+    auto p_client = GetRequestClient(request, false, ec);
+    if (!ec) {
+      UpdateUserService(p_client, request, op == "add", ec);
+    }
+  } else if (op == "list") {
+    auto p_client = GetRequestClient(request, true, ec);
+    if (!ec) {
+      reply["services"] = ListUserServices(p_client);
+    }
+  } else if (op == "metrics") {
+    auto p_client = GetRequestClient(request, true, ec);
+    if (!ec) {
+      reply["metrics"] = Metrics(p_client);
+    }
+  } else if (op == "watch") {
+    uint32_t interval = Connection::kDefaultWatchInterval;
+    auto interval_it = request.find("interval_ms");
+    if (interval_it != request.end() && interval_it->is_number_unsigned()) {
+      interval = std::max(interval_it->get<uint32_t>(),
+                          static_cast<uint32_t>(Connection::kMinWatchInterval));
+    }
+    p_connection->Watch(std::chrono::milliseconds(interval));
+  } else if (op == "unwatch") {
+    p_connection->Unwatch();
+  } else {
+    reply["ok"] = false;
+    reply["error"] = "unknown operation";
+    return reply;
+  }
+
+  reply["ok"] = !ec;
+  if (ec) {
+    reply["error"] = ec.message();
+  }
+  return reply;
+}
+
+Client* ControlApi::GetRequestClient(const Json& request, bool all_by_default,
+                                     boost::system::error_code& ec) {
+  auto session_it = request.find("session");
+  if (session_it == request.end()) {
+    return all_by_default ? nullptr : clients_.front();
+  }
+
+  if (!session_it->is_number_unsigned() ||
+      session_it->get<std::size_t>() >= clients_.size()) {
+    ec.assign(::error::invalid_argument, ::error::get_ssf_category());
+    return nullptr;
+  }
+  return clients_[session_it->get<std::size_t>()];
+}
+
+void ControlApi::UpdateUserService(Client* p_client, const Json& request,
+                                   bool add, boost::system::error_code& ec) {
+  auto service_it = request.find("service");
+  auto value_it = request.find("value");
+  if (service_it == request.end() || !service_it->is_string() ||
+      value_it == request.end() || !value_it->is_string()) {
+    ec.assign(::error::invalid_argument, ::error::get_ssf_category());
+    return;
+  }
+
+  std::string service_name;
+  auto parameters = p_option_factory_->ParseUserServiceParameters(
+      service_it->get<std::string>(), value_it->get<std::string>(),
+      &service_name, ec);
+  if (ec) {
+    return;
+  }
+
+  if (add) {
+    p_client->AddUserService(service_name, parameters, ec);
+  } else {
+    p_client->RemoveUserService(service_name, parameters, ec);
+  }
+  SSF_LOG("control_api", debug, "{} service <{}> ({})",
+          add ? "add" : "remove", service_name, ec.message());
+}
+
+ControlApi::Json ControlApi::ListUserServices(Client* p_client) {
+  Json services = Json::array();
+  for (std::size_t i = 0; i < clients_.size(); ++i) {
+    if (p_client != nullptr && p_client != clients_[i]) {
+      continue;
+    }
+
+    for (const auto& user_service : clients_[i]->GetUserServices()) {
+      std::string state;
+      switch (user_service.state) {
+        case Client::UserServiceState::kPending:
+          state = "pending";
+          break;
+        case Client::UserServiceState::kRunning:
+          state = "running";
+          break;
+        case Client::UserServiceState::kFailed:
+          state = "failed";
+          break;
+      }
+      Json service = {{"service", user_service.name},
+                      {"parameters", user_service.parameters},
+                      {"state", state}};
+      if (p_client == nullptr && clients_.size() > 1) {
+        service["session"] = i;
+      }
+      services.push_back(std::move(service));
+    }
+  }
+  return services;
+}
+
+ControlApi::Json ControlApi::Metrics(Client* p_client) {
+  if (p_client != nullptr) {
+    return SessionMetrics(p_client);
+  }
+  if (clients_.size() == 1) {
+    return SessionMetrics(clients_.front());
+  }
+
+  Json sessions = Json::array();
+  for (auto p_session_client : clients_) {
+    sessions.push_back(SessionMetrics(p_session_client));
+  }
+  return {{"sessions", std::move(sessions)}};
+}
+
+ControlApi::Json ControlApi::SessionMetrics(Client* p_client) {
+  Json metrics = Json::object();
+
+  uint64_t pending = 0;
+  uint64_t running = 0;
+  uint64_t failed = 0;
+  for (const auto& user_service : p_client->GetUserServices()) {
+    switch (user_service.state) {
+      case Client::UserServiceState::kPending:
+        ++pending;
+        break;
+      case Client::UserServiceState::kRunning:
+        ++running;
+        break;
+      case Client::UserServiceState::kFailed:
+        ++failed;
+        break;
+    }
+  }
+  metrics["services"] = {
+      {"pending", pending}, {"running", running}, {"failed", failed}};
+
+  boost::system::error_code session_ec;
+  auto p_session = p_client->GetSession(session_ec);
+  metrics["connected"] = !session_ec;
+  if (session_ec) {
+    return metrics;
+  }
+
+  auto& demux = p_session->GetDemux();
+  metrics["fibers"] = static_cast<uint64_t>(demux.connected_fibers());
+  auto p_quotas = demux.quotas();
+  if (p_quotas) {
+    metrics["buffered_bytes"] = p_quotas->buffered_bytes();
+    metrics["outbound_sockets"] = p_quotas->outbound_sockets();
+    metrics["rejected_fibers"] = p_quotas->rejected_fibers();
+    metrics["rejected_syns"] = p_quotas->rejected_syns();
+    metrics["throttled_fibers"] = p_quotas->throttled_fibers();
+    metrics["dropped_datagrams"] = p_quotas->dropped_datagrams();
+    metrics["rejected_outbound_sockets"] =
+        p_quotas->rejected_outbound_sockets();
+  }
+
+  return metrics;
+}
+
+#else
+
+void ControlApi::Start(boost::system::error_code& ec) {
+  SSF_LOG("control_api", error, "local sockets not supported");
+  ec.assign(::error::operation_not_supported, ::error::get_ssf_category());
+}
+
+void ControlApi::Stop() {}
+
+#endif
+
+}  // ssf
@@ -0,0 +1,115 @@
+#ifndef SSF_CORE_CLIENT_CONTROL_API_H_
+#define SSF_CORE_CLIENT_CONTROL_API_H_
+
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <json.hpp>
+
+#include "core/client/client.h"
+#include "core/command_line/user_service_option_factory.h"
+
+namespace ssf {
+
+// Local control API of a running client
+//   The API listens on a local (UNIX domain) socket. Each line sent by a
+//   controller is a JSON request and gets one JSON line as reply, in order:
+//     {"id": 1, "op": "add", "service": "L", "value": "9000:127.0.0.1:80"}
+//     {"id": 1, "ok": true}
+//   Operations:
+//     add, remove: start or stop a user service (same values as the command
+//                  line options) on the session and the next ones
+//     list:        user services and their state (pending, running, failed)
+//     metrics:     fiber and quota counters of the session
+//     watch:       stream {"event": "metrics", ...} lines every interval_ms
+//     unwatch:     stop the metrics stream
+//   An API may control several sessions (sessions of the config file). The
+//   optional "session" field gives the index of the session a request
+//   applies to (add and remove default to the first one). Without it, list
+//   tags each service with its session and metrics returns the counters of
+//   every session in a "sessions" array.
+//   Requests are pipelined: a controller may send many lines without waiting
+//   for the replies, which are batched in the socket writes.
+class ControlApi : public std::enable_shared_from_this<ControlApi> {
+ public:
+  using ControlApiPtr = std::shared_ptr<ControlApi>;
+  using Json = nlohmann::json;
+
+ public:
+  // p_client and p_option_factory must outlive the control API
+  static ControlApiPtr Create(Client* p_client,
+                              const UserServiceOptionFactory* p_option_factory,
+                              const std::string& path);
+
+  // One API over several sessions, clients must not be empty
+  static ControlApiPtr Create(std::vector<Client*> clients,
+                              const UserServiceOptionFactory* p_option_factory,
+                              const std::string& path);
+
+  ~ControlApi();
+
+  // Listen on the API path (a stale socket file is replaced)
+  void Start(boost::system::error_code& ec);
+
+  void Stop();
+
+ private:
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+  using Protocol = boost::asio::local::stream_protocol;
+  using Socket = Protocol::socket;
+
+  class Connection;
+  using ConnectionPtr = std::shared_ptr<Connection>;
+#endif
+
+ private:
+  ControlApi(std::vector<Client*> clients,
+             const UserServiceOptionFactory* p_option_factory,
+             const std::string& path);
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+  void AsyncAccept();
+
+  void OnConnectionClosed(ConnectionPtr p_connection);
+
+  // Execute one request and build its reply
+  Json HandleRequest(ConnectionPtr p_connection, const Json& request);
+
+  // Client selected by the "session" field of the request, null if the
+  // request applies to every session
+  Client* GetRequestClient(const Json& request, bool all_by_default,
+                           boost::system::error_code& ec);
+
+  void UpdateUserService(Client* p_client, const Json& request, bool add,
+                         boost::system::error_code& ec);
+
+  Json ListUserServices(Client* p_client);
+
+  Json Metrics(Client* p_client);
+
+  Json SessionMetrics(Client* p_client);
+#endif
+
+ private:
+  std::vector<Client*> clients_;
+  const UserServiceOptionFactory* p_option_factory_;
+  std::string path_;
+
+  std::recursive_mutex mutex_;
+  bool stopped_;
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+  Protocol::acceptor acceptor_;
+  std::set<ConnectionPtr> connections_;
+#endif
+};
+
+}  // ssf
+
+#endif  // SSF_CORE_CLIENT_CONTROL_API_H_
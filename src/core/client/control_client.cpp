@@ -0,0 +1,99 @@
+#include "core/client/control_client.h"
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/filesystem.hpp>
+
+#include <ssf/log/log.h>
+
+#include "common/error/error.h"
+
+#include "core/client/control_master.h"
+
+#include "services/copy/error_code.h"
+#include "services/copy/packet_helper.h"
+
+namespace ssf {
+
+bool CopyThroughControlMaster(const std::string& path,
+                              bool from_client_to_server,
+                              services::copy::CopyRequest req,
+                              boost::system::error_code& copy_ec,
+                              boost::system::error_code& ec) {
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+  using Protocol = boost::asio::local::stream_protocol;
+  using services::copy::ErrorCode;
+  using services::copy::Packet;
+
+  if (req.is_from_stdin) {
+    // stdin cannot be handed to the master
+    ec.assign(::error::operation_not_supported, ::error::get_ssf_category());
+    return false;
+  }
+
+  // The master does not share our working directory
+  auto& local_pattern =
+      from_client_to_server ? req.input_pattern : req.output_pattern;
+  auto absolute_pattern = boost::filesystem::absolute(local_pattern);
+  local_pattern = absolute_pattern.string();
+
+  boost::asio::io_service io_service;
+  Protocol::socket socket(io_service);
+  socket.connect(Protocol::endpoint(path), ec);
+  if (ec) {
+    SSF_LOG("control_client", debug, "no master on {} ({})", path,
+            ec.message());
+    return false;
+  }
+
+  Packet packet;
+  services::copy::PayloadToPacket(
+      ControlCopyRequest(from_client_to_server, req), &packet, ec);
+  if (!ec) {
+    boost::asio::write(socket, packet.GetConstBuf(), ec);
+  }
+  if (ec) {
+    SSF_LOG("control_client", debug, "cannot send copy request ({})",
+            ec.message());
+    return false;
+  }
+
+  // Once the request is sent, the copy result comes from the master
+  copy_ec.assign(ErrorCode::kNetworkError, services::copy::get_copy_category());
+
+  Packet reply;
+  boost::system::error_code read_ec;
+  boost::asio::read(socket, reply.GetHeaderMutBuf(), read_ec);
+  if (!read_ec && reply.payload_size() <= Packet::kMaxPayloadSize) {
+    boost::asio::read(socket, reply.GetPayloadMutBuf(), read_ec);
+  } else if (!read_ec) {
+    read_ec.assign(::error::protocol_error, ::error::get_ssf_category());
+  }
+  if (read_ec) {
+    SSF_LOG("control_client", error, "copy result not received ({})",
+            read_ec.message());
+    return true;
+  }
+
+  services::copy::CopyFinishedNotification notification;
+  boost::system::error_code convert_ec;
+  services::copy::PacketToPayload(reply, notification, convert_ec);
+  if (convert_ec || reply.type() != services::copy::PacketType::kCopyFinished) {
+    SSF_LOG("control_client", error, "invalid copy result");
+    return true;
+  }
+
+  SSF_LOG("control_client", info, "copy finished ({}/{} files copied)",
+          notification.files_count - notification.errors_count,
+          notification.files_count);
+  copy_ec.assign(notification.error_code, services::copy::get_copy_category());
+  return true;
+#else
+  ec.assign(::error::operation_not_supported, ::error::get_ssf_category());
+  return false;
+#endif
+}
+
+}  // ssf
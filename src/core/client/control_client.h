@@ -0,0 +1,24 @@
+#ifndef SSF_CORE_CLIENT_CONTROL_CLIENT_H_
+#define SSF_CORE_CLIENT_CONTROL_CLIENT_H_
+
+#include <string>
+
+#include <boost/system/error_code.hpp>
+
+#include "services/copy/packet/control.h"
+
+namespace ssf {
+
+// Run a copy over the session of the control master listening on path
+//   Blocks until the copy ends. Returns false if the master could not be
+//   reached (ec is set), the copy result being in copy_ec otherwise. Local
+//   paths of the request are made absolute.
+bool CopyThroughControlMaster(const std::string& path,
+                              bool from_client_to_server,
+                              services::copy::CopyRequest req,
+                              boost::system::error_code& copy_ec,
+                              boost::system::error_code& ec);
+
+}  // ssf
+
+#endif  // SSF_CORE_CLIENT_CONTROL_CLIENT_H_
@@ -0,0 +1,302 @@
+#include "core/client/control_master.h"
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+#include <sys/stat.h>
+#endif
+
+#include <cerrno>
+
+#include <boost/filesystem.hpp>
+
+#include <ssf/log/log.h>
+
+#include "common/error/error.h"
+
+#include "services/copy/copy_client.h"
+#include "services/copy/error_code.h"
+#include "services/copy/packet_helper.h"
+
+namespace ssf {
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+
+// Copy run on behalf of one ssfcp process
+class ControlMaster::CopyOperation {
+ public:
+  CopyOperation(SocketPtr p_socket, const ControlCopyRequest& request)
+      : p_socket(std::move(p_socket)),
+        request(request),
+        p_packet(std::make_shared<services::copy::Packet>()),
+        notification(0, 0, services::copy::ErrorCode::kUnknown),
+        finished(false) {}
+
+  SocketPtr p_socket;
+  ControlCopyRequest request;
+  services::copy::CopyClientPtr p_copy_client;
+  services::copy::PacketPtr p_packet;
+  services::copy::CopyFinishedNotification notification;
+  bool finished;
+};
+
+#endif
+
+ControlMaster::ControlMasterPtr ControlMaster::Create(Client* p_client,
+                                                      const std::string& path) {
+  return ControlMasterPtr(new ControlMaster(p_client, path));
+}
+
+ControlMaster::ControlMaster(Client* p_client, const std::string& path)
+    : p_client_(p_client),
+      path_(path),
+      mutex_(),
+      stopped_(false)
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+      ,
+      acceptor_(p_client->get_io_service()),
+      operations_(),
+      pending_copies_from_server_(),
+      copy_from_server_running_(false)
+#endif
+{
+}
+
+ControlMaster::~ControlMaster() { Stop(); }
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+
+void ControlMaster::Start(boost::system::error_code& ec) {
+  std::unique_lock<std::recursive_mutex> lock(mutex_);
+
+  // Replace the socket file of a dead master, refuse to steal a live one
+  boost::system::error_code fs_ec;
+  if (boost::filesystem::exists(path_, fs_ec)) {
+    Socket probe(p_client_->get_io_service());
+    boost::system::error_code probe_ec;
+    probe.connect(Protocol::endpoint(path_), probe_ec);
+    if (!probe_ec) {
+      SSF_LOG("control_master", error, "a master already listens on {}",
+              path_);
+      ec.assign(::error::device_or_resource_busy, ::error::get_ssf_category());
+      return;
+    }
+    boost::filesystem::remove(path_, fs_ec);
+  }
+
+  acceptor_.open(Protocol(), ec);
+  if (!ec) {
+    acceptor_.bind(Protocol::endpoint(path_), ec);
+  }
+  if (!ec) {
+    // Only the owner may use the session, never listen without it
+    if (::chmod(path_.c_str(), S_IRUSR | S_IWUSR) != 0) {
+      ec.assign(errno, boost::system::system_category());
+      boost::filesystem::remove(path_, fs_ec);
+    }
+  }
+  if (!ec) {
+    acceptor_.listen(boost::asio::socket_base::max_connections, ec);
+  }
+  if (ec) {
+    SSF_LOG("control_master", error, "cannot listen on {} ({})", path_,
+            ec.message());
+    boost::system::error_code close_ec;
+    acceptor_.close(close_ec);
+    return;
+  }
+
+  SSF_LOG("control_master", info, "listening on {}", path_);
+  AsyncAccept();
+}
+
+void ControlMaster::Stop() {
+  std::unique_lock<std::recursive_mutex> lock(mutex_);
+  if (stopped_) {
+    return;
+  }
+  stopped_ = true;
+
+  boost::system::error_code ec;
+  if (acceptor_.is_open()) {
+    acceptor_.close(ec);
+    boost::filesystem::remove(path_, ec);
+  }
+
+  for (auto& p_operation : operations_) {
+    if (p_operation->p_copy_client) {
+      p_operation->p_copy_client->Stop();
+    }
+    p_operation->p_socket->close(ec);
+  }
+  operations_.clear();
+  pending_copies_from_server_ = std::queue<CopyOperationPtr>();
+}
+
+void ControlMaster::AsyncAccept() {
+  auto self = shared_from_this();
+  auto p_socket = std::make_shared<Socket>(p_client_->get_io_service());
+  acceptor_.async_accept(
+      *p_socket, [this, self, p_socket](const boost::system::error_code& ec) {
+        if (ec) {
+          if (ec != boost::asio::error::operation_aborted) {
+            SSF_LOG("control_master", debug, "accept failed ({})",
+                    ec.message());
+          }
+          return;
+        }
+
+        auto p_packet = std::make_shared<services::copy::Packet>();
+        services::copy::AsyncReadPacket(
+            *p_socket, *p_packet,
+            [this, self, p_socket,
+             p_packet](const boost::system::error_code& ec) {
+              if (ec) {
+                SSF_LOG("control_master", debug, "cannot read request ({})",
+                        ec.message());
+                return;
+              }
+              OnRequest(p_socket, p_packet);
+            });
+
+        std::unique_lock<std::recursive_mutex> lock(mutex_);
+        if (!stopped_) {
+          AsyncAccept();
+        }
+      });
+}
+
+void ControlMaster::OnRequest(SocketPtr p_socket,
+                              services::copy::PacketPtr p_packet) {
+  using services::copy::ErrorCode;
+
+  ControlCopyRequest request;
+  boost::system::error_code convert_ec;
+  if (p_packet->type() != ControlCopyRequest::kType) {
+    convert_ec.assign(::error::protocol_error, ::error::get_ssf_category());
+  } else {
+    services::copy::PacketToPayload(*p_packet, request, convert_ec);
+  }
+
+  auto p_operation = std::make_shared<CopyOperation>(p_socket, request);
+  {
+    std::unique_lock<std::recursive_mutex> lock(mutex_);
+    if (stopped_) {
+      return;
+    }
+    operations_.insert(p_operation);
+  }
+
+  if (convert_ec) {
+    SSF_LOG("control_master", warn, "invalid copy request");
+    p_operation->notification.error_code = ErrorCode::kCopyRequestCorrupted;
+    OnCopyFinished(p_operation);
+    return;
+  }
+
+  boost::system::error_code session_ec;
+  auto p_session = p_client_->GetSession(session_ec);
+  if (session_ec) {
+    SSF_LOG("control_master", warn, "no session for copy request");
+    p_operation->notification.error_code = ErrorCode::kNetworkError;
+    OnCopyFinished(p_operation);
+    return;
+  }
+
+  auto self = shared_from_this();
+  auto on_file_status = [](services::copy::CopyContext* context,
+                           const boost::system::error_code& ec) {};
+  auto on_file_copied = [](services::copy::CopyContext* context,
+                           const boost::system::error_code& ec) {
+    SSF_LOG("control_master", debug, "data copied from {} to {} ({})",
+            context->GetInputFilepath().GetString(),
+            context->GetOutputFilepath().GetString(), ec.message());
+  };
+  auto on_copy_finished = [this, self, p_operation](
+      uint64_t files_count, uint64_t errors_count,
+      const boost::system::error_code& ec) {
+    p_operation->notification.files_count = files_count;
+    p_operation->notification.errors_count = errors_count;
+    p_operation->notification.error_code =
+        ec.category() == services::copy::get_copy_category()
+            ? ErrorCode(ec.value())
+            : ErrorCode::kNetworkError;
+    OnCopyFinished(p_operation);
+  };
+
+  boost::system::error_code create_ec;
+  p_operation->p_copy_client = services::copy::CopyClient::Create(
+      p_session, on_file_status, on_file_copied, on_copy_finished, create_ec);
+  if (create_ec) {
+    p_operation->notification.error_code = ErrorCode::kCopyInitializationFailed;
+    OnCopyFinished(p_operation);
+    return;
+  }
+
+  SSF_LOG("control_master", debug, "copy {} to {}",
+          request.req.input_pattern, request.req.output_pattern);
+
+  if (request.from_client_to_server) {
+    p_operation->p_copy_client->AsyncCopyToServer(request.req);
+  } else {
+    QueueCopyFromServer(p_operation);
+  }
+}
+
+void ControlMaster::QueueCopyFromServer(CopyOperationPtr p_operation) {
+  std::unique_lock<std::recursive_mutex> lock(mutex_);
+  if (p_operation) {
+    pending_copies_from_server_.push(std::move(p_operation));
+  }
+  if (copy_from_server_running_ || pending_copies_from_server_.empty()) {
+    return;
+  }
+
+  auto p_next = pending_copies_from_server_.front();
+  pending_copies_from_server_.pop();
+  copy_from_server_running_ = true;
+  p_next->p_copy_client->AsyncCopyFromServer(p_next->request.req);
+}
+
+void ControlMaster::OnCopyFinished(CopyOperationPtr p_operation) {
+  {
+    std::unique_lock<std::recursive_mutex> lock(mutex_);
+    if (p_operation->finished) {
+      return;
+    }
+    p_operation->finished = true;
+  }
+
+  auto self = shared_from_this();
+  auto on_sent = [this, self, p_operation](const boost::system::error_code&) {
+    boost::system::error_code close_ec;
+    p_operation->p_socket->close(close_ec);
+    if (p_operation->p_copy_client) {
+      p_operation->p_copy_client->Stop();
+    }
+
+    std::unique_lock<std::recursive_mutex> lock(mutex_);
+    operations_.erase(p_operation);
+    if (!p_operation->request.from_client_to_server &&
+        p_operation->p_copy_client) {
+      copy_from_server_running_ = false;
+      if (!stopped_) {
+        QueueCopyFromServer(nullptr);
+      }
+    }
+  };
+  services::copy::AsyncWritePayload(*p_operation->p_socket,
+                                    p_operation->notification,
+                                    p_operation->p_packet, on_sent);
+}
+
+#else
+
+void ControlMaster::Start(boost::system::error_code& ec) {
+  SSF_LOG("control_master", error, "local sockets not supported");
+  ec.assign(::error::operation_not_supported, ::error::get_ssf_category());
+}
+
+void ControlMaster::Stop() {}
+
+#endif
+
+}  // ssf
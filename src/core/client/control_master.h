@@ -0,0 +1,103 @@
+#ifndef SSF_CORE_CLIENT_CONTROL_MASTER_H_
+#define SSF_CORE_CLIENT_CONTROL_MASTER_H_
+
+#include <cstdint>
+
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <set>
+#include <string>
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <msgpack.hpp>
+
+#include "core/client/client.h"
+
+#include "services/copy/packet.h"
+#include "services/copy/packet/control.h"
+
+namespace ssf {
+
+// Copy requested by a ssfcp process to the control master
+struct ControlCopyRequest {
+  static const services::copy::PacketType kType =
+      services::copy::PacketType::kCopyRequest;
+
+  ControlCopyRequest() : from_client_to_server(true), req() {}
+
+  ControlCopyRequest(bool i_from_client_to_server,
+                     const services::copy::CopyRequest& i_req)
+      : from_client_to_server(i_from_client_to_server), req(i_req) {}
+
+  bool from_client_to_server;
+  services::copy::CopyRequest req;
+
+  MSGPACK_DEFINE(from_client_to_server, req)
+};
+
+// Shares the session of a running client with local ssfcp processes
+//   The master listens on a local (UNIX domain) socket. Each connection
+//   carries one ControlCopyRequest, the copy runs over the session fibers and
+//   a CopyFinishedNotification is sent back. Local paths must be absolute
+//   since the master does not share the working directory of the requester.
+class ControlMaster : public std::enable_shared_from_this<ControlMaster> {
+ public:
+  using ControlMasterPtr = std::shared_ptr<ControlMaster>;
+
+ public:
+  // p_client must outlive the control master
+  static ControlMasterPtr Create(Client* p_client, const std::string& path);
+
+  ~ControlMaster();
+
+  // Listen on the control path (a stale socket file is replaced)
+  void Start(boost::system::error_code& ec);
+
+  void Stop();
+
+ private:
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+  using Protocol = boost::asio::local::stream_protocol;
+  using Socket = Protocol::socket;
+  using SocketPtr = std::shared_ptr<Socket>;
+
+  class CopyOperation;
+  using CopyOperationPtr = std::shared_ptr<CopyOperation>;
+#endif
+
+ private:
+  ControlMaster(Client* p_client, const std::string& path);
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+  void AsyncAccept();
+
+  void OnRequest(SocketPtr p_socket, services::copy::PacketPtr p_packet);
+
+  // Copies from the server are run one at a time: the file acceptor of the
+  // copy client is bound on a fixed fiber port
+  void QueueCopyFromServer(CopyOperationPtr p_operation);
+
+  void OnCopyFinished(CopyOperationPtr p_operation);
+#endif
+
+ private:
+  Client* p_client_;
+  std::string path_;
+
+  std::recursive_mutex mutex_;
+  bool stopped_;
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+  Protocol::acceptor acceptor_;
+  std::set<CopyOperationPtr> operations_;
+  std::queue<CopyOperationPtr> pending_copies_from_server_;
+  bool copy_from_server_running_;
+#endif
+};
+
+}  // ssf
+
+#endif  // SSF_CORE_CLIENT_CONTROL_MASTER_H_
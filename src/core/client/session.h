@@ -1,8 +1,12 @@
 #ifndef SSF_CORE_CLIENT_SESSION_H_
 #define SSF_CORE_CLIENT_SESSION_H_
 
+#include <cstdint>
+
+#include <chrono>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 #include <boost/system/error_code.hpp>
@@ -13,6 +17,7 @@
 #include "core/client/status.h"
 #include "core/service_manager/service_manager.h"
 
+#include "services/admin/admin.h"
 #include "services/user_services/base_user_service.h"
 
 namespace ssf {
@@ -52,6 +57,18 @@ class Session
 
   void Stop(boost::system::error_code& ec);
 
+  // Keep the connection after the SSF handshake until Resume is called
+  //   (e.g. to open the next connection while a server drains)
+  void Hold();
+
+  // Start the microservices of a held session
+  void Resume();
+
+  // Start the added user services and stop the removed ones without
+  // closing the connection
+  void UpdateUserServices(const std::vector<BaseUserServicePtr>& added,
+                          const std::vector<BaseUserServicePtr>& removed);
+
   Demux& GetDemux() { return fiber_demux_; }
 
   bool is_stopped() { return stopped_; }
@@ -72,8 +89,13 @@ class Session
 
   void OnDemuxClose();
 
+  void OnServerDrain(uint32_t deadline);
+
   void UpdateStatus(Status status);
 
+  // Log the time elapsed since Start for a startup step
+  void LogStartupStep(const char* step);
+
  private:
   boost::asio::io_service& io_service_;
   NetworkSocketPtr p_socket_;
@@ -82,6 +104,11 @@ class Session
   ServiceManagerPtr<Demux> p_service_manager_;
   Demux fiber_demux_;
   bool stopped_;
+  std::recursive_mutex hold_mutex_;
+  bool hold_;
+  bool handshake_done_;
+  std::weak_ptr<services::admin::Admin<Demux>> p_admin_service_;
+  std::chrono::steady_clock::time_point start_time_;
   Status status_;
   OnStatusCb on_status_;
   OnUserServiceStatusCb on_user_service_status_;
@@ -1,12 +1,14 @@
 #ifndef SSF_CORE_CLIENT_SESSION_IPP_
 #define SSF_CORE_CLIENT_SESSION_IPP_
 
+#include <algorithm>
+
 #include "common/error/error.h"
 
 #include "core/factories/service_factory.h"
 
-#include "services/admin/admin.h"
 #include "services/admin/requests/create_service_request.h"
+#include "services/admin/requests/drain_notice.h"
 #include "services/admin/requests/service_status.h"
 #include "services/admin/requests/stop_service_request.h"
 
@@ -47,6 +49,11 @@ Session<N, T>::Session(boost::asio::io_service& io_service,
       services_config_(services_config),
       fiber_demux_(io_service),
       stopped_(false),
+      hold_mutex_(),
+      hold_(false),
+      handshake_done_(false),
+      p_admin_service_(),
+      start_time_(std::chrono::steady_clock::now()),
       status_(Status::kInitialized),
       on_status_(on_status),
       on_user_service_status_(on_user_service_status) {}
@@ -59,6 +66,8 @@ Session<N, T>::~Session() {
 template <class N, template <class> class T>
 void Session<N, T>::Start(const NetworkQuery& query,
                           boost::system::error_code& ec) {
+  start_time_ = std::chrono::steady_clock::now();
+
   // create network socket
   p_socket_ = std::make_shared<NetworkSocket>(io_service_);
 
@@ -73,6 +82,8 @@ void Session<N, T>::Start(const NetworkQuery& query,
     UpdateStatus(Status::kEndpointNotResolvable);
     return;
   }
+  // Resolving builds the layer stack (TLS context included)
+  LogStartupStep("endpoint resolved");
 
   // async connect to given endpoint
   auto self = this->shared_from_this();
@@ -112,6 +123,54 @@ void Session<N, T>::Stop(boost::system::error_code& ec) {
   }
 }
 
+template <class N, template <class> class T>
+void Session<N, T>::Hold() {
+  std::unique_lock<std::recursive_mutex> lock(hold_mutex_);
+  hold_ = true;
+}
+
+template <class N, template <class> class T>
+void Session<N, T>::Resume() {
+  auto self = this->shared_from_this();
+  io_service_.post([this, self]() {
+    std::unique_lock<std::recursive_mutex> lock(hold_mutex_);
+    if (!hold_) {
+      return;
+    }
+    hold_ = false;
+    if (!handshake_done_ || stopped_) {
+      // DoSSFStart will go on
+      return;
+    }
+
+    SSF_LOG("client_session", debug, "resume");
+    boost::system::error_code fiberize_ec;
+    DoFiberize(fiberize_ec);
+    if (fiberize_ec) {
+      UpdateStatus(Status::kServerNotSupported);
+    }
+  });
+}
+
+template <class N, template <class> class T>
+void Session<N, T>::UpdateUserServices(
+    const std::vector<BaseUserServicePtr>& added,
+    const std::vector<BaseUserServicePtr>& removed) {
+  std::unique_lock<std::recursive_mutex> lock(hold_mutex_);
+  for (auto& p_user_service : removed) {
+    user_services_.erase(std::remove(user_services_.begin(),
+                                     user_services_.end(), p_user_service),
+                         user_services_.end());
+  }
+  user_services_.insert(user_services_.end(), added.begin(), added.end());
+
+  // Not fiberized yet: the admin service will start the new list
+  auto p_admin_service = p_admin_service_.lock();
+  if (p_admin_service) {
+    p_admin_service->UpdateUserServices(added, removed);
+  }
+}
+
 template <class N, template <class> class T>
 void Session<N, T>::NetworkToTransport(const boost::system::error_code& ec) {
   if (ec) {
@@ -122,6 +181,7 @@ void Session<N, T>::NetworkToTransport(const boost::system::error_code& ec) {
   }
 
   UpdateStatus(Status::kConnected);
+  LogStartupStep("transport connected");
   auto self = this->shared_from_this();
   auto on_ssf_initiate = [this, self](NetworkSocket& socket,
                                       const boost::system::error_code& ec) {
@@ -141,6 +201,16 @@ void Session<N, T>::DoSSFStart(const boost::system::error_code& ec) {
   }
 
   SSF_LOG("client_session", trace, "SSF reply ok");
+  LogStartupStep("SSF handshake done");
+  {
+    std::unique_lock<std::recursive_mutex> lock(hold_mutex_);
+    handshake_done_ = true;
+    if (hold_) {
+      SSF_LOG("client_session", debug, "held until resumed");
+      return;
+    }
+  }
+
   boost::system::error_code fiberize_ec;
   DoFiberize(fiberize_ec);
   if (fiberize_ec) {
@@ -161,21 +231,35 @@ void Session<N, T>::DoFiberize(boost::system::error_code& ec) {
   auto p_service_factory = ServiceFactory<Demux>::Create(
       io_service_, fiber_demux_, p_service_manager_);
 
-  // Register supported micro services
-  services::socks::SocksServer<Demux>::RegisterToServiceFactory(
-      p_service_factory, services_config_.socks());
-  services::fibers_to_sockets::FibersToSockets<Demux>::RegisterToServiceFactory(
-      p_service_factory, services_config_.stream_forwarder());
-  services::sockets_to_fibers::SocketsToFibers<Demux>::RegisterToServiceFactory(
-      p_service_factory, services_config_.stream_listener());
-  services::fibers_to_datagrams::FibersToDatagrams<
-      Demux>::RegisterToServiceFactory(p_service_factory,
-                                       services_config_.datagram_forwarder());
-  services::datagrams_to_fibers::DatagramsToFibers<
-      Demux>::RegisterToServiceFactory(p_service_factory,
-                                       services_config_.datagram_listener());
-  services::process::Server<Demux>::RegisterToServiceFactory(
-      p_service_factory, services_config_.process());
+  // The factory outlives the session until the demux is closed
+  std::weak_ptr<Session> p_weak_session(self);
+  p_service_factory->SetOnServerDrain([p_weak_session](uint32_t deadline) {
+    if (auto p_session = p_weak_session.lock()) {
+      p_session->OnServerDrain(deadline);
+    }
+  });
+
+  // Register supported micro services when the server first requests one
+  auto services_config = services_config_;
+  p_service_factory->RegisterOnFirstUse(
+      [services_config](std::shared_ptr<ServiceFactory<Demux>> p_factory) {
+        services::socks::SocksServer<Demux>::RegisterToServiceFactory(
+            p_factory, services_config.socks());
+        services::fibers_to_sockets::FibersToSockets<
+            Demux>::RegisterToServiceFactory(
+            p_factory, services_config.stream_forwarder());
+        services::sockets_to_fibers::SocketsToFibers<
+            Demux>::RegisterToServiceFactory(
+            p_factory, services_config.stream_listener());
+        services::fibers_to_datagrams::FibersToDatagrams<
+            Demux>::RegisterToServiceFactory(
+            p_factory, services_config.datagram_forwarder());
+        services::datagrams_to_fibers::DatagramsToFibers<
+            Demux>::RegisterToServiceFactory(
+            p_factory, services_config.datagram_listener());
+        services::process::Server<Demux>::RegisterToServiceFactory(
+            p_factory, services_config.process());
+      });
 
   // Create admin microservice
   auto on_user_service_status = [this, self](
@@ -184,13 +268,18 @@ void Session<N, T>::DoFiberize(boost::system::error_code& ec) {
   };
 
   auto on_initialization = [this, self](const boost::system::error_code& ec) {
+    LogStartupStep("user services initialized");
     UpdateStatus(Status::kRunning);
   };
 
   auto p_admin_service =
       services::admin::Admin<Demux>::Create(io_service_, fiber_demux_, {});
-  p_admin_service->SetAsClient(user_services_, on_user_service_status,
-                               on_initialization);
+  {
+    std::unique_lock<std::recursive_mutex> lock(hold_mutex_);
+    p_admin_service->SetAsClient(user_services_, on_user_service_status,
+                                 on_initialization);
+    p_admin_service_ = p_admin_service;
+  }
 
   // Register supported admin microservice commands
   if (!p_admin_service->template RegisterCommand<
@@ -214,6 +303,13 @@ void Session<N, T>::DoFiberize(boost::system::error_code& ec) {
     ec.assign(::error::service_not_started, ::error::get_ssf_category());
     return;
   }
+  if (!p_admin_service
+           ->template RegisterCommand<services::admin::DrainNotice>()) {
+    SSF_LOG("client_session", error,
+            "cannot register DrainNotice into admin service");
+    ec.assign(::error::service_not_started, ::error::get_ssf_category());
+    return;
+  }
   // Start admin microservice
   p_service_manager_->start(p_admin_service, ec);
 
@@ -234,6 +330,17 @@ void Session<N, T>::OnDemuxClose() {
   UpdateStatus(Status::kDisconnected);
 }
 
+template <class N, template <class> class T>
+void Session<N, T>::OnServerDrain(uint32_t deadline) {
+  if (stopped_) {
+    return;
+  }
+
+  SSF_LOG("client_session", info, "server draining, closing within {}s",
+          deadline);
+  UpdateStatus(Status::kDraining);
+}
+
 template <class N, template <class> class T>
 void Session<N, T>::UpdateStatus(Status status) {
   if (status_ == status) {
@@ -244,6 +351,14 @@ void Session<N, T>::UpdateStatus(Status status) {
   on_status_(status);
 }
 
+template <class N, template <class> class T>
+void Session<N, T>::LogStartupStep(const char* step) {
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start_time_);
+  SSF_LOG("client_session", debug, "startup: {} after {}us", step,
+          elapsed.count());
+}
+
 }  // ssf
 
 #endif  // SSF_CORE_CLIENT_SESSION_IPP_
@@ -10,7 +10,9 @@ enum class Status {
   kServerNotSupported,
   kDisconnected,
   kConnected,
-  kRunning
+  kRunning,
+  // The server is draining: the connection will be closed soon
+  kDraining
 };
 
 }  // ssf
@@ -23,7 +23,8 @@ CopyCommandLine::CopyCommandLine()
       resume_(false),
       recursive_(false),
       check_file_integrity_(false),
-      max_parallel_copies_() {}
+      max_parallel_copies_(),
+      control_path_() {}
 
 void CopyCommandLine::InitOptions(Options& opts) {
   // clang-format off
@@ -36,6 +37,10 @@ void CopyCommandLine::InitOptions(Options& opts) {
     ("r,recursive", "Copy files recursively")
     ("max-transfers", "Max transfers in parallel",
         cxxopts::value<uint32_t>()->default_value("1"))
+    ("control-path",
+        "Copy over the session of the ssf client listening on this local "
+        "socket",
+        cxxopts::value<std::string>()->default_value(""))
     ("args", "", cxxopts::value<std::vector<std::string>>());
 
   opts.parse_positional("args");
@@ -68,9 +73,12 @@ std::string CopyCommandLine::input_pattern() const { return input_pattern_; }
 
 std::string CopyCommandLine::output_pattern() const { return output_pattern_; }
 
+std::string CopyCommandLine::control_path() const { return control_path_; }
+
 void CopyCommandLine::ParseOptions(const Options& opts,
                                    boost::system::error_code& ec) {
   stdin_input_ = opts.count("stdin-input");
+  control_path_ = opts["control-path"].as<std::string>();
 
   if (!stdin_input_) {
     resume_ = opts.count("resume");
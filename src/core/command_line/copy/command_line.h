@@ -28,6 +28,8 @@ class CopyCommandLine : public Base {
 
   std::string output_pattern() const;
 
+  std::string control_path() const;
+
  protected:
   bool IsServerCli() override;
   void ParseOptions(const Options& opts,
@@ -54,6 +56,7 @@ class CopyCommandLine : public Base {
   bool recursive_;
   bool check_file_integrity_;
   uint32_t max_parallel_copies_;
+  std::string control_path_;
 };
 
 }  // command_line
@@ -12,9 +12,14 @@ StandardCommandLine::StandardCommandLine(bool is_server)
       is_server_(is_server),
       show_status_(false),
       relay_only_(false),
+      reuse_port_(false),
+      drain_timeout_(0),
       gateway_ports_(false),
       max_connection_attempts_(1),
-      reconnection_timeout_(60) {}
+      reconnection_timeout_(60),
+      no_reconnection_(false),
+      control_path_(),
+      api_path_() {}
 
 void StandardCommandLine::InitOptions(Options& opts) {
   Base::InitOptions(opts);
@@ -23,7 +28,12 @@ void StandardCommandLine::InitOptions(Options& opts) {
     // server cli
     opts.add_options()
       ("R,relay-only", "The server will only relay connections")
-      ("l,bind-address", "Server bind address", cxxopts::value<std::string>());
+      ("l,bind-address", "Server bind address", cxxopts::value<std::string>())
+      ("reuse-port",
+       "Share the listening port with another server process")
+      ("drain-timeout",
+       "On stop, wait up to this delay (s) for the connections to end",
+       cxxopts::value<uint32_t>()->default_value("0"));
   } else {
     // client cli
     opts.add_options()
@@ -35,6 +45,12 @@ void StandardCommandLine::InitOptions(Options& opts) {
         cxxopts::value<uint32_t>()->default_value("60"))
       ("n,no-reconnect",
        "Do not attempt to reconnect after loosing a connection")
+      ("control-path",
+       "Share the session with ssfcp through this local socket",
+       cxxopts::value<std::string>()->default_value(""))
+      ("api-path",
+       "Accept service and status requests (JSON lines) on this local socket",
+       cxxopts::value<std::string>()->default_value(""))
       ("server-address", "", cxxopts::value<std::vector<std::string>>());
 
     opts.parse_positional("server-address");
@@ -60,20 +76,22 @@ void StandardCommandLine::ParseOptions(const Options& opts,
   } else {
     auto& server_address = opts["server-address"].as<std::vector<std::string>>();
 
+    // the server address may be omitted when the sessions are given by the
+    // config file
     if (server_address.size() > 1) {
       SSF_LOG("cli", error, "too many arguments");
       ec.assign(::error::invalid_argument, ::error::get_ssf_category());
-    } else if (!server_address.size()) {
-      SSF_LOG("cli", error, "missing arguments");
-      ec.assign(::error::invalid_argument, ::error::get_ssf_category());
-    } else
+    } else if (server_address.size() == 1) {
       host_ = server_address[0];
+    }
   }
 
   show_status_ = opts.count("status");
 
   if (IsServerCli()) {
     relay_only_ = opts.count("relay-only");
+    reuse_port_ = opts.count("reuse-port");
+    drain_timeout_ = opts["drain-timeout"].as<uint32_t>();
   } else {
     uint32_t max_attempts = opts["max-connect-attempts"].as<uint32_t>();
     if (max_attempts == 0) {
@@ -85,6 +103,8 @@ void StandardCommandLine::ParseOptions(const Options& opts,
 
     reconnection_timeout_ = opts["reconnect-delay"].as<uint32_t>();
     no_reconnection_ = opts.count("no-reconnect");
+    control_path_ = opts["control-path"].as<std::string>();
+    api_path_ = opts["api-path"].as<std::string>();
   }
 
   gateway_ports_ = opts.count("gateway-ports");
@@ -1,6 +1,8 @@
 #ifndef SSF_CORE_COMMAND_LINE_STANDARD_COMMAND_LINE_H
 #define SSF_CORE_COMMAND_LINE_STANDARD_COMMAND_LINE_H
 
+#include <string>
+
 #include <ssf/log/log.h>
 
 #include "core/command_line/base.h"
@@ -16,6 +18,10 @@ class StandardCommandLine : public Base {
 
   bool relay_only() const { return relay_only_; }
 
+  bool reuse_port() const { return reuse_port_; }
+
+  uint32_t drain_timeout() const { return drain_timeout_; }
+
   bool gateway_ports() const { return gateway_ports_; }
 
   uint32_t max_connection_attempts() const { return max_connection_attempts_; }
@@ -24,6 +30,10 @@ class StandardCommandLine : public Base {
 
   bool no_reconnection() const { return no_reconnection_; }
 
+  std::string control_path() const { return control_path_; }
+
+  std::string api_path() const { return api_path_; }
+
  protected:
   void InitOptions(Options& opts) override;
   bool IsServerCli() override;
@@ -34,10 +44,14 @@ class StandardCommandLine : public Base {
   bool is_server_;
   bool show_status_;
   bool relay_only_;
+  bool reuse_port_;
+  uint32_t drain_timeout_;
   bool gateway_ports_;
   uint32_t max_connection_attempts_;
   uint32_t reconnection_timeout_;
   bool no_reconnection_;
+  std::string control_path_;
+  std::string api_path_;
 };
 
 }  // command_line
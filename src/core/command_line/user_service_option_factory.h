@@ -88,6 +88,31 @@ class UserServiceOptionFactory {
     return result;
   }
 
+  // Parse one option value of a service given by its parse name, its long
+  // option name or its short option name (e.g. "tcp-forward" or "L")
+  UserServiceParameterBag ParseUserServiceParameters(
+      const std::string& service, const std::string& value,
+      std::string* p_service_name, boost::system::error_code& ec) const {
+    for (const auto& service_option : service_options_) {
+      const auto& fullname = service_option.second.fullname;
+      auto comma = fullname.find(',');
+      bool short_match = comma != std::string::npos &&
+                         fullname.compare(0, comma, service) == 0;
+      bool long_match =
+          fullname.compare(comma == std::string::npos ? 0 : comma + 1,
+                           std::string::npos, service) == 0;
+      if (service_option.first != service && !short_match && !long_match) {
+        continue;
+      }
+
+      *p_service_name = service_option.first;
+      return service_option.second.parser(value, ec);
+    }
+
+    ec.assign(::error::service_not_found, ::error::get_ssf_category());
+    return {};
+  }
+
   void InitOptions(ssf::command_line::Base::Options& opts) const {
     for (const auto& it: service_options_)
       opts.add_options("Services")
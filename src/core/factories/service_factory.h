@@ -7,6 +7,7 @@
 #include <map>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 #include <boost/asio/io_service.hpp>
 #include <boost/system/error_code.hpp>
@@ -31,6 +32,11 @@ class ServiceFactory
   using ServiceCreatorMap = std::map<uint32_t, ServiceCreator>;
   using ServiceManagerPtr = std::shared_ptr<ServiceManager<Demux>>;
 
+ public:
+  using OnServerDrain = std::function<void(uint32_t)>;
+  using ServiceRegistration =
+      std::function<void(std::shared_ptr<ServiceFactory>)>;
+
  public:
   static std::shared_ptr<ServiceFactory> Create(
       boost::asio::io_service& io_service, Demux& demux,
@@ -58,10 +64,19 @@ class ServiceFactory
     }
   }
 
+  // Defer the registration of service creators until a service is first
+  // requested (most sessions never start one)
+  void RegisterOnFirstUse(ServiceRegistration registration) {
+    std::unique_lock<std::recursive_mutex> lock(service_creators_mutex_);
+    pending_registrations_.push_back(std::move(registration));
+  }
+
   uint32_t CreateRunNewService(uint32_t index, Parameters parameters,
                                boost::system::error_code& ec) {
     std::unique_lock<std::recursive_mutex> lock(service_creators_mutex_);
 
+    RunPendingRegistrations();
+
     auto it = service_creators_.find(index);
 
     if (it != std::end(service_creators_)) {
@@ -105,6 +120,22 @@ class ServiceFactory
     return p_service_manager_->update_remote(id, error_code_value, ec);
   }
 
+  // Set the handler called when the remote server starts draining
+  void SetOnServerDrain(OnServerDrain on_server_drain) {
+    std::unique_lock<std::recursive_mutex> lock(on_server_drain_mutex_);
+    on_server_drain_ = std::move(on_server_drain);
+  }
+
+  void NotifyServerDrain(uint32_t deadline) {
+    std::unique_lock<std::recursive_mutex> lock(on_server_drain_mutex_);
+    if (!on_server_drain_) {
+      return;
+    }
+    auto on_server_drain = on_server_drain_;
+    io_service_.post(
+        [on_server_drain, deadline]() { on_server_drain(deadline); });
+  }
+
   uint32_t GetIdFromParameters(uint32_t index, Parameters parameters) {
     return p_service_manager_->get_id(index, parameters);
   }
@@ -122,6 +153,18 @@ class ServiceFactory
         demux_(demux),
         p_service_manager_(p_service_manager) {}
 
+  void RunPendingRegistrations() {
+    if (pending_registrations_.empty()) {
+      return;
+    }
+    auto registrations = std::move(pending_registrations_);
+    pending_registrations_.clear();
+    auto self = this->shared_from_this();
+    for (auto& registration : registrations) {
+      registration(self);
+    }
+  }
+
  private:
   boost::asio::io_service& io_service_;
   Demux& demux_;
@@ -129,6 +172,10 @@ class ServiceFactory
 
   std::recursive_mutex service_creators_mutex_;
   ServiceCreatorMap service_creators_;
+  std::vector<ServiceRegistration> pending_registrations_;
+
+  std::recursive_mutex on_server_drain_mutex_;
+  OnServerDrain on_server_drain_;
 };
 
 }  // ssf
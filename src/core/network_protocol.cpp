@@ -61,7 +61,7 @@ NetworkProtocol::Query NetworkProtocol::GenerateClientTLSQuery(
     const ssf::config::Config& ssf_config,
     const ssf::config::NodeList& circuit_nodes) {
   ssf::layer::LayerParameters tls_param_layer =
-      TlsConfigToLayerParameters(ssf_config);
+      TlsConfigToLayerParameters(ssf_config, false);
 
   ssf::layer::LayerParameters proxy_param_layer =
       ProxyConfigToLayerParameters(ssf_config, false);
@@ -122,7 +122,7 @@ NetworkProtocol::Query NetworkProtocol::GenerateServerTLSQuery(
     const std::string& remote_addr, const std::string& remote_port,
     const ssf::config::Config& ssf_config) {
   ssf::layer::LayerParameters tls_param_layer =
-      TlsConfigToLayerParameters(ssf_config);
+      TlsConfigToLayerParameters(ssf_config, true);
 
   ssf::layer::LayerParameters physical_parameters;
   physical_parameters["port"] = remote_port;
@@ -153,17 +153,25 @@ NetworkProtocol::Query NetworkProtocol::GenerateServerTLSQuery(
 }
 
 ssf::layer::LayerParameters NetworkProtocol::TlsConfigToLayerParameters(
-    const ssf::config::Config& ssf_config) {
-  return {{ssf_config.tls().ca_cert().IsBuffer() ? "ca_buffer" : "ca_file",
-           ssf_config.tls().ca_cert().value()},
-          {ssf_config.tls().cert().IsBuffer() ? "crt_buffer" : "crt_file",
-           ssf_config.tls().cert().value()},
-          {ssf_config.tls().key().IsBuffer() ? "key_buffer" : "key_file",
-           ssf_config.tls().key().value()},
-          {"key_password", ssf_config.tls().key_password()},
-          {ssf_config.tls().dh().IsBuffer() ? "dhparam_buffer" : "dhparam_file",
-           ssf_config.tls().dh().value()},
-          {"cipher_suit", ssf_config.tls().cipher_alg()}};
+    const ssf::config::Config& ssf_config, bool acceptor_endpoint) {
+  ssf::layer::LayerParameters parameters = {
+      {ssf_config.tls().ca_cert().IsBuffer() ? "ca_buffer" : "ca_file",
+       ssf_config.tls().ca_cert().value()},
+      {ssf_config.tls().cert().IsBuffer() ? "crt_buffer" : "crt_file",
+       ssf_config.tls().cert().value()},
+      {ssf_config.tls().key().IsBuffer() ? "key_buffer" : "key_file",
+       ssf_config.tls().key().value()},
+      {"key_password", ssf_config.tls().key_password()},
+      {"cipher_suit", ssf_config.tls().cipher_alg()}};
+
+  // DH parameters are only used by the server side of the handshake
+  if (acceptor_endpoint) {
+    parameters[ssf_config.tls().dh().IsBuffer() ? "dhparam_buffer"
+                                                : "dhparam_file"] =
+        ssf_config.tls().dh().value();
+  }
+
+  return parameters;
 }
 
 ssf::layer::LayerParameters NetworkProtocol::ProxyConfigToLayerParameters(
@@ -81,7 +81,7 @@ class NetworkProtocol {
                                       const ssf::config::Config& ssf_config);
 
   static ssf::layer::LayerParameters TlsConfigToLayerParameters(
-      const ssf::config::Config& ssf_config);
+      const ssf::config::Config& ssf_config, bool acceptor_endpoint);
 
   static ssf::layer::LayerParameters ProxyConfigToLayerParameters(
       const ssf::config::Config& ssf_config, bool acceptor_endpoint);
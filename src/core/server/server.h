@@ -1,17 +1,25 @@
 #ifndef SSF_CORE_SERVER_SERVER_H_
 #define SSF_CORE_SERVER_SERVER_H_
 
+#include <chrono>
+#include <functional>
 #include <set>
 #include <map>
 #include <mutex>
 
 #include <boost/asio/io_service.hpp>
+#include <boost/asio/socket_base.hpp>
+#include <boost/asio/steady_timer.hpp>
 
 #include "common/boost/fiber/basic_fiber_demux.hpp"
+#include "common/config/quotas.h"
+#include "common/config/services.h"
 
 #include "core/async_engine.h"
 #include "core/service_manager/service_manager.h"
 
+#include "services/admin/admin.h"
+
 namespace ssf {
 template <class NetworkProtocol,
           template <class> class TransportVirtualLayerPolicy>
@@ -33,15 +41,34 @@ class SSFServer
   using DemuxPtr = std::shared_ptr<Demux>;
   using DemuxPtrSet = std::set<DemuxPtr>;
   using ServiceManagerPtrMap = std::map<DemuxPtr, ServiceManagerPtr<Demux>>;
+  using AdminPtr = std::shared_ptr<services::admin::Admin<Demux>>;
+  using AdminPtrMap = std::map<DemuxPtr, AdminPtr>;
+#if defined(SO_REUSEPORT)
+  using ReusePort =
+      boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+#endif
+
+  enum {
+    kDrainCheckInterval = 500  // milliseconds
+  };
+
+ public:
+  using OnDrained = std::function<void()>;
 
  public:
   SSFServer(const ssf::config::Services& services_config,
-            bool relay_only = false);
+            bool relay_only = false,
+            const ssf::config::Quotas& quotas_config = ssf::config::Quotas(),
+            bool reuse_port = false);
 
   ~SSFServer();
 
   void Run(const NetworkQuery& query, boost::system::error_code& ec);
 
+  // Stop accepting connections, notify the clients and close each connection
+  // once its fibers are done or when the timeout expires
+  void Drain(const std::chrono::seconds& timeout, OnDrained on_drained);
+
   void Stop();
 
   boost::asio::io_service& get_io_service();
@@ -51,21 +78,35 @@ class SSFServer
   void NetworkToTransport(const boost::system::error_code& ec,
                           NetworkSocketPtr p_socket);
   void AddDemux(DemuxPtr p_fiber_demux,
-                ServiceManagerPtr<Demux> p_service_manager);
+                ServiceManagerPtr<Demux> p_service_manager,
+                AdminPtr p_admin_service);
   void DoSSFStart(NetworkSocketPtr p_socket, NetworkSocket& socket,
                   const boost::system::error_code& ec);
   void DoFiberize(NetworkSocketPtr p_socket, boost::system::error_code& ec);
   void RemoveDemux(DemuxPtr p_fiber_demux);
   void RemoveAllDemuxes();
+  void SendDrainNotice(AdminPtr p_admin_service);
+  void AsyncWaitDrained();
+  void CheckDrained(const boost::system::error_code& ec);
 
  private:
   AsyncEngine async_engine_;
   NetworkAcceptor network_acceptor_;
   ssf::config::Services services_config_;
   bool relay_only_;
+  bool reuse_port_;
+  // Limits applied to each client demux
+  typename Demux::quota_limits_type quota_limits_;
 
   DemuxPtrSet p_fiber_demuxes_;
   ServiceManagerPtrMap p_service_managers_;
+  AdminPtrMap p_admin_services_;
+
+  // Drain
+  bool draining_;
+  std::chrono::steady_clock::time_point drain_deadline_;
+  boost::asio::steady_timer drain_timer_;
+  OnDrained on_drained_;
 
   std::recursive_mutex storage_mutex_;
 };
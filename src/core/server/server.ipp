@@ -1,6 +1,7 @@
 #ifndef SSF_CORE_SERVER_SERVER_IPP_
 #define SSF_CORE_SERVER_SERVER_IPP_
 
+#include <algorithm>
 #include <functional>
 
 #include <ssf/log/log.h>
@@ -11,12 +12,14 @@
 
 #include "services/admin/admin.h"
 #include "services/admin/requests/create_service_request.h"
+#include "services/admin/requests/drain_notice.h"
 #include "services/admin/requests/service_status.h"
 #include "services/admin/requests/stop_service_request.h"
 
 #include "services/base_service.h"
 #include "services/copy/copy_server.h"
 #include "services/datagrams_to_fibers/datagrams_to_fibers.h"
+#include "services/exec/server.h"
 #include "services/fibers_to_datagrams/fibers_to_datagrams.h"
 #include "services/fibers_to_sockets/fibers_to_sockets.h"
 #include "services/process/server.h"
@@ -27,12 +30,24 @@ namespace ssf {
 
 template <class N, template <class> class T>
 SSFServer<N, T>::SSFServer(const ssf::config::Services& services_config,
-                           bool relay_only)
+                           bool relay_only,
+                           const ssf::config::Quotas& quotas_config,
+                           bool reuse_port)
     : T<typename N::socket>(),
       async_engine_(),
       network_acceptor_(async_engine_.get_io_service()),
       services_config_(services_config),
-      relay_only_(relay_only) {}
+      relay_only_(relay_only),
+      reuse_port_(reuse_port),
+      quota_limits_(),
+      draining_(false),
+      drain_deadline_(),
+      drain_timer_(async_engine_.get_io_service()) {
+  quota_limits_.max_fibers = quotas_config.max_fibers();
+  quota_limits_.max_buffered_bytes = quotas_config.max_buffered_bytes();
+  quota_limits_.max_syn_per_second = quotas_config.max_syn_per_second();
+  quota_limits_.max_outbound_sockets = quotas_config.max_outbound_sockets();
+}
 
 template <class N, template <class> class T>
 SSFServer<N, T>::~SSFServer() {
@@ -70,6 +85,21 @@ void SSFServer<N, T>::Run(const NetworkQuery& query,
 
   boost::system::error_code close_ec;
 
+  if (reuse_port_) {
+    // Share the port with another server process (e.g. a new version
+    // started before draining this one)
+#if defined(SO_REUSEPORT)
+    network_acceptor_.set_option(ReusePort(true), ec);
+#else
+    ec.assign(::error::operation_not_supported, ::error::get_ssf_category());
+#endif
+    if (ec) {
+      network_acceptor_.close(close_ec);
+      SSF_LOG("server", error, "could not share the network endpoint");
+      return;
+    }
+  }
+
   network_acceptor_.bind(*endpoint_it, ec);
   if (ec) {
     network_acceptor_.close(close_ec);
@@ -90,11 +120,42 @@ void SSFServer<N, T>::Run(const NetworkQuery& query,
   AsyncAcceptConnection();
 }
 
+/// Stop accepting connections and end the connections once idle
+template <class N, template <class> class T>
+void SSFServer<N, T>::Drain(const std::chrono::seconds& timeout,
+                            OnDrained on_drained) {
+  std::unique_lock<std::recursive_mutex> lock(storage_mutex_);
+  if (draining_) {
+    return;
+  }
+
+  SSF_LOG("server", info, "draining {} connection(s) within {}s",
+          p_fiber_demuxes_.size(), timeout.count());
+
+  draining_ = true;
+  drain_deadline_ = std::chrono::steady_clock::now() + timeout;
+  on_drained_ = std::move(on_drained);
+
+  // New connections go to the other processes listening on the endpoint
+  boost::system::error_code close_ec;
+  network_acceptor_.close(close_ec);
+
+  for (auto& admin_pair : p_admin_services_) {
+    SendDrainNotice(admin_pair.second);
+  }
+
+  // Leave time to the notices to be sent before closing idle connections
+  AsyncWaitDrained();
+}
+
 /// Stop accepting connections and end all on going connections
 template <class N, template <class> class T>
 void SSFServer<N, T>::Stop() {
   SSF_LOG("server", debug, "stop");
 
+  boost::system::error_code cancel_ec;
+  drain_timer_.cancel(cancel_ec);
+
   RemoveAllDemuxes();
 
   // close acceptor
@@ -159,6 +220,17 @@ void SSFServer<N, T>::DoSSFStart(NetworkSocketPtr p_socket,
   }
 
   SSF_LOG("server", debug, "SSF reply ok");
+  {
+    std::unique_lock<std::recursive_mutex> lock(storage_mutex_);
+    if (draining_) {
+      SSF_LOG("server", debug, "draining, connection refused");
+      boost::system::error_code close_ec;
+      p_socket->shutdown(boost::asio::socket_base::shutdown_both, close_ec);
+      p_socket->close(close_ec);
+      return;
+    }
+  }
+
   boost::system::error_code fiberize_ec;
   DoFiberize(p_socket, fiberize_ec);
 }
@@ -174,7 +246,8 @@ void SSFServer<N, T>::DoFiberize(NetworkSocketPtr p_socket,
     std::unique_lock<std::recursive_mutex> lock(storage_mutex_);
     RemoveDemux(p_fiber_demux);
   };
-  p_fiber_demux->fiberize(std::move(*p_socket), close_demux_handler);
+  p_fiber_demux->fiberize(std::move(*p_socket), close_demux_handler, 60 * 1024,
+                          quota_limits_);
 
   // Make a new service manager
   auto p_service_manager = std::make_shared<ServiceManager<Demux>>();
@@ -200,6 +273,8 @@ void SSFServer<N, T>::DoFiberize(NetworkSocketPtr p_socket,
       p_service_factory, services_config_.copy());
   services::process::Server<Demux>::RegisterToServiceFactory(
       p_service_factory, services_config_.process());
+  services::exec::Server<Demux>::RegisterToServiceFactory(
+      p_service_factory, services_config_.exec());
 
   // Start the admin microservice
   std::map<std::string, std::string> empty_map;
@@ -227,32 +302,54 @@ void SSFServer<N, T>::DoFiberize(NetworkSocketPtr p_socket,
     ec.assign(::error::service_not_started, ::error::get_ssf_category());
     return;
   }
+  if (!p_admin_service
+           ->template RegisterCommand<services::admin::DrainNotice>()) {
+    SSF_LOG("server", error, "cannot register DrainNotice into admin service");
+    ec.assign(::error::service_not_started, ::error::get_ssf_category());
+    return;
+  }
 
   p_admin_service->SetAsServer();
   p_service_manager->start(p_admin_service, ec);
 
   // Save the demux, the socket and the service manager
-  AddDemux(p_fiber_demux, p_service_manager);
+  AddDemux(p_fiber_demux, p_service_manager, p_admin_service);
 }
 
 template <class N, template <class> class T>
 void SSFServer<N, T>::AddDemux(DemuxPtr p_fiber_demux,
-                               ServiceManagerPtr<Demux> p_service_manager) {
+                               ServiceManagerPtr<Demux> p_service_manager,
+                               AdminPtr p_admin_service) {
   SSF_LOG("server", trace, "adding a new demux");
 
   p_fiber_demuxes_.insert(p_fiber_demux);
   p_service_managers_[p_fiber_demux] = p_service_manager;
+  p_admin_services_[p_fiber_demux] = p_admin_service;
 }
 
 template <class N, template <class> class T>
 void SSFServer<N, T>::RemoveDemux(DemuxPtr p_fiber_demux) {
   SSF_LOG("server", trace, "removing a demux");
 
+  auto p_quotas = p_fiber_demux->quotas();
+  if (p_quotas &&
+      (p_quotas->rejected_fibers() || p_quotas->rejected_syns() ||
+       p_quotas->throttled_fibers() || p_quotas->dropped_datagrams() ||
+       p_quotas->rejected_outbound_sockets())) {
+    SSF_LOG("server", info,
+            "client quotas: {} fibers rejected, {} syns rejected, {} fibers "
+            "throttled, {} datagrams dropped, {} outbound sockets rejected",
+            p_quotas->rejected_fibers(), p_quotas->rejected_syns(),
+            p_quotas->throttled_fibers(), p_quotas->dropped_datagrams(),
+            p_quotas->rejected_outbound_sockets());
+  }
+
   if (p_service_managers_.count(p_fiber_demux)) {
     auto p_service_manager = p_service_managers_[p_fiber_demux];
     p_service_manager->stop_all();
     p_service_managers_.erase(p_fiber_demux);
   }
+  p_admin_services_.erase(p_fiber_demux);
 
   auto p_service_factory =
       ServiceFactoryManager<Demux>::GetServiceFactory(p_fiber_demux.get());
@@ -275,6 +372,60 @@ void SSFServer<N, T>::RemoveAllDemuxes() {
   }
 }
 
+template <class N, template <class> class T>
+void SSFServer<N, T>::SendDrainNotice(AdminPtr p_admin_service) {
+  auto remaining = std::chrono::duration_cast<std::chrono::seconds>(
+      drain_deadline_ - std::chrono::steady_clock::now());
+  services::admin::DrainNotice<Demux> notice(
+      static_cast<uint32_t>(std::max<int64_t>(remaining.count(), 0)));
+  p_admin_service->Command(notice, [](const boost::system::error_code&) {});
+}
+
+template <class N, template <class> class T>
+void SSFServer<N, T>::AsyncWaitDrained() {
+  drain_timer_.expires_from_now(
+      std::chrono::milliseconds(kDrainCheckInterval));
+  drain_timer_.async_wait(
+      [this](const boost::system::error_code& ec) { CheckDrained(ec); });
+}
+
+/// Close the connections without fibers left and the others past the deadline
+template <class N, template <class> class T>
+void SSFServer<N, T>::CheckDrained(const boost::system::error_code& ec) {
+  if (ec) {
+    return;
+  }
+
+  std::unique_lock<std::recursive_mutex> lock(storage_mutex_);
+  DemuxPtrSet idle_demuxes;
+  for (auto& p_fiber_demux : p_fiber_demuxes_) {
+    // The admin fiber stays connected until the demux is closed
+    if (p_fiber_demux->connected_fibers() <= 1) {
+      idle_demuxes.insert(p_fiber_demux);
+    }
+  }
+  for (auto& p_fiber_demux : idle_demuxes) {
+    RemoveDemux(p_fiber_demux);
+  }
+
+  if (!p_fiber_demuxes_.empty() &&
+      std::chrono::steady_clock::now() < drain_deadline_) {
+    AsyncWaitDrained();
+    return;
+  }
+
+  if (!p_fiber_demuxes_.empty()) {
+    SSF_LOG("server", warn, "drain deadline expired, closing {} connection(s)",
+            p_fiber_demuxes_.size());
+    RemoveAllDemuxes();
+  }
+
+  SSF_LOG("server", info, "drained");
+  if (on_drained_) {
+    async_engine_.get_io_service().post(on_drained_);
+  }
+}
+
 }  // ssf
 
 #endif  // SSF_CORE_SERVER_SERVER_H_
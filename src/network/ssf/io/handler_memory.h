@@ -0,0 +1,118 @@
+#ifndef SSF_IO_HANDLER_MEMORY_H_
+#define SSF_IO_HANDLER_MEMORY_H_
+
+#include <cstddef>
+
+#include <type_traits>
+#include <utility>
+
+#include <boost/asio/detail/handler_alloc_helpers.hpp>
+#include <boost/asio/detail/handler_cont_helpers.hpp>
+#include <boost/asio/detail/handler_invoke_helpers.hpp>
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#pragma once
+#endif  // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+namespace ssf {
+namespace io {
+
+/// Storage recycled by the asynchronous operations of a single handler chain
+/**
+* A chain of asynchronous operations where each handler starts the next
+* operation (a forwarding loop) has at most one operation in flight. Asio
+* releases the memory of an operation before invoking its handler, so the
+* same block can be reused by every operation of the chain instead of being
+* allocated and freed on each hop.
+*
+* Requests bigger than the block, or made while the block is in use, fall
+* back to the global heap.
+*/
+class HandlerMemory {
+ public:
+  HandlerMemory() : in_use_(false) {}
+
+  HandlerMemory(const HandlerMemory&) = delete;
+  HandlerMemory& operator=(const HandlerMemory&) = delete;
+
+  void* allocate(std::size_t size) {
+    if (!in_use_ && size <= sizeof(storage_)) {
+      in_use_ = true;
+      return &storage_;
+    }
+
+    return ::operator new(size);
+  }
+
+  void deallocate(void* pointer) {
+    if (pointer == &storage_) {
+      in_use_ = false;
+      return;
+    }
+
+    ::operator delete(pointer);
+  }
+
+ private:
+  typename std::aligned_storage<1024>::type storage_;
+  bool in_use_;
+};
+
+/// Wrapper making asio allocate the operations of a handler in HandlerMemory
+template <class Handler>
+class MemoryHandler {
+ public:
+  MemoryHandler(HandlerMemory& memory, Handler handler)
+      : memory_(memory), handler(std::move(handler)) {}
+
+  template <class... Args>
+  void operator()(Args&&... args) {
+    handler(std::forward<Args>(args)...);
+  }
+
+  friend void* asio_handler_allocate(std::size_t size,
+                                     MemoryHandler* this_handler) {
+    return this_handler->memory_.allocate(size);
+  }
+
+  friend void asio_handler_deallocate(void* pointer, std::size_t,
+                                      MemoryHandler* this_handler) {
+    this_handler->memory_.deallocate(pointer);
+  }
+
+  friend bool asio_handler_is_continuation(MemoryHandler* this_handler) {
+    return boost_asio_handler_cont_helpers::is_continuation(
+        this_handler->handler);
+  }
+
+  template <class Function>
+  friend void asio_handler_invoke(Function& function,
+                                  MemoryHandler* this_handler) {
+    boost_asio_handler_invoke_helpers::invoke(function, this_handler->handler);
+  }
+
+  template <class Function>
+  friend void asio_handler_invoke(const Function& function,
+                                  MemoryHandler* this_handler) {
+    boost_asio_handler_invoke_helpers::invoke(function, this_handler->handler);
+  }
+
+ private:
+  HandlerMemory& memory_;
+
+ public:
+  Handler handler;
+};
+
+/// Wrap a handler so that its operations are allocated in the given memory
+template <class Handler>
+MemoryHandler<typename std::decay<Handler>::type> MakeMemoryHandler(
+    HandlerMemory& memory, Handler&& handler) {
+  return MemoryHandler<typename std::decay<Handler>::type>(
+      memory, std::forward<Handler>(handler));
+}
+
+}  // io
+}  // ssf
+
+#endif  // SSF_IO_HANDLER_MEMORY_H_
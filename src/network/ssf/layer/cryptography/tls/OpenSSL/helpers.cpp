@@ -1,5 +1,8 @@
 #include "ssf/layer/cryptography/tls/OpenSSL/helpers.h"
 
+#include <map>
+#include <mutex>
+
 #include "ssf/error/error.h"
 #include "ssf/log/log.h"
 #include "ssf/utils/cleaner.h"
@@ -35,8 +38,53 @@ bool ExtendedTLSContext::operator<(const ExtendedTLSContext& other) const {
 
 bool ExtendedTLSContext::operator!() const { return !p_ctx_; }
 
+namespace {
+
+using TLSContextPtr = std::shared_ptr<boost::asio::ssl::context>;
+
+// Contexts alive in the process, indexed by their parameters. Parsing
+// certificates and keys is only done once for all the endpoints sharing the
+// same parameters.
+std::mutex tls_contexts_mutex;
+std::map<LayerParameters, std::weak_ptr<boost::asio::ssl::context>>
+    tls_contexts;
+
+TLSContextPtr create_tls_context(const LayerParameters& parameters);
+
+}  // namespace
+
 ExtendedTLSContext make_tls_context(boost::asio::io_service& io_service,
                                     const LayerParameters& parameters) {
+  std::unique_lock<std::mutex> lock(tls_contexts_mutex);
+
+  auto it = tls_contexts.find(parameters);
+  if (it != tls_contexts.end()) {
+    auto p_ctx = it->second.lock();
+    if (p_ctx) {
+      return ExtendedTLSContext(p_ctx);
+    }
+  }
+
+  // Remove the contexts released since the last creation
+  for (auto ctx_it = tls_contexts.begin(); ctx_it != tls_contexts.end();) {
+    if (ctx_it->second.expired()) {
+      ctx_it = tls_contexts.erase(ctx_it);
+    } else {
+      ++ctx_it;
+    }
+  }
+
+  auto p_ctx = create_tls_context(parameters);
+  if (p_ctx) {
+    tls_contexts[parameters] = p_ctx;
+  }
+
+  return ExtendedTLSContext(p_ctx);
+}
+
+namespace {
+
+TLSContextPtr create_tls_context(const LayerParameters& parameters) {
   auto p_ctx = std::make_shared<boost::asio::ssl::context>(
       boost::asio::ssl::context::tlsv12);
 
@@ -65,7 +113,7 @@ ExtendedTLSContext make_tls_context(boost::asio::io_service& io_service,
 
   if (ec) {
     SSF_LOG("network_crypto", error, "could not set verify callback");
-    return ExtendedTLSContext(nullptr);
+    return nullptr;
   }
 
   // Set various security options
@@ -103,16 +151,25 @@ ExtendedTLSContext make_tls_context(boost::asio::io_service& io_service,
     success = false;
   }
 
-  success |= SetCtxDhparam(ctx, parameters, ec);
+  // Only the server side loads DH parameters
+  if (parameters.count("dhparam_file") > 0 ||
+      parameters.count("dhparam_buffer") > 0) {
+    if (!SetCtxDhparam(ctx, parameters, ec)) {
+      SSF_LOG("network_crypto", warn, "set context DH parameters failed ({})",
+              ec.message());
+    }
+  }
 
   if (!success) {
     SSF_LOG("network_crypto", error, "context init failed");
-    return ExtendedTLSContext(nullptr);
+    return nullptr;
   }
 
-  return ExtendedTLSContext(p_ctx);
+  return p_ctx;
 }
 
+}  // namespace
+
 bool SetCtxCipher(boost::asio::ssl::context& ctx,
                   const LayerParameters& parameters,
                   boost::system::error_code& ec) {
@@ -1,6 +1,7 @@
 #ifndef SSF_LAYER_INTERFACE_LAYER_GENERIC_INTERFACE_SOCKET_H_
 #define SSF_LAYER_INTERFACE_LAYER_GENERIC_INTERFACE_SOCKET_H_
 
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -33,6 +34,10 @@ class generic_interface_socket {
 
   virtual void connect(boost::system::error_code& ec) = 0;
 
+  /// Set the handler called each time the socket goes down (an I/O error or
+  /// a close call). An empty handler unsets it.
+  virtual void set_close_handler(std::function<void()> close_handler) = 0;
+
   virtual void async_receive(interface_mutable_buffers buffers,
                              ssf::layer::WrappedIOHandler handler) = 0;
 
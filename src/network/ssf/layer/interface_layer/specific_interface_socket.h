@@ -3,6 +3,7 @@
 
 #include <cstdint>
 
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <vector>
@@ -95,10 +96,20 @@ class specific_interface_socket
   }
 
   virtual void close(boost::system::error_code& ec) {
-    std::unique_lock<std::recursive_mutex> lock_closed_(closed_mutex_);
-    if (!closed_) {
+    std::function<void()> close_handler;
+    {
+      std::unique_lock<std::recursive_mutex> lock_closed_(closed_mutex_);
+      if (closed_) {
+        return;
+      }
       closed_ = true;
       p_internal_socket_->close(ec);
+      close_handler = close_handler_;
+    }
+
+    // Outside of the lock: the handler may remount the interface
+    if (close_handler) {
+      close_handler();
     }
   }
 
@@ -114,6 +125,11 @@ class specific_interface_socket
         [this]() { this->do_async_send(); });
   }
 
+  virtual void set_close_handler(std::function<void()> close_handler) {
+    std::unique_lock<std::recursive_mutex> lock_closed_(closed_mutex_);
+    close_handler_ = std::move(close_handler);
+  }
+
   virtual void async_receive(interface_mutable_buffers buffers,
                              ssf::layer::WrappedIOHandler handler) {
     std::unique_lock<std::recursive_mutex> lock(receive_mutex_);
@@ -158,6 +174,7 @@ class specific_interface_socket
       : p_internal_socket_(std::move(p_internal_socket)),
         closed_mutex_(),
         closed_(false),
+        close_handler_(),
         receive_mutex_(),
         receive_pending_(false),
         internal_receive_datagram_(),
@@ -323,6 +340,7 @@ class specific_interface_socket
   p_internal_socket_type p_internal_socket_;
   std::recursive_mutex closed_mutex_;
   bool closed_;
+  std::function<void()> close_handler_;
 
   std::recursive_mutex receive_mutex_;
   bool receive_pending_;
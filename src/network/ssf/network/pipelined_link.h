@@ -0,0 +1,369 @@
+#ifndef SSF_NETWORK_PIPELINED_LINK_H_
+#define SSF_NETWORK_PIPELINED_LINK_H_
+
+#include <cstdint>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <boost/asio/buffer.hpp>  // NOLINT
+#include <boost/asio/steady_timer.hpp>  // NOLINT
+
+#include <boost/system/error_code.hpp>  // NOLINT
+
+#include "ssf/io/handler_memory.h"
+#include "ssf/network/socket_link.h"
+#include "ssf/network/zero_copy.h"
+
+namespace ssf {
+
+/// Options of a pipelined half duplex link
+struct PipelinedLinkOptions {
+  PipelinedLinkOptions()
+      : buffer_size(50 * 1024), buffers(2), zero_copy(false) {}
+
+  /// Size of each buffer
+  std::size_t buffer_size;
+  /// Number of buffers (1: the link reads and writes in turn)
+  std::size_t buffers;
+  /// Send large writes without a copy (TCP sockets on Linux)
+  bool zero_copy;
+};
+
+/// Async Half Duplex Stream Forwarder with several buffers in flight
+/**
+* The buffers form a ring: the link reads into the free buffers while the
+* filled ones are written in order, so that a read overlaps the write of the
+* previous data. Data read before the end of the input is written before the
+* handler is called.
+*
+* @tparam Handler type of the callback handler
+* @tparam ReadFromSocketType type of the input socket
+* @tparam WriteToSocketType type of the output socket
+*/
+template <class Handler, class ReadFromSocketType,
+          class WriteToSocketType = ReadFromSocketType>
+class AsyncPipelinedHDLinker
+    : public std::enable_shared_from_this<
+          AsyncPipelinedHDLinker<Handler, ReadFromSocketType,
+                                 WriteToSocketType>> {
+ private:
+  struct Buffer {
+    std::vector<char> data;
+    std::size_t size;
+    std::size_t written;
+    // last zero copy send of the buffer not known as completed
+    bool zero_copy_pending;
+    uint32_t zero_copy_id;
+  };
+
+ public:
+  using LinkerPtr = std::shared_ptr<AsyncPipelinedHDLinker>;
+
+  /// Writes smaller than this are copied even with zero copy enabled
+  enum { kZeroCopyMinSize = 16 * 1024 };
+  /// Period of the zero copy completions polls
+  enum { kZeroCopyPollMilliseconds = 1 };
+  /// Polls made at the end of the link before dropping pending completions
+  enum { kZeroCopyDrainPolls = 1000 };
+
+ public:
+  /// Return a shared pointer to a new link
+  /**
+  * @param read_from input socket
+  * @param write_to output socket
+  * @param options buffers of the link
+  * @param handler the callback to call when the transfer stops
+  */
+  static LinkerPtr Create(ReadFromSocketType& read_from,
+                          WriteToSocketType& write_to,
+                          const PipelinedLinkOptions& options,
+                          Handler handler) {
+    return LinkerPtr(
+        new AsyncPipelinedHDLinker(read_from, write_to, options, handler));
+  }
+
+  /// Start forwarding
+  void Start() {
+    std::unique_lock<std::recursive_mutex> lock(mutex_);
+    StartRead();
+  }
+
+ private:
+  AsyncPipelinedHDLinker(ReadFromSocketType& read_from,
+                         WriteToSocketType& write_to,
+                         const PipelinedLinkOptions& options, Handler handler)
+      : r_(read_from),
+        w_(write_to),
+        handler_(handler),
+        mutex_(),
+        buffers_(std::max<std::size_t>(options.buffers, 1)),
+        head_(0),
+        filled_(0),
+        reading_(false),
+        writing_(false),
+        polling_(false),
+        read_done_(false),
+        finished_(false),
+        read_ec_(),
+        zero_copy_(options.zero_copy && EnableZeroCopy(write_to)),
+        zero_copy_sent_(0),
+        zero_copy_completed_(0),
+        drain_polls_(0),
+        timer_(write_to.get_io_service()),
+        read_memory_(),
+        write_memory_() {
+    for (auto& buffer : buffers_) {
+      buffer.data.resize(std::max<std::size_t>(options.buffer_size, 1));
+      buffer.size = 0;
+      buffer.written = 0;
+      buffer.zero_copy_pending = false;
+      buffer.zero_copy_id = 0;
+    }
+  }
+
+  // mutex_ held
+  void StartRead() {
+    if (reading_ || read_done_ || finished_ || filled_ == buffers_.size()) {
+      return;
+    }
+
+    auto& buffer = buffers_[(head_ + filled_) % buffers_.size()];
+    if (!IsReleased(buffer)) {
+      // the kernel still sends from the buffer
+      if (!writing_) {
+        AsyncPoll();
+      }
+      return;
+    }
+
+    reading_ = true;
+    auto self = this->shared_from_this();
+    r_.async_read_some(
+        boost::asio::buffer(buffer.data),
+        io::MakeMemoryHandler(read_memory_,
+                              [this, self](const boost::system::error_code& ec,
+                                           std::size_t n) { OnRead(ec, n); }));
+  }
+
+  void OnRead(const boost::system::error_code& ec, std::size_t n) {
+    std::unique_lock<std::recursive_mutex> lock(mutex_);
+    reading_ = false;
+    if (finished_) {
+      return;
+    }
+
+    if (ec || !r_.is_open() || !w_.is_open()) {
+      read_done_ = true;
+      read_ec_ = ec;
+      CheckEnd(lock);
+      return;
+    }
+
+    if (n > 0) {
+      auto& buffer = buffers_[(head_ + filled_) % buffers_.size()];
+      buffer.size = n;
+      buffer.written = 0;
+      ++filled_;
+      StartWrite();
+    }
+
+    StartRead();
+  }
+
+  // mutex_ held
+  void StartWrite() {
+    if (writing_ || filled_ == 0) {
+      return;
+    }
+
+    auto& buffer = buffers_[head_];
+    auto to_write = boost::asio::buffer(
+        static_cast<const void*>(buffer.data.data() + buffer.written),
+        buffer.size - buffer.written);
+    bool zero_copy =
+        zero_copy_ && boost::asio::buffer_size(to_write) >= kZeroCopyMinSize;
+
+    writing_ = true;
+    auto self = this->shared_from_this();
+    auto on_write = io::MakeMemoryHandler(
+        write_memory_,
+        [this, self, zero_copy](const boost::system::error_code& ec,
+                                std::size_t n) { OnWrite(zero_copy, ec, n); });
+    if (zero_copy) {
+      AsyncZeroCopySend(w_, to_write, std::move(on_write));
+    } else {
+      w_.async_write_some(to_write, std::move(on_write));
+    }
+  }
+
+  void OnWrite(bool zero_copy, const boost::system::error_code& ec,
+               std::size_t n) {
+    std::unique_lock<std::recursive_mutex> lock(mutex_);
+    writing_ = false;
+    if (finished_) {
+      return;
+    }
+
+    if (ec) {
+      Finish(lock, ec);
+      return;
+    }
+
+    auto& buffer = buffers_[head_];
+    buffer.written += n;
+    if (zero_copy && n > 0) {
+      buffer.zero_copy_pending = true;
+      buffer.zero_copy_id = zero_copy_sent_++;
+    }
+
+    if (buffer.written == buffer.size) {
+      head_ = (head_ + 1) % buffers_.size();
+      --filled_;
+    }
+
+    ReapCompletions();
+    if (CheckEnd(lock)) {
+      return;
+    }
+
+    StartWrite();
+    StartRead();
+  }
+
+  // mutex_ held, true if the link ended (lock released)
+  bool CheckEnd(std::unique_lock<std::recursive_mutex>& lock) {
+    if (!read_done_ || writing_ || filled_ > 0) {
+      return false;
+    }
+
+    if (zero_copy_completed_ != zero_copy_sent_ &&
+        drain_polls_ < kZeroCopyDrainPolls) {
+      // the output is closed by the handler, keep the buffers until the
+      // kernel has sent them
+      AsyncPoll();
+      return false;
+    }
+
+    Finish(lock, read_ec_);
+    return true;
+  }
+
+  // mutex_ held
+  void Finish(std::unique_lock<std::recursive_mutex>& lock,
+              const boost::system::error_code& ec) {
+    finished_ = true;
+    boost::system::error_code cancel_ec;
+    timer_.cancel(cancel_ec);
+    lock.unlock();
+    handler_(ec, 0);
+  }
+
+  // mutex_ held
+  bool IsReleased(Buffer& buffer) {
+    if (buffer.zero_copy_pending) {
+      ReapCompletions();
+      if (static_cast<int32_t>(buffer.zero_copy_id - zero_copy_completed_) >=
+          0) {
+        return false;
+      }
+      buffer.zero_copy_pending = false;
+    }
+
+    return true;
+  }
+
+  // mutex_ held
+  void ReapCompletions() {
+    if (!zero_copy_ || zero_copy_completed_ == zero_copy_sent_) {
+      return;
+    }
+
+    boost::system::error_code ec;
+    zero_copy_completed_ =
+        ReapZeroCopyCompletions(w_, zero_copy_completed_, ec);
+    if (ec) {
+      // closed output, no completion will come
+      zero_copy_completed_ = zero_copy_sent_;
+    }
+  }
+
+  // mutex_ held, wait for zero copy completions when no write wakes the link
+  void AsyncPoll() {
+    if (polling_) {
+      return;
+    }
+
+    polling_ = true;
+    boost::system::error_code ec;
+    timer_.expires_from_now(
+        std::chrono::milliseconds(kZeroCopyPollMilliseconds), ec);
+    auto self = this->shared_from_this();
+    timer_.async_wait([this, self](const boost::system::error_code& ec) {
+      std::unique_lock<std::recursive_mutex> lock(mutex_);
+      polling_ = false;
+      if (ec || finished_) {
+        return;
+      }
+
+      if (read_done_) {
+        ++drain_polls_;
+      }
+      ReapCompletions();
+      if (CheckEnd(lock)) {
+        return;
+      }
+      StartRead();
+    });
+  }
+
+ private:
+  ReadFromSocketType& r_;
+  WriteToSocketType& w_;
+  Handler handler_;
+
+  std::recursive_mutex mutex_;
+  std::vector<Buffer> buffers_;
+  // oldest filled buffer and number of filled buffers
+  std::size_t head_;
+  std::size_t filled_;
+  bool reading_;
+  bool writing_;
+  bool polling_;
+  bool read_done_;
+  bool finished_;
+  boost::system::error_code read_ec_;
+
+  bool zero_copy_;
+  uint32_t zero_copy_sent_;
+  uint32_t zero_copy_completed_;
+  uint32_t drain_polls_;
+  boost::asio::steady_timer timer_;
+
+  // operation memory recycled by the reads and by the writes
+  io::HandlerMemory read_memory_;
+  io::HandlerMemory write_memory_;
+};
+
+/// Establish a Half Duplex Link with several buffers in flight
+/**
+* The link owns its buffers and lives until the handler is called. The
+* sockets must outlive the link.
+*/
+template <typename Handler, class ReadFrom, class WriteTo>
+void AsyncEstablishPipelinedHDLink(ReadFrom rf, WriteTo wt,
+                                   const PipelinedLinkOptions& options,
+                                   Handler handler) {
+  AsyncPipelinedHDLinker<Handler, typename ReadFrom::type,
+                         typename WriteTo::type>::Create(rf.read_from_,
+                                                         wt.write_to_, options,
+                                                         handler)
+      ->Start();
+}
+
+}  // ssf
+
+#endif  // SSF_NETWORK_PIPELINED_LINK_H_
@@ -11,6 +11,7 @@
 
 #include <ssf/log/log.h>
 
+#include "ssf/io/handler_memory.h"
 #include "ssf/network/base_session.h"  // NOLINT
 #include "ssf/network/manager.h"
 #include "ssf/network/socket_link.h"
@@ -85,13 +86,13 @@ class SessionForwarder : public ssf::BaseSession {
     // Make two Half Duplex links to have a Full Duplex Link
     AsyncEstablishHDLink(
         ReadFrom(inbound_), WriteTo(outbound_),
-        boost::asio::buffer(inwardBuffer_),
+        boost::asio::buffer(inwardBuffer_), inward_handler_memory_,
         std::bind(&SessionForwarder::OnStop, this,
                   this->shared_from_this(), std::placeholders::_1));
 
     AsyncEstablishHDLink(
         ReadFrom(outbound_), WriteTo(inbound_),
-        boost::asio::buffer(forwardBuffer_),
+        boost::asio::buffer(forwardBuffer_), forward_handler_memory_,
         std::bind(&SessionForwarder::OnStop, this,
                   this->shared_from_this(), std::placeholders::_1));
   }
@@ -113,6 +114,10 @@ class SessionForwarder : public ssf::BaseSession {
   // One buffer for each Half Duplex Link
   StreamBuf inwardBuffer_;
   StreamBuf forwardBuffer_;
+
+  // Operation memory recycled by each Half Duplex Link
+  io::HandlerMemory inward_handler_memory_;
+  io::HandlerMemory forward_handler_memory_;
 };
 
 }  // ssf
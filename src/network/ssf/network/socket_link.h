@@ -9,6 +9,8 @@
 
 #include <boost/system/error_code.hpp>   // NOLINT
 
+#include "ssf/io/handler_memory.h"
+
 namespace ssf {
 
 /// Async Half Duplex Stream Socket Forwarder
@@ -28,16 +30,19 @@ struct AsyncHDSocketLinker : boost::asio::coroutine {
   * @param write_to output socket
   * @param working_buffer a single buffer to receive and send
   * @param handler the callback to call when the transfer stops
+  * @param p_memory storage recycled by the read and write operations of the
+  *   link (operations are allocated with the handler hooks when null)
   */
   AsyncHDSocketLinker(ReadFromSocketType& read_from,
                       WriteToSocketType& write_to,
                       boost::asio::mutable_buffers_1 working_buffer,
-                      Handler handler)
+                      Handler handler, io::HandlerMemory* p_memory = nullptr)
       : r_(read_from),
         w_(write_to),
         working_buffer_(working_buffer),
         handler_(handler),
-        transfered_bytes_(0) { }
+        transfered_bytes_(0),
+        p_memory_(p_memory) { }
 
 #include <boost/asio/detail/win_iocp_io_service.hpp>
 #include <boost/asio/yield.hpp>  // NOLINT
@@ -74,11 +79,31 @@ struct AsyncHDSocketLinker : boost::asio::coroutine {
   }
 #include <boost/asio/unyield.hpp>  // NOLINT
 
+  friend void* asio_handler_allocate(std::size_t size,
+                                     AsyncHDSocketLinker* this_handler) {
+    if (this_handler->p_memory_) {
+      return this_handler->p_memory_->allocate(size);
+    }
+    return boost_asio_handler_alloc_helpers::allocate(size,
+                                                      this_handler->handler_);
+  }
+
+  friend void asio_handler_deallocate(void* pointer, std::size_t size,
+                                      AsyncHDSocketLinker* this_handler) {
+    if (this_handler->p_memory_) {
+      this_handler->p_memory_->deallocate(pointer);
+      return;
+    }
+    boost_asio_handler_alloc_helpers::deallocate(pointer, size,
+                                                 this_handler->handler_);
+  }
+
   ReadFromSocketType& r_;
   WriteToSocketType& w_;
   boost::asio::mutable_buffers_1 working_buffer_;
   Handler handler_;
   size_t transfered_bytes_;
+  io::HandlerMemory* p_memory_;
 };
 
 /// Wrapper for the Stream Socket to read from
@@ -126,6 +151,22 @@ void AsyncEstablishHDLink(ReadFrom rf, WriteTo wt,
   AsyncTransfer(boost::system::error_code(), 0);
 }
 
+/// Establish a Half Duplex Link whose operations are allocated in memory
+/**
+* The memory must outlive the link. It is reused by each read and write of the
+* link, so that forwarding does not allocate per operation.
+*/
+template<typename Handler, class ReadFrom, class WriteTo>
+void AsyncEstablishHDLink(ReadFrom rf, WriteTo wt,
+                          boost::asio::mutable_buffers_1 working_buffer,
+                          io::HandlerMemory& memory, Handler handler) {
+  AsyncHDSocketLinker<Handler, typename ReadFrom::type, typename WriteTo::type>
+      AsyncTransfer(rf.read_from_, wt.write_to_, working_buffer, handler,
+                    &memory);
+
+  AsyncTransfer(boost::system::error_code(), 0);
+}
+
 }  // ssf
 
 #endif  // SSF_NETWORK_SOCKET_LINK_H_
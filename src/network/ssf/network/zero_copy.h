@@ -0,0 +1,131 @@
+#ifndef SSF_NETWORK_ZERO_COPY_H_
+#define SSF_NETWORK_ZERO_COPY_H_
+
+#include <cstdint>
+
+#include <utility>
+
+#include <boost/asio/buffer.hpp>  // NOLINT
+#include <boost/asio/ip/tcp.hpp>  // NOLINT
+
+#include <boost/system/error_code.hpp>  // NOLINT
+
+#if defined(__linux__)
+#include <errno.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <linux/errqueue.h>
+#endif  // defined(__linux__)
+
+#if defined(__linux__) && defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY) && \
+    defined(SO_EE_ORIGIN_ZEROCOPY)
+#define SSF_HAS_ZERO_COPY_SEND 1
+#endif
+
+namespace ssf {
+
+/// Zero copy sends on TCP sockets (Linux MSG_ZEROCOPY)
+/**
+* The kernel sends from the user pages instead of copying them into the socket
+* buffer. A sent buffer must not be modified until the kernel reports its
+* send as completed on the socket error queue: zero copy sends are numbered
+* from 0 in call order and completions are reported as ranges of numbers.
+*
+* Other stream types (fibers) and other platforms send with a copy.
+*/
+
+/// Enable zero copy sends on a stream
+/**
+* @return true if the stream sends with AsyncZeroCopySend without a copy
+*/
+template <class StreamType>
+bool EnableZeroCopy(StreamType&) {
+  return false;
+}
+
+inline bool EnableZeroCopy(boost::asio::ip::tcp::socket& socket) {
+#if defined(SSF_HAS_ZERO_COPY_SEND)
+  int one = 1;
+  return setsockopt(socket.native_handle(), SOL_SOCKET, SO_ZEROCOPY, &one,
+                    sizeof(one)) == 0;
+#else
+  return false;
+#endif
+}
+
+/// Send some bytes of a buffer, without a copy once enabled
+template <class StreamType, class Handler>
+void AsyncZeroCopySend(StreamType& stream, boost::asio::const_buffers_1 buffer,
+                       Handler&& handler) {
+  stream.async_write_some(buffer, std::forward<Handler>(handler));
+}
+
+template <class Handler>
+void AsyncZeroCopySend(boost::asio::ip::tcp::socket& socket,
+                       boost::asio::const_buffers_1 buffer,
+                       Handler&& handler) {
+#if defined(SSF_HAS_ZERO_COPY_SEND)
+  socket.async_send(buffer, MSG_ZEROCOPY, std::forward<Handler>(handler));
+#else
+  socket.async_write_some(buffer, std::forward<Handler>(handler));
+#endif
+}
+
+/// Read the send completions queued on a stream
+/**
+* @param completed number of zero copy sends known as completed
+* @param ec set if the error queue cannot be read (closed socket)
+* @return the number of zero copy sends completed
+*/
+template <class StreamType>
+uint32_t ReapZeroCopyCompletions(StreamType&, uint32_t completed,
+                                 boost::system::error_code&) {
+  return completed;
+}
+
+inline uint32_t ReapZeroCopyCompletions(boost::asio::ip::tcp::socket& socket,
+                                        uint32_t completed,
+                                        boost::system::error_code& ec) {
+#if defined(SSF_HAS_ZERO_COPY_SEND)
+  for (;;) {
+    char control[128];
+    msghdr msg = {};
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    if (recvmsg(socket.native_handle(), &msg, MSG_ERRQUEUE | MSG_DONTWAIT) ==
+        -1) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        ec.assign(errno, boost::system::system_category());
+      }
+      return completed;
+    }
+
+    for (cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm != nullptr;
+         cm = CMSG_NXTHDR(&msg, cm)) {
+      if (!((cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) ||
+            (cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR))) {
+        continue;
+      }
+
+      auto p_err = reinterpret_cast<sock_extended_err*>(CMSG_DATA(cm));
+      if (p_err->ee_errno != 0 ||
+          p_err->ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+        continue;
+      }
+
+      // sends [ee_info, ee_data] completed, TCP completes them in order
+      uint32_t next = p_err->ee_data + 1;
+      if (static_cast<int32_t>(next - completed) > 0) {
+        completed = next;
+      }
+    }
+  }
+#else
+  return completed;
+#endif
+}
+
+}  // ssf
+
+#endif  // SSF_NETWORK_ZERO_COPY_H_
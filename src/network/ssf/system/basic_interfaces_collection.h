@@ -1,14 +1,39 @@
 #ifndef SSF_SYSTEM_BASIC_INTERFACES_COLLECTION_H_
 #define SSF_SYSTEM_BASIC_INTERFACES_COLLECTION_H_
 
+#include <chrono>
+#include <functional>
 #include <string>
 
+#include <boost/asio/io_service.hpp>
+
 #include <boost/property_tree/ptree.hpp>
 #include <boost/system/error_code.hpp>
 
 namespace ssf {
 namespace system {
 
+// Delays between the remount attempts of an interface which went down
+//   The first attempt waits min_delay, each failed attempt doubles the delay
+//   up to max_delay. Each delay is shortened by a random part of up to
+//   jitter * delay so that the interfaces of a flapped link do not remount
+//   in lockstep.
+struct RemountPolicy {
+  RemountPolicy()
+      : min_delay(std::chrono::milliseconds(250)),
+        max_delay(std::chrono::seconds(60)),
+        jitter(0.5),
+        watch_links(false) {}
+
+  std::chrono::milliseconds min_delay;
+  std::chrono::milliseconds max_delay;
+  double jitter;
+
+  // Remount the down interfaces at once when the system reports a network
+  // link up (Linux netlink only)
+  bool watch_links;
+};
+
 class BasicInterfacesCollection {
  public:
   using PropertyTree = boost::property_tree::ptree;
@@ -24,6 +49,9 @@ class BasicInterfacesCollection {
                           const PropertyTree& property_tree,
                           MountCallback mount_handler) = 0;
 
+  virtual void SetRemountPolicy(const RemountPolicy& remount_policy) = 0;
+
+  // Remount the down interfaces now, without waiting for their next attempt
   virtual void RemountDownInterfaces() = 0;
 
   virtual void Umount(const std::string& interface_name) = 0;
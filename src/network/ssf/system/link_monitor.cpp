@@ -0,0 +1,124 @@
+#include "ssf/system/link_monitor.h"
+
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#endif  // defined(__linux__)
+
+#include "ssf/error/error.h"
+#include "ssf/log/log.h"
+
+namespace ssf {
+namespace system {
+
+LinkMonitor::LinkMonitor(boost::asio::io_service& io_service)
+    : mutex_(), link_up_handler_(), socket_(io_service), buffer_() {}
+
+LinkMonitor::~LinkMonitor() { Stop(); }
+
+void LinkMonitor::Start(LinkUpHandler link_up_handler,
+                        boost::system::error_code& ec) {
+#if defined(__linux__)
+  std::unique_lock<std::recursive_mutex> lock(mutex_);
+  if (socket_.is_open()) {
+    ec.assign(ssf::error::device_or_resource_busy,
+              ssf::error::get_ssf_category());
+    return;
+  }
+
+  sockaddr_nl address;
+  std::memset(&address, 0, sizeof(address));
+  address.nl_family = AF_NETLINK;
+  address.nl_groups = RTMGRP_LINK;
+
+  socket_.open(Protocol(AF_NETLINK, NETLINK_ROUTE), ec);
+  if (ec) {
+    return;
+  }
+
+  socket_.bind(Protocol::endpoint(&address, sizeof(address), NETLINK_ROUTE),
+               ec);
+  if (ec) {
+    boost::system::error_code close_ec;
+    socket_.close(close_ec);
+    return;
+  }
+
+  link_up_handler_ = std::move(link_up_handler);
+  DoReceive();
+#else
+  ec.assign(ssf::error::function_not_supported,
+            ssf::error::get_ssf_category());
+#endif  // defined(__linux__)
+}
+
+void LinkMonitor::Stop() {
+  std::unique_lock<std::recursive_mutex> lock(mutex_);
+  boost::system::error_code ec;
+  socket_.close(ec);
+  link_up_handler_ = LinkUpHandler();
+}
+
+void LinkMonitor::DoReceive() {
+  socket_.async_receive(
+      boost::asio::buffer(buffer_),
+      std::bind(&LinkMonitor::ReceiveHandler, this, std::placeholders::_1,
+                std::placeholders::_2));
+}
+
+void LinkMonitor::ReceiveHandler(const boost::system::error_code& ec,
+                                 std::size_t length) {
+  if (ec) {
+    if (ec != boost::asio::error::operation_aborted) {
+      SSF_LOG("network_link_monitor", debug, "receive failed ({})",
+              ec.message());
+    }
+    return;
+  }
+
+#if defined(__linux__)
+  std::unique_lock<std::recursive_mutex> lock(mutex_);
+  if (!socket_.is_open()) {
+    return;
+  }
+
+  int remaining = static_cast<int>(length);
+  for (auto p_header = reinterpret_cast<nlmsghdr*>(buffer_.data());
+       NLMSG_OK(p_header, remaining);
+       p_header = NLMSG_NEXT(p_header, remaining)) {
+    if (p_header->nlmsg_type != RTM_NEWLINK) {
+      continue;
+    }
+
+    auto p_info = reinterpret_cast<ifinfomsg*>(NLMSG_DATA(p_header));
+    if (!(p_info->ifi_flags & IFF_RUNNING)) {
+      continue;
+    }
+
+    std::string link_name;
+    int attributes_length = IFLA_PAYLOAD(p_header);
+    for (auto p_attribute = IFLA_RTA(p_info);
+         RTA_OK(p_attribute, attributes_length);
+         p_attribute = RTA_NEXT(p_attribute, attributes_length)) {
+      if (p_attribute->rta_type == IFLA_IFNAME) {
+        link_name = reinterpret_cast<const char*>(RTA_DATA(p_attribute));
+        break;
+      }
+    }
+
+    SSF_LOG("network_link_monitor", debug, "link {} up", link_name);
+    if (link_up_handler_) {
+      link_up_handler_(link_name);
+    }
+  }
+
+  DoReceive();
+#endif  // defined(__linux__)
+}
+
+}  // system
+}  // ssf
@@ -0,0 +1,55 @@
+#ifndef SSF_SYSTEM_LINK_MONITOR_H_
+#define SSF_SYSTEM_LINK_MONITOR_H_
+
+#include <array>
+#include <functional>
+#include <mutex>
+#include <string>
+
+#include <boost/asio/generic/raw_protocol.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/system/error_code.hpp>
+
+namespace ssf {
+namespace system {
+
+// Notifications of the network links going up
+//   Linux reports the link state changes on a netlink socket (RTMGRP_LINK
+//   group). Start fails with function_not_supported on other platforms.
+class LinkMonitor {
+ public:
+  using LinkUpHandler = std::function<void(const std::string& link_name)>;
+
+ public:
+  explicit LinkMonitor(boost::asio::io_service& io_service);
+
+  LinkMonitor(const LinkMonitor&) = delete;
+
+  LinkMonitor& operator=(const LinkMonitor&) = delete;
+
+  ~LinkMonitor();
+
+  // Call link_up_handler each time a link goes up, until Stop
+  void Start(LinkUpHandler link_up_handler, boost::system::error_code& ec);
+
+  void Stop();
+
+ private:
+  using Protocol = boost::asio::generic::raw_protocol;
+
+ private:
+  void DoReceive();
+
+  void ReceiveHandler(const boost::system::error_code& ec, std::size_t length);
+
+ private:
+  std::recursive_mutex mutex_;
+  LinkUpHandler link_up_handler_;
+  Protocol::socket socket_;
+  std::array<char, 8192> buffer_;
+};
+
+}  // system
+}  // ssf
+
+#endif  // SSF_SYSTEM_LINK_MONITOR_H_
@@ -1,8 +1,11 @@
 #ifndef SSF_SYSTEM_SPECIFIC_INTERFACES_COLLECTION_H_
 #define SSF_SYSTEM_SPECIFIC_INTERFACES_COLLECTION_H_
 
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
 #include <mutex>
+#include <random>
 #include <string>
 #include <unordered_set>
 
@@ -49,13 +52,26 @@ class SpecificInterfacesCollection : public BasicInterfacesCollection {
     int ttl;
     int delay;
     MountCallback mount_callback;
+
+    // Remount state of an interface which went down
+    bool remounting;
+    uint32_t remount_attempts;
+    // Incremented to discard the scheduled attempt
+    uint64_t remount_generation;
+    TimerPtr p_remount_timer;
   };
 
  public:
   enum { DEFAULT_TTL = 1, DEFAULT_DELAY = 0 };
 
  public:
-  explicit SpecificInterfacesCollection() : interfaces_() {}
+  explicit SpecificInterfacesCollection()
+      : interfaces_mutex_(),
+        interfaces_(),
+        interfaces_config_(),
+        interfaces_up_(),
+        remount_policy_(),
+        random_generator_(std::random_device()()) {}
 
   virtual ~SpecificInterfacesCollection() { UmountAll(); }
 
@@ -111,6 +127,11 @@ class SpecificInterfacesCollection : public BasicInterfacesCollection {
     }
   }
 
+  virtual void SetRemountPolicy(const RemountPolicy& remount_policy) {
+    std::unique_lock<std::recursive_mutex> lock_interfaces(interfaces_mutex_);
+    remount_policy_ = remount_policy;
+  }
+
   virtual void RemountDownInterfaces() {
     std::unique_lock<std::recursive_mutex> lock_interfaces(interfaces_mutex_);
     auto interface_up_it = interfaces_up_.begin();
@@ -122,12 +143,16 @@ class SpecificInterfacesCollection : public BasicInterfacesCollection {
         interface_up_it = interfaces_up_.erase(interface_up_it);
         continue;
       } else {
+        // An open interface is up or has a remount attempt in progress
         if (!interface_it->second.is_open()) {
           auto& interface_name = *interface_up_it;
           SSF_LOG("network_interface", trace, "{} down", interface_name);
 
-          const auto& config = interfaces_config_[interface_name];
-          InitializeInterface(*interface_up_it, config.ttl);
+          auto& config = interfaces_config_[interface_name];
+          config.remounting = true;
+          config.remount_attempts = 0;
+          ++config.remount_generation;
+          Remount(interface_name);
         }
         ++interface_up_it;
       }
@@ -138,6 +163,7 @@ class SpecificInterfacesCollection : public BasicInterfacesCollection {
     std::unique_lock<std::recursive_mutex> lock_interfaces(interfaces_mutex_);
     auto interface_it = interfaces_.find(interface_name);
     if (interface_it != interfaces_.end()) {
+      UnwatchInterface(interface_name);
       interfaces_.erase(interface_it);
       interfaces_up_.erase(interface_name);
       interfaces_config_.erase(interface_name);
@@ -148,6 +174,7 @@ class SpecificInterfacesCollection : public BasicInterfacesCollection {
     std::unique_lock<std::recursive_mutex> lock_interfaces(interfaces_mutex_);
     auto interface_it = interfaces_.begin();
     while (interface_it != interfaces_.end()) {
+      UnwatchInterface(interface_it->first);
       interfaces_config_.erase(interface_it->first);
       interfaces_up_.erase(interface_it->first);
       interface_it = interfaces_.erase(interface_it);
@@ -162,6 +189,9 @@ class SpecificInterfacesCollection : public BasicInterfacesCollection {
     p_config->ttl = DEFAULT_TTL;
     p_config->delay = DEFAULT_DELAY;
     p_config->mount_callback = mount_handler;
+    p_config->remounting = false;
+    p_config->remount_attempts = 0;
+    p_config->remount_generation = 0;
 
     auto given_type = property_tree.get_child_optional("type");
     if (given_type && given_type.get().data() == "ACCEPT") {
@@ -266,6 +296,8 @@ class SpecificInterfacesCollection : public BasicInterfacesCollection {
                   interface_name));
           interfaces_.erase(interface_name);
           interfaces_config_.erase(interface_name);
+        } else if (config.remounting) {
+          ScheduleRemount(interface_name);
         }
         return;
       }
@@ -281,6 +313,7 @@ class SpecificInterfacesCollection : public BasicInterfacesCollection {
 
     SSF_LOG("network_interface", trace, "{} up", interface_name);
     interfaces_up_.insert(interface_name);
+    WatchInterface(interface_name);
 
     interface_it->second.get_io_service().post(
         boost::asio::detail::binder2<MountCallback, boost::system::error_code,
@@ -316,11 +349,15 @@ class SpecificInterfacesCollection : public BasicInterfacesCollection {
                 interface_name));
         interfaces_.erase(interface_name);
         interfaces_config_.erase(interface_name);
+      } else if (config.remounting) {
+        ScheduleRemount(interface_name);
       }
       return;
     }
 
+    SSF_LOG("network_interface", trace, "{} up", interface_name);
     interfaces_up_.insert(interface_name);
+    WatchInterface(interface_name);
 
     interface_it->second.get_io_service().post(
         boost::asio::detail::binder2<MountCallback, boost::system::error_code,
@@ -343,11 +380,121 @@ class SpecificInterfacesCollection : public BasicInterfacesCollection {
     }
   }
 
+  // Remount the interface as soon as its socket goes down
+  void WatchInterface(const std::string& interface_name) {
+    auto& config = interfaces_config_[interface_name];
+    if (config.remounting) {
+      SSF_LOG("network_interface", debug, "{} remounted", interface_name);
+    }
+    config.remounting = false;
+    config.remount_attempts = 0;
+    ++config.remount_generation;
+
+    auto p_socket_optional =
+        InterfaceProtocol::get_interface_manager().Find(interface_name);
+    if (!p_socket_optional) {
+      return;
+    }
+    (*p_socket_optional)->set_close_handler([this, interface_name]() {
+      this->InterfaceDownHandler(interface_name);
+    });
+  }
+
+  void UnwatchInterface(const std::string& interface_name) {
+    auto config_it = interfaces_config_.find(interface_name);
+    if (config_it != interfaces_config_.end()) {
+      ++config_it->second.remount_generation;
+      if (config_it->second.p_remount_timer) {
+        boost::system::error_code ec;
+        config_it->second.p_remount_timer->cancel(ec);
+      }
+    }
+
+    auto p_socket_optional =
+        InterfaceProtocol::get_interface_manager().Find(interface_name);
+    if (p_socket_optional) {
+      (*p_socket_optional)->set_close_handler(std::function<void()>());
+    }
+  }
+
+  void InterfaceDownHandler(const std::string& interface_name) {
+    std::unique_lock<std::recursive_mutex> lock_interfaces(interfaces_mutex_);
+    if (interfaces_.find(interface_name) == interfaces_.end() ||
+        interfaces_up_.find(interface_name) == interfaces_up_.end()) {
+      return;
+    }
+
+    auto& config = interfaces_config_[interface_name];
+    if (config.remounting) {
+      return;
+    }
+
+    SSF_LOG("network_interface", trace, "{} down", interface_name);
+    config.remounting = true;
+    config.remount_attempts = 0;
+    ScheduleRemount(interface_name);
+  }
+
+  // Wait for the next remount attempt (exponential backoff with jitter)
+  void ScheduleRemount(const std::string& interface_name) {
+    auto interface_it = interfaces_.find(interface_name);
+    if (interface_it == interfaces_.end()) {
+      return;
+    }
+
+    auto& config = interfaces_config_[interface_name];
+    auto delay = remount_policy_.min_delay;
+    for (uint32_t i = 0;
+         i < config.remount_attempts && delay < remount_policy_.max_delay;
+         ++i) {
+      delay *= 2;
+    }
+    delay = std::min(delay, remount_policy_.max_delay);
+
+    std::uniform_real_distribution<double> jitter_distribution(
+        0.0, std::max(0.0, std::min(1.0, remount_policy_.jitter)));
+    delay = std::chrono::milliseconds(static_cast<int64_t>(
+        delay.count() * (1.0 - jitter_distribution(random_generator_))));
+
+    ++config.remount_attempts;
+    uint64_t generation = ++config.remount_generation;
+    if (!config.p_remount_timer) {
+      config.p_remount_timer = std::make_shared<boost::asio::steady_timer>(
+          interface_it->second.get_io_service());
+    }
+
+    SSF_LOG("network_interface", trace, "{} remount attempt {} in {}ms",
+            interface_name, config.remount_attempts, delay.count());
+
+    config.p_remount_timer->expires_from_now(delay);
+    config.p_remount_timer->async_wait([this, interface_name, generation](
+        const boost::system::error_code& ec) {
+      if (ec) {
+        return;
+      }
+      std::unique_lock<std::recursive_mutex> lock_interfaces(
+          this->interfaces_mutex_);
+      auto config_it = this->interfaces_config_.find(interface_name);
+      if (config_it == this->interfaces_config_.end() ||
+          config_it->second.remount_generation != generation) {
+        return;
+      }
+      this->Remount(interface_name);
+    });
+  }
+
+  void Remount(const std::string& interface_name) {
+    const auto& config = interfaces_config_[interface_name];
+    InitializeInterface(interface_name, config.ttl);
+  }
+
  private:
   std::recursive_mutex interfaces_mutex_;
   std::map<std::string, Interface<LayerStack>> interfaces_;
   std::map<std::string, InterfaceConfig> interfaces_config_;
   std::unordered_set<std::string> interfaces_up_;
+  RemountPolicy remount_policy_;
+  std::mt19937 random_generator_;
 };
 
 }  // system
@@ -13,6 +13,7 @@
 #include <boost/system/error_code.hpp>
 
 #include "ssf/error/error.h"
+#include "ssf/log/log.h"
 
 #include "ssf/system/specific_interfaces_collection.h"
 #include "ssf/system/system_interfaces.h"
@@ -25,7 +26,8 @@ SystemInterfaces::SystemInterfaces(boost::asio::io_service& io_service)
       p_worker_(nullptr),
       interfaces_collections_mutex_(),
       interfaces_collection_map_(),
-      remount_timer_(io_service_) {}
+      remount_policy_(),
+      link_monitor_(io_service_) {}
 
 SystemInterfaces::~SystemInterfaces() { Stop(); }
 
@@ -83,18 +85,40 @@ void SystemInterfaces::UmountAll() {
   }
 }
 
-void SystemInterfaces::Start(int remount_delay) {
-  if (!p_worker_) {
-    p_worker_ = std::unique_ptr<boost::asio::io_service::work>(
-        new boost::asio::io_service::work(io_service_));
-    LaunchRemountTimer(remount_delay);
+void SystemInterfaces::Start(const RemountPolicy& remount_policy) {
+  if (p_worker_) {
+    return;
+  }
+
+  p_worker_ = std::unique_ptr<boost::asio::io_service::work>(
+      new boost::asio::io_service::work(io_service_));
+
+  {
+    std::unique_lock<std::recursive_mutex> lock_interfaces_collections(
+        interfaces_collections_mutex_);
+    remount_policy_ = remount_policy;
+    for (auto& interfaces_collection_pair : interfaces_collection_map_) {
+      interfaces_collection_pair.second->SetRemountPolicy(remount_policy_);
+    }
+  }
+
+  if (remount_policy.watch_links) {
+    boost::system::error_code ec;
+    link_monitor_.Start(std::bind(&SystemInterfaces::LinkUpHandler, this,
+                                  std::placeholders::_1),
+                        ec);
+    if (ec) {
+      SSF_LOG("network_interface", warn,
+              "link monitoring unavailable, interfaces remount on their own "
+              "delays ({})",
+              ec.message());
+    }
   }
 }
 
 void SystemInterfaces::Stop() {
-  boost::system::error_code ec;
+  link_monitor_.Stop();
   UmountAll();
-  remount_timer_.cancel(ec);
   if (p_worker_) {
     p_worker_.reset();
   }
@@ -121,20 +145,13 @@ boost::optional<std::string> SystemInterfaces::GetCollectionNameFromLayerStack(
   }
 }
 
-void SystemInterfaces::LaunchRemountTimer(int remount_delay) {
-  remount_timer_.expires_from_now(std::chrono::seconds(remount_delay));
-  remount_timer_.async_wait(std::bind(&SystemInterfaces::RemountTimerHandler,
-                                      this, std::placeholders::_1,
-                                      remount_delay));
-}
-
-void SystemInterfaces::RemountTimerHandler(const boost::system::error_code& ec,
-                                           int remount_delay) {
-  if (!ec) {
-    for (auto& interfaces_collection_pair : interfaces_collection_map_) {
-      interfaces_collection_pair.second->RemountDownInterfaces();
-    }
-    LaunchRemountTimer(remount_delay);
+void SystemInterfaces::LinkUpHandler(const std::string& link_name) {
+  SSF_LOG("network_interface", debug, "link {} up, remount down interfaces",
+          link_name);
+  std::unique_lock<std::recursive_mutex> lock_interfaces_collections(
+      interfaces_collections_mutex_);
+  for (auto& interfaces_collection_pair : interfaces_collection_map_) {
+    interfaces_collection_pair.second->RemountDownInterfaces();
   }
 }
 
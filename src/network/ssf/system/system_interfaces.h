@@ -5,29 +5,32 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 
 #include <boost/asio/io_service.hpp>
-#include <boost/asio/steady_timer.hpp>
 
 #include <boost/optional.hpp>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/system/error_code.hpp>
 
 #include "ssf/system/basic_interfaces_collection.h"
+#include "ssf/system/link_monitor.h"
 #include "ssf/system/specific_interfaces_collection.h"
 
 namespace ssf {
 namespace system {
 
+// Interfaces mounted from a configuration file
+//   An interface going down is remounted by its collection after a jittered
+//   exponential backoff (see RemountPolicy). With RemountPolicy::watch_links,
+//   the down interfaces are remounted at once when a network link goes up.
 class SystemInterfaces {
  public:
   using PropertyTree = boost::property_tree::ptree;
   using InterfacesCollectionPtr = std::unique_ptr<BasicInterfacesCollection>;
   using InterfaceUpHandler = BasicInterfacesCollection::MountCallback;
 
-  enum { DEFAULT_REMOUNT_DELAY_SEC = 60 };
-
  public:
   explicit SystemInterfaces(boost::asio::io_service& io_service);
 
@@ -41,14 +44,17 @@ class SystemInterfaces {
   bool RegisterInterfacesCollection() {
     std::string stack_id(LayerStack::get_name());
 
+    std::unique_lock<std::recursive_mutex> lock_interfaces_collections(
+        interfaces_collections_mutex_);
     if (interfaces_collection_map_.find(stack_id) !=
         interfaces_collection_map_.end()) {
       return false;
     }
 
-    interfaces_collection_map_.emplace(
-        stack_id, std::unique_ptr<SpecificInterfacesCollection<LayerStack>>(
-                      new SpecificInterfacesCollection<LayerStack>()));
+    std::unique_ptr<SpecificInterfacesCollection<LayerStack>> p_collection(
+        new SpecificInterfacesCollection<LayerStack>());
+    p_collection->SetRemountPolicy(remount_policy_);
+    interfaces_collection_map_.emplace(stack_id, std::move(p_collection));
 
     return true;
   }
@@ -65,7 +71,7 @@ class SystemInterfaces {
 
   void UmountAll();
 
-  void Start(int remount_delay = DEFAULT_REMOUNT_DELAY_SEC);
+  void Start(const RemountPolicy& remount_policy = RemountPolicy());
 
   void Stop();
 
@@ -75,17 +81,15 @@ class SystemInterfaces {
   boost::optional<std::string> GetCollectionNameFromLayerStack(
       const PropertyTree& property_tree);
 
-  void LaunchRemountTimer(int remount_delay);
-
-  void RemountTimerHandler(const boost::system::error_code& ec,
-                           int remount_delay);
+  void LinkUpHandler(const std::string& link_name);
 
  private:
   boost::asio::io_service& io_service_;
   std::unique_ptr<boost::asio::io_service::work> p_worker_;
   std::recursive_mutex interfaces_collections_mutex_;
   std::map<std::string, InterfacesCollectionPtr> interfaces_collection_map_;
-  boost::asio::steady_timer remount_timer_;
+  RemountPolicy remount_policy_;
+  LinkMonitor link_monitor_;
 };
 
 }  // system
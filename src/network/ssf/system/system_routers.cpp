@@ -120,7 +120,7 @@ uint32_t SystemRouters::AsyncConfig(
   return static_cast<uint32_t>(added_routers.size());
 }
 
-void SystemRouters::Start(int remount_delay) {
+void SystemRouters::Start(const RemountPolicy& remount_policy) {
   using TCPProtocol = ssf::layer::physical::TCPPhysicalLayer;
   using TLSoTCPProtocol =
       ssf::layer::physical::TLSboTCPPhysicalLayer;
@@ -136,7 +136,7 @@ void SystemRouters::Start(int remount_delay) {
   system_interfaces_.RegisterInterfacesCollection<CircuitTCPProtocol>();
   system_interfaces_.RegisterInterfacesCollection<CircuitTLSoTCPProtocol>();
 
-  system_interfaces_.Start(remount_delay);
+  system_interfaces_.Start(remount_policy);
 }
 
 void SystemRouters::Stop() {
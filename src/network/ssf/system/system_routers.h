@@ -60,7 +60,7 @@ class SystemRouters {
                        AllRoutersUpHandler all_up_handler =
                            [](const boost::system::error_code&) {});
 
-  void Start(int remount_delay = SystemInterfaces::DEFAULT_REMOUNT_DELAY_SEC);
+  void Start(const RemountPolicy& remount_policy = RemountPolicy());
 
   void Stop();
 
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdlib>
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <new>
+#include <vector>
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+
+#include "ssf/io/handler_memory.h"
+#include "ssf/network/socket_link.h"
+
+namespace {
+std::atomic<std::size_t> heap_allocations(0);
+}
+
+void* operator new(std::size_t size) {
+  ++heap_allocations;
+  if (void* p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+class HandlerMemoryTest : public ::testing::Test {
+ protected:
+  using Socket = boost::asio::ip::tcp::socket;
+
+  HandlerMemoryTest()
+      : io_service_(),
+        client_(io_service_),
+        link_in_(io_service_),
+        link_out_(io_service_),
+        server_(io_service_) {}
+
+  void SetUp() override {
+    boost::asio::ip::tcp::acceptor acceptor(
+        io_service_, boost::asio::ip::tcp::endpoint(
+                         boost::asio::ip::address_v4::loopback(), 0));
+    client_.connect(acceptor.local_endpoint());
+    acceptor.accept(link_in_);
+    link_out_.connect(acceptor.local_endpoint());
+    acceptor.accept(server_);
+  }
+
+  /// Send packets through the half duplex link one at a time
+  /**
+  * @return the number of heap allocations made during the transfer
+  */
+  std::size_t Forward(std::size_t packet_count) {
+    std::array<uint8_t, 256> packet;
+    std::array<uint8_t, 256> received;
+    packet.fill(42);
+
+    std::size_t allocations_before = heap_allocations;
+    for (std::size_t i = 0; i < packet_count; ++i) {
+      boost::asio::write(client_, boost::asio::buffer(packet));
+      while (server_.available() < packet.size()) {
+        io_service_.run_one();
+      }
+      boost::asio::read(server_, boost::asio::buffer(received));
+      EXPECT_EQ(packet, received);
+    }
+
+    return heap_allocations - allocations_before;
+  }
+
+  boost::asio::io_service io_service_;
+  Socket client_;
+  Socket link_in_;
+  Socket link_out_;
+  Socket server_;
+  std::array<char, 1024> working_buffer_;
+  ssf::io::HandlerMemory memory_;
+};
+
+TEST_F(HandlerMemoryTest, RecycleStorage) {
+  ssf::io::HandlerMemory memory;
+
+  void* p_first = memory.allocate(64);
+  void* p_second = memory.allocate(64);
+  EXPECT_NE(p_first, p_second);
+  memory.deallocate(p_second);
+  memory.deallocate(p_first);
+
+  void* p_third = memory.allocate(64);
+  EXPECT_EQ(p_first, p_third);
+  memory.deallocate(p_third);
+
+  void* p_big = memory.allocate(64 * 1024);
+  EXPECT_NE(p_first, p_big);
+  memory.deallocate(p_big);
+}
+
+TEST_F(HandlerMemoryTest, HalfDuplexLinkForwardsWithoutAllocation) {
+  const std::size_t packet_count = 1000;
+
+  ssf::AsyncEstablishHDLink(
+      ssf::ReadFrom(link_in_), ssf::WriteTo(link_out_),
+      boost::asio::buffer(working_buffer_), memory_,
+      [](const boost::system::error_code&, std::size_t) {});
+
+  // Let the link reach its steady state before counting
+  Forward(10);
+  std::size_t allocations = Forward(packet_count);
+
+  EXPECT_LT(allocations, packet_count / 10)
+      << "heap allocations for " << packet_count << " forwarded packets";
+}
@@ -2,6 +2,8 @@
 
 #include <cstdint>
 
+#include <atomic>
+#include <chrono>
 #include <future>
 #include <vector>
 
@@ -47,7 +49,9 @@ class SystemTestFixture : public ::testing::Test {
         system_multiple_config_filename_(
             "./system/system_multiple_config.json"),
         system_reconnect_config_filename_(
-            "./system/system_reconnect_config.json") {}
+            "./system/system_reconnect_config.json"),
+        system_remount_config_filename_(
+            "./system/system_remount_config.json") {}
 
   virtual ~SystemTestFixture() {}
 
@@ -71,6 +75,7 @@ class SystemTestFixture : public ::testing::Test {
   std::string circuit_tlsotcp_connect_filename_;
   std::string system_multiple_config_filename_;
   std::string system_reconnect_config_filename_;
+  std::string system_remount_config_filename_;
 };
 
 template <class Protocol>
@@ -276,6 +281,111 @@ TEST_F(SystemTestFixture, ImportHeterogeneousInterfaces) {
   system_interfaces.UnregisterAllInterfacesCollection();
 }
 
+// Time to recover of an interface whose link goes down: the remote end closes
+// the connection and the interface remounts on the close event
+TEST_F(SystemTestFixture, RemountInterfaceAfterLinkDown) {
+  using TCPProtocol = ssf::layer::physical::TCPPhysicalLayer;
+  using InterfaceProtocol =
+      ssf::layer::interface_layer::basic_InterfaceProtocol;
+  using Clock = std::chrono::steady_clock;
+
+  boost::asio::io_service io_service;
+  ssf::system::SystemInterfaces system_interfaces(io_service);
+
+  ssf::system::RemountPolicy remount_policy;
+  remount_policy.min_delay = std::chrono::milliseconds(100);
+  system_interfaces.Start(remount_policy);
+
+  ASSERT_TRUE(system_interfaces.RegisterInterfacesCollection<TCPProtocol>());
+
+  boost::system::error_code ec;
+  boost::asio::ip::tcp::acceptor acceptor(io_service);
+  boost::asio::ip::tcp::socket first_socket(io_service);
+  boost::asio::ip::tcp::socket second_socket(io_service);
+  boost::asio::ip::tcp::endpoint ep(boost::asio::ip::tcp::v4(), 8010);
+  acceptor.open(ep.protocol(), ec);
+  acceptor.set_option(boost::asio::socket_base::reuse_address(true), ec);
+  acceptor.bind(ep, ec);
+  acceptor.listen(boost::asio::socket_base::max_connections, ec);
+  ASSERT_EQ(ec.value(), 0) << "Could not listen on the interface endpoint";
+
+  std::promise<bool> first_accepted;
+  std::promise<bool> first_up;
+  std::promise<bool> remounted;
+  std::atomic<uint32_t> nb_interface_ups(0);
+  int dummy_buf;
+
+  auto interface_up_handler = [&](const boost::system::error_code& up_ec,
+                                  const std::string& interface_name) {
+    SSF_LOG("test", trace, "interface {} up ({})", interface_name,
+            up_ec.message());
+    auto nb_ups = ++nb_interface_ups;
+    if (!up_ec) {
+      // A pending receive detects the connection closing
+      auto socket_optional =
+          InterfaceProtocol::get_interface_manager().Find(interface_name);
+      if (socket_optional) {
+        (*socket_optional)
+            ->async_receive(
+                boost::asio::buffer(&dummy_buf, sizeof(dummy_buf)),
+                [](const boost::system::error_code&, std::size_t) {});
+      }
+    }
+    if (nb_ups == 1) {
+      first_up.set_value(!up_ec);
+    } else if (nb_ups == 2) {
+      remounted.set_value(!up_ec);
+    }
+  };
+
+  auto first_accept_handler =
+      [&first_accepted](const boost::system::error_code& accept_ec) {
+        first_accepted.set_value(!accept_ec);
+      };
+  acceptor.async_accept(first_socket, first_accept_handler);
+
+  system_interfaces.AsyncMount(system_remount_config_filename_,
+                               interface_up_handler);
+
+  std::vector<std::thread> threads;
+  for (uint16_t i = 1; i <= std::thread::hardware_concurrency(); ++i) {
+    threads.emplace_back([&io_service]() { io_service.run(); });
+  }
+
+  ASSERT_TRUE(first_up.get_future().get()) << "Interface not mounted";
+  ASSERT_TRUE(first_accepted.get_future().get()) << "Connection not accepted";
+
+  acceptor.async_accept(second_socket,
+                        [](const boost::system::error_code&) {});
+
+  auto link_down_time = Clock::now();
+  first_socket.close(ec);
+
+  auto remounted_future = remounted.get_future();
+  ASSERT_EQ(remounted_future.wait_for(std::chrono::seconds(10)),
+            std::future_status::ready)
+      << "Interface not remounted";
+  auto time_to_recover = std::chrono::duration_cast<std::chrono::milliseconds>(
+      Clock::now() - link_down_time);
+  EXPECT_TRUE(remounted_future.get()) << "Interface remount failed";
+
+  SSF_LOG("test", info, "interface remounted in {}ms", time_to_recover.count());
+  EXPECT_LT(time_to_recover, std::chrono::seconds(1))
+      << "Interface should remount within its first backoff delays";
+
+  system_interfaces.Stop();
+  acceptor.close(ec);
+  second_socket.close(ec);
+
+  for (auto& thread : threads) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+
+  system_interfaces.UnregisterAllInterfacesCollection();
+}
+
 /*TEST_F(SystemTestFixture, ReconnectHeterogeneousInterfaces) {
   using TCPProtocol = ssf::layer::physical::TCPPhysicalLayer;
   using InterfaceProtocol =
@@ -284,7 +394,7 @@ TEST_F(SystemTestFixture, ImportHeterogeneousInterfaces) {
   boost::asio::io_service io_service;
   ssf::system::SystemInterfaces system_interfaces(io_service);
 
-  system_interfaces.Start(1);
+  system_interfaces.Start();
 
   ASSERT_TRUE(system_interfaces.RegisterInterfacesCollection<TCPProtocol>());
 
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+#include <thread>
+#include <vector>
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+
+#include "ssf/network/pipelined_link.h"
+
+class PipelinedLinkTest : public ::testing::Test {
+ protected:
+  using Socket = boost::asio::ip::tcp::socket;
+
+  PipelinedLinkTest()
+      : io_service_(),
+        client_(io_service_),
+        link_in_(io_service_),
+        link_out_(io_service_),
+        server_(io_service_) {}
+
+  void SetUp() override {
+    boost::asio::ip::tcp::acceptor acceptor(
+        io_service_, boost::asio::ip::tcp::endpoint(
+                         boost::asio::ip::address_v4::loopback(), 0));
+    client_.connect(acceptor.local_endpoint());
+    acceptor.accept(link_in_);
+    link_out_.connect(acceptor.local_endpoint());
+    acceptor.accept(server_);
+  }
+
+  /// Send data through the half duplex link and check it on the other side
+  void Forward(const ssf::PipelinedLinkOptions& options, std::size_t size) {
+    std::vector<uint8_t> sent(size);
+    for (std::size_t i = 0; i < sent.size(); ++i) {
+      sent[i] = static_cast<uint8_t>(i * 7 + i / 4096);
+    }
+
+    bool link_ended = false;
+    boost::system::error_code link_ec;
+    ssf::AsyncEstablishPipelinedHDLink(
+        ssf::ReadFrom(link_in_), ssf::WriteTo(link_out_), options,
+        [&](const boost::system::error_code& ec, std::size_t) {
+          link_ended = true;
+          link_ec = ec;
+        });
+
+    std::thread io_thread([this]() { io_service_.run(); });
+
+    std::thread writer([this, &sent]() {
+      boost::asio::write(client_, boost::asio::buffer(sent));
+      boost::system::error_code ec;
+      client_.shutdown(boost::asio::socket_base::shutdown_send, ec);
+    });
+
+    std::vector<uint8_t> received(size);
+    boost::system::error_code read_ec;
+    boost::asio::read(server_, boost::asio::buffer(received), read_ec);
+
+    writer.join();
+    io_thread.join();
+
+    EXPECT_EQ(read_ec.value(), 0);
+    EXPECT_TRUE(sent == received) << "forwarded data differs";
+    EXPECT_TRUE(link_ended);
+    EXPECT_EQ(link_ec, boost::asio::error::eof);
+  }
+
+  boost::asio::io_service io_service_;
+  Socket client_;
+  Socket link_in_;
+  Socket link_out_;
+  Socket server_;
+};
+
+TEST_F(PipelinedLinkTest, SingleBufferTest) {
+  ssf::PipelinedLinkOptions options;
+  options.buffer_size = 4096;
+  options.buffers = 1;
+
+  Forward(options, 4 * 1024 * 1024);
+}
+
+TEST_F(PipelinedLinkTest, SeveralBuffersTest) {
+  ssf::PipelinedLinkOptions options;
+  options.buffer_size = 4096;
+  options.buffers = 4;
+
+  Forward(options, 4 * 1024 * 1024);
+}
+
+TEST_F(PipelinedLinkTest, ZeroCopyTest) {
+  // sent with a copy where zero copy is not available
+  ssf::PipelinedLinkOptions options;
+  options.buffer_size = 64 * 1024;
+  options.buffers = 3;
+  options.zero_copy = true;
+
+  Forward(options, 16 * 1024 * 1024);
+}
@@ -1,4 +1,6 @@
+#include <chrono>
 #include <condition_variable>
+#include <functional>
 #include <mutex>
 
 #include <boost/asio/io_service.hpp>
@@ -76,7 +78,8 @@ void Run(int argc, char** argv, boost::system::error_code& exit_ec) {
   ssf_config.services().SetGatewayPorts(cmd.gateway_ports());
 
   // initialize and run the server
-  Server server(ssf_config.services(), cmd.relay_only());
+  Server server(ssf_config.services(), cmd.relay_only(), ssf_config.quotas(),
+                cmd.reuse_port());
 
   // construct endpoint parameter stack
   auto endpoint_query = NetworkProtocol::GenerateServerQuery(
@@ -96,22 +99,38 @@ void Run(int argc, char** argv, boost::system::error_code& exit_ec) {
   std::condition_variable wait_stop_cv;
   std::mutex mutex;
   bool stopped = false;
+  bool draining = false;
   boost::asio::signal_set signal(server.get_io_service(), SIGINT, SIGTERM);
 
-  signal.async_wait([&wait_stop_cv, &mutex, &stopped](
+  auto notify_stop = [&wait_stop_cv, &mutex, &stopped]() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopped = true;
+    }
+    wait_stop_cv.notify_all();
+  };
+
+  // First signal drains the connections if a drain timeout is set, the next
+  // one stops the server
+  std::function<void(const boost::system::error_code&, int)> on_signal;
+  on_signal = [&server, &cmd, &signal, &on_signal, &draining, &notify_stop](
       const boost::system::error_code& ec, int signum) {
     if (ec) {
       return;
     }
 
-    SSF_LOG("ssfd", info, "interrupted");
-
-    {
-      std::lock_guard<std::mutex> lock(mutex);
-      stopped = true;
+    if (cmd.drain_timeout() > 0 && !draining) {
+      SSF_LOG("ssfd", info, "draining (signal again to stop)");
+      draining = true;
+      server.Drain(std::chrono::seconds(cmd.drain_timeout()), notify_stop);
+      signal.async_wait(on_signal);
+      return;
     }
-    wait_stop_cv.notify_all();
-  });
+
+    SSF_LOG("ssfd", info, "interrupted");
+    notify_stop();
+  };
+  signal.async_wait(on_signal);
 
   SSF_LOG("ssfd", info, "running (Ctrl + C to stop)");
 
@@ -1,13 +1,16 @@
 #ifndef SSF_SERVICES_ADMIN_ADMIN_H_
 #define SSF_SERVICES_ADMIN_ADMIN_H_
 
+#include <atomic>
+#include <chrono>
 #include <functional>
 #include <mutex>
+#include <queue>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <boost/asio.hpp>
-#include <boost/asio/coroutine.hpp>
 #include <boost/asio/steady_timer.hpp>
 #include <boost/system/error_code.hpp>
 
@@ -58,6 +61,11 @@ class Admin : public BaseService<Demux> {
 
   using CommandHandler = std::function<void(const boost::system::error_code&)>;
   using IdToCommandHandlerMap = std::map<uint32_t, CommandHandler>;
+  using AdminCommandPtr = std::shared_ptr<AdminCommand>;
+  using SendCommandHandler =
+      std::function<void(const boost::system::error_code&, size_t)>;
+  using PendingCommandQueue =
+      std::queue<std::pair<AdminCommandPtr, SendCommandHandler>>;
 
  public:
   static AdminPtr Create(boost::asio::io_service& io_service,
@@ -70,8 +78,11 @@ class Admin : public BaseService<Demux> {
   enum {
     kFactoryId = to_underlying(MicroserviceId::kAdmin),
     kServicePort = to_underlying(MicroservicePort::kAdmin),
-    kKeepAliveInterval = 120,      // seconds
-    kServiceStatusRetryCount = 50  // retries
+    kKeepAliveInterval = 120,       // seconds
+    kServiceStatusRetryCount = 50,  // retries
+    kReceiveBufferSize = 4096,      // bytes, grown for larger commands
+    kMaxCommandSize = 1024 * 1024,  // bytes of parameters
+    kMaxBatchedCommands = 64        // commands written at once
   };
 
   static void RegisterToServiceFactory(
@@ -93,6 +104,11 @@ class Admin : public BaseService<Demux> {
                    OnUserService on_user_service,
                    OnInitialization on_initialization);
 
+  // Start the added user services and stop the removed ones (client side),
+  // the other user services keep running
+  void UpdateUserServices(const std::vector<BaseUserServicePtr>& added,
+                          const std::vector<BaseUserServicePtr>& removed);
+
   template <typename Request, typename Handler>
   void Command(Request request, Handler handler) {
     std::string parameters_buff_to_send = request.OnSending();
@@ -101,13 +117,12 @@ class Admin : public BaseService<Demux> {
     InsertHandler(serial, handler);
 
     auto p_command = std::make_shared<AdminCommand>(
-        serial, request.command_id, (uint32_t)parameters_buff_to_send.size(),
-        parameters_buff_to_send);
+        serial, request.command_id, parameters_buff_to_send);
 
-    auto do_handler = [p_command](const boost::system::error_code& ec,
-                                  size_t length) {};
+    auto do_handler = [](const boost::system::error_code& ec, size_t length) {
+    };
 
-    AsyncSendCommand(*p_command, do_handler);
+    AsyncSendCommand(p_command, do_handler);
   }
 
   void InsertHandler(uint32_t serial, CommandHandler command_handler) {
@@ -117,12 +132,14 @@ class Admin : public BaseService<Demux> {
 
   // execute handler bound to the command serial id if exists
   void ExecuteAndRemoveCommandHandler(uint32_t serial) {
-    if (command_handlers_.count(command_serial_received_)) {
+    std::unique_lock<std::recursive_mutex> lock1(command_handlers_mutex_);
+    auto handler_it = command_handlers_.find(serial);
+    if (handler_it != command_handlers_.end()) {
       auto self = this->shared_from_this();
-      auto command_handler = command_handlers_[command_serial_received_];
+      auto command_handler = std::move(handler_it->second);
+      command_handlers_.erase(handler_it);
       this->get_io_service().post(
           [self, command_handler]() { command_handler({}); });
-      this->EraseHandler(command_serial_received_);
     }
   }
 
@@ -169,23 +186,20 @@ class Admin : public BaseService<Demux> {
   void StopRemoteService(const admin::StopServiceRequest<Demux>& stop_request,
                          const CommandHandler& handler);
   void InitializeRemoteServices(const boost::system::error_code& ec);
-  void ListenForCommand();
-  void DoAdmin(
-      const boost::system::error_code& ec = boost::system::error_code(),
-      size_t length = 0);
+  void InitializeUserService(BaseUserServicePtr p_user_service);
+  void OnRemoteServicesStarted(BaseUserServicePtr p_user_service);
+  bool HasUserService(BaseUserServicePtr p_user_service);
+  void StopRemoteServices(BaseUserServicePtr p_user_service);
+  void OnUserServiceInitialized();
+  void AsyncReceiveCommands();
+  void OnCommandsReceived(const boost::system::error_code& ec,
+                          std::size_t length);
+  void ProcessCommand(const CommandHeader& header, const char* p_parameters);
   void PostKeepAlive(const boost::system::error_code& ec, size_t length);
   void OnSendKeepAlive(const boost::system::error_code& ec);
-  void ReceiveInstructionHeader();
-  void ReceiveInstructionParameters();
-  void ProcessInstructionId();
 
-  template <typename Handler>
-  void AsyncSendCommand(const AdminCommand& command, Handler handler) {
-    auto do_handler = [handler](const boost::system::error_code& ec,
-                                size_t length) { handler(ec, length); };
-
-    boost::asio::async_write(fiber_, command.const_buffers(), do_handler);
-  }
+  void AsyncSendCommand(AdminCommandPtr p_command, SendCommandHandler handler);
+  void SendNextCommand();
 
   void NotifyUserService(BaseUserServicePtr p_user_service,
                          const boost::system::error_code& ec) {
@@ -218,23 +232,21 @@ class Admin : public BaseService<Demux> {
   FiberAcceptor fiber_acceptor_;
   Fiber fiber_;
 
-  // The status in which the admin service is
-  uint32_t status_;
-
-  // Buffers to receive commands
-  uint32_t command_serial_received_;
-  uint32_t command_id_received_;
-  uint32_t command_size_received_;
-  std::vector<char> parameters_buff_received_;
+  // Commands are received in a reusable buffer and decoded in place,
+  // received_size_ bytes being pending in the buffer
+  std::vector<char> receive_buffer_;
+  std::size_t received_size_;
 
   // Keep alives
   uint32_t reserved_keep_alive_id_;
-  uint32_t reserved_keep_alive_size_;
   std::string reserved_keep_alive_parameters_;
   boost::asio::steady_timer reserved_keep_alive_timer_;
 
   // List of user services
+  std::recursive_mutex user_services_mutex_;
   std::vector<BaseUserServicePtr> user_services_;
+  bool user_services_initialized_;
+  bool initialization_notified_;
 
   // Connection attempts
   uint8_t retries_;
@@ -244,19 +256,19 @@ class Admin : public BaseService<Demux> {
   bool stopped_;
 
   // Initialize services
-  boost::asio::coroutine coroutine_;
-  size_t i_;
-  std::vector<admin::CreateServiceRequest<Demux>> create_request_vector_;
-  size_t j_;
-  uint32_t remote_all_started_;
-  uint16_t init_retries_;
-  std::vector<admin::StopServiceRequest<Demux>> stop_request_vector_;
-  bool local_all_started_;
+  std::atomic<size_t> pending_user_services_;
+  std::chrono::steady_clock::time_point init_start_time_;
   boost::system::error_code init_ec_;
 
   std::recursive_mutex command_handlers_mutex_;
   IdToCommandHandlerMap command_handlers_;
 
+  // Commands waiting to be written on the fiber and commands being written
+  std::recursive_mutex pending_commands_mutex_;
+  PendingCommandQueue pending_commands_;
+  std::vector<std::pair<AdminCommandPtr, SendCommandHandler>>
+      sending_commands_;
+
   OnUserService on_user_service_;
   OnInitialization on_initialization_;
 
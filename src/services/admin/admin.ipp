@@ -1,6 +1,8 @@
 #ifndef SSF_SERVICES_ADMIN_ADMIN_IPP_
 #define SSF_SERVICES_ADMIN_ADMIN_IPP_
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <memory>
 
@@ -21,13 +23,22 @@ Admin<Demux>::Admin(boost::asio::io_service& io_service, Demux& fiber_demux)
       is_server_(true),
       fiber_acceptor_(io_service),
       fiber_(io_service),
+      receive_buffer_(kReceiveBufferSize),
+      received_size_(0),
       reserved_keep_alive_id_(0),
-      reserved_keep_alive_size_(0),
       reserved_keep_alive_parameters_(),
       reserved_keep_alive_timer_(io_service),
+      user_services_mutex_(),
+      user_services_(),
+      user_services_initialized_(false),
+      initialization_notified_(false),
       retries_(0),
       stopping_mutex_(),
       stopped_(false),
+      pending_user_services_(0),
+      init_start_time_(),
+      pending_commands_(),
+      sending_commands_(),
       on_user_service_(),
       on_initialization_() {}
 
@@ -49,6 +60,55 @@ void Admin<Demux>::SetAsClient(std::vector<BaseUserServicePtr> user_services,
   on_initialization_ = std::move(on_initialization);
 }
 
+template <typename Demux>
+void Admin<Demux>::UpdateUserServices(
+    const std::vector<BaseUserServicePtr>& added,
+    const std::vector<BaseUserServicePtr>& removed) {
+  auto self = this->shared_from_this();
+  this->get_io_service().post([this, self, added, removed]() {
+    {
+      std::unique_lock<std::recursive_mutex> lock(stopping_mutex_);
+      if (stopped_) {
+        return;
+      }
+    }
+
+    std::unique_lock<std::recursive_mutex> lock(user_services_mutex_);
+    for (auto& p_user_service : removed) {
+      auto it = std::find(user_services_.begin(), user_services_.end(),
+                          p_user_service);
+      if (it == user_services_.end()) {
+        continue;
+      }
+      user_services_.erase(it);
+
+      if (user_services_initialized_) {
+        SSF_LOG("microservice", info, "[admin] stop service[{}]",
+                p_user_service->GetName());
+        StopRemoteServices(p_user_service);
+        p_user_service->StopLocalServices(this->get_demux());
+      }
+    }
+
+    for (auto& p_user_service : added) {
+      user_services_.push_back(p_user_service);
+    }
+
+    if (!user_services_initialized_ || added.empty()) {
+      // services added before the remote initialization are started by it
+      return;
+    }
+
+    init_start_time_ = std::chrono::steady_clock::now();
+    pending_user_services_ += added.size();
+    for (auto& p_user_service : added) {
+      SSF_LOG("microservice", info, "[admin] start service[{}]",
+              p_user_service->GetName());
+      InitializeUserService(p_user_service);
+    }
+  });
+}
+
 template <typename Demux>
 void Admin<Demux>::start(boost::system::error_code& ec) {
   ec = init_ec_;
@@ -147,15 +207,19 @@ void Admin<Demux>::Initialize() {
   }
 
   // Initialize the command reception processes
-  this->ListenForCommand();
+  this->AsyncReceiveCommands();
 
   // Initialize the keep alive processes
   this->PostKeepAlive(boost::system::error_code(), 0);
 }
 
-#include <boost/asio/yield.hpp>  // NOLINT
-
 /// Initialize micro services (local and remote) asked by the client
+/**
+* All the remote micro service creation requests are sent at once, their
+* statuses are collected by command serial as they come back. Each user
+* service is checked and its local micro services started as soon as all of
+* its remote micro services have replied.
+*/
 template <typename Demux>
 void Admin<Demux>::InitializeRemoteServices(
     const boost::system::error_code& ec) {
@@ -165,180 +229,214 @@ void Admin<Demux>::InitializeRemoteServices(
     return;
   }
 
-  auto self = this->shared_from_this();
+  std::unique_lock<std::recursive_mutex> lock(user_services_mutex_);
+  user_services_initialized_ = true;
+  init_start_time_ = std::chrono::steady_clock::now();
+  pending_user_services_ = user_services_.size();
 
-  reenter(coroutine_) {
-    // For each user service
-    for (i_ = 0; i_ < user_services_.size(); ++i_) {
-      // Get the remote micro services to start
-      create_request_vector_ =
-          user_services_[i_]->GetRemoteServiceCreateVector();
-
-      // For each remote micro service to start
-      for (j_ = 0; j_ < create_request_vector_.size(); ++j_) {
-        // Start remove service and yield until server response comes back
-        yield StartRemoteService(
-            create_request_vector_[j_],
-            [this, self](const boost::system::error_code& ec) {
-              InitializeRemoteServices(ec);
-            });
-      }
+  if (user_services_.empty()) {
+    OnUserServiceInitialized();
+    return;
+  }
 
-      // At this point, all remote services have responded with their statuses
-      remote_all_started_ =
-          user_services_[i_]->CheckRemoteServiceStatus(this->get_demux());
-
-      // If something went wrong remote_all_started_ > 0
-      if (remote_all_started_) {
-        SSF_LOG("microservice", error,
-                "[admin] could not start remote microservice for service[{}]",
-                user_services_[i_]->GetName());
-
-        NotifyUserService(user_services_[i_], boost::system::error_code(
-                                                  ::error::operation_canceled,
-                                                  ::error::get_ssf_category()));
-
-        // Get the remote micro services to stop
-        stop_request_vector_ =
-            user_services_[i_]->GetRemoteServiceStopVector(this->get_demux());
-        for (j_ = 0; j_ < stop_request_vector_.size(); ++j_) {
-          // Send a service stop request
-          yield StopRemoteService(
-              stop_request_vector_[j_],
-              [this, self](const boost::system::error_code& ec) {
-                InitializeRemoteServices(ec);
-              });
-        }
-        // Try next user service
-        continue;
-      }
+  // the user services may change while they are initialized
+  auto user_services = user_services_;
+  for (auto& p_user_service : user_services) {
+    InitializeUserService(p_user_service);
+  }
+}
 
-      // Start local associated services
-      local_all_started_ =
-          user_services_[i_]->StartLocalServices(this->get_demux());
-
-      // If something went wrong local_all_started_ == false
-      if (!local_all_started_) {
-        SSF_LOG("microservice", error,
-                "[admin] could not start local microservice for service[{}]",
-                user_services_[i_]->GetName());
-
-        NotifyUserService(user_services_[i_], boost::system::error_code(
-                                                  ::error::operation_canceled,
-                                                  ::error::get_ssf_category()));
-
-        // Get the remote micro services to stop
-        stop_request_vector_ =
-            user_services_[i_]->GetRemoteServiceStopVector(this->get_demux());
-        for (j_ = 0; j_ < stop_request_vector_.size(); ++j_) {
-          // Send a service stop request
-          yield StopRemoteService(
-              stop_request_vector_[j_],
-              [this, self](const boost::system::error_code& ec) {
-                InitializeRemoteServices(ec);
-              });
-        }
-        // Stop local services
-        user_services_[i_]->StopLocalServices(this->get_demux());
-        // Try next user service
-        continue;
-      }
+template <typename Demux>
+void Admin<Demux>::InitializeUserService(BaseUserServicePtr p_user_service) {
+  // Get the remote micro services to start
+  auto create_request_vector = p_user_service->GetRemoteServiceCreateVector();
 
-      NotifyUserService(user_services_[i_],
-                        boost::system::error_code(::error::success,
-                                                  ::error::get_ssf_category()));
-    }
-    NotifyInitialization({::error::success, ::error::get_ssf_category()});
+  if (create_request_vector.empty()) {
+    OnRemoteServicesStarted(p_user_service);
+    return;
+  }
+
+  auto self = this->shared_from_this();
+  auto p_pending_replies =
+      std::make_shared<std::atomic<size_t>>(create_request_vector.size());
+
+  // Send every request without waiting for the previous replies
+  for (auto& create_request : create_request_vector) {
+    StartRemoteService(
+        create_request, [this, self, p_user_service, p_pending_replies](
+                            const boost::system::error_code& ec) {
+          if (ec) {
+            SSF_LOG("microservice", debug,
+                    "[admin] intializing remote services failed {}",
+                    ec.value());
+            return;
+          }
+
+          // The last reply completes the remote initialization
+          if (--(*p_pending_replies) == 0) {
+            OnRemoteServicesStarted(p_user_service);
+          }
+        });
   }
 }
-#include <boost/asio/unyield.hpp>  // NOLINT
 
 template <typename Demux>
-void Admin<Demux>::ListenForCommand() {
-  status_ = 101;
-  auto self = this->shared_from_this();
-  auto do_admin = [this, self]() { DoAdmin(boost::system::error_code(), 0); };
-  this->get_io_service().post(do_admin);
+bool Admin<Demux>::HasUserService(BaseUserServicePtr p_user_service) {
+  std::unique_lock<std::recursive_mutex> lock(user_services_mutex_);
+  return std::find(user_services_.begin(), user_services_.end(),
+                   p_user_service) != user_services_.end();
 }
 
 template <typename Demux>
-void Admin<Demux>::DoAdmin(const boost::system::error_code& ec, size_t length) {
-  if (ec) {
+void Admin<Demux>::OnRemoteServicesStarted(BaseUserServicePtr p_user_service) {
+  if (!HasUserService(p_user_service)) {
+    // removed by a reload while its remote services were starting
+    StopRemoteServices(p_user_service);
+    OnUserServiceInitialized();
     return;
   }
 
-  switch (status_) {
-    case 101:
-      this->ReceiveInstructionHeader();
-      break;
+  // If something went wrong remote_all_started > 0
+  auto remote_all_started =
+      p_user_service->CheckRemoteServiceStatus(this->get_demux());
 
-    case 102:
-      if (command_id_received_) {
-        this->ReceiveInstructionParameters();
-      } else {
-        this->ListenForCommand();
-      }
-      break;
+  if (remote_all_started) {
+    SSF_LOG("microservice", error,
+            "[admin] could not start remote microservice for service[{}]",
+            p_user_service->GetName());
+
+    NotifyUserService(p_user_service,
+                      boost::system::error_code(::error::operation_canceled,
+                                                ::error::get_ssf_category()));
+    StopRemoteServices(p_user_service);
+    OnUserServiceInitialized();
+    return;
+  }
 
-    case 103:
-      this->ProcessInstructionId();
-      break;
+  // Start local associated services
+  auto local_all_started = p_user_service->StartLocalServices(this->get_demux());
 
-    default:
-      /*get_io_service().post(std::bind(&Admin::DoAdmin,
-                                          this, this->shared_from_this(),
-                                          boost::system::error_code(),
-                                          0));*/
-      break;
+  if (!local_all_started) {
+    SSF_LOG("microservice", error,
+            "[admin] could not start local microservice for service[{}]",
+            p_user_service->GetName());
+
+    NotifyUserService(p_user_service,
+                      boost::system::error_code(::error::operation_canceled,
+                                                ::error::get_ssf_category()));
+    StopRemoteServices(p_user_service);
+    p_user_service->StopLocalServices(this->get_demux());
+    OnUserServiceInitialized();
+    return;
+  }
+
+  NotifyUserService(p_user_service,
+                    boost::system::error_code(::error::success,
+                                              ::error::get_ssf_category()));
+  OnUserServiceInitialized();
+}
+
+template <typename Demux>
+void Admin<Demux>::StopRemoteServices(BaseUserServicePtr p_user_service) {
+  // Send every stop request, their replies are not waited for
+  auto stop_request_vector =
+      p_user_service->GetRemoteServiceStopVector(this->get_demux());
+  for (auto& stop_request : stop_request_vector) {
+    StopRemoteService(stop_request, [](const boost::system::error_code&) {});
   }
 }
 
 template <typename Demux>
-void Admin<Demux>::ReceiveInstructionHeader() {
-  status_ = 102;  // Receive current instruction parameter size
+void Admin<Demux>::OnUserServiceInitialized() {
+  std::unique_lock<std::recursive_mutex> lock(user_services_mutex_);
+  if (pending_user_services_ > 0 && --pending_user_services_ > 0) {
+    return;
+  }
+
+  auto init_duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - init_start_time_);
+  SSF_LOG("microservice", info, "[admin] {} service(s) initialized in {}ms",
+          user_services_.size(), init_duration.count());
+
+  if (initialization_notified_) {
+    // services started by a reload
+    return;
+  }
+  initialization_notified_ = true;
+  NotifyInitialization({::error::success, ::error::get_ssf_category()});
+}
 
-  std::array<boost::asio::mutable_buffer, 3> buff = {
-      {boost::asio::buffer(&command_serial_received_,
-                           sizeof(command_serial_received_)),
-       boost::asio::buffer(&command_id_received_, sizeof(command_id_received_)),
-       boost::asio::buffer(&command_size_received_,
-                           sizeof(command_size_received_))}};
+template <typename Demux>
+void Admin<Demux>::AsyncReceiveCommands() {
+  // Room for at least the next header
+  if (receive_buffer_.size() - received_size_ < CommandHeader::kSize) {
+    receive_buffer_.resize(received_size_ + kReceiveBufferSize);
+  }
 
-  // receive the command header
   auto self = this->shared_from_this();
   auto on_fiber_read = [this, self](const boost::system::error_code& ec,
                                     std::size_t length) {
-    DoAdmin(ec, length);
+    OnCommandsReceived(ec, length);
   };
-  boost::asio::async_read(fiber_, buff, std::move(on_fiber_read));
+  fiber_.async_read_some(
+      boost::asio::buffer(&receive_buffer_[received_size_],
+                          receive_buffer_.size() - received_size_),
+      std::move(on_fiber_read));
 }
 
+/// Process every complete command received, several commands may come in one
+/// read when they are pipelined by the peer
 template <typename Demux>
-void Admin<Demux>::ReceiveInstructionParameters() {
-  status_ = 103;  // Handler current instruction
+void Admin<Demux>::OnCommandsReceived(const boost::system::error_code& ec,
+                                      std::size_t length) {
+  if (ec) {
+    return;
+  }
 
-  // @todo check size
-  parameters_buff_received_.resize(command_size_received_);
+  received_size_ += length;
+
+  std::size_t processed = 0;
+  while (received_size_ - processed >= CommandHeader::kSize) {
+    auto header = CommandHeader::Decode(&receive_buffer_[processed]);
+    if (header.size > kMaxCommandSize) {
+      SSF_LOG("microservice", error,
+              "[admin] command {} too large ({} bytes)", header.command_id,
+              header.size);
+      boost::system::error_code close_ec;
+      fiber_.close(close_ec);
+      return;
+    }
 
-  // Receive the command parameters
-  auto self = this->shared_from_this();
-  auto on_fiber_read = [this, self](const boost::system::error_code& ec,
-                                    std::size_t length) {
-    DoAdmin(ec, length);
-  };
-  boost::asio::async_read(fiber_,
-                          boost::asio::buffer(parameters_buff_received_),
-                          std::move(on_fiber_read));
+    std::size_t command_size = CommandHeader::kSize + header.size;
+    if (received_size_ - processed < command_size) {
+      // Wait for the end of the command
+      if (receive_buffer_.size() - processed < command_size) {
+        receive_buffer_.resize(processed + command_size);
+      }
+      break;
+    }
+
+    ProcessCommand(header, &receive_buffer_[processed + CommandHeader::kSize]);
+    processed += command_size;
+  }
+
+  // Keep the incomplete command at the beginning of the buffer
+  if (processed > 0) {
+    std::copy(receive_buffer_.begin() + processed,
+              receive_buffer_.begin() + received_size_,
+              receive_buffer_.begin());
+    received_size_ -= processed;
+  }
+
+  AsyncReceiveCommands();
 }
 
 /// Execute the command received and send back the result
 template <typename Demux>
-void Admin<Demux>::ProcessInstructionId() {
+void Admin<Demux>::ProcessCommand(const CommandHeader& header,
+                                  const char* p_parameters) {
   // Get the right function to execute the command
-  auto p_executer = cmd_factory_.GetExecuter(command_id_received_);
-
-  const std::string serialized(&parameters_buff_received_[0],
-                               parameters_buff_received_.size());
+  auto p_executer = cmd_factory_.GetExecuter(header.command_id);
 
   Demux& d = this->get_demux();
 
@@ -346,34 +444,79 @@ void Admin<Demux>::ProcessInstructionId() {
   if (p_executer) {
     // Execute and get the result
     boost::system::error_code ec;
-    std::string serialized_result = (*p_executer)(serialized, &d, ec);
+    std::string serialized_result =
+        (*p_executer)(p_parameters, header.size, &d, ec);
 
     // Get the right function to reply
-    auto p_replier = cmd_factory_.GetReplier(command_id_received_);
+    auto p_replier = cmd_factory_.GetReplier(header.command_id);
 
     // Get the reply
-    std::string reply = (*p_replier)(serialized, &d, ec, serialized_result);
+    std::string reply =
+        (*p_replier)(p_parameters, header.size, &d, ec, serialized_result);
 
     // If there is something to send back
     if (reply.size() > 0) {
       uint32_t* p_reply_command_index =
-          cmd_factory_.GetReplyCommandIndex(command_id_received_);
+          cmd_factory_.GetReplyCommandIndex(header.command_id);
 
       // reply with command serial received (command handler execution)
       auto p_command = std::make_shared<AdminCommand>(
-          command_serial_received_, *p_reply_command_index,
-          (uint32_t)reply.size(), reply);
+          header.serial, *p_reply_command_index, reply);
 
-      this->AsyncSendCommand(
-          *p_command, [p_command](const boost::system::error_code&, size_t) {});
+      this->AsyncSendCommand(p_command,
+                             [](const boost::system::error_code&, size_t) {});
     }
   }
 
   // Execute an handler bound to the serial command (e.g, callback after a
   // service started)
-  this->ExecuteAndRemoveCommandHandler(command_serial_received_);
+  this->ExecuteAndRemoveCommandHandler(header.serial);
+}
+
+template <typename Demux>
+void Admin<Demux>::AsyncSendCommand(AdminCommandPtr p_command,
+                                    SendCommandHandler handler) {
+  std::unique_lock<std::recursive_mutex> lock(pending_commands_mutex_);
+  pending_commands_.emplace(std::move(p_command), std::move(handler));
+
+  // Commands are written by batches so that pipelined commands never
+  // interleave on the fiber
+  if (!sending_commands_.empty()) {
+    return;
+  }
+
+  SendNextCommand();
+}
+
+template <typename Demux>
+void Admin<Demux>::SendNextCommand() {
+  // Write the commands queued so far at once
+  std::vector<boost::asio::const_buffer> buffers;
+  while (!pending_commands_.empty() &&
+         sending_commands_.size() < kMaxBatchedCommands) {
+    buffers.push_back(pending_commands_.front().first->const_buffer());
+    sending_commands_.push_back(std::move(pending_commands_.front()));
+    pending_commands_.pop();
+  }
+
+  auto self = this->shared_from_this();
+  auto on_commands_sent = [this, self](const boost::system::error_code& ec,
+                                       size_t length) {
+    std::vector<std::pair<AdminCommandPtr, SendCommandHandler>> sent_commands;
+    {
+      std::unique_lock<std::recursive_mutex> lock(pending_commands_mutex_);
+      sent_commands.swap(sending_commands_);
+
+      if (!pending_commands_.empty()) {
+        SendNextCommand();
+      }
+    }
+    for (auto& sent_command : sent_commands) {
+      sent_command.second(ec, sent_command.first->size());
+    }
+  };
 
-  this->ListenForCommand();
+  boost::asio::async_write(fiber_, buffers, std::move(on_commands_sent));
 }
 
 template <typename Demux>
@@ -397,12 +540,11 @@ void Admin<Demux>::OnSendKeepAlive(const boost::system::error_code& ec) {
   }
 
   auto p_command = std::make_shared<AdminCommand>(
-      0, reserved_keep_alive_id_, reserved_keep_alive_size_,
-      reserved_keep_alive_parameters_);
+      0, reserved_keep_alive_id_, reserved_keep_alive_parameters_);
 
   auto self = this->shared_from_this();
-  auto on_command_sent = [this, self, p_command](
-      const boost::system::error_code& ec, size_t length) {
+  auto on_command_sent = [this, self](const boost::system::error_code& ec,
+                                     size_t length) {
     std::unique_lock<std::recursive_mutex> lock(stopping_mutex_);
     if (stopped_) {
       return;
@@ -411,7 +553,7 @@ void Admin<Demux>::OnSendKeepAlive(const boost::system::error_code& ec) {
     this->PostKeepAlive(ec, length);
   };
 
-  this->AsyncSendCommand(*p_command, on_command_sent);
+  this->AsyncSendCommand(p_command, on_command_sent);
 }
 
 template <typename Demux>
@@ -4,42 +4,61 @@
 #include <cstdint>
 
 #include <string>
-#include <memory>
-#include <array>
-#include <iostream>
 
 #include <boost/asio/buffer.hpp>
 
+#include "services/admin/binary_codec.h"
+
 namespace ssf {
 namespace services {
 namespace admin {
 
+// Admin command on the fiber:
+//   | serial (4 bytes) | command id (4 bytes) | parameters size (4 bytes) |
+//   | parameters |
+// The header fields are big endian. Replies carry the serial of the command
+// they answer so that several commands may be in flight.
+struct CommandHeader {
+  enum { kSize = 12 };
+
+  CommandHeader() : serial(0), command_id(0), size(0) {}
+
+  // Decode the header at the beginning of a buffer of at least kSize bytes
+  static CommandHeader Decode(const char* p_data) {
+    CommandHeader header;
+    BinaryReader reader(p_data, kSize);
+    reader.ReadUint32(&header.serial);
+    reader.ReadUint32(&header.command_id);
+    reader.ReadUint32(&header.size);
+    return header;
+  }
+
+  uint32_t serial;
+  uint32_t command_id;
+  uint32_t size;
+};
+
 class AdminCommand {
  public:
   AdminCommand(uint32_t serial, uint32_t command_id,
-               uint32_t serialize_arguments_size,
-               std::string serialized_arguments)
-      : serial_(serial),
-        command_id_(command_id),
-        serialize_arguments_size_(serialize_arguments_size),
-        serialized_arguments_(serialized_arguments) {}
-
-  std::array<boost::asio::const_buffer, 4> const_buffers() const {
-    std::array<boost::asio::const_buffer, 4> buf = {
-        {boost::asio::buffer(&serial_, sizeof(serial_)),
-         boost::asio::buffer(&command_id_, sizeof(command_id_)),
-         boost::asio::buffer(&serialize_arguments_size_,
-                             sizeof(serialize_arguments_size_)),
-         boost::asio::buffer(serialized_arguments_)}};
-
-    return buf;
+               const std::string& serialized_arguments)
+      : data_() {
+    data_.reserve(CommandHeader::kSize + serialized_arguments.size());
+    BinaryWriter writer(&data_);
+    writer.WriteUint32(serial);
+    writer.WriteUint32(command_id);
+    writer.WriteUint32(static_cast<uint32_t>(serialized_arguments.size()));
+    data_.append(serialized_arguments);
   }
 
+  boost::asio::const_buffer const_buffer() const {
+    return boost::asio::buffer(data_);
+  }
+
+  std::size_t size() const { return data_.size(); }
+
  private:
-  uint32_t serial_;
-  uint32_t command_id_;
-  uint32_t serialize_arguments_size_;
-  std::string serialized_arguments_;
+  std::string data_;
 };
 
 }  // admin
@@ -0,0 +1,116 @@
+#ifndef SSF_SERVICES_ADMIN_BINARY_CODEC_H_
+#define SSF_SERVICES_ADMIN_BINARY_CODEC_H_
+
+#include <cstdint>
+
+#include <map>
+#include <string>
+
+namespace ssf {
+namespace services {
+namespace admin {
+
+// Compact binary encoding of the admin command parameters
+//   uint32: 4 bytes, big endian
+//   string: uint32 length | bytes
+//   string map: uint32 count | (key string | value string)...
+
+class BinaryWriter {
+ public:
+  explicit BinaryWriter(std::string* p_output) : p_output_(p_output) {}
+
+  void WriteUint32(uint32_t value) {
+    char data[4] = {static_cast<char>(value >> 24),
+                    static_cast<char>(value >> 16),
+                    static_cast<char>(value >> 8), static_cast<char>(value)};
+    p_output_->append(data, sizeof(data));
+  }
+
+  void WriteString(const std::string& value) {
+    WriteUint32(static_cast<uint32_t>(value.size()));
+    p_output_->append(value);
+  }
+
+  void WriteStringMap(const std::map<std::string, std::string>& values) {
+    WriteUint32(static_cast<uint32_t>(values.size()));
+    for (const auto& value : values) {
+      WriteString(value.first);
+      WriteString(value.second);
+    }
+  }
+
+ private:
+  std::string* p_output_;
+};
+
+// Decode parameters in place from a received buffer
+//   Each read returns false, and the reader stays failed, if the buffer is too
+//   short
+class BinaryReader {
+ public:
+  BinaryReader(const char* p_data, std::size_t size)
+      : p_data_(p_data), remaining_(size), failed_(false) {}
+
+  bool ReadUint32(uint32_t* p_value) {
+    if (failed_ || remaining_ < 4) {
+      failed_ = true;
+      return false;
+    }
+
+    auto p_bytes = reinterpret_cast<const uint8_t*>(p_data_);
+    *p_value = (static_cast<uint32_t>(p_bytes[0]) << 24) |
+               (static_cast<uint32_t>(p_bytes[1]) << 16) |
+               (static_cast<uint32_t>(p_bytes[2]) << 8) |
+               static_cast<uint32_t>(p_bytes[3]);
+    p_data_ += 4;
+    remaining_ -= 4;
+    return true;
+  }
+
+  bool ReadString(std::string* p_value) {
+    uint32_t size = 0;
+    if (!ReadUint32(&size)) {
+      return false;
+    }
+    if (remaining_ < size) {
+      failed_ = true;
+      return false;
+    }
+
+    p_value->assign(p_data_, size);
+    p_data_ += size;
+    remaining_ -= size;
+    return true;
+  }
+
+  bool ReadStringMap(std::map<std::string, std::string>* p_values) {
+    uint32_t count = 0;
+    if (!ReadUint32(&count)) {
+      return false;
+    }
+
+    p_values->clear();
+    for (uint32_t i = 0; i < count; ++i) {
+      std::string key;
+      std::string value;
+      if (!ReadString(&key) || !ReadString(&value)) {
+        return false;
+      }
+      (*p_values)[std::move(key)] = std::move(value);
+    }
+    return true;
+  }
+
+  bool failed() const { return failed_; }
+
+ private:
+  const char* p_data_;
+  std::size_t remaining_;
+  bool failed_;
+};
+
+}  // admin
+}  // services
+}  // ssf
+
+#endif  // SSF_SERVICES_ADMIN_BINARY_CODEC_H_
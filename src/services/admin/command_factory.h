@@ -15,10 +15,11 @@ namespace ssf {
 template <typename Demux>
 class CommandFactory {
  public:
-  typedef std::string (*CommandExecuterType)(const std::string&, Demux*,
+  // Command parameters are decoded in place from the receive buffer
+  typedef std::string (*CommandExecuterType)(const char*, std::size_t, Demux*,
                                              boost::system::error_code&);
 
-  typedef std::string (*CommandReplierType)(const std::string&, Demux*,
+  typedef std::string (*CommandReplierType)(const char*, std::size_t, Demux*,
                                             const boost::system::error_code&,
                                             const std::string&);
 
@@ -3,21 +3,18 @@
 
 #include <cstdint>
 
-#include <fstream>
 #include <map>
-#include <sstream>
 #include <string>
 
 #include <boost/system/error_code.hpp>
 
-#include <msgpack.hpp>
-
 #include <ssf/log/log.h>
 
 #include "core/factories/service_factory.h"
 
 #include "core/factory_manager/service_factory_manager.h"
 
+#include "services/admin/binary_codec.h"
 #include "services/admin/command_factory.h"
 #include "services/admin/requests/service_status.h"
 
@@ -54,16 +51,11 @@ class CreateServiceRequest {
     return cmd_factory->RegisterReplyCommandIndex(command_id, reply_id);
   }
 
-  static std::string OnReceive(const std::string& serialized_request,
+  static std::string OnReceive(const char* p_request, std::size_t request_size,
                                Demux* p_demux, boost::system::error_code& ec) {
     CreateServiceRequest<Demux> request;
 
-    try {
-      auto obj_handle =
-          msgpack::unpack(serialized_request.data(), serialized_request.size());
-      auto obj = obj_handle.get();
-      obj.convert(request);
-    } catch (const std::exception&) {
+    if (!request.Decode(p_request, request_size)) {
       SSF_LOG("microservice", warn,
               "[admin] create service[on receive]: cannot extract request");
       ec.assign(::error::invalid_argument, ::error::get_ssf_category());
@@ -79,27 +71,16 @@ class CreateServiceRequest {
     SSF_LOG("microservice", debug, "[admin] create service: {} - ec {}", id,
             ec.value());
 
-    std::stringstream ss;
-    std::string result;
-
-    ss << id;
-    ss >> result;
-
-    return result;
+    return std::to_string(id);
   }
 
-  static std::string OnReply(const std::string& serialized_request,
+  static std::string OnReply(const char* p_request, std::size_t request_size,
                              Demux* p_demux,
                              const boost::system::error_code& ec,
                              const std::string& serialized_result) {
     CreateServiceRequest<Demux> request;
 
-    try {
-      auto obj_handle =
-          msgpack::unpack(serialized_request.data(), serialized_request.size());
-      auto obj = obj_handle.get();
-      obj.convert(request);
-    } catch (const std::exception&) {
+    if (!request.Decode(p_request, request_size)) {
       SSF_LOG("microservice", warn,
               "[admin] create service[on reply]: cannot extract request");
       return {};
@@ -122,9 +103,17 @@ class CreateServiceRequest {
   }
 
   std::string OnSending() const {
-    std::ostringstream ostrs;
-    msgpack::pack(ostrs, *this);
-    return ostrs.str();
+    std::string serialized;
+    BinaryWriter writer(&serialized);
+    writer.WriteUint32(service_id_);
+    writer.WriteStringMap(parameters_);
+    return serialized;
+  }
+
+  bool Decode(const char* p_data, std::size_t size) {
+    BinaryReader reader(p_data, size);
+    return reader.ReadUint32(&service_id_) &&
+           reader.ReadStringMap(&parameters_);
   }
 
   uint32_t service_id() { return service_id_; }
@@ -135,10 +124,6 @@ class CreateServiceRequest {
     parameters_[key] = value;
   }
 
- public:
-  // add msgpack function definitions
-  MSGPACK_DEFINE(service_id_, parameters_)
-
  private:
   uint32_t service_id_;
   Parameters parameters_;
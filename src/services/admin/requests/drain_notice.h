@@ -0,0 +1,101 @@
+#ifndef SSF_SERVICES_ADMIN_REQUESTS_DRAIN_NOTICE_H_
+#define SSF_SERVICES_ADMIN_REQUESTS_DRAIN_NOTICE_H_
+
+#include <cstdint>
+
+#include <string>
+
+#include <boost/system/error_code.hpp>
+
+#include <ssf/log/log.h>
+
+#include "core/factories/service_factory.h"
+
+#include "core/factory_manager/service_factory_manager.h"
+
+#include "services/admin/binary_codec.h"
+#include "services/admin/command_factory.h"
+
+namespace ssf {
+namespace services {
+namespace admin {
+
+// Sent by a draining server: the connection will be closed once its fibers
+// are done or when the deadline (in seconds) expires
+template <typename Demux>
+class DrainNotice {
+ public:
+  DrainNotice() : deadline_(0) {}
+
+  DrainNotice(uint32_t deadline) : deadline_(deadline) {}
+
+  enum { command_id = 4, reply_id = 2 };
+
+  static bool RegisterOnReceiveCommand(CommandFactory<Demux>* cmd_factory) {
+    return cmd_factory->RegisterOnReceiveCommand(command_id,
+                                                 &DrainNotice::OnReceive);
+  }
+
+  static bool RegisterOnReplyCommand(CommandFactory<Demux>* cmd_factory) {
+    return cmd_factory->RegisterOnReplyCommand(command_id,
+                                               &DrainNotice::OnReply);
+  }
+
+  static bool RegisterReplyCommandIndex(CommandFactory<Demux>* cmd_factory) {
+    return cmd_factory->RegisterReplyCommandIndex(command_id, reply_id);
+  }
+
+  static std::string OnReceive(const char* p_request, std::size_t request_size,
+                               Demux* p_demux, boost::system::error_code& ec) {
+    DrainNotice<Demux> notice;
+
+    if (!notice.Decode(p_request, request_size)) {
+      SSF_LOG("microservice", warn,
+              "[admin] drain notice[on receive]: cannot extract request");
+      ec.assign(::error::invalid_argument, ::error::get_ssf_category());
+      return {};
+    }
+
+    SSF_LOG("microservice", debug, "[admin] drain notice: deadline {}s",
+            notice.deadline());
+
+    auto p_service_factory =
+        ServiceFactoryManager<Demux>::GetServiceFactory(p_demux);
+    if (p_service_factory) {
+      p_service_factory->NotifyServerDrain(notice.deadline());
+    }
+
+    return {};
+  }
+
+  // No reply: the server does not wait for the client
+  static std::string OnReply(const char* p_request, std::size_t request_size,
+                             Demux* p_demux,
+                             const boost::system::error_code& ec,
+                             const std::string& serialized_result) {
+    return {};
+  }
+
+  std::string OnSending() const {
+    std::string serialized;
+    BinaryWriter writer(&serialized);
+    writer.WriteUint32(deadline_);
+    return serialized;
+  }
+
+  bool Decode(const char* p_data, std::size_t size) {
+    BinaryReader reader(p_data, size);
+    return reader.ReadUint32(&deadline_);
+  }
+
+  uint32_t deadline() { return deadline_; }
+
+ private:
+  uint32_t deadline_;
+};
+
+}  // admin
+}  // services
+}  // ssf
+
+#endif  // SSF_SERVICES_ADMIN_REQUESTS_DRAIN_NOTICE_H_
@@ -3,19 +3,17 @@
 
 #include <cstdint>
 
-#include <fstream>
 #include <map>
 #include <string>
 
 #include <boost/system/error_code.hpp>
 
-#include <msgpack.hpp>
-
 #include <ssf/log/log.h>
 
 #include "core/factories/service_factory.h"
 
 #include "core/factory_manager/service_factory_manager.h"
+#include "services/admin/binary_codec.h"
 #include "services/admin/command_factory.h"
 
 namespace ssf {
@@ -53,16 +51,11 @@ class ServiceStatus {
     return cmd_factory->RegisterReplyCommandIndex(command_id, reply_id);
   }
 
-  static std::string OnReceive(const std::string& serialized_request,
+  static std::string OnReceive(const char* p_request, std::size_t request_size,
                                Demux* p_demux, boost::system::error_code& ec) {
     ServiceStatus<Demux> status;
 
-    try {
-      auto obj_handle =
-          msgpack::unpack(serialized_request.data(), serialized_request.size());
-      auto obj = obj_handle.get();
-      obj.convert(status);
-    } catch (const std::exception&) {
+    if (!status.Decode(p_request, request_size)) {
       SSF_LOG("microservice", warn,
               "[admin] service status[on receive]: cannot extract request");
       ec.assign(::error::invalid_argument, ::error::get_ssf_category());
@@ -88,7 +81,7 @@ class ServiceStatus {
     return {};
   }
 
-  static std::string OnReply(const std::string& serialized_request,
+  static std::string OnReply(const char* p_request, std::size_t request_size,
                              Demux* p_demux,
                              const boost::system::error_code& ec,
                              const std::string& serialized_result) {
@@ -101,9 +94,20 @@ class ServiceStatus {
   }
 
   std::string OnSending() const {
-    std::ostringstream ostrs;
-    msgpack::pack(ostrs, *this);
-    return ostrs.str();
+    std::string serialized;
+    BinaryWriter writer(&serialized);
+    writer.WriteUint32(id_);
+    writer.WriteUint32(service_id_);
+    writer.WriteUint32(error_code_value_);
+    writer.WriteStringMap(parameters_);
+    return serialized;
+  }
+
+  bool Decode(const char* p_data, std::size_t size) {
+    BinaryReader reader(p_data, size);
+    return reader.ReadUint32(&id_) && reader.ReadUint32(&service_id_) &&
+           reader.ReadUint32(&error_code_value_) &&
+           reader.ReadStringMap(&parameters_);
   }
 
   uint32_t id() { return id_; }
@@ -118,10 +122,6 @@ class ServiceStatus {
     parameters_[key] = value;
   }
 
- public:
-  // add msgpack function definitions
-  MSGPACK_DEFINE(id_, service_id_, error_code_value_, parameters_)
-
  private:
   uint32_t id_;
   uint32_t service_id_;
@@ -3,21 +3,18 @@
 
 #include <cstdint>
 
-#include <fstream>
 #include <map>
-#include <sstream>
 #include <string>
 
 #include <boost/system/error_code.hpp>
 
-#include <msgpack.hpp>
-
 #include <ssf/log/log.h>
 
 #include "core/factories/service_factory.h"
 
 #include "core/factory_manager/service_factory_manager.h"
 
+#include "services/admin/binary_codec.h"
 #include "services/admin/command_factory.h"
 #include "services/admin/requests/service_status.h"
 
@@ -51,16 +48,11 @@ class StopServiceRequest {
     return cmd_factory->RegisterReplyCommandIndex(command_id, reply_id);
   }
 
-  static std::string OnReceive(const std::string& serialized_request,
+  static std::string OnReceive(const char* p_request, std::size_t request_size,
                                Demux* p_demux, boost::system::error_code& ec) {
     StopServiceRequest<Demux> request;
 
-    try {
-      auto obj_handle =
-          msgpack::unpack(serialized_request.data(), serialized_request.size());
-      auto obj = obj_handle.get();
-      obj.convert(request);
-    } catch (const std::exception&) {
+    if (!request.Decode(p_request, request_size)) {
       SSF_LOG("microservice", warn,
               "[admin] stop service[on receive]: cannot extract request");
       ec.assign(::error::invalid_argument, ::error::get_ssf_category());
@@ -78,27 +70,16 @@ class StopServiceRequest {
     ec.assign(boost::system::errc::interrupted,
               boost::system::system_category());
 
-    std::stringstream ss;
-    std::string result;
-
-    ss << request.unique_id();
-    ss >> result;
-
-    return result;
+    return std::to_string(request.unique_id());
   }
 
-  static std::string OnReply(const std::string& serialized_request,
+  static std::string OnReply(const char* p_request, std::size_t request_size,
                              Demux* p_demux,
                              const boost::system::error_code& ec,
                              const std::string& serialized_result) {
     StopServiceRequest<Demux> request;
 
-    try {
-      auto obj_handle =
-          msgpack::unpack(serialized_request.data(), serialized_request.size());
-      auto obj = obj_handle.get();
-      obj.convert(request);
-    } catch (const std::exception&) {
+    if (!request.Decode(p_request, request_size)) {
       // TODO: ec?
       SSF_LOG("microservice", warn,
               "[admin] stop service[on reply]: cannot extract request");
@@ -119,16 +100,18 @@ class StopServiceRequest {
   }
 
   std::string OnSending() const {
-    std::ostringstream ostrs;
-    msgpack::pack(ostrs, *this);
-    return ostrs.str();
+    std::string serialized;
+    BinaryWriter writer(&serialized);
+    writer.WriteUint32(unique_id_);
+    return serialized;
   }
 
-  uint32_t unique_id() { return unique_id_; }
+  bool Decode(const char* p_data, std::size_t size) {
+    BinaryReader reader(p_data, size);
+    return reader.ReadUint32(&unique_id_);
+  }
 
- public:
-  // add msgpack function definitions
-  MSGPACK_DEFINE(unique_id_)
+  uint32_t unique_id() { return unique_id_; }
 
  private:
   uint32_t unique_id_;
@@ -1,14 +1,17 @@
 #ifndef SSF_SERVICES_COPY_FILE_SENDER_H_
 #define SSF_SERVICES_COPY_FILE_SENDER_H_
 
-#include <list>
+#include <deque>
 #include <memory>
+#include <vector>
 
 #include <boost/asio/io_service.hpp>
+#include <boost/asio/strand.hpp>
 #include <boost/system/error_code.hpp>
 
 #include <ssf/log/log.h>
 
+#include "common/filesystem/file_walker.h"
 #include "common/filesystem/filesystem.h"
 #include "common/filesystem/path.h"
 
@@ -85,6 +88,10 @@ class FileSender : public std::enable_shared_from_this<FileSender<Demux>> {
     SSF_LOG("microservice", debug, "[copy][file_sender] stop");
     stopped_ = true;
 
+    if (p_walker_) {
+      p_walker_->Stop();
+    }
+
     // stop all current sessions
     manager_.stop_all();
 
@@ -96,12 +103,12 @@ class FileSender : public std::enable_shared_from_this<FileSender<Demux>> {
       {
         std::lock_guard<std::recursive_mutex> lock(input_files_mutex_);
         if (pending_input_files_.empty() ||
-            input_files_.size() > copy_request_.max_parallel_copies) {
+            running_files_count_ > copy_request_.max_parallel_copies) {
           // noop if pending_input_files is empty or max parallel copies reached
           return;
         }
         input_file = pending_input_files_.front();
-        input_files_.emplace_back(input_file);
+        ++running_files_count_;
         pending_input_files_.pop_front();
       }
 
@@ -119,11 +126,16 @@ class FileSender : public std::enable_shared_from_this<FileSender<Demux>> {
              OnFileStatus on_file_status, OnFileCopied on_file_copied,
              OnCopyFinished on_copy_finished)
       : io_service_(demux.get_io_service()),
+        listing_strand_(demux.get_io_service()),
         demux_(demux),
         worker_(std::make_unique<boost::asio::io_service::work>(
             demux.get_io_service())),
         control_fiber_(std::move(control_fiber)),
         copy_request_(req),
+        running_files_count_(0),
+        listing_done_(false),
+        is_file_input_(false),
+        input_dir_(),
         input_files_count_(0),
         copy_errors_count_(0),
         copy_ec_(ErrorCode::kSuccess),
@@ -140,13 +152,6 @@ class FileSender : public std::enable_shared_from_this<FileSender<Demux>> {
               "[copy][file_sender] cannot list input files");
       NotifyCopyFinished(ErrorCode(ec.value()));
     }
-
-    if (pending_input_files_.empty()) {
-      NotifyCopyFinished(ErrorCode::kSuccess);
-      return;
-    }
-
-    RunFileSession();
   }
 
   void RunFileSession() {
@@ -154,13 +159,13 @@ class FileSender : public std::enable_shared_from_this<FileSender<Demux>> {
     {
       std::lock_guard<std::recursive_mutex> lock(input_files_mutex_);
       if (stopped_ || pending_input_files_.empty() ||
-          input_files_.size() >= copy_request_.max_parallel_copies) {
+          running_files_count_ >= copy_request_.max_parallel_copies) {
         // noop if stopped or pending_input_files is empty or max parallel
         // copies reached
         return;
       }
       input_file = pending_input_files_.front();
-      input_files_.emplace_back(input_file);
+      ++running_files_count_;
       pending_input_files_.pop_front();
     }
 
@@ -270,31 +275,25 @@ class FileSender : public std::enable_shared_from_this<FileSender<Demux>> {
                                       boost::system::error_code& ec) {
     CopyContextUPtr context = std::make_unique<CopyContext>(io_service_);
 
-    Path input_dir(copy_request_.input_pattern);
-    if (!fs_.IsDirectory(input_dir, ec)) {
-      input_dir = input_dir.GetParent();
-    }
-
     Path output_path(copy_request_.output_pattern);
     Path output_directory = output_path;
     Path output_filename = input_filepath;
-    if (fs_.IsFile(copy_request_.input_pattern, ec)) {
+    if (is_file_input_) {
       // output_pattern should be a file path instead of a directory path
       output_directory = output_path.GetParent();
       output_filename = output_path.GetFilename();
     }
-    ec.clear();
 
     ICopyStateUPtr send_init_request_state = SendInitRequestState::Create();
     context->SetState(std::move(send_init_request_state));
     boost::system::error_code fs_ec;
-    auto filesize = context->fs.GetFilesize(input_dir / input_filepath, fs_ec);
+    auto filesize = context->fs.GetFilesize(input_dir_ / input_filepath, fs_ec);
     if (fs_ec) {
       filesize = 0;
     }
 
     context->Init(
-        input_dir.GetString(), input_filepath.GetString(),
+        input_dir_.GetString(), input_filepath.GetString(),
         copy_request_.check_file_integrity,
         copy_request_.is_from_stdin, 0, copy_request_.is_resume, filesize,
         output_directory.GetString(), output_filename.GetString());
@@ -353,27 +352,84 @@ class FileSender : public std::enable_shared_from_this<FileSender<Demux>> {
     manager_.start(p_session, start_ec);
   }
 
+  // Files are copied while the input directory is still being walked
   void ListInputFiles(boost::system::error_code& ec) {
     std::lock_guard<std::recursive_mutex> lock(input_files_mutex_);
     boost::system::error_code fs_ec;
     SSF_LOG("microservice", trace, "[copy][file_sender] list input files");
-    std::list<Path> files;
-    bool is_file = fs_.IsFile(copy_request_.input_pattern, fs_ec);
-    if (is_file) {
-      pending_input_files_.emplace_back(Path(copy_request_.input_pattern).GetFilename());
-    } else {
-      fs_ec.clear();
-      pending_input_files_ = fs_.ListFiles(copy_request_.input_pattern,
-                                           copy_request_.is_recursive, fs_ec);
-      if (fs_ec) {
-        SSF_LOG("microservice", debug,
-                "[copy][file_sender] could not list input files");
-        ec.assign(ErrorCode::kSenderInputFileListingFailed,
-                  get_copy_category());
+    auto self = this->shared_from_this();
+    // the pattern is checked once for all the copied files: a file or a
+    // wildcard pattern is read from its parent directory
+    input_dir_ = Path(copy_request_.input_pattern);
+    is_file_input_ = fs_.IsFile(input_dir_, fs_ec);
+    if (is_file_input_ || !fs_.IsDirectory(input_dir_, fs_ec)) {
+      input_dir_ = input_dir_.GetParent();
+    }
+
+    if (is_file_input_) {
+      pending_input_files_.emplace_back(
+          Path(copy_request_.input_pattern).GetFilename());
+      input_files_count_ = 1;
+      listing_done_ = true;
+      io_service_.post([this, self]() { RunFileSession(); });
+      return;
+    }
+
+    // the walker reports its last files before the end of the listing, the
+    // strand keeps that order so the copy cannot be notified finished early
+    auto on_files = [this, self](std::vector<Path> files) {
+      listing_strand_.post([this, self, files]() { OnInputFiles(files); });
+    };
+    auto on_done = [this, self](const boost::system::error_code& ec) {
+      listing_strand_.post([this, self, ec]() { OnInputFilesListed(ec); });
+    };
+    p_walker_ = FileWalker::Create(copy_request_.input_pattern,
+                                   copy_request_.is_recursive);
+    p_walker_->Start(on_files, on_done);
+  }
+
+  void OnInputFiles(const std::vector<Path>& files) {
+    {
+      std::lock_guard<std::recursive_mutex> lock(input_files_mutex_);
+      if (stopped_) {
         return;
       }
+      pending_input_files_.insert(pending_input_files_.end(), files.begin(),
+                                  files.end());
+      input_files_count_ += files.size();
+    }
+
+    // one session per free slot, each one posts the next
+    RunFileSession();
+  }
+
+  void OnInputFilesListed(const boost::system::error_code& ec) {
+    bool is_copy_finished = false;
+    {
+      std::lock_guard<std::recursive_mutex> lock(input_files_mutex_);
+      listing_done_ = true;
+      p_walker_.reset();
+      if (stopped_) {
+        return;
+      }
+      if (ec) {
+        SSF_LOG("microservice", debug,
+                "[copy][file_sender] could not list input files ({})",
+                ec.message());
+      }
+      is_copy_finished =
+          running_files_count_ == 0 && pending_input_files_.empty();
+    }
+
+    if (!is_copy_finished) {
+      return;
+    }
+
+    if (ec && input_files_count_ == 0) {
+      NotifyCopyFinished(ErrorCode::kSenderInputFileListingFailed);
+    } else {
+      NotifyCopyFinished(ComputeCopyFinishedCode(ec));
     }
-    input_files_count_ = pending_input_files_.size();
   }
 
   void NotifyFileStatus(CopyContext* context,
@@ -393,12 +449,15 @@ class FileSender : public std::enable_shared_from_this<FileSender<Demux>> {
       SSF_LOG("microservice", debug, "[copy][file_sender] file {} copied {}",
               context->GetInputFilepath().GetString(), ec.message());
       std::lock_guard<std::recursive_mutex> lock(input_files_mutex_);
-      input_files_.remove(context->input_filename);
+      if (running_files_count_ > 0) {
+        --running_files_count_;
+      }
 
       if (ec) {
         ++copy_errors_count_;
       }
-      is_copy_finished = input_files_.empty() && pending_input_files_.empty();
+      is_copy_finished = listing_done_ && running_files_count_ == 0 &&
+                         pending_input_files_.empty();
     }
 
     if (!stopped_) {
@@ -413,16 +472,20 @@ class FileSender : public std::enable_shared_from_this<FileSender<Demux>> {
       return;
     }
 
-    // copy finished
+    NotifyCopyFinished(ComputeCopyFinishedCode(ec));
+  }
+
+  ErrorCode ComputeCopyFinishedCode(const boost::system::error_code& ec) {
     ErrorCode copy_finished_ec = ErrorCode::kSuccess;
     if (input_files_count_ == 1 || copy_request_.is_from_stdin) {
       copy_finished_ec = ErrorCode(ec.value());
-    } else if (copy_errors_count_ == input_files_count_) {
+    } else if (copy_errors_count_ == input_files_count_ &&
+               input_files_count_ > 0) {
       copy_finished_ec = ErrorCode::kNoFileCopied;
     } else if (copy_errors_count_ > 0) {
       copy_finished_ec = ErrorCode::kFilesPartiallyCopied;
     }
-    NotifyCopyFinished(copy_finished_ec);
+    return copy_finished_ec;
   }
 
   void NotifyCopyFinished(ErrorCode error_code) {
@@ -451,6 +514,7 @@ class FileSender : public std::enable_shared_from_this<FileSender<Demux>> {
 
  private:
   boost::asio::io_service& io_service_;
+  boost::asio::io_service::strand listing_strand_;
   Demux& demux_;
   std::unique_ptr<boost::asio::io_service::work> worker_;
   Fiber control_fiber_;
@@ -458,8 +522,14 @@ class FileSender : public std::enable_shared_from_this<FileSender<Demux>> {
 
   SessionManager manager_;
   std::recursive_mutex input_files_mutex_;
-  std::list<Path> pending_input_files_;
-  std::list<Path> input_files_;
+  std::deque<Path> pending_input_files_;
+  // copies in progress
+  uint64_t running_files_count_;
+  FileWalker::FileWalkerPtr p_walker_;
+  bool listing_done_;
+  // kind of the input pattern, checked once when listing
+  bool is_file_input_;
+  Path input_dir_;
   uint64_t input_files_count_;
   ssf::Filesystem fs_;
   uint64_t copy_errors_count_;
@@ -14,6 +14,8 @@
 
 #include <boost/asio/steady_timer.hpp>
 
+#include "ssf/io/handler_memory.h"
+
 #include "services/datagram/datagram_link_operator.h"
 
 namespace ssf {
@@ -86,9 +88,10 @@ struct DatagramLink : public std::enable_shared_from_this<
         // if no error occured but no data is available, we wait
         if (!ec && dgr_queue_.empty()) {
           timer_.expires_from_now(std::chrono::seconds(30));
-          yield timer_.async_wait(std::bind(&DatagramLink::ExternalFeed,
-                                            this->shared_from_this(),
-                                            std::placeholders::_1, 0));
+          yield timer_.async_wait(io::MakeMemoryHandler(
+              external_handler_memory_,
+              std::bind(&DatagramLink::ExternalFeed, this->shared_from_this(),
+                        std::placeholders::_1, 0)));
         }
 
         // if no other error than a canceled timer has occured and that some
@@ -109,8 +112,10 @@ struct DatagramLink : public std::enable_shared_from_this<
 
         yield l_.async_send_to(
             boost::asio::buffer(dgr_queue_.front()), remote_endpoint_left_,
-            std::bind(&DatagramLink::ExternalFeed, this->shared_from_this(),
-                      std::placeholders::_1, std::placeholders::_2));
+            io::MakeMemoryHandler(
+                external_handler_memory_,
+                std::bind(&DatagramLink::ExternalFeed, this->shared_from_this(),
+                          std::placeholders::_1, std::placeholders::_2)));
         dgr_queue_.pop();
         if (!auto_feeding_) {
           auto_feeding_ = true;
@@ -142,8 +147,10 @@ struct DatagramLink : public std::enable_shared_from_this<
       for (;;) {
         yield l_.async_receive_from(
             boost::asio::buffer(array_buffer_), remote_endpoint_left_,
-            std::bind(&DatagramLink::AutoFeed, this->shared_from_this(),
-                      std::placeholders::_1, std::placeholders::_2));
+            io::MakeMemoryHandler(
+                auto_handler_memory_,
+                std::bind(&DatagramLink::AutoFeed, this->shared_from_this(),
+                          std::placeholders::_1, std::placeholders::_2)));
         bytes_to_transfer_ = n;
         transferred_bytes_ = 0;
         while (transferred_bytes_ < bytes_to_transfer_) {
@@ -151,8 +158,10 @@ struct DatagramLink : public std::enable_shared_from_this<
               boost::asio::buffer(array_buffer_,
                                   bytes_to_transfer_ - transferred_bytes_),
               remote_endpoint_right_,
-              std::bind(&DatagramLink::AutoFeed, this->shared_from_this(),
-                        std::placeholders::_1, std::placeholders::_2));
+              io::MakeMemoryHandler(
+                  auto_handler_memory_,
+                  std::bind(&DatagramLink::AutoFeed, this->shared_from_this(),
+                            std::placeholders::_1, std::placeholders::_2)));
 
           transferred_bytes_ += n;
         }
@@ -232,6 +241,9 @@ struct DatagramLink : public std::enable_shared_from_this<
   bool stopping_;
   DatagramLinkOperatorSpecPtr p_operator_;
   bool auto_feeding_;
+  // Operation memory recycled by each forwarding loop
+  io::HandlerMemory auto_handler_memory_;
+  io::HandlerMemory external_handler_memory_;
 };
 
 }  // ssf
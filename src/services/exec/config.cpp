@@ -0,0 +1,14 @@
+#include "services/exec/config.h"
+
+namespace ssf {
+namespace services {
+namespace exec {
+
+Config::Config() : BaseServiceConfig(false), path_("/bin/sh") {}
+
+Config::Config(const Config& exec_service)
+    : BaseServiceConfig(exec_service.enabled()), path_(exec_service.path_) {}
+
+}  // exec
+}  // services
+}  // ssf
\ No newline at end of file
@@ -0,0 +1,29 @@
+#ifndef SSF_SERVICES_EXEC_CONFIG_H_
+#define SSF_SERVICES_EXEC_CONFIG_H_
+
+#include <string>
+
+#include "services/base_service_config.h"
+
+namespace ssf {
+namespace services {
+namespace exec {
+
+class Config : public BaseServiceConfig {
+ public:
+  Config();
+  Config(const Config& exec_service);
+
+  // Interpreter of the commands (run as <path> -c <command>)
+  inline std::string path() const { return path_; }
+  inline void set_path(const std::string& path) { path_ = path; }
+
+ private:
+  std::string path_;
+};
+
+}  // exec
+}  // services
+}  // ssf
+
+#endif  // SSF_SERVICES_EXEC_CONFIG_H_
\ No newline at end of file
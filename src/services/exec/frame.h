@@ -0,0 +1,77 @@
+#ifndef SSF_SERVICES_EXEC_FRAME_H_
+#define SSF_SERVICES_EXEC_FRAME_H_
+
+#include <cstdint>
+
+#include <array>
+
+#include <boost/asio/buffer.hpp>
+
+namespace ssf {
+namespace services {
+namespace exec {
+
+// The exec service reads one command line ending with '\n' and replies with
+// frames until the command exits:
+//   | type (1 byte) | payload length (4 bytes, big endian) | payload |
+// The last frame holds the exit status of the command (4 bytes, big endian,
+// 128 + signal number if the command was killed)
+enum class FrameType : uint8_t {
+  kUnknown = 0,
+  kStdout,
+  kStderr,
+  kExitStatus
+};
+
+class FrameHeader {
+ public:
+  enum { kSize = 5 };
+
+ public:
+  FrameHeader() : data_() {}
+
+  FrameHeader(FrameType type, uint32_t length) : data_() {
+    data_[0] = static_cast<uint8_t>(type);
+    EncodeUint32(length, data_.data() + 1);
+  }
+
+  FrameType type() const {
+    if (data_[0] > static_cast<uint8_t>(FrameType::kExitStatus)) {
+      return FrameType::kUnknown;
+    }
+    return static_cast<FrameType>(data_[0]);
+  }
+
+  uint32_t length() const { return DecodeUint32(data_.data() + 1); }
+
+  boost::asio::const_buffers_1 GetConstBuf() const {
+    return boost::asio::buffer(data_);
+  }
+
+  boost::asio::mutable_buffers_1 GetMutBuf() {
+    return boost::asio::buffer(data_);
+  }
+
+  static void EncodeUint32(uint32_t value, uint8_t* p_data) {
+    p_data[0] = static_cast<uint8_t>(value >> 24);
+    p_data[1] = static_cast<uint8_t>(value >> 16);
+    p_data[2] = static_cast<uint8_t>(value >> 8);
+    p_data[3] = static_cast<uint8_t>(value);
+  }
+
+  static uint32_t DecodeUint32(const uint8_t* p_data) {
+    return (static_cast<uint32_t>(p_data[0]) << 24) |
+           (static_cast<uint32_t>(p_data[1]) << 16) |
+           (static_cast<uint32_t>(p_data[2]) << 8) |
+           static_cast<uint32_t>(p_data[3]);
+  }
+
+ private:
+  std::array<uint8_t, kSize> data_;
+};
+
+}  // exec
+}  // services
+}  // ssf
+
+#endif  // SSF_SERVICES_EXEC_FRAME_H_
@@ -0,0 +1,156 @@
+#ifndef SSF_SERVICES_EXEC_POSIX_SESSION_H_
+#define SSF_SERVICES_EXEC_POSIX_SESSION_H_
+
+#include <sys/types.h>
+
+#include <array>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <boost/system/error_code.hpp>
+#include <boost/asio.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <boost/asio/signal_set.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/streambuf.hpp>
+
+#include <ssf/io/handler_memory.h>
+#include <ssf/network/base_session.h>
+#include <ssf/network/manager.h>
+
+#include "common/boost/fiber/stream_fiber.hpp"
+
+#include "services/exec/frame.h"
+
+namespace ssf {
+namespace services {
+namespace exec {
+
+template <typename Demux>
+class Server;
+
+namespace posix {
+
+// Run one command with pipes as stdout and stderr (stdin is /dev/null)
+template <typename Demux>
+class Session : public ssf::BaseSession {
+ private:
+  using Fiber = typename boost::asio::fiber::stream_fiber<
+      typename Demux::socket_type>::socket;
+  using ExecServer = Server<Demux>;
+
+  enum { kInvalidProcessId = -1 };
+  enum { kMaxCommandSize = 64 * 1024 };
+  // Pipe capacity asked to the system, reads are as large as the pipe
+  enum { kPipeSize = 1024 * 1024 };
+  // Delay before a stopped command is killed, then period of its reaping
+  enum { kTermTimeoutMs = 2000 };
+  enum { kReapPeriodMs = 100 };
+
+  // Output pipe of the command, read again once its frame was sent
+  struct Output {
+    Output(boost::asio::io_service& io_service, FrameType frame_type)
+        : type(frame_type),
+          sd(io_service),
+          header(),
+          size(0),
+          read_memory(),
+          done(false) {}
+
+    FrameType type;
+    boost::asio::posix::stream_descriptor sd;
+    FrameHeader header;
+    std::array<char, 256 * 1024> buffer;
+    std::size_t size;
+    io::HandlerMemory read_memory;
+    bool done;
+  };
+
+ public:
+  Session(std::weak_ptr<ExecServer> server, Fiber client,
+          const std::string& binary_path);
+
+  ~Session();
+
+ public:
+  void start(boost::system::error_code&) override;
+
+  void stop(boost::system::error_code&) override;
+
+ private:
+  std::shared_ptr<Session> SelfFromThis();
+
+  void OnCommand(const boost::system::error_code& ec, std::size_t length);
+
+  void Spawn(const std::string& command, boost::system::error_code& ec);
+
+  // Stop the command when the client goes away
+  void WaitClientClose();
+
+  // Create a pipe whose ends are closed on exec
+  static bool CloexecPipe(int fds[2]);
+
+  void AsyncReadOutput(Output* p_output);
+
+  void OnOutputRead(Output* p_output, const boost::system::error_code& ec,
+                    std::size_t length);
+
+  // Send the next output frame, or the exit status once the command is over
+  // (mutex_ held)
+  void WriteNextFrame();
+
+  void OnFrameWritten(const boost::system::error_code& ec);
+
+  // Reap the command if it exited (mutex_ held)
+  void CheckChild();
+
+  void StopHandler(const boost::system::error_code& ec);
+
+  void StartSignalWait();
+
+  void SigchldHandler(const boost::system::error_code& ec, int sig_num);
+
+  // Reap the stopped command, killing it if SIGTERM was not enough
+  // (mutex_ held)
+  void WaitKilledChild(bool sigkill_sent);
+
+ private:
+  boost::asio::io_service& io_service_;
+  std::weak_ptr<ExecServer> p_server_;
+
+  Fiber client_;
+  boost::asio::signal_set signal_;
+  boost::asio::steady_timer kill_timer_;
+
+  std::string binary_path_;
+
+  boost::asio::streambuf command_;
+  std::array<char, 256> client_input_;
+
+  std::recursive_mutex mutex_;
+  pid_t child_pid_;
+  bool exited_;
+  uint32_t exit_status_;
+
+  Output stdout_;
+  Output stderr_;
+
+  // outputs whose frame waits to be sent, writing_ while one is in flight
+  std::deque<Output*> pending_outputs_;
+  bool writing_;
+  bool exit_sent_;
+  FrameHeader exit_header_;
+  std::array<uint8_t, 4> exit_payload_;
+  io::HandlerMemory write_memory_;
+};
+
+}  // posix
+}  // exec
+}  // services
+}  // ssf
+
+#include "services/exec/posix/session.ipp"
+
+#endif  // SSF_SERVICES_EXEC_POSIX_SESSION_H_
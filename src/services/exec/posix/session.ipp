@@ -0,0 +1,418 @@
+#ifndef SSF_SERVICES_EXEC_POSIX_SESSION_IPP_
+#define SSF_SERVICES_EXEC_POSIX_SESSION_IPP_
+
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <vector>
+
+#include <boost/asio/read_until.hpp>
+#include <boost/asio/write.hpp>
+
+#include <ssf/log/log.h>
+
+#include "common/error/error.h"
+
+extern char** environ;
+
+namespace ssf {
+namespace services {
+namespace exec {
+namespace posix {
+
+template <typename Demux>
+Session<Demux>::Session(std::weak_ptr<ExecServer> server, Fiber client,
+                        const std::string& binary_path)
+    : ssf::BaseSession(),
+      io_service_(client.get_io_service()),
+      p_server_(server),
+      client_(std::move(client)),
+      signal_(io_service_),
+      kill_timer_(io_service_),
+      binary_path_(binary_path),
+      command_(kMaxCommandSize),
+      mutex_(),
+      child_pid_(kInvalidProcessId),
+      exited_(false),
+      exit_status_(0),
+      stdout_(io_service_, FrameType::kStdout),
+      stderr_(io_service_, FrameType::kStderr),
+      pending_outputs_(),
+      writing_(false),
+      exit_sent_(false),
+      exit_header_(),
+      exit_payload_(),
+      write_memory_() {}
+
+template <typename Demux>
+Session<Demux>::~Session() {
+  SSF_LOG("microservice", trace, "[exec] session destroy");
+}
+
+template <typename Demux>
+void Session<Demux>::start(boost::system::error_code& ec) {
+  SSF_LOG("microservice", debug, "[exec] session start");
+
+  // registered before the command is spawned so that its exit is not missed
+  signal_.add(SIGCHLD, ec);
+  if (ec) {
+    SSF_LOG("microservice", error,
+            "[exec] session init signal handler on SIGCHLD failed");
+    stop(ec);
+    return;
+  }
+
+  auto self = this->SelfFromThis();
+  boost::asio::async_read_until(
+      client_, command_, '\n',
+      [this, self](const boost::system::error_code& ec, std::size_t length) {
+        OnCommand(ec, length);
+      });
+}
+
+template <typename Demux>
+void Session<Demux>::stop(boost::system::error_code& ec) {
+  SSF_LOG("microservice", debug, "[exec] session stop");
+
+  client_.close();
+
+  std::unique_lock<std::recursive_mutex> lock(mutex_);
+  stdout_.sd.cancel(ec);
+  stdout_.sd.close(ec);
+  stderr_.sd.cancel(ec);
+  stderr_.sd.close(ec);
+
+  if (child_pid_ > 0) {
+    kill(child_pid_, SIGTERM);
+    CheckChild();
+    if (child_pid_ > 0) {
+      // reaped later without blocking the io_service thread
+      WaitKilledChild(false);
+    }
+  }
+
+  signal_.cancel(ec);
+  signal_.clear(ec);
+}
+
+template <typename Demux>
+void Session<Demux>::WaitKilledChild(bool sigkill_sent) {
+  auto self = this->SelfFromThis();
+  kill_timer_.expires_from_now(
+      sigkill_sent ? std::chrono::milliseconds(kReapPeriodMs)
+                   : std::chrono::milliseconds(kTermTimeoutMs));
+  kill_timer_.async_wait(
+      [this, self, sigkill_sent](const boost::system::error_code& ec) {
+        std::unique_lock<std::recursive_mutex> lock(mutex_);
+        CheckChild();
+        if (ec || child_pid_ <= 0) {
+          return;
+        }
+
+        if (!sigkill_sent) {
+          SSF_LOG("microservice", debug,
+                  "[exec] command still running after SIGTERM, kill it");
+          kill(child_pid_, SIGKILL);
+        }
+        WaitKilledChild(true);
+      });
+}
+
+template <typename Demux>
+std::shared_ptr<Session<Demux>> Session<Demux>::SelfFromThis() {
+  return std::static_pointer_cast<Session>(this->shared_from_this());
+}
+
+template <typename Demux>
+void Session<Demux>::OnCommand(const boost::system::error_code& ec,
+                               std::size_t length) {
+  if (ec) {
+    SSF_LOG("microservice", debug, "[exec] session could not read command");
+    StopHandler(ec);
+    return;
+  }
+
+  auto begin = boost::asio::buffers_begin(command_.data());
+  std::string command(begin, begin + length - 1);
+  command_.consume(command_.size());
+  if (!command.empty() && command.back() == '\r') {
+    command.pop_back();
+  }
+
+  boost::system::error_code spawn_ec;
+  if (command.empty()) {
+    spawn_ec.assign(::error::invalid_argument, ::error::get_ssf_category());
+    StopHandler(spawn_ec);
+    return;
+  }
+
+  std::unique_lock<std::recursive_mutex> lock(mutex_);
+  Spawn(command, spawn_ec);
+  if (spawn_ec) {
+    SSF_LOG("microservice", error, "[exec] session could not run command");
+    lock.unlock();
+    StopHandler(spawn_ec);
+    return;
+  }
+
+  StartSignalWait();
+  AsyncReadOutput(&stdout_);
+  AsyncReadOutput(&stderr_);
+  WaitClientClose();
+}
+
+template <typename Demux>
+void Session<Demux>::WaitClientClose() {
+  // the command has no stdin: anything but the end of the client is ignored
+  auto self = this->SelfFromThis();
+  client_.async_read_some(
+      boost::asio::buffer(client_input_),
+      [this, self](const boost::system::error_code& ec, std::size_t) {
+        if (ec) {
+          SSF_LOG("microservice", debug, "[exec] session client closed");
+          StopHandler(ec);
+          return;
+        }
+        WaitClientClose();
+      });
+}
+
+template <typename Demux>
+void Session<Demux>::Spawn(const std::string& command,
+                           boost::system::error_code& ec) {
+  // the command only gets its own ends, duplicated on stdout and stderr
+  int stdout_pipe[2];
+  int stderr_pipe[2];
+  if (!CloexecPipe(stdout_pipe)) {
+    ec.assign(::error::broken_pipe, ::error::get_ssf_category());
+    return;
+  }
+  if (!CloexecPipe(stderr_pipe)) {
+    close(stdout_pipe[0]);
+    close(stdout_pipe[1]);
+    ec.assign(::error::broken_pipe, ::error::get_ssf_category());
+    return;
+  }
+
+#if defined(F_SETPIPE_SZ)
+  // larger pipes let the command run ahead while frames are sent
+  fcntl(stdout_pipe[0], F_SETPIPE_SZ, kPipeSize);
+  fcntl(stderr_pipe[0], F_SETPIPE_SZ, kPipeSize);
+#endif
+
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null",
+                                   O_RDONLY, 0);
+  posix_spawn_file_actions_adddup2(&actions, stdout_pipe[1], STDOUT_FILENO);
+  posix_spawn_file_actions_adddup2(&actions, stderr_pipe[1], STDERR_FILENO);
+
+  std::size_t slash_pos = binary_path_.rfind('/');
+  std::string binary_name = std::string::npos != slash_pos
+                                ? binary_path_.substr(slash_pos + 1)
+                                : binary_path_;
+  std::string command_option("-c");
+  std::vector<char*> argv = {const_cast<char*>(binary_name.c_str()),
+                             const_cast<char*>(command_option.c_str()),
+                             const_cast<char*>(command.c_str()), nullptr};
+
+  pid_t child_pid;
+  int result = posix_spawn(&child_pid, binary_path_.c_str(), &actions,
+                           nullptr, argv.data(), environ);
+  posix_spawn_file_actions_destroy(&actions);
+
+  close(stdout_pipe[1]);
+  close(stderr_pipe[1]);
+
+  if (result != 0) {
+    close(stdout_pipe[0]);
+    close(stderr_pipe[0]);
+    ec.assign(::error::process_not_created, ::error::get_ssf_category());
+    return;
+  }
+
+  child_pid_ = child_pid;
+
+  stdout_.sd.assign(stdout_pipe[0], ec);
+  if (ec) {
+    close(stdout_pipe[0]);
+    close(stderr_pipe[0]);
+    return;
+  }
+
+  stderr_.sd.assign(stderr_pipe[0], ec);
+  if (ec) {
+    close(stderr_pipe[0]);
+  }
+}
+
+template <typename Demux>
+bool Session<Demux>::CloexecPipe(int fds[2]) {
+#if defined(O_CLOEXEC) && (defined(__linux__) || defined(__FreeBSD__) || \
+                           defined(__NetBSD__) || defined(__OpenBSD__))
+  // no window where a concurrent spawn inherits the descriptors
+  return pipe2(fds, O_CLOEXEC) == 0;
+#else
+  if (pipe(fds) != 0) {
+    return false;
+  }
+  fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+  fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+  return true;
+#endif
+}
+
+template <typename Demux>
+void Session<Demux>::AsyncReadOutput(Output* p_output) {
+  auto self = this->SelfFromThis();
+  p_output->sd.async_read_some(
+      boost::asio::buffer(p_output->buffer),
+      io::MakeMemoryHandler(
+          p_output->read_memory,
+          [this, self, p_output](const boost::system::error_code& ec,
+                                 std::size_t length) {
+            OnOutputRead(p_output, ec, length);
+          }));
+}
+
+template <typename Demux>
+void Session<Demux>::OnOutputRead(Output* p_output,
+                                  const boost::system::error_code& ec,
+                                  std::size_t length) {
+  std::unique_lock<std::recursive_mutex> lock(mutex_);
+  if (ec) {
+    // end of the output (the command exited or closed it)
+    boost::system::error_code close_ec;
+    p_output->done = true;
+    p_output->sd.close(close_ec);
+    CheckChild();
+    WriteNextFrame();
+    return;
+  }
+
+  p_output->size = length;
+  p_output->header = FrameHeader(p_output->type, static_cast<uint32_t>(length));
+  pending_outputs_.push_back(p_output);
+  WriteNextFrame();
+}
+
+template <typename Demux>
+void Session<Demux>::WriteNextFrame() {
+  if (writing_) {
+    return;
+  }
+
+  auto self = this->SelfFromThis();
+  auto on_written = io::MakeMemoryHandler(
+      write_memory_,
+      [this, self](const boost::system::error_code& ec, std::size_t) {
+        OnFrameWritten(ec);
+      });
+
+  if (!pending_outputs_.empty()) {
+    auto p_output = pending_outputs_.front();
+    std::array<boost::asio::const_buffer, 2> frame = {
+        {p_output->header.GetConstBuf(),
+         boost::asio::buffer(p_output->buffer.data(), p_output->size)}};
+    writing_ = true;
+    boost::asio::async_write(client_, frame, std::move(on_written));
+    return;
+  }
+
+  if (!stdout_.done || !stderr_.done || !exited_ || exit_sent_) {
+    return;
+  }
+
+  exit_header_ = FrameHeader(FrameType::kExitStatus,
+                             static_cast<uint32_t>(exit_payload_.size()));
+  FrameHeader::EncodeUint32(exit_status_, exit_payload_.data());
+  std::array<boost::asio::const_buffer, 2> frame = {
+      {exit_header_.GetConstBuf(), boost::asio::buffer(exit_payload_)}};
+  exit_sent_ = true;
+  writing_ = true;
+  boost::asio::async_write(client_, frame, std::move(on_written));
+}
+
+template <typename Demux>
+void Session<Demux>::OnFrameWritten(const boost::system::error_code& ec) {
+  std::unique_lock<std::recursive_mutex> lock(mutex_);
+  writing_ = false;
+
+  if (ec || exit_sent_) {
+    // the exit status is the last frame of the session
+    lock.unlock();
+    StopHandler(ec);
+    return;
+  }
+
+  auto p_output = pending_outputs_.front();
+  pending_outputs_.pop_front();
+  AsyncReadOutput(p_output);
+  WriteNextFrame();
+}
+
+template <typename Demux>
+void Session<Demux>::CheckChild() {
+  if (child_pid_ <= 0 || exited_) {
+    return;
+  }
+
+  int status;
+  if (waitpid(child_pid_, &status, WNOHANG) != child_pid_) {
+    return;
+  }
+
+  if (WIFEXITED(status)) {
+    exit_status_ = WEXITSTATUS(status);
+  } else if (WIFSIGNALED(status)) {
+    exit_status_ = 128 + WTERMSIG(status);
+  } else {
+    // stopped or continued, not terminated
+    return;
+  }
+
+  exited_ = true;
+  child_pid_ = kInvalidProcessId;
+}
+
+template <typename Demux>
+void Session<Demux>::StopHandler(const boost::system::error_code& ec) {
+  boost::system::error_code stop_err;
+  if (auto server = p_server_.lock()) {
+    server->StopSession(this->SelfFromThis(), stop_err);
+  }
+}
+
+template <typename Demux>
+void Session<Demux>::StartSignalWait() {
+  signal_.async_wait(std::bind(&Session::SigchldHandler, this->SelfFromThis(),
+                               std::placeholders::_1, std::placeholders::_2));
+}
+
+template <typename Demux>
+void Session<Demux>::SigchldHandler(const boost::system::error_code& ec,
+                                    int sig_num) {
+  if (ec) {
+    return;
+  }
+
+  std::unique_lock<std::recursive_mutex> lock(mutex_);
+  CheckChild();
+  if (!exited_) {
+    StartSignalWait();
+    return;
+  }
+
+  WriteNextFrame();
+}
+
+}  // posix
+}  // exec
+}  // services
+}  // ssf
+
+#endif  // SSF_SERVICES_EXEC_POSIX_SESSION_IPP_
@@ -0,0 +1,126 @@
+#ifndef SSF_SERVICES_EXEC_SERVER_IPP_
+#define SSF_SERVICES_EXEC_SERVER_IPP_
+
+#include <fstream>
+#include <functional>
+#include <string>
+
+#include <boost/system/error_code.hpp>
+
+#include <ssf/log/log.h>
+
+namespace ssf {
+namespace services {
+namespace exec {
+
+template <typename Demux>
+Server<Demux>::Server(boost::asio::io_service& io_service, Demux& fiber_demux,
+                      const LocalPortType& port, const std::string& binary_path)
+    : ssf::BaseService<Demux>::BaseService(io_service, fiber_demux),
+      fiber_acceptor_(io_service),
+      session_manager_(),
+      local_port_(port),
+      binary_path_(binary_path) {}
+
+template <typename Demux>
+void Server<Demux>::start(boost::system::error_code& ec) {
+  FiberEndpoint ep(this->get_demux(), local_port_);
+  fiber_acceptor_.bind(ep, ec);
+
+  if (ec) {
+    SSF_LOG("microservice", error,
+            "[exec]: fiber acceptor could not bind on port {}", local_port_);
+    return;
+  }
+
+  fiber_acceptor_.listen(boost::asio::socket_base::max_connections, ec);
+  if (ec) {
+    SSF_LOG("microservice", error, "[exec]: fiber acceptor could not listen");
+    return;
+  }
+
+  if (!CheckBinaryPath()) {
+    SSF_LOG("microservice", error, "[exec]: binary not found");
+    ec.assign(::error::file_not_found, ::error::get_ssf_category());
+    return;
+  }
+
+  SSF_LOG("microservice", info, "[exec]: start server on fiber port {}",
+          local_port_);
+
+  this->AsyncAcceptFiber();
+}
+
+template <typename Demux>
+void Server<Demux>::stop(boost::system::error_code& ec) {
+  ec.assign(boost::system::errc::success, boost::system::system_category());
+
+  SSF_LOG("microservice", debug, "[exec]: stop server");
+  this->HandleStop();
+}
+
+template <typename Demux>
+uint32_t Server<Demux>::service_type_id() {
+  return kFactoryId;
+}
+
+template <typename Demux>
+void Server<Demux>::StopSession(BaseSessionPtr session,
+                                boost::system::error_code& ec) {
+  session_manager_.stop(session, ec);
+}
+
+template <typename Demux>
+void Server<Demux>::AsyncAcceptFiber() {
+  SSF_LOG("microservice", trace, "[exec]: accepting new session");
+  FiberPtr new_connection = std::make_shared<Fiber>(
+      this->get_io_service(), FiberEndpoint(this->get_demux(), 0));
+
+  fiber_acceptor_.async_accept(
+      *new_connection,
+      std::bind(&Server::FiberAcceptHandler, this->SelfFromThis(),
+                new_connection, std::placeholders::_1));
+}
+
+template <typename Demux>
+void Server<Demux>::FiberAcceptHandler(FiberPtr new_connection,
+                                       const boost::system::error_code& ec) {
+  if (ec) {
+    SSF_LOG("microservice", debug,
+            "[exec]: error accepting new connections: {} ({})", ec.message(),
+            ec.value());
+    return;
+  }
+
+  SSF_LOG("microservice", debug, "[exec]: start session");
+
+  this->AsyncAcceptFiber();
+
+#if !defined(BOOST_ASIO_WINDOWS)
+  ssf::BaseSessionPtr new_exec_session =
+      std::make_shared<posix::Session<Demux>>(
+          this->SelfFromThis(), std::move(*new_connection), binary_path_);
+  boost::system::error_code e;
+  session_manager_.start(new_exec_session, e);
+#else
+  new_connection->close();
+#endif  // !defined(BOOST_ASIO_WINDOWS)
+}
+
+template <typename Demux>
+void Server<Demux>::HandleStop() {
+  fiber_acceptor_.close();
+  session_manager_.stop_all();
+}
+
+template <typename Demux>
+bool Server<Demux>::CheckBinaryPath() {
+  std::ifstream binary_file(binary_path_);
+  return binary_file.good();
+}
+
+}  // exec
+}  // services
+}  // ssf
+
+#endif  // SSF_SERVICES_EXEC_SERVER_IPP_
@@ -3,6 +3,7 @@
 
 #include <cstdint>
 
+#include <array>
 #include <memory>
 
 #include <boost/asio.hpp>
@@ -17,9 +18,8 @@
 #include "core/factories/service_factory.h"
 
 #include "services/admin/requests/create_service_request.h"
-#include "services/datagram/datagram_link.h"
-#include "services/datagram/datagram_link_operator.h"
 #include "services/fibers_to_datagrams/config.h"
+#include "services/fibers_to_datagrams/udp_relay.h"
 
 namespace ssf {
 namespace services {
@@ -38,9 +38,8 @@ class FibersToDatagrams : public BaseService<Demux> {
 
   using Udp = boost::asio::ip::udp;
 
-  using UdpOperator = DatagramLinkOperator<FiberEndpoint, FiberDatagram,
-                                           Udp::endpoint, Udp::socket>;
-  using UdpOperatorPtr = std::shared_ptr<UdpOperator>;
+  using Relay = UdpRelay<FiberDatagram, FiberEndpoint>;
+  using RelayPtr = typename Relay::UdpRelayPtr;
 
   using FibersToDatagramsPtr = std::shared_ptr<FibersToDatagrams>;
 
@@ -139,7 +138,7 @@ class FibersToDatagrams : public BaseService<Demux> {
 
   WorkingBufferType working_buffer_;
 
-  UdpOperatorPtr p_udp_operator_;
+  RelayPtr p_relay_;
 };
 
 }  // fibers_to_datagrams
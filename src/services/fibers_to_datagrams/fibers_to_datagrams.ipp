@@ -20,7 +20,7 @@ FibersToDatagrams<Demux>::FibersToDatagrams(boost::asio::io_service& io_service,
       local_port_(local_port),
       fiber_(io_service),
       from_endpoint_(fiber_demux, 0),
-      p_udp_operator_(UdpOperator::Create(fiber_)) {}
+      p_relay_() {}
 
 template <typename Demux>
 void FibersToDatagrams<Demux>::start(boost::system::error_code& ec) {
@@ -45,6 +45,9 @@ void FibersToDatagrams<Demux>::start(boost::system::error_code& ec) {
 
   to_endpoint_ = *iterator;
 
+  p_relay_ = Relay::Create(this->get_io_service(), fiber_, to_endpoint_);
+  p_relay_->Start();
+
   SSF_LOG("microservice", info,
           "[datagram_forwarder]: forward fiber datagrams from fiber port {} to "
           "<{}:{}>",
@@ -59,7 +62,9 @@ void FibersToDatagrams<Demux>::stop(boost::system::error_code& ec) {
   ec.assign(::error::success, ::error::get_ssf_category());
 
   fiber_.close();
-  p_udp_operator_->StopAll();
+  if (p_relay_) {
+    p_relay_->Stop();
+  }
 }
 
 template <typename Demux>
@@ -86,16 +91,8 @@ void FibersToDatagrams<Demux>::OnFiberDatagramReceive(
     return;
   }
 
-  auto already_in = p_udp_operator_->Feed(
-      from_endpoint_, boost::asio::buffer(working_buffer_), length);
-
-  if (!already_in) {
-    Udp::socket left(this->get_io_service(), Udp::endpoint(Udp::v4(), 0));
-    p_udp_operator_->AddLink(std::move(left), from_endpoint_, to_endpoint_,
-                             this->get_io_service());
-    p_udp_operator_->Feed(from_endpoint_, boost::asio::buffer(working_buffer_),
-                          length);
-  }
+  p_relay_->Send(from_endpoint_,
+                 boost::asio::buffer(working_buffer_.data(), length));
 
   this->AsyncReceiveDatagram();
 }
@@ -0,0 +1,370 @@
+#ifndef SSF_SERVICES_FIBERS_TO_DATAGRAMS_UDP_RELAY_H_
+#define SSF_SERVICES_FIBERS_TO_DATAGRAMS_UDP_RELAY_H_
+
+#include <cstdint>
+
+#include <array>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/udp.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <ssf/io/handler_memory.h>
+#include <ssf/log/log.h>
+
+namespace ssf {
+namespace services {
+namespace fibers_to_datagrams {
+
+// Relay of fiber datagram flows to a UDP endpoint
+//   Each flow (remote fiber port) is mapped to the source port of a UDP
+//   socket so that replies find their flow. Idle flows expire on a timer
+//   wheel, their sockets are kept in a small pool and reused by the next
+//   flows instead of being opened and bound again.
+template <typename FiberDatagram, typename FiberEndpoint>
+class UdpRelay
+    : public std::enable_shared_from_this<UdpRelay<FiberDatagram,
+                                                   FiberEndpoint>> {
+ private:
+  using Udp = boost::asio::ip::udp;
+  using PortType = typename FiberEndpoint::port_type;
+
+  struct Flow {
+    Flow(Udp::socket flow_socket, const FiberEndpoint& flow_fiber_endpoint,
+         const Udp::endpoint& flow_peer_endpoint)
+        : socket(std::move(flow_socket)),
+          fiber_endpoint(flow_fiber_endpoint),
+          peer_endpoint(flow_peer_endpoint),
+          received_from(),
+          last_tick(0),
+          wheel_tick(0),
+          stopped(false) {}
+
+    Udp::socket socket;
+    FiberEndpoint fiber_endpoint;
+    // replies are sent back to the last endpoint which answered
+    Udp::endpoint peer_endpoint;
+    Udp::endpoint received_from;
+    // sized to the largest datagram received by the flow
+    std::vector<uint8_t> buffer;
+    // tick of the last datagram and tick of the wheel slot holding the flow
+    uint64_t last_tick;
+    uint64_t wheel_tick;
+    bool stopped;
+    // receive and send to the fiber alternate on the same memory
+    io::HandlerMemory handler_memory;
+  };
+
+  using FlowPtr = std::shared_ptr<Flow>;
+
+ public:
+  using UdpRelayPtr = std::shared_ptr<UdpRelay>;
+
+  // Flows idle for kIdleTicks ticks expire
+  enum { kTickMilliseconds = 1000, kIdleTicks = 60, kWheelSize = 64 };
+  // Sockets of expired flows kept for the next flows
+  enum { kMaxPooledSockets = 64 };
+
+ public:
+  static UdpRelayPtr Create(
+      boost::asio::io_service& io_service, FiberDatagram& fiber,
+      const Udp::endpoint& to_endpoint,
+      std::chrono::milliseconds tick =
+          std::chrono::milliseconds(kTickMilliseconds)) {
+    return UdpRelayPtr(new UdpRelay(io_service, fiber, to_endpoint, tick));
+  }
+
+  ~UdpRelay() {}
+
+  void Start() {
+    std::unique_lock<std::recursive_mutex> lock(mutex_);
+    AsyncTick();
+  }
+
+  void Stop() {
+    std::unique_lock<std::recursive_mutex> lock(mutex_);
+    if (stopped_) {
+      return;
+    }
+    stopped_ = true;
+
+    boost::system::error_code ec;
+    timer_.cancel(ec);
+    for (auto& flow : flows_) {
+      flow.second->stopped = true;
+      flow.second->socket.close(ec);
+    }
+    flows_.clear();
+    for (auto& socket : free_sockets_) {
+      socket.close(ec);
+    }
+    free_sockets_.clear();
+    for (auto& slot : wheel_) {
+      slot.clear();
+    }
+  }
+
+  // Send a datagram received from a fiber flow to the UDP endpoint, the
+  // datagram is dropped if the socket buffer is full
+  void Send(const FiberEndpoint& from, boost::asio::const_buffer datagram) {
+    std::unique_lock<std::recursive_mutex> lock(mutex_);
+    if (stopped_) {
+      return;
+    }
+
+    FlowPtr p_flow;
+    auto flow_it = flows_.find(from.port());
+    if (flow_it != flows_.end()) {
+      p_flow = flow_it->second;
+    } else {
+      boost::system::error_code ec;
+      p_flow = CreateFlow(from, ec);
+      if (ec) {
+        SSF_LOG("microservice", debug,
+                "[datagram_forwarder]: cannot create flow ({})", ec.message());
+        return;
+      }
+    }
+
+    p_flow->last_tick = tick_;
+    boost::system::error_code ec;
+    p_flow->socket.send_to(boost::asio::buffer(datagram),
+                           p_flow->peer_endpoint, 0, ec);
+  }
+
+  std::size_t flows_count() {
+    std::unique_lock<std::recursive_mutex> lock(mutex_);
+    return flows_.size();
+  }
+
+  std::size_t pooled_sockets_count() {
+    std::unique_lock<std::recursive_mutex> lock(mutex_);
+    return free_sockets_.size();
+  }
+
+ private:
+  UdpRelay(boost::asio::io_service& io_service, FiberDatagram& fiber,
+           const Udp::endpoint& to_endpoint, std::chrono::milliseconds tick)
+      : io_service_(io_service),
+        fiber_(fiber),
+        to_endpoint_(to_endpoint),
+        tick_duration_(tick),
+        mutex_(),
+        flows_(),
+        free_sockets_(),
+        wheel_(),
+        tick_(0),
+        timer_(io_service),
+        stopped_(false) {}
+
+  // mutex_ held
+  FlowPtr CreateFlow(const FiberEndpoint& from,
+                     boost::system::error_code& ec) {
+    Udp::socket socket(io_service_);
+    if (!free_sockets_.empty()) {
+      socket = std::move(free_sockets_.back());
+      free_sockets_.pop_back();
+      DiscardPendingDatagrams(socket);
+    } else {
+      socket.open(to_endpoint_.protocol(), ec);
+      if (ec) {
+        return FlowPtr();
+      }
+      socket.bind(Udp::endpoint(to_endpoint_.protocol(), 0), ec);
+      if (!ec) {
+        socket.non_blocking(true, ec);
+      }
+      if (ec) {
+        boost::system::error_code close_ec;
+        socket.close(close_ec);
+        return FlowPtr();
+      }
+    }
+
+    auto p_flow = std::make_shared<Flow>(std::move(socket), from, to_endpoint_);
+    p_flow->last_tick = tick_;
+    p_flow->wheel_tick = tick_ + kIdleTicks;
+    wheel_[p_flow->wheel_tick % kWheelSize].push_back(from.port());
+    flows_[from.port()] = p_flow;
+
+    AsyncReceive(p_flow);
+
+    return p_flow;
+  }
+
+  // Late replies to the previous flow of a pooled socket are dropped
+  static void DiscardPendingDatagrams(Udp::socket& socket) {
+    std::array<uint8_t, 1> discarded;
+    boost::system::error_code ec;
+    while (socket.available(ec) > 0 && !ec) {
+      socket.receive(boost::asio::buffer(discarded), 0, ec);
+      if (ec == boost::asio::error::message_size) {
+        ec.clear();
+      }
+    }
+  }
+
+  // Wait for a datagram, it is received once its size is known
+  void AsyncReceive(FlowPtr p_flow) {
+    auto self = this->shared_from_this();
+    p_flow->socket.async_receive(
+        boost::asio::null_buffers(),
+        io::MakeMemoryHandler(
+            p_flow->handler_memory,
+            [this, self, p_flow](const boost::system::error_code& ec,
+                                 std::size_t) { OnUdpReadable(p_flow, ec); }));
+  }
+
+  void OnUdpReadable(FlowPtr p_flow, boost::system::error_code ec) {
+    std::unique_lock<std::recursive_mutex> lock(mutex_);
+    if (stopped_ || p_flow->stopped) {
+      return;
+    }
+
+    std::size_t length = 0;
+    if (!ec) {
+      std::size_t available = p_flow->socket.available(ec);
+      if (!ec && p_flow->buffer.size() < available) {
+        p_flow->buffer.resize(available);
+      }
+    }
+    if (!ec) {
+      length = p_flow->socket.receive_from(boost::asio::buffer(p_flow->buffer),
+                                           p_flow->received_from, 0, ec);
+    }
+
+    if (ec == boost::asio::error::would_block) {
+      AsyncReceive(p_flow);
+      return;
+    }
+
+    if (ec) {
+      if (ec == boost::asio::error::connection_refused ||
+          ec == boost::asio::error::connection_reset) {
+        // ICMP unreachable reported on the socket, the flow goes on
+        AsyncReceive(p_flow);
+        return;
+      }
+      SSF_LOG("microservice", debug,
+              "[datagram_forwarder]: flow receive error: {} ({})",
+              ec.message(), ec.value());
+      Expire(p_flow);
+      return;
+    }
+
+    p_flow->last_tick = tick_;
+    p_flow->peer_endpoint = p_flow->received_from;
+
+    auto self = this->shared_from_this();
+    fiber_.async_send_to(
+        boost::asio::buffer(p_flow->buffer.data(), length),
+        p_flow->fiber_endpoint,
+        io::MakeMemoryHandler(
+            p_flow->handler_memory,
+            [this, self, p_flow](const boost::system::error_code& ec,
+                                 std::size_t) { OnFiberSent(p_flow, ec); }));
+  }
+
+  void OnFiberSent(FlowPtr p_flow, const boost::system::error_code& ec) {
+    std::unique_lock<std::recursive_mutex> lock(mutex_);
+    if (stopped_ || p_flow->stopped) {
+      return;
+    }
+
+    if (ec) {
+      Expire(p_flow);
+      return;
+    }
+
+    AsyncReceive(p_flow);
+  }
+
+  // mutex_ held
+  void Expire(FlowPtr p_flow) {
+    p_flow->stopped = true;
+    flows_.erase(p_flow->fiber_endpoint.port());
+
+    boost::system::error_code ec;
+    p_flow->socket.cancel(ec);
+    if (!ec && p_flow->socket.is_open() &&
+        free_sockets_.size() < kMaxPooledSockets) {
+      free_sockets_.push_back(std::move(p_flow->socket));
+    } else {
+      p_flow->socket.close(ec);
+    }
+  }
+
+  void AsyncTick() {
+    if (stopped_) {
+      return;
+    }
+
+    boost::system::error_code ec;
+    timer_.expires_from_now(tick_duration_, ec);
+    timer_.async_wait(std::bind(&UdpRelay::OnTick, this->shared_from_this(),
+                                std::placeholders::_1));
+  }
+
+  // Visit the flows of the current wheel slot: expire the idle ones and
+  // reschedule the others at their new deadline
+  void OnTick(const boost::system::error_code& ec) {
+    if (ec) {
+      return;
+    }
+
+    std::unique_lock<std::recursive_mutex> lock(mutex_);
+    if (stopped_) {
+      return;
+    }
+
+    ++tick_;
+    std::vector<PortType> ports;
+    ports.swap(wheel_[tick_ % kWheelSize]);
+    for (auto port : ports) {
+      auto flow_it = flows_.find(port);
+      if (flow_it == flows_.end() || flow_it->second->wheel_tick != tick_) {
+        // the flow of this entry is gone
+        continue;
+      }
+
+      auto p_flow = flow_it->second;
+      if (tick_ - p_flow->last_tick >= kIdleTicks) {
+        Expire(p_flow);
+        continue;
+      }
+
+      p_flow->wheel_tick = p_flow->last_tick + kIdleTicks;
+      wheel_[p_flow->wheel_tick % kWheelSize].push_back(port);
+    }
+
+    AsyncTick();
+  }
+
+ private:
+  boost::asio::io_service& io_service_;
+  FiberDatagram& fiber_;
+  Udp::endpoint to_endpoint_;
+  std::chrono::milliseconds tick_duration_;
+
+  std::recursive_mutex mutex_;
+  std::unordered_map<PortType, FlowPtr> flows_;
+  std::vector<Udp::socket> free_sockets_;
+  std::array<std::vector<PortType>, kWheelSize> wheel_;
+  uint64_t tick_;
+  boost::asio::steady_timer timer_;
+  bool stopped_;
+};
+
+}  // fibers_to_datagrams
+}  // services
+}  // ssf
+
+#endif  // SSF_SERVICES_FIBERS_TO_DATAGRAMS_UDP_RELAY_H_
@@ -4,10 +4,17 @@ namespace ssf {
 namespace services {
 namespace fibers_to_sockets {
 
-Config::Config() : BaseServiceConfig(true) {}
+Config::Config()
+    : BaseServiceConfig(true),
+      buffer_size_(50 * 1024),
+      buffers_(2),
+      zero_copy_(false) {}
 
 Config::Config(const Config& stream_forwarder)
-    : BaseServiceConfig(stream_forwarder.enabled()) {}
+    : BaseServiceConfig(stream_forwarder.enabled()),
+      buffer_size_(stream_forwarder.buffer_size_),
+      buffers_(stream_forwarder.buffers_),
+      zero_copy_(stream_forwarder.zero_copy_) {}
 
 }  // fibers_to_sockets
 }  // services
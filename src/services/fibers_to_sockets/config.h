@@ -1,6 +1,8 @@
 #ifndef SSF_SERVICES_FIBERS_TO_SOCKETS_CONFIG_H_
 #define SSF_SERVICES_FIBERS_TO_SOCKETS_CONFIG_H_
 
+#include <cstdint>
+
 #include "services/base_service_config.h"
 
 namespace ssf {
@@ -11,6 +13,26 @@ class Config : public BaseServiceConfig {
  public:
   Config();
   Config(const Config& stream_forwarder);
+
+  // Size of the forwarding buffers of each session direction
+  inline uint32_t buffer_size() const { return buffer_size_; }
+  inline void set_buffer_size(uint32_t buffer_size) {
+    buffer_size_ = buffer_size;
+  }
+
+  // Buffers in flight in each session direction (reads overlap writes from
+  // 2 buffers)
+  inline uint32_t buffers() const { return buffers_; }
+  inline void set_buffers(uint32_t buffers) { buffers_ = buffers; }
+
+  // Large writes to the target TCP socket sent without a copy (Linux only)
+  inline bool zero_copy() const { return zero_copy_; }
+  inline void set_zero_copy(bool zero_copy) { zero_copy_ = zero_copy; }
+
+ private:
+  uint32_t buffer_size_;
+  uint32_t buffers_;
+  bool zero_copy_;
 };
 
 }  // fibers_to_sockets
@@ -11,6 +11,7 @@
 
 #include <ssf/network/base_session.h>
 #include <ssf/network/manager.h>
+#include <ssf/network/pipelined_link.h>
 #include <ssf/network/socket_link.h>
 
 #include "services/base_service.h"
@@ -41,6 +42,9 @@ class FibersToSockets : public BaseService<Demux> {
   using FiberAcceptor = typename ssf::BaseService<Demux>::fiber_acceptor;
 
   using Tcp = boost::asio::ip::tcp;
+  using OutboundSocketReservation =
+      boost::asio::fiber::detail::outbound_socket_reservation;
+  using OutboundSocketReservationPtr = OutboundSocketReservation::pointer;
 
  public:
   enum { kFactoryId = to_underlying(MicroserviceId::kFibersToSockets) };
@@ -56,7 +60,8 @@ class FibersToSockets : public BaseService<Demux> {
  public:
   static FibersToSocketsPtr Create(boost::asio::io_service& io_service,
                                    Demux& fiber_demux,
-                                   const Parameters& parameters) {
+                                   const Parameters& parameters,
+                                   const PipelinedLinkOptions& link_options) {
     if (!parameters.count("local_port") || !parameters.count("remote_ip") ||
         !parameters.count("remote_port")) {
       return FibersToSocketsPtr(nullptr);
@@ -81,7 +86,7 @@ class FibersToSockets : public BaseService<Demux> {
 
     return FibersToSocketsPtr(new FibersToSockets(
         io_service, fiber_demux, local_port, parameters.at("remote_ip"),
-        static_cast<RemotePortType>(remote_port)));
+        static_cast<RemotePortType>(remote_port), link_options));
   }
 
   static void RegisterToServiceFactory(
@@ -91,9 +96,15 @@ class FibersToSockets : public BaseService<Demux> {
       return;
     }
 
-    auto creator = [](boost::asio::io_service& io_service, Demux& fiber_demux,
-                      const Parameters& parameters) {
-      return FibersToSockets::Create(io_service, fiber_demux, parameters);
+    PipelinedLinkOptions link_options;
+    link_options.buffer_size = config.buffer_size();
+    link_options.buffers = config.buffers();
+    link_options.zero_copy = config.zero_copy();
+    auto creator = [link_options](boost::asio::io_service& io_service,
+                                  Demux& fiber_demux,
+                                  const Parameters& parameters) {
+      return FibersToSockets::Create(io_service, fiber_demux, parameters,
+                                     link_options);
     };
     p_factory->RegisterServiceCreator(kFactoryId, creator);
   }
@@ -120,7 +131,8 @@ class FibersToSockets : public BaseService<Demux> {
  private:
   FibersToSockets(boost::asio::io_service& io_service, Demux& fiber_demux,
                   LocalPortType local_port, const std::string& ip,
-                  RemotePortType remote_port);
+                  RemotePortType remote_port,
+                  const PipelinedLinkOptions& link_options);
 
   void AsyncAcceptFibers();
 
@@ -129,6 +141,7 @@ class FibersToSockets : public BaseService<Demux> {
 
   void TcpSocketConnectHandler(std::shared_ptr<Tcp::socket> socket,
                                FiberPtr fiber_connection,
+                               OutboundSocketReservationPtr p_reservation,
                                const boost::system::error_code& ec);
 
   FibersToSocketsPtr SelfFromThis() {
@@ -142,6 +155,7 @@ class FibersToSockets : public BaseService<Demux> {
   FiberAcceptor fiber_acceptor_;
 
   Tcp::endpoint remote_endpoint_;
+  PipelinedLinkOptions link_options_;
 
   SessionManager manager_;
 };
@@ -12,16 +12,16 @@ namespace services {
 namespace fibers_to_sockets {
 
 template <typename Demux>
-FibersToSockets<Demux>::FibersToSockets(boost::asio::io_service& io_service,
-                                        Demux& fiber_demux,
-                                        LocalPortType local_port,
-                                        const std::string& ip,
-                                        RemotePortType remote_port)
+FibersToSockets<Demux>::FibersToSockets(
+    boost::asio::io_service& io_service, Demux& fiber_demux,
+    LocalPortType local_port, const std::string& ip,
+    RemotePortType remote_port, const PipelinedLinkOptions& link_options)
     : ssf::BaseService<Demux>::BaseService(io_service, fiber_demux),
       remote_port_(remote_port),
       ip_(ip),
       local_port_(local_port),
-      fiber_acceptor_(io_service) {}
+      fiber_acceptor_(io_service),
+      link_options_(link_options) {}
 
 template <typename Demux>
 void FibersToSockets<Demux>::start(boost::system::error_code& ec) {
@@ -113,17 +113,28 @@ void FibersToSockets<Demux>::FiberAcceptHandler(
     this->AsyncAcceptFibers();
   }
 
+  auto p_reservation =
+      OutboundSocketReservation::acquire(this->get_demux().quotas());
+  if (!p_reservation) {
+    SSF_LOG("microservice", warn,
+            "[stream_forwarder]: outbound socket quota reached");
+    fiber_connection->close();
+    return;
+  }
+
   std::shared_ptr<Tcp::socket> socket =
       std::make_shared<Tcp::socket>(this->get_io_service());
   socket->async_connect(
       remote_endpoint_,
       std::bind(&FibersToSockets::TcpSocketConnectHandler, this->SelfFromThis(),
-                socket, fiber_connection, std::placeholders::_1));
+                socket, fiber_connection, p_reservation,
+                std::placeholders::_1));
 }
 
 template <typename Demux>
 void FibersToSockets<Demux>::TcpSocketConnectHandler(
     std::shared_ptr<Tcp::socket> socket, FiberPtr fiber_connection,
+    OutboundSocketReservationPtr p_reservation,
     const boost::system::error_code& ec) {
   if (ec) {
     SSF_LOG("microservice", error,
@@ -133,7 +144,8 @@ void FibersToSockets<Demux>::TcpSocketConnectHandler(
   }
 
   auto session = Session<Demux, Fiber, Tcp::socket>::create(
-      this->SelfFromThis(), std::move(*fiber_connection), std::move(*socket));
+      this->SelfFromThis(), std::move(*fiber_connection), std::move(*socket),
+      std::move(p_reservation), link_options_);
   boost::system::error_code start_ec;
   manager_.start(session, start_ec);
   if (start_ec) {
@@ -1,7 +1,6 @@
 #ifndef SSF_SERVICES_FIBERS_TO_SOCKETS_SESSION_H_
 #define SSF_SERVICES_FIBERS_TO_SOCKETS_SESSION_H_
 
-#include <array>
 #include <memory>
 
 #include <boost/system/error_code.hpp>
@@ -10,7 +9,10 @@
 
 #include <ssf/log/log.h>
 
+#include "common/boost/fiber/detail/fiber_quotas.hpp"
+
 #include "ssf/network/base_session.h"  // NOLINT
+#include "ssf/network/pipelined_link.h"
 #include "ssf/network/socket_link.h"
 
 namespace ssf {
@@ -20,13 +22,11 @@ namespace fibers_to_sockets {
 /// Create a Full Duplex Forwarding Link
 template <typename Demux, typename InwardStream, typename ForwardStream>
 class Session : public ssf::BaseSession {
- private:
-  /// Buffer type for the transiting data
-  using StreamBuf = std::array<char, 50 * 1024>;
-
  public:
   using Server = FibersToSockets<Demux>;
   using FibersToSocketsWPtr = std::weak_ptr<Server>;
+  using OutboundSocketReservationPtr =
+      boost::asio::fiber::detail::outbound_socket_reservation::pointer;
 
  public:
   using SessionPtr = std::shared_ptr<Session>;
@@ -78,10 +78,13 @@ class Session : public ssf::BaseSession {
  private:
   /// The constructor is made private to ensure users only use create()
   Session(FibersToSocketsWPtr server, InwardStream inbound,
-          ForwardStream outbound)
+          ForwardStream outbound, OutboundSocketReservationPtr p_reservation,
+          const PipelinedLinkOptions& link_options)
       : server_(server),
         inbound_(std::move(inbound)),
-        outbound_(std::move(outbound)) {}
+        outbound_(std::move(outbound)),
+        p_outbound_reservation_(std::move(p_reservation)),
+        link_options_(link_options) {}
 
   /// Start forwarding
   void DoForward() {
@@ -89,12 +92,15 @@ class Session : public ssf::BaseSession {
     auto stop_handler = [this, self](const boost::system::error_code& ec,
                                      std::size_t) { StopHandler(ec); };
 
-    // Make two Half Duplex links to have a Full Duplex Link
-    AsyncEstablishHDLink(ReadFrom(inbound_), WriteTo(outbound_),
-                         boost::asio::buffer(inwardBuffer_), stop_handler);
+    // Make two Half Duplex links to have a Full Duplex Link, only the writes
+    // to the outbound socket may be sent without a copy
+    AsyncEstablishPipelinedHDLink(ReadFrom(inbound_), WriteTo(outbound_),
+                                  link_options_, stop_handler);
 
-    AsyncEstablishHDLink(ReadFrom(outbound_), WriteTo(inbound_),
-                         boost::asio::buffer(forwardBuffer_), stop_handler);
+    PipelinedLinkOptions inward_options(link_options_);
+    inward_options.zero_copy = false;
+    AsyncEstablishPipelinedHDLink(ReadFrom(outbound_), WriteTo(inbound_),
+                                  inward_options, stop_handler);
   }
 
   /// Stop forwarding
@@ -112,9 +118,11 @@ class Session : public ssf::BaseSession {
   InwardStream inbound_;
   ForwardStream outbound_;
 
-  // One buffer for each Half Duplex Link
-  StreamBuf inwardBuffer_;
-  StreamBuf forwardBuffer_;
+  // Outbound socket counted in the demux quotas until the session ends
+  OutboundSocketReservationPtr p_outbound_reservation_;
+
+  // Buffers of the Half Duplex Links
+  PipelinedLinkOptions link_options_;
 };
 
 }  // fibers_to_sockets
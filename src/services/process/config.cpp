@@ -4,12 +4,19 @@ namespace ssf {
 namespace services {
 namespace process {
 
-Config::Config() : BaseServiceConfig(false), path_(""), args_("") {}
+Config::Config()
+    : BaseServiceConfig(false),
+      path_(""),
+      args_(""),
+      interactive_(true),
+      pool_size_(0) {}
 
 Config::Config(const Config& process_service)
     : BaseServiceConfig(process_service.enabled()),
       path_(process_service.path_),
-      args_(process_service.args_) {}
+      args_(process_service.args_),
+      interactive_(process_service.interactive_),
+      pool_size_(process_service.pool_size_) {}
 
 }  // process
 }  // services
@@ -1,6 +1,8 @@
 #ifndef SSF_SERVICES_PROCESS_CONFIG_H_
 #define SSF_SERVICES_PROCESS_CONFIG_H_
 
+#include <cstdint>
+
 #include <string>
 
 #include "services/base_service_config.h"
@@ -20,9 +22,20 @@ class Config : public BaseServiceConfig {
   inline std::string args() const { return args_; }
   inline void set_args(const std::string& args) { args_ = args; }
 
+  // Interactive sessions: high fiber priority, immediate input and
+  // output coalesced within a bounded delay
+  inline bool interactive() const { return interactive_; }
+  inline void set_interactive(bool interactive) { interactive_ = interactive; }
+
+  // Number of processes spawned ahead of the sessions (0: no pool)
+  inline uint32_t pool_size() const { return pool_size_; }
+  inline void set_pool_size(uint32_t pool_size) { pool_size_ = pool_size; }
+
  private:
   std::string path_;
   std::string args_;
+  bool interactive_;
+  uint32_t pool_size_;
 };
 
 }  // process
@@ -0,0 +1,429 @@
+#include "services/process/posix/process_pool.h"
+
+#include <fcntl.h>
+#include <pwd.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/ioctl.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <list>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include <ssf/log/log.h>
+
+#include "common/error/error.h"
+
+namespace ssf {
+namespace services {
+namespace process {
+namespace posix {
+
+namespace {
+
+// Delay before a terminated process is killed, then period of its reaping
+enum { kTermTimeoutMs = 2000, kReapPeriodMs = 100 };
+
+void ChdirHome(boost::system::error_code& ec) {
+  const char* home_dir = getenv("HOME");
+
+  if (home_dir == NULL) {
+    struct passwd* p_pw = getpwuid(getuid());
+    if (p_pw == NULL) {
+      fprintf(stderr, "Could not find passwd entry for current user\n");
+      ec.assign(::error::file_not_found, ::error::get_ssf_category());
+      return;
+    }
+
+    home_dir = p_pw->pw_dir;
+  }
+
+  if (chdir(home_dir) < 0) {
+    fprintf(stderr, "Could not chdir to user home <%s>\n", home_dir);
+    ec.assign(::error::file_not_found, ::error::get_ssf_category());
+    return;
+  }
+
+  // overwrite PWD env var after chdir
+  if (setenv("PWD", home_dir, 1) < 0) {
+    fprintf(stderr, "Could not set PWD env var <%s>\n", home_dir);
+  }
+}
+
+void GenerateArgv(const std::string& binary_name,
+                  const std::list<std::string>& split_args,
+                  std::vector<char*>& argv) {
+  if (split_args.size() > 0) {
+    argv.resize(split_args.size() + 2);
+    std::size_t i = 1;
+    for (auto& arg : split_args) {
+      argv[i] = const_cast<char*>(arg.c_str());
+      ++i;
+    }
+  } else {
+    argv.resize(2);
+  }
+
+  argv[0] = const_cast<char*>(binary_name.c_str());
+  argv[argv.size() - 1] = nullptr;
+}
+
+void InitMasterSlaveTty(int* p_master_tty, int* p_slave_tty,
+                        boost::system::error_code& ec) {
+  // open an available pseudo terminal device (master/slave pair)
+  *p_master_tty = posix_openpt(O_RDWR | O_NOCTTY);
+  if (*p_master_tty < 0) {
+    SSF_LOG("microservice", error, "[shell] session could not open master tty");
+    ec.assign(::error::broken_pipe, ::error::get_ssf_category());
+    return;
+  }
+
+  // the master side of pooled ptys must not leak into the other shells
+  fcntl(*p_master_tty, F_SETFD, FD_CLOEXEC);
+
+  // change permissions and owner of the slave side
+  if (grantpt(*p_master_tty) != 0) {
+    ec.assign(::error::broken_pipe, ::error::get_ssf_category());
+    return;
+  }
+
+  // unlock master/slave pair
+  if (unlockpt(*p_master_tty) != 0) {
+    ec.assign(::error::broken_pipe, ::error::get_ssf_category());
+    return;
+  }
+
+  // open slave side
+  *p_slave_tty = open(ptsname(*p_master_tty), O_RDWR | O_NOCTTY);
+  if (*p_slave_tty < 0) {
+    SSF_LOG("microservice", error, "[shell] session could not open slave tty");
+    ec.assign(::error::broken_pipe, ::error::get_ssf_category());
+    return;
+  }
+}
+
+// Reap a terminated process, killing it if SIGTERM was not enough
+void ReapKilledProcess(std::shared_ptr<boost::asio::steady_timer> p_timer,
+                       pid_t pid, bool sigkill_sent) {
+  p_timer->expires_from_now(
+      std::chrono::milliseconds(sigkill_sent ? kReapPeriodMs : kTermTimeoutMs));
+  p_timer->async_wait(
+      [p_timer, pid, sigkill_sent](const boost::system::error_code& ec) {
+        int status;
+        if (waitpid(pid, &status, WNOHANG) != 0 || ec) {
+          return;
+        }
+
+        if (!sigkill_sent) {
+          SSF_LOG("microservice", debug,
+                  "[shell] process {} still running after SIGTERM, kill it",
+                  pid);
+          kill(pid, SIGKILL);
+        }
+        ReapKilledProcess(p_timer, pid, true);
+      });
+}
+
+// Key of the pool registry: binary path and arguments
+using PoolKey = std::pair<std::string, std::string>;
+
+std::mutex& GetPoolsMutex() {
+  static std::mutex pools_mutex;
+  return pools_mutex;
+}
+
+std::map<PoolKey, std::weak_ptr<ProcessPool>>& GetPools() {
+  static std::map<PoolKey, std::weak_ptr<ProcessPool>> pools;
+  return pools;
+}
+
+}  // unnamed namespace
+
+PtyProcess SpawnPtyProcess(const std::string& binary_path,
+                           const std::string& binary_args,
+                           boost::system::error_code& ec) {
+  PtyProcess process;
+  int master_tty = kInvalidTtyDescriptor;
+  int slave_tty = kInvalidTtyDescriptor;
+
+  InitMasterSlaveTty(&master_tty, &slave_tty, ec);
+  if (ec) {
+    SSF_LOG("microservice", error, "[shell] session init tty failed");
+    close(master_tty);
+    close(slave_tty);
+    return process;
+  }
+
+  pid_t child_pid = fork();
+  if (child_pid < 0) {
+    SSF_LOG("microservice", error, "[shell] session fork failed");
+    close(master_tty);
+    close(slave_tty);
+    ec.assign(::error::process_not_created, ::error::get_ssf_category());
+    return process;
+  }
+
+  if (child_pid == 0) {
+    // child
+    boost::system::error_code ec;
+    struct termios new_term_settings;
+    close(master_tty);
+
+    tcgetattr(slave_tty, &new_term_settings);
+    // IGNCR: ignore  carriage return on input
+    new_term_settings.c_iflag |= (IGNCR);
+    tcsetattr(slave_tty, TCSANOW, &new_term_settings);
+
+    // new process as session leader
+    setsid();
+
+    // slave side as controlling terminal
+    ioctl(slave_tty, TIOCSCTTY, 1);
+
+    close(STDOUT_FILENO);
+    close(STDERR_FILENO);
+    close(STDIN_FILENO);
+
+    // set slave_tty as process I/O
+    while ((dup2(slave_tty, STDOUT_FILENO) == -1) && (errno == EINTR)) {
+    }
+    while ((dup2(slave_tty, STDERR_FILENO) == -1) && (errno == EINTR)) {
+    }
+    while ((dup2(slave_tty, STDIN_FILENO) == -1) && (errno == EINTR)) {
+    }
+
+    // dup2 done, close descriptor
+    close(slave_tty);
+
+    // Change dir to user home
+    ChdirHome(ec);
+
+    std::size_t slash_pos = binary_path.rfind('/');
+    std::string binary_name = std::string::npos != slash_pos
+                                  ? binary_path.substr(slash_pos + 1)
+                                  : binary_path;
+
+    // Generate argv array
+    std::vector<char*> argv;
+    std::list<std::string> split_args;
+    if (!binary_args.empty()) {
+      boost::split(split_args, binary_args, boost::algorithm::is_any_of(" "));
+    }
+    GenerateArgv(binary_name, split_args, argv);
+
+    execv(binary_path.c_str(), argv.data());
+
+    fprintf(stderr, "Exiting: fail to exec <%s>\n", binary_path.c_str());
+    exit(1);
+  }
+
+  // parent
+  close(slave_tty);
+  process.pid = child_pid;
+  process.master_tty = master_tty;
+
+  return process;
+}
+
+void KillPtyProcess(boost::asio::io_service& io_service,
+                    PtyProcess* p_process) {
+  if (p_process->master_tty != kInvalidTtyDescriptor) {
+    close(p_process->master_tty);
+    p_process->master_tty = kInvalidTtyDescriptor;
+  }
+
+  if (p_process->pid > 0) {
+    int status;
+    kill(p_process->pid, SIGTERM);
+    if (waitpid(p_process->pid, &status, WNOHANG) == 0) {
+      ReapKilledProcess(std::make_shared<boost::asio::steady_timer>(io_service),
+                        p_process->pid, false);
+    }
+    p_process->pid = kInvalidProcessId;
+  }
+}
+
+ProcessPool::ProcessPoolPtr ProcessPool::Get(
+    boost::asio::io_service& io_service, const std::string& binary_path,
+    const std::string& binary_args, uint32_t size) {
+  ProcessPoolPtr p_pool;
+  {
+    std::unique_lock<std::mutex> lock(GetPoolsMutex());
+    auto& pools = GetPools();
+    auto key = std::make_pair(binary_path, binary_args);
+    p_pool = pools[key].lock();
+    if (!p_pool) {
+      p_pool.reset(
+          new ProcessPool(io_service, binary_path, binary_args, size));
+      pools[key] = p_pool;
+      p_pool->StartReaping();
+    }
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(p_pool->mutex_);
+    p_pool->size_ = std::max(p_pool->size_, size);
+  }
+  p_pool->AsyncRefill();
+
+  return p_pool;
+}
+
+ProcessPool::ProcessPool(boost::asio::io_service& io_service,
+                         const std::string& binary_path,
+                         const std::string& binary_args, uint32_t size)
+    : io_service_(io_service),
+      binary_path_(binary_path),
+      binary_args_(binary_args),
+      size_(size),
+      mutex_(),
+      processes_(),
+      refilling_(false),
+      stopped_(false),
+      sigchld_(io_service) {}
+
+ProcessPool::~ProcessPool() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  stopped_ = true;
+  for (auto& process : processes_) {
+    KillPtyProcess(io_service_, &process);
+  }
+  processes_.clear();
+
+  std::unique_lock<std::mutex> pools_lock(GetPoolsMutex());
+  auto& pools = GetPools();
+  auto pool_it = pools.find(std::make_pair(binary_path_, binary_args_));
+  if (pool_it != pools.end() && pool_it->second.expired()) {
+    pools.erase(pool_it);
+  }
+}
+
+bool ProcessPool::Take(PtyProcess* p_process) {
+  bool taken = false;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!taken && !processes_.empty()) {
+      *p_process = processes_.front();
+      processes_.pop_front();
+
+      // an idle process may have exited (e.g. killed by an administrator)
+      int status;
+      if (waitpid(p_process->pid, &status, WNOHANG) == 0) {
+        taken = true;
+      } else {
+        close(p_process->master_tty);
+      }
+    }
+  }
+
+  AsyncRefill();
+
+  return taken;
+}
+
+std::vector<pid_t> ProcessPool::IdleProcesses() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  std::vector<pid_t> pids;
+  for (const auto& process : processes_) {
+    pids.push_back(process.pid);
+  }
+  return pids;
+}
+
+void ProcessPool::AsyncRefill() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (refilling_ || stopped_ || processes_.size() >= size_) {
+      return;
+    }
+    refilling_ = true;
+  }
+
+  // the pool does not stay alive for its refill
+  std::weak_ptr<ProcessPool> weak_self(shared_from_this());
+  io_service_.post([weak_self]() {
+    if (auto self = weak_self.lock()) {
+      self->Refill();
+    }
+  });
+}
+
+void ProcessPool::Refill() {
+  boost::system::error_code ec;
+  auto process = SpawnPtyProcess(binary_path_, binary_args_, ec);
+
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    refilling_ = false;
+    if (ec) {
+      SSF_LOG("microservice", warn, "[shell] pool refill failed ({})",
+              ec.message());
+      return;
+    }
+    processes_.push_back(process);
+  }
+
+  SSF_LOG("microservice", trace, "[shell] process {} added to pool",
+          process.pid);
+  AsyncRefill();
+}
+
+void ProcessPool::StartReaping() {
+  boost::system::error_code ec;
+  sigchld_.add(SIGCHLD, ec);
+  if (ec) {
+    SSF_LOG("microservice", warn,
+            "[shell] pool could not wait for SIGCHLD ({}), exited idle "
+            "processes are skipped on take",
+            ec.message());
+    return;
+  }
+
+  AsyncWaitSigchld();
+}
+
+void ProcessPool::AsyncWaitSigchld() {
+  std::weak_ptr<ProcessPool> weak_self(shared_from_this());
+  sigchld_.async_wait([weak_self](const boost::system::error_code& ec, int) {
+    if (ec) {
+      return;
+    }
+    if (auto self = weak_self.lock()) {
+      self->ReapIdleProcesses();
+      self->AsyncWaitSigchld();
+    }
+  });
+}
+
+void ProcessPool::ReapIdleProcesses() {
+  // the pool is refilled on the next take: a binary exiting at once does not
+  // make the pool respawn it in a loop
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto process_it = processes_.begin();
+  while (process_it != processes_.end()) {
+    int status;
+    if (waitpid(process_it->pid, &status, WNOHANG) == 0) {
+      ++process_it;
+      continue;
+    }
+
+    SSF_LOG("microservice", debug, "[shell] idle process {} exited",
+            process_it->pid);
+    close(process_it->master_tty);
+    process_it = processes_.erase(process_it);
+  }
+}
+
+}  // posix
+}  // process
+}  // services
+}  // ssf
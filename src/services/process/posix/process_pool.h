@@ -0,0 +1,105 @@
+#ifndef SSF_SERVICES_PROCESS_POSIX_PROCESS_POOL_H_
+#define SSF_SERVICES_PROCESS_POSIX_PROCESS_POOL_H_
+
+#include <sys/types.h>
+
+#include <cstdint>
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/signal_set.hpp>
+#include <boost/system/error_code.hpp>
+
+namespace ssf {
+namespace services {
+namespace process {
+namespace posix {
+
+enum { kInvalidProcessId = -1, kInvalidTtyDescriptor = -1 };
+
+// Process running a binary on the slave side of a pseudo terminal
+struct PtyProcess {
+  PtyProcess() : pid(kInvalidProcessId), master_tty(kInvalidTtyDescriptor) {}
+
+  pid_t pid;
+  int master_tty;
+};
+
+// Fork and exec binary_path (in the user home directory) on a new pty
+PtyProcess SpawnPtyProcess(const std::string& binary_path,
+                           const std::string& binary_args,
+                           boost::system::error_code& ec);
+
+// Terminate the process and close its pty
+//   The process is reaped on the io_service without blocking, and killed if
+//   it is still running a few seconds after SIGTERM.
+void KillPtyProcess(boost::asio::io_service& io_service,
+                    PtyProcess* p_process);
+
+// Warm pool of processes spawned ahead of the shell sessions
+//   Sessions take a running process at once, the pool is refilled in the
+//   background on the io_service. Pools are shared by the shell servers
+//   running the same binary and arguments. Idle processes which exit are
+//   reaped on SIGCHLD.
+class ProcessPool : public std::enable_shared_from_this<ProcessPool> {
+ public:
+  using ProcessPoolPtr = std::shared_ptr<ProcessPool>;
+
+ public:
+  // Return the pool of binary_path/binary_args, created and filled if needed
+  static ProcessPoolPtr Get(boost::asio::io_service& io_service,
+                            const std::string& binary_path,
+                            const std::string& binary_args, uint32_t size);
+
+  ~ProcessPool();
+
+  // Take a spawned process, false if the pool is empty
+  bool Take(PtyProcess* p_process);
+
+  // Return the pids of the idle processes
+  std::vector<pid_t> IdleProcesses();
+
+ private:
+  ProcessPool(boost::asio::io_service& io_service,
+              const std::string& binary_path, const std::string& binary_args,
+              uint32_t size);
+
+  // Spawn one process and schedule the next one until the pool is full
+  void AsyncRefill();
+
+  void Refill();
+
+  void StartReaping();
+
+  void AsyncWaitSigchld();
+
+  // Remove the idle processes which exited
+  void ReapIdleProcesses();
+
+ private:
+  boost::asio::io_service& io_service_;
+  std::string binary_path_;
+  std::string binary_args_;
+  uint32_t size_;
+
+  std::mutex mutex_;
+  std::deque<PtyProcess> processes_;
+  bool refilling_;
+  bool stopped_;
+
+  boost::asio::signal_set sigchld_;
+};
+
+using ProcessPoolPtr = ProcessPool::ProcessPoolPtr;
+
+}  // posix
+}  // process
+}  // services
+}  // ssf
+
+#endif  // SSF_SERVICES_PROCESS_POSIX_PROCESS_POOL_H_
@@ -4,13 +4,17 @@
 #include <sys/types.h>
 
 #include <array>
+#include <chrono>
 #include <memory>
+#include <mutex>
 
 #include <boost/system/error_code.hpp>
 #include <boost/asio.hpp>
 #include <boost/asio/posix/stream_descriptor.hpp>
 #include <boost/asio/signal_set.hpp>
+#include <boost/asio/steady_timer.hpp>
 
+#include <ssf/io/handler_memory.h>
 #include <ssf/network/base_session.h>
 #include <ssf/network/socket_link.h>
 #include <ssf/network/manager.h>
@@ -18,6 +22,8 @@
 
 #include "common/boost/fiber/stream_fiber.hpp"
 
+#include "services/process/posix/process_pool.h"
+
 namespace ssf {
 namespace services {
 namespace process {
@@ -34,12 +40,17 @@ class Session : public ssf::BaseSession {
   using Fiber = typename boost::asio::fiber::stream_fiber<
       typename Demux::socket_type>::socket;
   using ShellServer = Server<Demux>;
+  using Clock = std::chrono::steady_clock;
 
-  enum { kInvalidProcessId = -1, kInvalidTtyDescriptor = -1 };
+  // Interactive output is sent at once when this much is buffered...
+  enum { kOutputFlushSize = 16 * 1024 };
+  // ...or when its first byte waited for this long
+  static constexpr std::chrono::microseconds kOutputCoalesceDelay{500};
 
  public:
   Session(std::weak_ptr<ShellServer> server, Fiber client,
-          const std::string& binary_path, const std::string& binary_args);
+          const std::string& binary_path, const std::string& binary_args,
+          bool interactive, ProcessPoolPtr p_pool);
 
   ~Session();
 
@@ -51,16 +62,31 @@ class Session : public ssf::BaseSession {
  private:
   std::shared_ptr<Session> SelfFromThis();
 
-  static void ChdirHome(boost::system::error_code& ec);
+  void StartForwarding(boost::system::error_code& ec);
 
-  static void GenerateArgv(const std::string& binary_name,
-                           const std::list<std::string>& splitted_argv,
-                           std::vector<char*>& argv);
+  // Interactive forwarding: input written to the pty as soon as received,
+  // pty output accumulated while a write is in flight or a burst is running
+  // and sent in large frames
+  void StartInteractiveForwarding(boost::system::error_code& ec);
 
-  void InitMasterSlaveTty(int* p_master, int* p_slave,
-                          boost::system::error_code& ec);
+  void AsyncReadInput();
 
-  void StartForwarding(boost::system::error_code& ec);
+  void OnInputRead(const boost::system::error_code& ec, std::size_t length);
+
+  void AsyncReadOutput();
+
+  // The read targets output_buffers_[buffer_index] at offset, a flush may
+  // have swapped the buffers since it started
+  void OnOutputRead(std::size_t buffer_index, std::size_t offset,
+                    const boost::system::error_code& ec, std::size_t length);
+
+  // Send the buffered output now or arm the coalescing timer (output_mutex_
+  // held)
+  void ScheduleOutputFlush();
+
+  void FlushOutput();
+
+  void OnOutputWritten(const boost::system::error_code& ec);
 
   void StopHandler(const boost::system::error_code& ec);
 
@@ -78,14 +104,35 @@ class Session : public ssf::BaseSession {
   std::string binary_path_;
   std::string binary_args_;
 
-  pid_t child_pid_;
+  // Warm processes, null if the pool is disabled
+  ProcessPoolPtr p_pool_;
 
-  int master_tty_;
+  pid_t child_pid_;
 
   boost::asio::posix::stream_descriptor sd_;
 
   StreamBuf upstream_;
   StreamBuf downstream_;
+
+  io::HandlerMemory upstream_memory_;
+  io::HandlerMemory downstream_memory_;
+
+  bool interactive_;
+
+  // Interactive output: one buffer filled from the pty while the other one
+  // is written to the fiber
+  std::recursive_mutex output_mutex_;
+  std::array<StreamBuf, 2> output_buffers_;
+  std::size_t filling_buffer_;
+  std::size_t output_size_;
+  bool reading_output_;
+  bool writing_output_;
+  bool flush_timer_armed_;
+  Clock::time_point output_since_;
+  Clock::time_point last_flush_;
+  boost::system::error_code output_ec_;
+  boost::asio::steady_timer flush_timer_;
+  io::HandlerMemory output_write_memory_;
 };
 
 }  // posix
@@ -1,23 +1,19 @@
 #ifndef SSF_SERVICES_PROCESS_POSIX_SESSION_IPP_
 #define SSF_SERVICES_PROCESS_POSIX_SESSION_IPP_
 
-#include <fcntl.h>
-#include <pwd.h>
+#include <cstring>
+
 #include <signal.h>
 #include <sys/wait.h>
-#include <sys/ioctl.h>
-#include <stdlib.h>
-#include <termios.h>
 #include <unistd.h>
 
-#include <vector>
-
-#include <boost/algorithm/string.hpp>
+#include <boost/asio/write.hpp>
 
 #include <ssf/log/log.h>
 #include <ssf/network/session_forwarder.h>
 #include <ssf/network/socket_link.h>
 
+#include "common/boost/fiber/fiber_priority.hpp"
 #include "common/error/error.h"
 
 namespace ssf {
@@ -25,10 +21,14 @@ namespace services {
 namespace process {
 namespace posix {
 
+template <typename Demux>
+constexpr std::chrono::microseconds Session<Demux>::kOutputCoalesceDelay;
+
 template <typename Demux>
 Session<Demux>::Session(std::weak_ptr<ShellServer> server, Fiber client,
                         const std::string& binary_path,
-                        const std::string& binary_args)
+                        const std::string& binary_args, bool interactive,
+                        ProcessPoolPtr p_pool)
     : ssf::BaseSession(),
       io_service_(client.get_io_service()),
       p_server_(server),
@@ -36,8 +36,20 @@ Session<Demux>::Session(std::weak_ptr<ShellServer> server, Fiber client,
       signal_(io_service_),
       binary_path_(binary_path),
       binary_args_(binary_args),
+      p_pool_(p_pool),
       child_pid_(kInvalidProcessId),
-      sd_(io_service_) {}
+      sd_(io_service_),
+      interactive_(interactive),
+      output_mutex_(),
+      filling_buffer_(0),
+      output_size_(0),
+      reading_output_(false),
+      writing_output_(false),
+      flush_timer_armed_(false),
+      output_since_(),
+      last_flush_(),
+      output_ec_(),
+      flush_timer_(io_service_) {}
 
 template <typename Demux>
 Session<Demux>::~Session() {
@@ -47,96 +59,27 @@ Session<Demux>::~Session() {
 template <typename Demux>
 void Session<Demux>::start(boost::system::error_code& ec) {
   SSF_LOG("microservice", debug, "[shell] session start");
-  int master_tty;
-  int slave_tty;
-
-  InitMasterSlaveTty(&master_tty, &slave_tty, ec);
-
-  if (ec) {
-    SSF_LOG("microservice", error, "[shell] session init tty failed");
-    close(master_tty);
-    close(slave_tty);
-    stop(ec);
-    return;
-  }
 
   signal_.add(SIGCHLD, ec);
   if (ec) {
     SSF_LOG("microservice", error, "[shell] session init signal handler on SIGCHLD failed");
-    close(master_tty);
-    close(slave_tty);
-    stop(ec);
-    return;
-  }
-
-  child_pid_ = fork();
-  if (child_pid_ < 0) {
-    SSF_LOG("microservice", error, "[shell] session fork failed");
-    close(master_tty);
-    close(slave_tty);
-    ec.assign(::error::process_not_created, ::error::get_ssf_category());
     stop(ec);
     return;
   }
 
-  if (child_pid_ == 0) {
-    // child
-    boost::system::error_code ec;
-    struct termios new_term_settings;
-    close(master_tty);
-
-    tcgetattr(slave_tty, &new_term_settings);
-    // IGNCR: ignore  carriage return on input
-    new_term_settings.c_iflag |= (IGNCR);
-    tcsetattr(slave_tty, TCSANOW, &new_term_settings);
-
-    // new process as session leader
-    setsid();
-
-    // slave side as controlling terminal
-    ioctl(slave_tty, TIOCSCTTY, 1);
-
-    close(STDOUT_FILENO);
-    close(STDERR_FILENO);
-    close(STDIN_FILENO);
-
-    // set slave_tty as process I/O
-    while ((dup2(slave_tty, STDOUT_FILENO) == -1) && (errno == EINTR)) {
-    }
-    while ((dup2(slave_tty, STDERR_FILENO) == -1) && (errno == EINTR)) {
-    }
-    while ((dup2(slave_tty, STDIN_FILENO) == -1) && (errno == EINTR)) {
-    }
-
-    // dup2 done, close descriptor
-    close(slave_tty);
-
-    // Change dir to user home
-    ChdirHome(ec);
-
-    std::size_t slash_pos = binary_path_.rfind('/');
-    std::string binary_name = std::string::npos != slash_pos
-                                  ? binary_path_.substr(slash_pos + 1)
-                                  : binary_path_;
-
-    // Generate argv array
-    std::vector<char*> argv;
-    std::list<std::string> split_args;
-    if (!binary_args_.empty()) {
-      boost::split(split_args, binary_args_, boost::algorithm::is_any_of(" "));
+  PtyProcess process;
+  if (!p_pool_ || !p_pool_->Take(&process)) {
+    process = SpawnPtyProcess(binary_path_, binary_args_, ec);
+    if (ec) {
+      stop(ec);
+      return;
     }
-    GenerateArgv(binary_name, split_args, argv);
-
-    execv(binary_path_.c_str(), argv.data());
-
-    fprintf(stderr, "Exiting: fail to exec <%s>\n", binary_path_.c_str());
-    exit(1);
   }
 
-  // parent
-  close(slave_tty);
-  sd_.assign(master_tty, ec);
+  child_pid_ = process.pid;
+  sd_.assign(process.master_tty, ec);
   if (ec) {
+    close(process.master_tty);
     stop(ec);
     return;
   }
@@ -158,11 +101,13 @@ void Session<Demux>::stop(boost::system::error_code& ec) {
   sd_.cancel(ec);
   sd_.close(ec);
 
-  if (child_pid_ > 0) {
-    int status;
+  flush_timer_.cancel(ec);
 
-    kill(child_pid_, SIGTERM);
-    waitpid(child_pid_, &status, 0);
+  if (child_pid_ > 0) {
+    // the pty was closed with sd_, the process is reaped in the background
+    PtyProcess process;
+    process.pid = child_pid_;
+    KillPtyProcess(io_service_, &process);
     child_pid_ = kInvalidProcessId;
   }
   
@@ -219,100 +164,248 @@ void Session<Demux>::SigchldHandler(const boost::system::error_code& ec,
 }
 
 template <typename Demux>
-void Session<Demux>::ChdirHome(boost::system::error_code& ec) {
-  const char* home_dir = getenv("HOME");
-
-  if (home_dir == NULL) {
-    struct passwd* p_pw = getpwuid(getuid());
-    if (p_pw == NULL) {
-      fprintf(stderr, "Could not find passwd entry for current user\n");
-      ec.assign(::error::file_not_found, ::error::get_ssf_category());
-      return;
-    }
+void Session<Demux>::StartForwarding(boost::system::error_code& ec) {
+  if (ec) {
+    SSF_LOG("microservice", error, "[shell] session could not initialize stream handle");
+    return;
+  }
 
-    home_dir = p_pw->pw_dir;
+  if (interactive_) {
+    StartInteractiveForwarding(ec);
+    return;
   }
 
-  if (chdir(home_dir) < 0) {
-    fprintf(stderr, "Could not chdir to user home <%s>\n", home_dir);
-    ec.assign(::error::file_not_found, ::error::get_ssf_category());
+  // pipe process stdout/stderr to socket output
+  AsyncEstablishHDLink(ReadFrom(sd_), WriteTo(client_),
+                       boost::asio::buffer(downstream_), downstream_memory_,
+                       std::bind(&Session::StopHandler, this->SelfFromThis(),
+                                 std::placeholders::_1));
+  // pipe socket input to process stdin
+  AsyncEstablishHDLink(ReadFrom(client_), WriteTo(sd_),
+                       boost::asio::buffer(upstream_), upstream_memory_,
+                       std::bind(&Session::StopHandler, this->SelfFromThis(),
+                                 std::placeholders::_1));
+}
+
+template <typename Demux>
+void Session<Demux>::StartInteractiveForwarding(boost::system::error_code& ec) {
+  // keystrokes and echo go before bulk transfers on the demux
+  client_.set_option(
+      boost::asio::fiber::priority(boost::asio::fiber::priority::high), ec);
+  if (ec) {
     return;
   }
 
-  // overwrite PWD env var after chdir
-  if (setenv("PWD", home_dir, 1) < 0) {
-    fprintf(stderr, "Could not set PWD env var <%s>\n", home_dir);
+  // the input fast path writes to the pty without waiting for the reactor
+  sd_.non_blocking(true, ec);
+  if (ec) {
+    return;
   }
+
+  last_flush_ = Clock::now() - kOutputCoalesceDelay;
+
+  AsyncReadInput();
+
+  std::unique_lock<std::recursive_mutex> lock(output_mutex_);
+  AsyncReadOutput();
 }
 
 template <typename Demux>
-void Session<Demux>::GenerateArgv(const std::string& binary_name,
-                                  const std::list<std::string>& split_args,
-                                  std::vector<char*>& argv) {
-  if (split_args.size() > 0) {
-    argv.resize(split_args.size() + 2);
-    std::size_t i = 1;
-    for (auto& arg : split_args) {
-      argv[i] = const_cast<char*>(arg.c_str());
-      ++i;
-    }
-  } else {
-    argv.resize(2);
+void Session<Demux>::AsyncReadInput() {
+  auto self = this->SelfFromThis();
+  client_.async_read_some(
+      boost::asio::buffer(upstream_),
+      io::MakeMemoryHandler(
+          upstream_memory_,
+          [this, self](const boost::system::error_code& ec,
+                       std::size_t length) { OnInputRead(ec, length); }));
+}
+
+template <typename Demux>
+void Session<Demux>::OnInputRead(const boost::system::error_code& ec,
+                                 std::size_t length) {
+  if (ec) {
+    StopHandler(ec);
+    return;
+  }
+
+  // the pty accepts a few typed bytes at once almost every time
+  boost::system::error_code write_ec;
+  std::size_t written =
+      sd_.write_some(boost::asio::buffer(upstream_.data(), length), write_ec);
+  if (write_ec == boost::asio::error::would_block ||
+      write_ec == boost::asio::error::try_again) {
+    written = 0;
+    write_ec.clear();
+  }
+  if (write_ec) {
+    StopHandler(write_ec);
+    return;
+  }
+
+  if (written == length) {
+    AsyncReadInput();
+    return;
   }
 
-  argv[0] = const_cast<char*>(binary_name.c_str());
-  argv[argv.size() - 1] = nullptr;
+  auto self = this->SelfFromThis();
+  boost::asio::async_write(
+      sd_, boost::asio::buffer(upstream_.data() + written, length - written),
+      io::MakeMemoryHandler(upstream_memory_,
+                            [this, self](const boost::system::error_code& ec,
+                                         std::size_t) {
+                              if (ec) {
+                                StopHandler(ec);
+                                return;
+                              }
+                              AsyncReadInput();
+                            }));
 }
 
 template <typename Demux>
-void Session<Demux>::InitMasterSlaveTty(int* p_master_tty, int* p_slave_tty,
-                                        boost::system::error_code& ec) {
-  // open an available pseudo terminal device (master/slave pair)
-  *p_master_tty = posix_openpt(O_RDWR | O_NOCTTY);
-  if (*p_master_tty < 0) {
-    SSF_LOG("microservice", error, "[shell] session could not open master tty");
-    ec.assign(::error::broken_pipe, ::error::get_ssf_category());
+void Session<Demux>::AsyncReadOutput() {
+  // reading pauses when the filling buffer is full, until the next flush
+  if (reading_output_ || output_ec_ || output_size_ == sizeof(StreamBuf)) {
+    return;
+  }
+
+  reading_output_ = true;
+  auto buffer_index = filling_buffer_;
+  auto offset = output_size_;
+  auto& buffer = output_buffers_[buffer_index];
+  auto self = this->SelfFromThis();
+  sd_.async_read_some(
+      boost::asio::buffer(buffer.data() + offset, buffer.size() - offset),
+      io::MakeMemoryHandler(
+          downstream_memory_,
+          [this, self, buffer_index, offset](
+              const boost::system::error_code& ec, std::size_t length) {
+            OnOutputRead(buffer_index, offset, ec, length);
+          }));
+}
+
+template <typename Demux>
+void Session<Demux>::OnOutputRead(std::size_t buffer_index,
+                                  std::size_t offset,
+                                  const boost::system::error_code& ec,
+                                  std::size_t length) {
+  std::unique_lock<std::recursive_mutex> lock(output_mutex_);
+  reading_output_ = false;
+
+  if (length > 0 && buffer_index != filling_buffer_) {
+    // The buffer was flushed during the read: only its first offset bytes
+    // are being written, move the bytes read to the new filling buffer
+    // (empty, since no other read could fill it)
+    std::memcpy(output_buffers_[filling_buffer_].data() + output_size_,
+                output_buffers_[buffer_index].data() + offset, length);
+  }
+
+  if (length > 0) {
+    if (output_size_ == 0) {
+      output_since_ = Clock::now();
+    }
+    output_size_ += length;
+  }
+
+  if (ec) {
+    // the process output is over, send what is left before stopping
+    output_ec_ = ec;
+    if (!writing_output_ && output_size_ == 0) {
+      lock.unlock();
+      StopHandler(ec);
+      return;
+    }
+    if (!writing_output_) {
+      FlushOutput();
+    }
     return;
   }
 
-  // change permissions and owner of the slave side
-  if (grantpt(*p_master_tty) != 0) {
-    ec.assign(::error::broken_pipe, ::error::get_ssf_category());
+  ScheduleOutputFlush();
+  AsyncReadOutput();
+}
+
+template <typename Demux>
+void Session<Demux>::ScheduleOutputFlush() {
+  if (writing_output_ || output_size_ == 0) {
+    // the end of the current write schedules the next one
     return;
   }
 
-  // unlock master/slave pair
-  if (unlockpt(*p_master_tty) != 0) {
-    ec.assign(::error::broken_pipe, ::error::get_ssf_category());
+  auto now = Clock::now();
+  // Output after a quiet period (e.g. echo of a keystroke) is sent at once,
+  // a burst is coalesced for at most kOutputCoalesceDelay
+  if (output_size_ >= kOutputFlushSize ||
+      now - last_flush_ >= kOutputCoalesceDelay ||
+      now - output_since_ >= kOutputCoalesceDelay) {
+    FlushOutput();
     return;
   }
 
-  // open slave side
-  *p_slave_tty = open(ptsname(*p_master_tty), O_RDWR | O_NOCTTY);
-  if (*p_slave_tty < 0) {
-    SSF_LOG("microservice", error, "[shell] session could not open slave tty");
-    ec.assign(::error::broken_pipe, ::error::get_ssf_category());
+  if (flush_timer_armed_) {
     return;
   }
+
+  flush_timer_armed_ = true;
+  flush_timer_.expires_at(output_since_ + kOutputCoalesceDelay);
+  auto self = this->SelfFromThis();
+  flush_timer_.async_wait([this, self](const boost::system::error_code& ec) {
+    std::unique_lock<std::recursive_mutex> lock(output_mutex_);
+    flush_timer_armed_ = false;
+    if (ec) {
+      return;
+    }
+    ScheduleOutputFlush();
+  });
 }
 
 template <typename Demux>
-void Session<Demux>::StartForwarding(boost::system::error_code& ec) {
+void Session<Demux>::FlushOutput() {
+  auto& buffer = output_buffers_[filling_buffer_];
+  auto size = output_size_;
+
+  writing_output_ = true;
+  filling_buffer_ = 1 - filling_buffer_;
+  output_size_ = 0;
+  last_flush_ = Clock::now();
+
+  auto self = this->SelfFromThis();
+  boost::asio::async_write(
+      client_, boost::asio::buffer(buffer.data(), size),
+      io::MakeMemoryHandler(
+          output_write_memory_,
+          [this, self](const boost::system::error_code& ec, std::size_t) {
+            OnOutputWritten(ec);
+          }));
+
+  // resume reading if the previous buffer was full
+  AsyncReadOutput();
+}
+
+template <typename Demux>
+void Session<Demux>::OnOutputWritten(const boost::system::error_code& ec) {
+  std::unique_lock<std::recursive_mutex> lock(output_mutex_);
+  writing_output_ = false;
+
   if (ec) {
-    SSF_LOG("microservice", error, "[shell] session could not initialize stream handle");
+    lock.unlock();
+    StopHandler(ec);
     return;
   }
 
-  // pipe process stdout/stderr to socket output
-  AsyncEstablishHDLink(ReadFrom(sd_), WriteTo(client_),
-                       boost::asio::buffer(downstream_),
-                       std::bind(&Session::StopHandler, this->SelfFromThis(),
-                                 std::placeholders::_1));
-  // pipe socket input to process stdin
-  AsyncEstablishHDLink(ReadFrom(client_), WriteTo(sd_),
-                       boost::asio::buffer(upstream_),
-                       std::bind(&Session::StopHandler, this->SelfFromThis(),
-                                 std::placeholders::_1));
+  if (output_ec_) {
+    if (output_size_ > 0) {
+      FlushOutput();
+      return;
+    }
+    auto output_ec = output_ec_;
+    lock.unlock();
+    StopHandler(output_ec);
+    return;
+  }
+
+  ScheduleOutputFlush();
+  AsyncReadOutput();
 }
 
 }  // posix
@@ -66,7 +66,8 @@ class Server : public BaseService<Demux> {
   static ServerPtr Create(boost::asio::io_service& io_service,
                           Demux& fiber_demux, const Parameters& parameters,
                           const std::string& binary_path,
-                          const std::string& binary_args) {
+                          const std::string& binary_args, bool interactive,
+                          uint32_t pool_size) {
     if (!parameters.count("local_port") || binary_path.empty()) {
       return ServerPtr(nullptr);
     }
@@ -80,7 +81,8 @@ class Server : public BaseService<Demux> {
     }
 
     return ServerPtr(new Server(io_service, fiber_demux, local_port,
-                                binary_path, binary_args));
+                                binary_path, binary_args, interactive,
+                                pool_size));
   }
 
   // Function used to register the micro service to the given factory
@@ -93,11 +95,13 @@ class Server : public BaseService<Demux> {
 
     auto bin_path = config.path();
     auto bin_args = config.args();
-    auto creator = [bin_path, bin_args](boost::asio::io_service& io_service,
-                                        Demux& fiber_demux,
-                                        const Parameters& parameters) {
+    auto interactive = config.interactive();
+    auto pool_size = config.pool_size();
+    auto creator = [bin_path, bin_args, interactive, pool_size](
+        boost::asio::io_service& io_service, Demux& fiber_demux,
+        const Parameters& parameters) {
       return Server::Create(io_service, fiber_demux, parameters, bin_path,
-                            bin_args);
+                            bin_args, interactive, pool_size);
     };
     p_factory->RegisterServiceCreator(kFactoryId, creator);
   }
@@ -127,7 +131,8 @@ class Server : public BaseService<Demux> {
  private:
   Server(boost::asio::io_service& io_service, Demux& fiber_demux,
          const LocalPortType& port, const std::string& binary_path,
-         const std::string& binary_args);
+         const std::string& binary_args, bool interactive,
+         uint32_t pool_size);
 
  private:
   void AsyncAcceptFiber();
@@ -150,6 +155,11 @@ class Server : public BaseService<Demux> {
   LocalPortType local_port_;
   std::string binary_path_;
   std::string binary_args_;
+  bool interactive_;
+  uint32_t pool_size_;
+#if !defined(BOOST_ASIO_WINDOWS)
+  posix::ProcessPoolPtr p_pool_;
+#endif  // !defined(BOOST_ASIO_WINDOWS)
 };
 
 }  // process
@@ -16,13 +16,16 @@ namespace process {
 template <typename Demux>
 Server<Demux>::Server(boost::asio::io_service& io_service, Demux& fiber_demux,
                       const LocalPortType& port, const std::string& binary_path,
-                      const std::string& binary_args)
+                      const std::string& binary_args, bool interactive,
+                      uint32_t pool_size)
     : ssf::BaseService<Demux>::BaseService(io_service, fiber_demux),
       fiber_acceptor_(io_service),
       session_manager_(),
       local_port_(port),
       binary_path_(binary_path),
-      binary_args_(binary_args) {}
+      binary_args_(binary_args),
+      interactive_(interactive),
+      pool_size_(pool_size) {}
 
 template <typename Demux>
 void Server<Demux>::start(boost::system::error_code& ec) {
@@ -47,6 +50,13 @@ void Server<Demux>::start(boost::system::error_code& ec) {
     return;
   }
 
+#if !defined(BOOST_ASIO_WINDOWS)
+  if (pool_size_ > 0) {
+    p_pool_ = posix::ProcessPool::Get(this->get_io_service(), binary_path_,
+                                      binary_args_, pool_size_);
+  }
+#endif  // !defined(BOOST_ASIO_WINDOWS)
+
   SSF_LOG("microservice", info, "[shell]: start server on fiber port {}",
           local_port_);
 
@@ -100,7 +110,11 @@ void Server<Demux>::FiberAcceptHandler(FiberPtr new_connection,
 
   ssf::BaseSessionPtr new_process_session = std::make_shared<SessionImpl>(
       this->SelfFromThis(), std::move(*new_connection), binary_path_,
-      binary_args_);
+#if defined(BOOST_ASIO_WINDOWS)
+      binary_args_, interactive_);
+#else
+      binary_args_, interactive_, p_pool_);
+#endif  // defined(BOOST_ASIO_WINDOWS)
   boost::system::error_code e;
   session_manager_.start(new_process_session, e);
 }
@@ -109,6 +123,9 @@ template <typename Demux>
 void Server<Demux>::HandleStop() {
   fiber_acceptor_.close();
   session_manager_.stop_all();
+#if !defined(BOOST_ASIO_WINDOWS)
+  p_pool_.reset();
+#endif  // !defined(BOOST_ASIO_WINDOWS)
 }
 
 template <typename Demux>
@@ -9,6 +9,7 @@
 
 #include <windows.h>
 
+#include <ssf/io/handler_memory.h>
 #include <ssf/network/base_session.h>
 #include <ssf/network/socket_link.h>
 #include <ssf/network/manager.h>
@@ -36,7 +37,8 @@ class Session : public ssf::BaseSession {
 
  public:
   Session(std::weak_ptr<ShellServer> server, Fiber client,
-          const std::string& binary_path, const std::string& binary_args);
+          const std::string& binary_path, const std::string& binary_args,
+          bool interactive);
 
  public:
   void start(boost::system::error_code&) override;
@@ -70,6 +72,7 @@ class Session : public ssf::BaseSession {
 
   std::string binary_path_;
   std::string binary_args_;
+  bool interactive_;
 
   std::string out_pipe_name_;
   std::string err_pipe_name_;
@@ -91,6 +94,10 @@ class Session : public ssf::BaseSession {
   StreamBuf upstream_;
   StreamBuf downstream_out_;
   StreamBuf downstream_err_;
+
+  io::HandlerMemory upstream_memory_;
+  io::HandlerMemory downstream_out_memory_;
+  io::HandlerMemory downstream_err_memory_;
 };
 
 }  // windows
@@ -19,13 +19,14 @@ namespace windows {
 template <typename Demux>
 Session<Demux>::Session(std::weak_ptr<ShellServer> server, Fiber client,
                         const std::string& binary_path,
-                        const std::string& binary_args)
+                        const std::string& binary_args, bool interactive)
     : ssf::BaseSession(),
       io_service_(client.get_io_service()),
       p_server_(server),
       client_(std::move(client)),
       binary_path_(binary_path),
       binary_args_(binary_args),
+      interactive_(interactive),
       out_pipe_name_("\\\\.\\pipe\\out_pipe_"),
       err_pipe_name_("\\\\.\\pipe\\err_pipe_"),
       in_pipe_name_("\\\\.\\pipe\\in_pipe_"),
@@ -164,19 +165,29 @@ void Session<Demux>::StartForwarding(boost::system::error_code& ec) {
   }
   data_in_ = INVALID_HANDLE_VALUE;
 
+  if (interactive_) {
+    // shell packets go before bulk transfers on the demux
+    boost::system::error_code priority_ec;
+    client_.set_option(
+        boost::asio::fiber::priority(boost::asio::fiber::priority::high),
+        priority_ec);
+  }
+
   // pipe process stdout to socket output
   AsyncEstablishHDLink(ReadFrom(h_out_), WriteTo(client_),
                        boost::asio::buffer(downstream_out_),
+                       downstream_out_memory_,
                        std::bind(&Session::StopHandler, this->SelfFromThis(),
                                  std::placeholders::_1));
   // pipe process stderr to socket output
   AsyncEstablishHDLink(ReadFrom(h_err_), WriteTo(client_),
                        boost::asio::buffer(downstream_err_),
+                       downstream_err_memory_,
                        std::bind(&Session::StopHandler, this->SelfFromThis(),
                                  std::placeholders::_1));
   // pipe socket input to process stdin
   AsyncEstablishHDLink(ReadFrom(client_), WriteTo(h_in_),
-                       boost::asio::buffer(upstream_),
+                       boost::asio::buffer(upstream_), upstream_memory_,
                        std::bind(&Session::StopHandler, this->SelfFromThis(),
                                  std::placeholders::_1));
 }
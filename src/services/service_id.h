@@ -14,6 +14,7 @@ enum class MicroserviceId {
   kFibersToSockets,
   kProcessServer,
   kSocksServer,
+  kExecServer,
   kMax
 };
 
@@ -4,11 +4,17 @@ namespace ssf {
 namespace services {
 namespace sockets_to_fibers {
 
-Config::Config() : BaseServiceConfig(true), gateway_ports_(false) {}
+Config::Config()
+    : BaseServiceConfig(true),
+      gateway_ports_(false),
+      buffer_size_(50 * 1024),
+      buffers_(2) {}
 
 Config::Config(const Config& stream_listener)
     : BaseServiceConfig(stream_listener.enabled()),
-      gateway_ports_(stream_listener.gateway_ports_) {}
+      gateway_ports_(stream_listener.gateway_ports_),
+      buffer_size_(stream_listener.buffer_size_),
+      buffers_(stream_listener.buffers_) {}
 
 }  // sockets_to_fibers
 }  // services
@@ -1,6 +1,8 @@
 #ifndef SSF_SERVICES_SOCKETS_TO_FIBERS_CONFIG_H_
 #define SSF_SERVICES_SOCKETS_TO_FIBERS_CONFIG_H_
 
+#include <cstdint>
+
 #include "services/base_service_config.h"
 
 namespace ssf {
@@ -17,8 +19,21 @@ class Config : public BaseServiceConfig {
     gateway_ports_ = gateway_ports;
   }
 
+  // Size of the forwarding buffers of each session direction
+  inline uint32_t buffer_size() const { return buffer_size_; }
+  inline void set_buffer_size(uint32_t buffer_size) {
+    buffer_size_ = buffer_size;
+  }
+
+  // Buffers in flight in each session direction (reads overlap writes from
+  // 2 buffers)
+  inline uint32_t buffers() const { return buffers_; }
+  inline void set_buffers(uint32_t buffers) { buffers_ = buffers; }
+
  private:
   bool gateway_ports_;
+  uint32_t buffer_size_;
+  uint32_t buffers_;
 };
 
 }  // sockets_to_fibers
@@ -1,7 +1,6 @@
 #ifndef SSF_SERVICES_SOCKETS_TO_FIBERS_SESSION_H_
 #define SSF_SERVICES_SOCKETS_TO_FIBERS_SESSION_H_
 
-#include <array>
 #include <memory>
 
 #include <boost/system/error_code.hpp>
@@ -11,6 +10,7 @@
 #include <ssf/log/log.h>
 
 #include "ssf/network/base_session.h"  // NOLINT
+#include "ssf/network/pipelined_link.h"
 #include "ssf/network/socket_link.h"
 
 namespace ssf {
@@ -20,10 +20,6 @@ namespace sockets_to_fibers {
 /// Create a Full Duplex Forwarding Link
 template <typename Demux, typename InwardStream, typename ForwardStream>
 class Session : public ssf::BaseSession {
- private:
-  /// Buffer type for the transiting data
-  using StreamBuf = std::array<char, 50 * 1024>;
-
  public:
   using Server = SocketsToFibers<Demux>;
   using SocketsToFibersWPtr = std::weak_ptr<Server>;
@@ -78,10 +74,11 @@ class Session : public ssf::BaseSession {
  private:
   /// The constructor is made private to ensure users only use create()
   Session(SocketsToFibersWPtr server, InwardStream inbound,
-          ForwardStream outbound)
+          ForwardStream outbound, const PipelinedLinkOptions& link_options)
       : server_(server),
         inbound_(std::move(inbound)),
-        outbound_(std::move(outbound)) {}
+        outbound_(std::move(outbound)),
+        link_options_(link_options) {}
 
   /// Start forwarding
   void DoForward() {
@@ -90,11 +87,11 @@ class Session : public ssf::BaseSession {
                                      std::size_t) { StopHandler(ec); };
 
     // Make two Half Duplex links to have a Full Duplex Link
-    AsyncEstablishHDLink(ReadFrom(inbound_), WriteTo(outbound_),
-                         boost::asio::buffer(inwardBuffer_), stop_handler);
+    AsyncEstablishPipelinedHDLink(ReadFrom(inbound_), WriteTo(outbound_),
+                                  link_options_, stop_handler);
 
-    AsyncEstablishHDLink(ReadFrom(outbound_), WriteTo(inbound_),
-                         boost::asio::buffer(forwardBuffer_), stop_handler);
+    AsyncEstablishPipelinedHDLink(ReadFrom(outbound_), WriteTo(inbound_),
+                                  link_options_, stop_handler);
   }
 
   /// Stop forwarding
@@ -112,9 +109,8 @@ class Session : public ssf::BaseSession {
   InwardStream inbound_;
   ForwardStream outbound_;
 
-  // One buffer for each Half Duplex Link
-  StreamBuf inwardBuffer_;
-  StreamBuf forwardBuffer_;
+  // Buffers of the Half Duplex Links
+  PipelinedLinkOptions link_options_;
 };
 
 }  // sockets_to_fibers
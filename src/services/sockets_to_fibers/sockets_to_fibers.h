@@ -4,11 +4,13 @@
 #include <boost/asio.hpp>
 
 #include "common/boost/fiber/basic_fiber_demux.hpp"
+#include "common/boost/fiber/fiber_priority.hpp"
 #include "common/boost/fiber/stream_fiber.hpp"
 #include "common/utils/to_underlying.h"
 
 #include <ssf/network/base_session.h>
 #include <ssf/network/manager.h>
+#include <ssf/network/pipelined_link.h>
 #include <ssf/network/socket_link.h>
 
 #include "services/base_service.h"
@@ -62,6 +64,7 @@ class SocketsToFibers : public BaseService<Demux> {
   // @param parameters microservice configuration parameters
   // @param gateway_ports true to interpret local_addr parameters. Default
   //   behavior will set local_addr to 127.0.0.1
+  // @param link_options forwarding buffers of the sessions
   // @returns Microservice or nullptr if an error occured
   //
   // parameters format:
@@ -69,11 +72,13 @@ class SocketsToFibers : public BaseService<Demux> {
   //    "local_addr": IP_ADDR|*|""
   //    "local_port": TCP_PORT
   //    "remote_port": FIBER_PORT
+  //    "interactive": "1" (optional, high fiber priority and no TCP delay)
   //  }
   static SocketsToFibersPtr Create(boost::asio::io_service& io_service,
                                    Demux& fiber_demux,
                                    const Parameters& parameters,
-                                   bool gateway_ports) {
+                                   bool gateway_ports,
+                                   const PipelinedLinkOptions& link_options) {
     if (!parameters.count("local_addr") || !parameters.count("local_port") ||
         !parameters.count("remote_port")) {
       return SocketsToFibersPtr(nullptr);
@@ -113,9 +118,12 @@ class SocketsToFibers : public BaseService<Demux> {
       return SocketsToFibersPtr(nullptr);
     }
 
-    return SocketsToFibersPtr(
-        new SocketsToFibers(io_service, fiber_demux, local_addr,
-                            static_cast<uint16_t>(local_port), remote_port));
+    bool interactive = parameters.count("interactive") &&
+                       parameters.at("interactive") == "1";
+
+    return SocketsToFibersPtr(new SocketsToFibers(
+        io_service, fiber_demux, local_addr, static_cast<uint16_t>(local_port),
+        remote_port, interactive, link_options));
   }
 
   static void RegisterToServiceFactory(
@@ -126,22 +134,28 @@ class SocketsToFibers : public BaseService<Demux> {
     }
 
     auto gateway_ports = config.gateway_ports();
-    auto creator = [gateway_ports](boost::asio::io_service& io_service,
-                                   Demux& fiber_demux,
-                                   const Parameters& parameters) {
+    PipelinedLinkOptions link_options;
+    link_options.buffer_size = config.buffer_size();
+    link_options.buffers = config.buffers();
+    auto creator = [gateway_ports, link_options](
+        boost::asio::io_service& io_service, Demux& fiber_demux,
+        const Parameters& parameters) {
       return SocketsToFibers::Create(io_service, fiber_demux, parameters,
-                                     gateway_ports);
+                                     gateway_ports, link_options);
     };
     p_factory->RegisterServiceCreator(kFactoryId, creator);
   }
 
   static ssf::services::admin::CreateServiceRequest<Demux> GetCreateRequest(
       const std::string& local_addr, LocalPortType local_port,
-      RemotePortType remote_port) {
+      RemotePortType remote_port, bool interactive = false) {
     ssf::services::admin::CreateServiceRequest<Demux> create_req(kFactoryId);
     create_req.add_parameter("local_addr", local_addr);
     create_req.add_parameter("local_port", std::to_string(local_port));
     create_req.add_parameter("remote_port", std::to_string(remote_port));
+    if (interactive) {
+      create_req.add_parameter("interactive", "1");
+    }
 
     return create_req;
   }
@@ -157,7 +171,8 @@ class SocketsToFibers : public BaseService<Demux> {
  private:
   SocketsToFibers(boost::asio::io_service& io_service, Demux& fiber_demux,
                   const std::string& local_addr, LocalPortType local_port,
-                  RemotePortType remote_port);
+                  RemotePortType remote_port, bool interactive,
+                  const PipelinedLinkOptions& link_options);
 
   void AsyncAcceptSocket();
 
@@ -176,6 +191,8 @@ class SocketsToFibers : public BaseService<Demux> {
   std::string local_addr_;
   LocalPortType local_port_;
   RemotePortType remote_port_;
+  bool interactive_;
+  PipelinedLinkOptions link_options_;
   Tcp::acceptor socket_acceptor_;
 
   SessionManager manager_;
@@ -9,15 +9,17 @@ namespace services {
 namespace sockets_to_fibers {
 
 template <typename Demux>
-SocketsToFibers<Demux>::SocketsToFibers(boost::asio::io_service& io_service,
-                                        Demux& fiber_demux,
-                                        const std::string& local_addr,
-                                        LocalPortType local_port,
-                                        RemotePortType remote_port)
+SocketsToFibers<Demux>::SocketsToFibers(
+    boost::asio::io_service& io_service, Demux& fiber_demux,
+    const std::string& local_addr, LocalPortType local_port,
+    RemotePortType remote_port, bool interactive,
+    const PipelinedLinkOptions& link_options)
     : ssf::BaseService<Demux>::BaseService(io_service, fiber_demux),
       local_addr_(local_addr),
       local_port_(local_port),
       remote_port_(remote_port),
+      interactive_(interactive),
+      link_options_(link_options),
       socket_acceptor_(io_service) {}
 
 template <typename Demux>
@@ -158,9 +160,18 @@ void SocketsToFibers<Demux>::FiberConnectHandler(
     return;
   }
 
+  if (interactive_) {
+    // forward keystrokes at once, ahead of bulk transfers
+    boost::system::error_code option_ec;
+    socket_connection->set_option(Tcp::no_delay(true), option_ec);
+    fiber_connection->set_option(
+        boost::asio::fiber::priority(boost::asio::fiber::priority::high),
+        option_ec);
+  }
+
   auto session = Session<Demux, Tcp::socket, Fiber>::create(
       this->SelfFromThis(), std::move(*socket_connection),
-      std::move(*fiber_connection));
+      std::move(*fiber_connection), link_options_);
   boost::system::error_code start_ec;
   manager_.start(session, start_ec);
   if (start_ec) {
@@ -105,7 +105,8 @@ void SocksServer<Demux>::FiberAcceptHandler(
             SSF_LOG("microservice", trace, "[socks]: version accepted: v4");
             ssf::BaseSessionPtr new_socks_session =
                 std::make_shared<v4::Session<Demux> >(
-                    this->SelfFromThis(), std::move(*fiber_connection));
+                    this->SelfFromThis(), std::move(*fiber_connection),
+                    this->get_demux().quotas());
             boost::system::error_code e;
             session_manager_.start(new_socks_session, e);
             break;
@@ -114,7 +115,8 @@ void SocksServer<Demux>::FiberAcceptHandler(
             SSF_LOG("microservice", trace, "[socks]: version accepted: v5");
             ssf::BaseSessionPtr new_socks_session =
                 std::make_shared<v5::Session<Demux> >(
-                    this->SelfFromThis(), std::move(*fiber_connection));
+                    this->SelfFromThis(), std::move(*fiber_connection),
+                    this->get_demux().quotas());
             boost::system::error_code e;
             session_manager_.start(new_socks_session, e);
             break;
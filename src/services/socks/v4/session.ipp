@@ -15,13 +15,16 @@ namespace socks {
 namespace v4 {
 
 template <typename Demux>
-Session<Demux>::Session(SocksServerWPtr socks_server, Fiber client)
+Session<Demux>::Session(SocksServerWPtr socks_server, Fiber client,
+                        QuotasPtr p_quotas)
     : ssf::BaseSession(),
       io_service_(client.get_io_service()),
       socks_server_(socks_server),
       client_(std::move(client)),
       server_(io_service_),
-      server_resolver_(io_service_) {}
+      server_resolver_(io_service_),
+      p_quotas_(std::move(p_quotas)),
+      p_server_reservation_() {}
 
 template <typename Demux>
 void Session<Demux>::HandleStop() {
@@ -78,6 +81,15 @@ void Session<Demux>::DoConnectRequest() {
       std::bind(&Session<Demux>::HandleApplicationServerConnect, SelfFromThis(),
                 std::placeholders::_1);
 
+  p_server_reservation_ = OutboundSocketReservation::acquire(p_quotas_);
+  if (!p_server_reservation_) {
+    SSF_LOG("microservice", warn,
+            "[socks v4] session outbound socket quota reached");
+    connect_handler(boost::system::error_code(ssf::error::connection_refused,
+                                              ssf::error::get_ssf_category()));
+    return;
+  }
+
   if (request_.Is4aVersion()) {
     // socks4a: address needs to be resolved
     auto resolve_handler =
@@ -52,8 +52,12 @@ class Session : public ssf::BaseSession {
   using Server = SocksServer<Demux>;
   using SocksServerWPtr = std::weak_ptr<Server>;
 
+  using QuotasPtr = typename Demux::quotas_ptr_type;
+  using OutboundSocketReservation =
+      boost::asio::fiber::detail::outbound_socket_reservation;
+
  public:
-  Session(SocksServerWPtr socks_server, Fiber client);
+  Session(SocksServerWPtr socks_server, Fiber client, QuotasPtr p_quotas);
 
  public:
   virtual void start(boost::system::error_code&);
@@ -100,6 +104,8 @@ class Session : public ssf::BaseSession {
   Fiber client_;
   Tcp::socket server_;
   Tcp::resolver server_resolver_;
+  QuotasPtr p_quotas_;
+  OutboundSocketReservation::pointer p_server_reservation_;
   RequestAuth request_auth_;
   Request request_;
 
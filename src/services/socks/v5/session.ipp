@@ -13,13 +13,16 @@ namespace socks {
 namespace v5 {
 
 template <typename Demux>
-Session<Demux>::Session(SocksServerWPtr socks_server, Fiber client)
+Session<Demux>::Session(SocksServerWPtr socks_server, Fiber client,
+                        QuotasPtr p_quotas)
     : ssf::BaseSession(),
       io_service_(client.get_io_service()),
       socks_server_(socks_server),
       client_(std::move(client)),
       server_(io_service_),
-      server_resolver_(io_service_) {}
+      server_resolver_(io_service_),
+      p_quotas_(std::move(p_quotas)),
+      p_server_reservation_() {}
 
 template <typename Demux>
 void Session<Demux>::HandleStop() {
@@ -127,6 +130,14 @@ void Session<Demux>::HandleRequestDispatch(const boost::system::error_code& ec,
 
 template <typename Demux>
 void Session<Demux>::DoConnectRequest() {
+  p_server_reservation_ = OutboundSocketReservation::acquire(p_quotas_);
+  if (!p_server_reservation_) {
+    SSF_LOG("microservice", warn,
+            "[socks v5] session outbound socket quota reached");
+    DoErrorCommand(CommandStatus::kConnectionNotAllowed);
+    return;
+  }
+
   auto connect_handler =
       std::bind(&Session<Demux>::HandleApplicationServerConnect, SelfFromThis(),
                 std::placeholders::_1);
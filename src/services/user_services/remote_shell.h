@@ -77,7 +77,7 @@ class RemoteShell : public BaseUserService<Demux> {
 
     services::admin::CreateServiceRequest<Demux> r_forward(
         services::sockets_to_fibers::SocketsToFibers<Demux>::GetCreateRequest(
-            remote_addr_, remote_port_, remote_port_));
+            remote_addr_, remote_port_, remote_port_, true));
 
     result.push_back(r_forward);
 
@@ -100,7 +100,7 @@ class RemoteShell : public BaseUserService<Demux> {
   uint32_t CheckRemoteServiceStatus(Demux& demux) override {
     services::admin::CreateServiceRequest<Demux> r_forward(
         services::sockets_to_fibers::SocketsToFibers<Demux>::GetCreateRequest(
-            remote_addr_, remote_port_, remote_port_));
+            remote_addr_, remote_port_, remote_port_, true));
 
     auto p_service_factory =
         ServiceFactoryManager<Demux>::GetServiceFactory(&demux);
@@ -145,7 +145,7 @@ class RemoteShell : public BaseUserService<Demux> {
     } else {
       services::admin::CreateServiceRequest<Demux> r_forward(
           services::sockets_to_fibers::SocketsToFibers<Demux>::GetCreateRequest(
-              remote_addr_, remote_port_, remote_port_));
+              remote_addr_, remote_port_, remote_port_, true));
 
       auto p_service_factory =
           ServiceFactoryManager<Demux>::GetServiceFactory(&demux);
@@ -109,7 +109,7 @@ class Shell : public BaseUserService<Demux> {
   bool StartLocalServices(Demux& demux) override {
     services::admin::CreateServiceRequest<Demux> l_forward(
         services::sockets_to_fibers::SocketsToFibers<Demux>::GetCreateRequest(
-            local_addr_, local_port_, local_port_));
+            local_addr_, local_port_, local_port_, true));
 
     auto p_service_factory =
         ServiceFactoryManager<Demux>::GetServiceFactory(&demux);
@@ -81,11 +81,29 @@ TEST_F(LoadConfigTest, DefaultValueTest) {
   ASSERT_TRUE(config_.services().stream_forwarder().enabled());
   ASSERT_TRUE(config_.services().stream_listener().enabled());
   ASSERT_FALSE(config_.services().stream_listener().gateway_ports());
+  ASSERT_EQ(config_.services().stream_forwarder().buffer_size(),
+            static_cast<uint32_t>(51200));
+  ASSERT_EQ(config_.services().stream_forwarder().buffers(),
+            static_cast<uint32_t>(2));
+  ASSERT_FALSE(config_.services().stream_forwarder().zero_copy());
+  ASSERT_EQ(config_.services().stream_listener().buffer_size(),
+            static_cast<uint32_t>(51200));
+  ASSERT_EQ(config_.services().stream_listener().buffers(),
+            static_cast<uint32_t>(2));
   ASSERT_FALSE(config_.services().process().enabled());
 
   ASSERT_GT(config_.services().process().path().length(),
             static_cast<std::size_t>(0));
   ASSERT_EQ(config_.services().process().args(), "");
+  ASSERT_TRUE(config_.services().process().interactive());
+  ASSERT_EQ(config_.services().process().pool_size(),
+            static_cast<uint32_t>(0));
+  ASSERT_FALSE(config_.services().exec().enabled());
+
+  ASSERT_EQ(config_.quotas().max_fibers(), static_cast<uint32_t>(0));
+  ASSERT_EQ(config_.quotas().max_buffered_bytes(), static_cast<uint64_t>(0));
+  ASSERT_EQ(config_.quotas().max_syn_per_second(), static_cast<uint32_t>(0));
+  ASSERT_EQ(config_.quotas().max_outbound_sockets(), static_cast<uint32_t>(0));
 }
 
 TEST_F(LoadConfigTest, LoadTlsPartialFileTest) {
@@ -161,6 +179,15 @@ TEST_F(LoadConfigTest, LoadTlsCompleteFileTest) {
   ASSERT_TRUE(config_.services().stream_forwarder().enabled());
   ASSERT_TRUE(config_.services().stream_listener().enabled());
   ASSERT_FALSE(config_.services().stream_listener().gateway_ports());
+  ASSERT_EQ(config_.services().stream_forwarder().buffer_size(),
+            static_cast<uint32_t>(51200));
+  ASSERT_EQ(config_.services().stream_forwarder().buffers(),
+            static_cast<uint32_t>(2));
+  ASSERT_FALSE(config_.services().stream_forwarder().zero_copy());
+  ASSERT_EQ(config_.services().stream_listener().buffer_size(),
+            static_cast<uint32_t>(51200));
+  ASSERT_EQ(config_.services().stream_listener().buffers(),
+            static_cast<uint32_t>(2));
   ASSERT_FALSE(config_.services().process().enabled());
 
   ASSERT_GT(config_.services().process().path().length(),
@@ -203,10 +230,39 @@ TEST_F(LoadConfigTest, LoadServicesFileTest) {
   ASSERT_FALSE(config_.services().stream_forwarder().enabled());
   ASSERT_FALSE(config_.services().stream_listener().enabled());
   ASSERT_TRUE(config_.services().stream_listener().gateway_ports());
+  ASSERT_EQ(config_.services().stream_forwarder().buffer_size(),
+            static_cast<uint32_t>(262144));
+  ASSERT_EQ(config_.services().stream_forwarder().buffers(),
+            static_cast<uint32_t>(4));
+  ASSERT_TRUE(config_.services().stream_forwarder().zero_copy());
+  ASSERT_EQ(config_.services().stream_listener().buffer_size(),
+            static_cast<uint32_t>(131072));
+  ASSERT_EQ(config_.services().stream_listener().buffers(),
+            static_cast<uint32_t>(3));
   ASSERT_TRUE(config_.services().process().enabled());
 
   ASSERT_EQ(config_.services().process().path(), "/bin/custom_path");
   ASSERT_EQ(config_.services().process().args(), "-custom args");
+  ASSERT_FALSE(config_.services().process().interactive());
+  ASSERT_EQ(config_.services().process().pool_size(),
+            static_cast<uint32_t>(4));
+  ASSERT_TRUE(config_.services().exec().enabled());
+  ASSERT_EQ(config_.services().exec().path(), "/bin/custom_exec");
+}
+
+TEST_F(LoadConfigTest, LoadQuotasFileTest) {
+  boost::system::error_code ec;
+
+  config_.UpdateFromFile("./config_files/quotas.json", ec);
+
+  ASSERT_EQ(ec.value(), 0) << "Success if quotas file format";
+
+  ASSERT_EQ(config_.quotas().max_fibers(), static_cast<uint32_t>(64));
+  ASSERT_EQ(config_.quotas().max_buffered_bytes(),
+            static_cast<uint64_t>(1048576));
+  ASSERT_EQ(config_.quotas().max_syn_per_second(), static_cast<uint32_t>(100));
+  ASSERT_EQ(config_.quotas().max_outbound_sockets(),
+            static_cast<uint32_t>(16));
 }
 
 TEST_F(LoadConfigTest, LoadCircuitFileTest) {
@@ -247,6 +303,29 @@ TEST_F(LoadConfigTest, LoadArgumentsFileTest) {
   ASSERT_EQ(argv[9], nullptr);
 }
 
+TEST_F(LoadConfigTest, LoadSessionsFileTest) {
+  boost::system::error_code ec;
+
+  config_.UpdateFromFile("./config_files/sessions.json", ec);
+
+  ASSERT_EQ(ec.value(), 0) << "Success if sessions file format";
+  ASSERT_EQ(config_.GetArgc(), 0);
+  ASSERT_EQ(config_.GetSessionsCount(), 2);
+
+  auto first_argv = config_.GetSessionArgv(0);
+  ASSERT_EQ(first_argv.size(), 7);
+  ASSERT_STREQ(first_argv[1], "-L");
+  ASSERT_STREQ(first_argv[2], "9000:localhost:80");
+  ASSERT_STREQ(first_argv[5], "server1.example.com");
+  ASSERT_EQ(first_argv[6], nullptr);
+
+  auto second_argv = config_.GetSessionArgv(1);
+  ASSERT_EQ(second_argv.size(), 7);
+  ASSERT_STREQ(second_argv[2], "8012");
+  ASSERT_STREQ(second_argv[4], "127.0.0.1:9001");
+  ASSERT_STREQ(second_argv[5], "server2.example.com");
+}
+
 TEST_F(LoadConfigTest, LoadCompleteFileTest) {
   boost::system::error_code ec;
 
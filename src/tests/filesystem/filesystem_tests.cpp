@@ -1,4 +1,6 @@
 #include <fstream>
+#include <future>
+#include <mutex>
 #include <string>
 #include <regex>
 
@@ -6,7 +8,9 @@
 #include <boost/filesystem.hpp>
 #include <boost/system/error_code.hpp>
 
+#include "common/filesystem/file_walker.h"
 #include "common/filesystem/filesystem.h"
+#include "common/filesystem/glob_matcher.h"
 
 static constexpr char kFilesystemDirectory[] = "filesystem";
 
@@ -94,3 +98,66 @@ TEST_F(FilesystemTest, BasicTests) {
   ASSERT_EQ(ec.value(), 0);
   ASSERT_EQ(files.size(), 0);
 }
+
+TEST_F(FilesystemTest, GlobMatcherTest) {
+  ssf::GlobMatcher txt_matcher("dir/*.txt");
+  ASSERT_TRUE(txt_matcher.Match("dir/file.txt"));
+  ASSERT_TRUE(txt_matcher.Match("dir/sub/file.txt"));
+  ASSERT_TRUE(txt_matcher.Match("base/dir/file.txt"));
+  ASSERT_FALSE(txt_matcher.Match("dir/file.cpp"));
+  ASSERT_FALSE(txt_matcher.Match("other/file.txt"));
+
+  ssf::GlobMatcher literal_matcher("dir/[a].txt");
+  ASSERT_TRUE(literal_matcher.Match("dir/[a].txt"));
+  ASSERT_FALSE(literal_matcher.Match("dir/a.txt"));
+
+  ssf::GlobMatcher wildcard_matcher("dir/f?le*.bin");
+  ASSERT_TRUE(wildcard_matcher.Match("dir/file_1.bin"));
+  ASSERT_FALSE(wildcard_matcher.Match("dir/file_1.txt"));
+}
+
+TEST_F(FilesystemTest, FileWalkerTest) {
+  boost::system::error_code ec;
+
+  ssf::Path directory_base(kFilesystemDirectory);
+  for (uint32_t i = 0; i < 20; ++i) {
+    ssf::Path directory_path(directory_base);
+    directory_path /= "walk" + std::to_string(i) + "/sub";
+    ASSERT_TRUE(fs_.MakeDirectories(directory_path, ec));
+    for (uint32_t j = 0; j < 30; ++j) {
+      GenerateRandomFile(directory_path, "file", ".bin", 0);
+    }
+  }
+
+  std::mutex files_mutex;
+  std::size_t files_count = 0;
+  std::size_t batches_count = 0;
+  std::promise<boost::system::error_code> done;
+
+  auto p_walker = ssf::FileWalker::Create(directory_base, true, 4);
+  p_walker->Start(
+      [&](std::vector<ssf::Path> files) {
+        std::unique_lock<std::mutex> lock(files_mutex);
+        ASSERT_LE(files.size(), ssf::FileWalker::kBatchSize);
+        files_count += files.size();
+        ++batches_count;
+      },
+      [&done](const boost::system::error_code& ec) { done.set_value(ec); });
+
+  ec = done.get_future().get();
+  ASSERT_EQ(ec.value(), 0);
+  ASSERT_EQ(files_count, 20 * 30);
+  // files are reported before the end of the walk
+  ASSERT_GT(batches_count, 1);
+
+  std::promise<boost::system::error_code> error_done;
+  ssf::Path unknown_directory(directory_base);
+  unknown_directory /= "unknown/";
+  auto p_error_walker = ssf::FileWalker::Create(unknown_directory, true);
+  p_error_walker->Start(
+      [](std::vector<ssf::Path>) {},
+      [&error_done](const boost::system::error_code& ec) {
+        error_done.set_value(ec);
+      });
+  ASSERT_NE(error_done.get_future().get().value(), 0);
+}
@@ -1,4 +1,7 @@
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <functional>
 #include <future>
 #include <list>
@@ -17,6 +20,8 @@
 #include "common/boost/fiber/basic_endpoint.hpp"
 #include "common/boost/fiber/basic_fiber_demux.hpp"
 #include "common/boost/fiber/datagram_fiber.hpp"
+#include "common/boost/fiber/datagram_queue.hpp"
+#include "common/boost/fiber/fiber_priority.hpp"
 #include "common/boost/fiber/stream_fiber.hpp"
 
 #include "tests/tls_config_helper.h"
@@ -535,6 +540,397 @@ TEST_F(FiberTest, ExchangePackets) {
   fib_acceptor.close(close_fib_acceptor_ec);
 }
 
+//-----------------------------------------------------------------------------
+TEST_F(FiberTest, ExchangeManySmallPackets) {
+  Wait();
+
+  // Small packets are coalesced by the socket, the demux receive loop has to
+  // split them and to reassemble the ones spanning several reads
+  const uint32_t packet_number = 20000;
+  std::promise<bool> client_sent;
+  std::promise<bool> server_received_all;
+
+  fiber_acceptor fib_acceptor(io_service_server_);
+  fiber fib_server(io_service_server_);
+  fiber fib_client(io_service_client_);
+
+  uint32_t client_counter = 0;
+  uint32_t server_counter = 0;
+  uint32_t buffer_server = 0;
+  bool result_server = true;
+
+  std::function<void(const boost::system::error_code& ec, std::size_t)>
+      async_receive_h;
+  std::function<void(const boost::system::error_code& ec, std::size_t)>
+      async_send_h;
+
+  async_receive_h = [&, this](const boost::system::error_code& ec,
+                              std::size_t) {
+    ASSERT_EQ(ec.value(), 0);
+
+    result_server &= (buffer_server == server_counter);
+
+    if (++server_counter < packet_number) {
+      boost::asio::async_read(
+          fib_server, boost::asio::buffer(&buffer_server, sizeof(uint32_t)),
+          std::bind(async_receive_h, std::placeholders::_1,
+                    std::placeholders::_2));
+    } else {
+      server_received_all.set_value(true);
+    }
+  };
+
+  async_send_h = [&, this](const boost::system::error_code& ec, std::size_t) {
+    ASSERT_EQ(ec.value(), 0);
+
+    if (++client_counter < packet_number) {
+      boost::asio::async_write(
+          fib_client, boost::asio::buffer(&client_counter, sizeof(uint32_t)),
+          std::bind(async_send_h, std::placeholders::_1,
+                    std::placeholders::_2));
+    } else {
+      client_sent.set_value(true);
+    }
+  };
+
+  auto async_accept_h = [&, this](const boost::system::error_code& ec) {
+    ASSERT_EQ(ec.value(), 0);
+
+    boost::asio::async_read(
+        fib_server, boost::asio::buffer(&buffer_server, sizeof(uint32_t)),
+        std::bind(async_receive_h, std::placeholders::_1,
+                  std::placeholders::_2));
+  };
+
+  auto async_connect_h = [&, this](const boost::system::error_code& ec) {
+    ASSERT_EQ(ec.value(), 0);
+
+    boost::asio::async_write(
+        fib_client, boost::asio::buffer(&client_counter, sizeof(uint32_t)),
+        std::bind(async_send_h, std::placeholders::_1, std::placeholders::_2));
+  };
+
+  boost::system::error_code acceptor_ec;
+  fiber_endpoint server_endpoint(boost::asio::fiber::stream_fiber<socket>::v1(),
+                                 demux_server_, 1);
+  fib_acceptor.open(server_endpoint.protocol(), acceptor_ec);
+  fib_acceptor.bind(server_endpoint, acceptor_ec);
+  fib_acceptor.listen(boost::asio::socket_base::max_connections, acceptor_ec);
+  fib_acceptor.async_accept(fib_server,
+                            std::bind(async_accept_h, std::placeholders::_1));
+
+  fiber_endpoint client_endpoint(boost::asio::fiber::stream_fiber<socket>::v1(),
+                                 demux_client_, 1);
+  fib_client.async_connect(client_endpoint,
+                           std::bind(async_connect_h, std::placeholders::_1));
+
+  client_sent.get_future().wait();
+  server_received_all.get_future().wait();
+
+  ASSERT_EQ(true, result_server);
+  ASSERT_EQ(packet_number, server_counter);
+
+  boost::system::error_code close_ec;
+  fib_client.close(close_ec);
+  fib_server.close(close_ec);
+  fib_acceptor.close(close_ec);
+}
+
+//-----------------------------------------------------------------------------
+TEST_F(FiberTest, ReadHandlerNotCalledFromInitiatingFunction) {
+  Wait();
+
+  // Reads are started from read handlers while data is queued and still
+  // arriving: no handler may be invoked inside its async_receive call
+  const uint32_t packet_number = 2000;
+  const std::size_t packet_size = 64;
+  const std::size_t total_size = packet_number * packet_size;
+  static thread_local bool in_async_receive = false;
+
+  std::promise<bool> client_connected;
+  std::promise<bool> client_received_all;
+  std::promise<bool> server_sent_all;
+
+  fiber_acceptor fib_acceptor(io_service_server_);
+  fiber fib_server(io_service_server_);
+  fiber fib_client(io_service_client_);
+
+  std::array<uint8_t, packet_size> buffer_server;
+  buffer_server.fill(1);
+  std::array<uint8_t, 24> buffer_client;
+  uint32_t server_counter = 0;
+  std::size_t client_received = 0;
+  std::atomic<bool> inline_completion(false);
+
+  std::function<void(const boost::system::error_code& ec, std::size_t)>
+      async_receive_h;
+  std::function<void(const boost::system::error_code& ec, std::size_t)>
+      async_send_h;
+
+  auto start_read = [&]() {
+    in_async_receive = true;
+    fib_client.async_receive(boost::asio::buffer(buffer_client),
+                             async_receive_h);
+    in_async_receive = false;
+  };
+
+  async_receive_h = [&](const boost::system::error_code& ec,
+                        std::size_t length) {
+    if (in_async_receive) {
+      inline_completion = true;
+    }
+    ASSERT_EQ(ec.value(), 0);
+
+    client_received += length;
+    if (client_received < total_size) {
+      start_read();
+    } else {
+      client_received_all.set_value(true);
+    }
+  };
+
+  async_send_h = [&](const boost::system::error_code& ec, std::size_t) {
+    ASSERT_EQ(ec.value(), 0);
+
+    if (++server_counter < packet_number) {
+      boost::asio::async_write(fib_server, boost::asio::buffer(buffer_server),
+                               async_send_h);
+    } else {
+      server_sent_all.set_value(true);
+    }
+  };
+
+  auto async_accept_h = [&, this](const boost::system::error_code& ec) {
+    ASSERT_EQ(ec.value(), 0);
+
+    boost::asio::async_write(fib_server, boost::asio::buffer(buffer_server),
+                             async_send_h);
+  };
+
+  auto async_connect_h = [&, this](const boost::system::error_code& ec) {
+    client_connected.set_value(!ec);
+  };
+
+  boost::system::error_code acceptor_ec;
+  fiber_endpoint server_endpoint(boost::asio::fiber::stream_fiber<socket>::v1(),
+                                 demux_server_, 1);
+  fib_acceptor.open(server_endpoint.protocol(), acceptor_ec);
+  fib_acceptor.bind(server_endpoint, acceptor_ec);
+  fib_acceptor.listen(boost::asio::socket_base::max_connections, acceptor_ec);
+  fib_acceptor.async_accept(fib_server,
+                            std::bind(async_accept_h, std::placeholders::_1));
+
+  fiber_endpoint client_endpoint(boost::asio::fiber::stream_fiber<socket>::v1(),
+                                 demux_client_, 1);
+  fib_client.async_connect(client_endpoint,
+                           std::bind(async_connect_h, std::placeholders::_1));
+
+  ASSERT_TRUE(client_connected.get_future().get());
+
+  // Let some data be queued in the client fiber before the first read
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  io_service_client_.post(start_read);
+
+  server_sent_all.get_future().wait();
+  client_received_all.get_future().wait();
+
+  EXPECT_FALSE(inline_completion.load())
+      << "A read handler was invoked from its initiating function";
+  EXPECT_EQ(total_size, client_received);
+
+  boost::system::error_code close_ec;
+  fib_client.close(close_ec);
+  fib_server.close(close_ec);
+  fib_acceptor.close(close_ec);
+}
+
+//-----------------------------------------------------------------------------
+TEST_F(FiberTest, PriorityChangeKeepsFiberOrder) {
+  Wait();
+
+  // Writes queued before the fiber priority is raised are not overtaken by
+  // the ones queued after
+  const uint32_t packet_number = 2000;
+  std::vector<uint32_t> values(packet_number);
+  for (uint32_t i = 0; i < packet_number; ++i) {
+    values[i] = i;
+  }
+
+  std::promise<bool> client_sent;
+  std::promise<bool> server_received_all;
+
+  fiber_acceptor fib_acceptor(io_service_server_);
+  fiber fib_server(io_service_server_);
+  fiber fib_client(io_service_client_);
+
+  std::atomic<uint32_t> sent_counter(0);
+  uint32_t server_counter = 0;
+  uint32_t buffer_server = 0;
+  bool result_server = true;
+
+  std::function<void(const boost::system::error_code& ec, std::size_t)>
+      async_receive_h;
+
+  async_receive_h = [&, this](const boost::system::error_code& ec,
+                              std::size_t) {
+    ASSERT_EQ(ec.value(), 0);
+
+    result_server &= (buffer_server == server_counter);
+
+    if (++server_counter < packet_number) {
+      boost::asio::async_read(
+          fib_server, boost::asio::buffer(&buffer_server, sizeof(uint32_t)),
+          std::bind(async_receive_h, std::placeholders::_1,
+                    std::placeholders::_2));
+    } else {
+      server_received_all.set_value(true);
+    }
+  };
+
+  auto async_send_h = [&](const boost::system::error_code& ec, std::size_t) {
+    ASSERT_EQ(ec.value(), 0);
+    if (++sent_counter == packet_number) {
+      client_sent.set_value(true);
+    }
+  };
+
+  auto async_accept_h = [&, this](const boost::system::error_code& ec) {
+    ASSERT_EQ(ec.value(), 0);
+
+    boost::asio::async_read(
+        fib_server, boost::asio::buffer(&buffer_server, sizeof(uint32_t)),
+        std::bind(async_receive_h, std::placeholders::_1,
+                  std::placeholders::_2));
+  };
+
+  auto async_connect_h = [&, this](const boost::system::error_code& ec) {
+    ASSERT_EQ(ec.value(), 0);
+
+    for (uint32_t i = 0; i < packet_number; ++i) {
+      if (i == packet_number / 2) {
+        boost::system::error_code option_ec;
+        fib_client.set_option(
+            boost::asio::fiber::priority(boost::asio::fiber::priority::high),
+            option_ec);
+        ASSERT_EQ(option_ec.value(), 0);
+      }
+      fib_client.async_write_some(
+          boost::asio::buffer(&values[i], sizeof(uint32_t)), async_send_h);
+    }
+  };
+
+  boost::system::error_code acceptor_ec;
+  fiber_endpoint server_endpoint(boost::asio::fiber::stream_fiber<socket>::v1(),
+                                 demux_server_, 1);
+  fib_acceptor.open(server_endpoint.protocol(), acceptor_ec);
+  fib_acceptor.bind(server_endpoint, acceptor_ec);
+  fib_acceptor.listen(boost::asio::socket_base::max_connections, acceptor_ec);
+  fib_acceptor.async_accept(fib_server,
+                            std::bind(async_accept_h, std::placeholders::_1));
+
+  fiber_endpoint client_endpoint(boost::asio::fiber::stream_fiber<socket>::v1(),
+                                 demux_client_, 1);
+  fib_client.async_connect(client_endpoint,
+                           std::bind(async_connect_h, std::placeholders::_1));
+
+  client_sent.get_future().wait();
+  server_received_all.get_future().wait();
+
+  ASSERT_EQ(true, result_server);
+  ASSERT_EQ(packet_number, server_counter);
+
+  boost::system::error_code close_ec;
+  fib_client.close(close_ec);
+  fib_server.close(close_ec);
+  fib_acceptor.close(close_ec);
+}
+
+//-----------------------------------------------------------------------------
+TEST_F(FiberTest, LargeScatteredWriteInOneCall) {
+  Wait();
+
+  // A write bigger than the mtu and spread on several buffers is sent in
+  // several packets by a single write_some call
+  std::vector<uint8_t> first(100 * 1024);
+  std::vector<uint8_t> second(20);
+  std::vector<uint8_t> third(80 * 1024);
+  for (std::size_t i = 0; i < first.size(); ++i) {
+    first[i] = static_cast<uint8_t>(i);
+  }
+  for (std::size_t i = 0; i < second.size(); ++i) {
+    second[i] = static_cast<uint8_t>(3 * i);
+  }
+  for (std::size_t i = 0; i < third.size(); ++i) {
+    third[i] = static_cast<uint8_t>(7 * i);
+  }
+
+  std::vector<boost::asio::const_buffer> buffers_client;
+  buffers_client.push_back(boost::asio::buffer(first));
+  buffers_client.push_back(boost::asio::buffer(second));
+  buffers_client.push_back(boost::asio::buffer(third));
+  const std::size_t total_size = boost::asio::buffer_size(buffers_client);
+
+  std::vector<uint8_t> expected(first);
+  expected.insert(expected.end(), second.begin(), second.end());
+  expected.insert(expected.end(), third.begin(), third.end());
+  std::vector<uint8_t> buffer_server(total_size);
+
+  std::promise<std::size_t> client_sent;
+  std::promise<bool> server_received;
+
+  fiber_acceptor fib_acceptor(io_service_server_);
+  fiber fib_server(io_service_server_);
+  fiber fib_client(io_service_client_);
+
+  auto async_receive_h = [&](const boost::system::error_code& ec,
+                             std::size_t length) {
+    EXPECT_EQ(ec.value(), 0);
+    EXPECT_EQ(total_size, length);
+    server_received.set_value(expected == buffer_server);
+  };
+
+  auto async_send_h = [&](const boost::system::error_code& ec,
+                          std::size_t length) {
+    EXPECT_EQ(ec.value(), 0);
+    client_sent.set_value(length);
+  };
+
+  auto async_accept_h = [&, this](const boost::system::error_code& ec) {
+    ASSERT_EQ(ec.value(), 0);
+
+    boost::asio::async_read(fib_server, boost::asio::buffer(buffer_server),
+                            async_receive_h);
+  };
+
+  auto async_connect_h = [&, this](const boost::system::error_code& ec) {
+    ASSERT_EQ(ec.value(), 0);
+
+    fib_client.async_write_some(buffers_client, async_send_h);
+  };
+
+  boost::system::error_code acceptor_ec;
+  fiber_endpoint server_endpoint(boost::asio::fiber::stream_fiber<socket>::v1(),
+                                 demux_server_, 1);
+  fib_acceptor.open(server_endpoint.protocol(), acceptor_ec);
+  fib_acceptor.bind(server_endpoint, acceptor_ec);
+  fib_acceptor.listen(boost::asio::socket_base::max_connections, acceptor_ec);
+  fib_acceptor.async_accept(fib_server,
+                            std::bind(async_accept_h, std::placeholders::_1));
+
+  fiber_endpoint client_endpoint(boost::asio::fiber::stream_fiber<socket>::v1(),
+                                 demux_client_, 1);
+  fib_client.async_connect(client_endpoint,
+                           std::bind(async_connect_h, std::placeholders::_1));
+
+  ASSERT_EQ(total_size, client_sent.get_future().get());
+  ASSERT_EQ(true, server_received.get_future().get());
+
+  boost::system::error_code close_ec;
+  fib_client.close(close_ec);
+  fib_server.close(close_ec);
+  fib_acceptor.close(close_ec);
+}
+
 ////-----------------------------------------------------------------------------
 TEST_F(FiberTest, ExchangePacketsFiveClients) {
   Wait();
@@ -936,6 +1332,173 @@ TEST_F(FiberTest, UDPfiber) {
   server_closed.get_future().wait();
 }
 
+//-----------------------------------------------------------------------------
+TEST_F(FiberTest, UDPfiberBoundedQueue) {
+  Wait();
+
+  const uint8_t number_of_datagrams = 10;
+  const uint32_t max_datagrams = 4;
+
+  // Queue datagrams on a fiber which does not read them, then read what the
+  // bound kept
+  auto check_policy = [&](uint32_t port,
+                          boost::asio::fiber::datagram_queue::policy_type policy,
+                          uint8_t first_kept) {
+    dgr_fiber_endpoint endpoint_server_local_port(
+        boost::asio::fiber::datagram_fiber<socket>::v1(), demux_server_, port);
+    dgr_fiber_endpoint endpoint_client_remote_port(
+        boost::asio::fiber::datagram_fiber<socket>::v1(), demux_client_, port);
+    dgr_fiber dgr_f_server(io_service_server_);
+    dgr_fiber dgr_f_client(io_service_client_);
+
+    boost::system::error_code ec;
+    dgr_f_server.open(endpoint_server_local_port.protocol(), ec);
+    dgr_f_server.bind(endpoint_server_local_port, ec);
+    ASSERT_EQ(ec.value(), 0);
+    dgr_f_server.set_option(
+        boost::asio::fiber::datagram_queue(max_datagrams, policy), ec);
+    ASSERT_EQ(ec.value(), 0);
+
+    for (uint8_t i = 0; i < number_of_datagrams; ++i) {
+      std::promise<boost::system::error_code> sent;
+      std::array<uint8_t, 1> buffer_client = {{i}};
+      dgr_f_client.async_send_to(
+          boost::asio::buffer(buffer_client), endpoint_client_remote_port,
+          [&sent](const boost::system::error_code& sent_ec, size_t length) {
+            sent.set_value(sent_ec);
+          });
+      ASSERT_EQ(sent.get_future().get().value(), 0)
+          << "Sent handler should not be in error";
+    }
+
+    boost::asio::fiber::datagram_queue_stats stats;
+    for (int retry = 0; retry < 100; ++retry) {
+      dgr_f_server.get_option(stats, ec);
+      if (stats.received() == number_of_datagrams) {
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_EQ(stats.received(), number_of_datagrams);
+    ASSERT_EQ(stats.dropped(), number_of_datagrams - max_datagrams);
+
+    dgr_fiber_endpoint endpoint_server_from(
+        boost::asio::fiber::datagram_fiber<socket>::v1(), demux_server_);
+    for (uint8_t i = 0; i < max_datagrams; ++i) {
+      std::promise<boost::system::error_code> received;
+      std::array<uint8_t, 1> buffer_server = {{0}};
+      dgr_f_server.async_receive_from(
+          boost::asio::buffer(buffer_server), endpoint_server_from,
+          [&received](const boost::system::error_code& received_ec,
+                      size_t length) { received.set_value(received_ec); });
+      ASSERT_EQ(received.get_future().get().value(), 0)
+          << "Received handler should not be in error";
+      EXPECT_EQ(buffer_server[0], first_kept + i)
+          << "Datagrams should be kept in order";
+    }
+
+    dgr_f_server.get_option(stats, ec);
+    EXPECT_EQ(stats.delivered(), max_datagrams);
+    EXPECT_LE(stats.average_delay_us(), stats.max_delay_us());
+
+    dgr_f_client.close();
+    dgr_f_server.close();
+  };
+
+  check_policy((1 << 16) + 2, boost::asio::fiber::datagram_queue::drop_oldest,
+               number_of_datagrams - max_datagrams);
+  check_policy((1 << 16) + 3, boost::asio::fiber::datagram_queue::drop_newest,
+               0);
+}
+
+//-----------------------------------------------------------------------------
+TEST_F(FiberTest, UDPfiberFloodedQueue) {
+  Wait();
+
+  const uint32_t number_of_datagrams = 2000;
+  const uint32_t max_datagrams = 32;
+  const uint32_t port = (1 << 16) + 4;
+
+  dgr_fiber_endpoint endpoint_server_local_port(
+      boost::asio::fiber::datagram_fiber<socket>::v1(), demux_server_, port);
+  dgr_fiber_endpoint endpoint_client_remote_port(
+      boost::asio::fiber::datagram_fiber<socket>::v1(), demux_client_, port);
+  dgr_fiber dgr_f_server(io_service_server_);
+  dgr_fiber dgr_f_client(io_service_client_);
+
+  boost::system::error_code ec;
+  dgr_f_server.open(endpoint_server_local_port.protocol(), ec);
+  dgr_f_server.bind(endpoint_server_local_port, ec);
+  ASSERT_EQ(ec.value(), 0);
+  dgr_f_server.set_option(
+      boost::asio::fiber::datagram_queue(
+          max_datagrams, boost::asio::fiber::datagram_queue::drop_oldest),
+      ec);
+  ASSERT_EQ(ec.value(), 0);
+
+  // All the datagrams are sent at once, without waiting for any reply
+  std::vector<std::array<uint8_t, 64>> buffers_client(number_of_datagrams);
+  std::atomic<uint32_t> sent_count(0);
+  std::atomic<uint32_t> send_errors_count(0);
+  std::promise<void> all_sent;
+  for (uint32_t i = 0; i < number_of_datagrams; ++i) {
+    buffers_client[i].fill(static_cast<uint8_t>(i));
+    dgr_f_client.async_send_to(
+        boost::asio::buffer(buffers_client[i]), endpoint_client_remote_port,
+        [&](const boost::system::error_code& sent_ec, size_t length) {
+          if (sent_ec) {
+            ++send_errors_count;
+          }
+          if (++sent_count == number_of_datagrams) {
+            all_sent.set_value();
+          }
+        });
+  }
+
+  // The server reads slower than the datagrams arrive until the queue is
+  // drained
+  boost::asio::fiber::datagram_queue_stats stats;
+  dgr_fiber_endpoint endpoint_server_from(
+      boost::asio::fiber::datagram_fiber<socket>::v1(), demux_server_);
+  std::array<uint8_t, 64> buffer_server;
+  bool reads_timed_out = false;
+  while (true) {
+    dgr_f_server.get_option(stats, ec);
+    if (stats.received() == number_of_datagrams &&
+        stats.delivered() + stats.dropped() == stats.received()) {
+      break;
+    }
+
+    auto p_received = std::make_shared<std::promise<void>>();
+    dgr_f_server.async_receive_from(
+        boost::asio::buffer(buffer_server), endpoint_server_from,
+        [p_received](const boost::system::error_code& received_ec,
+                     size_t length) { p_received->set_value(); });
+    if (p_received->get_future().wait_for(std::chrono::seconds(5)) ==
+        std::future_status::timeout) {
+      reads_timed_out = true;
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(500));
+  }
+
+  all_sent.get_future().wait();
+  EXPECT_EQ(send_errors_count.load(), 0U)
+      << "Sent handlers should not be in error";
+  EXPECT_FALSE(reads_timed_out) << "Datagrams missing on the server fiber";
+
+  dgr_f_server.get_option(stats, ec);
+  EXPECT_EQ(stats.received(), number_of_datagrams);
+  EXPECT_GT(stats.dropped(), 0U) << "The flood should overflow the queue";
+  EXPECT_EQ(stats.delivered() + stats.dropped(), stats.received());
+  // Only the last max_datagrams datagrams wait, the delay does not grow with
+  // the flood
+  EXPECT_LT(stats.max_delay_us(), 500000U);
+
+  dgr_f_client.close();
+  dgr_f_server.close();
+}
+
 //----------------------------------------------------------------------------
 TEST_F(FiberTest, TLSConnectDisconnectFiberFromClient) {
   Wait();
@@ -1096,3 +1659,438 @@ TEST_F(FiberTest, TLSConnectDisconnectFiberFromClient) {
   ssl_fiber_server.next_layer().close(ec);
   fib_acceptor.close(ec);
 }
+
+//-----------------------------------------------------------------------------
+TEST_F(FiberTest, FiberQuotaRejectsFibersOverLimit) {
+  Wait();
+
+  // The acceptor counts as one bound fiber
+  const uint32_t max_fibers = 3;
+  const uint32_t number_of_connections = 5;
+
+  auto p_quotas = demux_server_.quotas();
+  ASSERT_TRUE(!!p_quotas) << "Quotas should be available once fiberized";
+  fiber_demux::quota_limits_type limits;
+  limits.max_fibers = max_fibers;
+  p_quotas->set_limits(limits);
+
+  fiber_acceptor fib_acceptor(io_service_server_);
+  std::vector<std::unique_ptr<fiber>> server_fibers;
+  std::vector<std::unique_ptr<fiber>> client_fibers;
+
+  boost::system::error_code acceptor_ec;
+  fiber_endpoint fib_server_endpoint(
+      boost::asio::fiber::stream_fiber<socket>::v1(), demux_server_, 1);
+  fib_acceptor.open(fib_server_endpoint.protocol());
+  fib_acceptor.bind(fib_server_endpoint, acceptor_ec);
+  fib_acceptor.listen();
+  ASSERT_EQ(acceptor_ec.value(), 0) << "Acceptor should be bound";
+
+  uint32_t number_of_connected = 0;
+  for (uint32_t i = 0; i < number_of_connections; ++i) {
+    std::promise<boost::system::error_code> connected;
+    if (i < max_fibers - 1) {
+      server_fibers.emplace_back(new fiber(io_service_server_));
+      auto accepted_lambda = [](const boost::system::error_code& ec) {
+        EXPECT_EQ(ec.value(), 0) << "Accept handler should not be in error";
+      };
+      fib_acceptor.async_accept(*server_fibers.back(),
+                                std::move(accepted_lambda));
+    }
+
+    client_fibers.emplace_back(new fiber(io_service_client_));
+    fiber_endpoint fib_client_endpoint(
+        boost::asio::fiber::stream_fiber<socket>::v1(), demux_client_, 1);
+    client_fibers.back()->async_connect(
+        fib_client_endpoint,
+        [&connected](const boost::system::error_code& ec) {
+          connected.set_value(ec);
+        });
+
+    if (!connected.get_future().get()) {
+      ++number_of_connected;
+    }
+  }
+
+  ASSERT_EQ(number_of_connected, max_fibers - 1)
+      << "Fibers over the limit should be refused";
+  ASSERT_EQ(p_quotas->rejected_fibers(),
+            static_cast<uint64_t>(number_of_connections - max_fibers + 1));
+
+  boost::system::error_code ec;
+  for (auto& p_fiber : client_fibers) {
+    p_fiber->close(ec);
+  }
+  for (auto& p_fiber : server_fibers) {
+    p_fiber->close(ec);
+  }
+  fib_acceptor.close(ec);
+}
+
+//-----------------------------------------------------------------------------
+TEST_F(FiberTest, FiberQuotaThrottlesBufferedBytes) {
+  Wait();
+
+  // Far below the per fiber threshold: only the quota pauses the sender
+  const uint64_t max_buffered_bytes = 64 * 1024;
+  const std::size_t data_size = 32 * 1024 * 1024;
+
+  auto p_quotas = demux_server_.quotas();
+  ASSERT_TRUE(!!p_quotas) << "Quotas should be available once fiberized";
+  fiber_demux::quota_limits_type limits;
+  limits.max_buffered_bytes = max_buffered_bytes;
+  p_quotas->set_limits(limits);
+
+  fiber_acceptor fib_acceptor(io_service_server_);
+  fiber fib_server(io_service_server_);
+  fiber fib_client(io_service_client_);
+  std::promise<boost::system::error_code> accepted;
+  std::promise<boost::system::error_code> connected;
+  std::promise<boost::system::error_code> client_sent;
+  std::promise<boost::system::error_code> server_received;
+
+  boost::system::error_code acceptor_ec;
+  fiber_endpoint server_endpoint(boost::asio::fiber::stream_fiber<socket>::v1(),
+                                 demux_server_, 2);
+  fib_acceptor.open(server_endpoint.protocol(), acceptor_ec);
+  fib_acceptor.bind(server_endpoint, acceptor_ec);
+  fib_acceptor.listen(boost::asio::socket_base::max_connections, acceptor_ec);
+  fib_acceptor.async_accept(fib_server,
+                            [&accepted](const boost::system::error_code& ec) {
+                              accepted.set_value(ec);
+                            });
+
+  fiber_endpoint client_endpoint(boost::asio::fiber::stream_fiber<socket>::v1(),
+                                 demux_client_, 2);
+  fib_client.async_connect(client_endpoint,
+                           [&connected](const boost::system::error_code& ec) {
+                             connected.set_value(ec);
+                           });
+  ASSERT_EQ(connected.get_future().get().value(), 0);
+  ASSERT_EQ(accepted.get_future().get().value(), 0);
+
+  // The server does not read: the client is paused once the quota is
+  // exceeded
+  std::vector<uint8_t> buffer_client(data_size, 1);
+  boost::asio::async_write(
+      fib_client, boost::asio::buffer(buffer_client),
+      [&client_sent](const boost::system::error_code& ec, std::size_t) {
+        client_sent.set_value(ec);
+      });
+  auto client_sent_future = client_sent.get_future();
+  EXPECT_EQ(client_sent_future.wait_for(std::chrono::seconds(1)),
+            std::future_status::timeout)
+      << "The client should be paused by the buffered bytes quota";
+  EXPECT_GT(p_quotas->throttled_fibers(), 0U);
+  EXPECT_LT(p_quotas->buffered_bytes(), static_cast<uint64_t>(data_size));
+
+  // Reading resumes the client
+  std::vector<uint8_t> buffer_server(data_size, 0);
+  boost::asio::async_read(
+      fib_server, boost::asio::buffer(buffer_server),
+      [&server_received](const boost::system::error_code& ec, std::size_t) {
+        server_received.set_value(ec);
+      });
+  EXPECT_EQ(client_sent_future.get().value(), 0);
+  EXPECT_EQ(server_received.get_future().get().value(), 0);
+  EXPECT_EQ(buffer_server, buffer_client);
+  EXPECT_EQ(p_quotas->buffered_bytes(), 0U);
+
+  boost::system::error_code close_ec;
+  fib_client.close(close_ec);
+  fib_server.close(close_ec);
+  fib_acceptor.close(close_ec);
+}
+
+//-----------------------------------------------------------------------------
+TEST_F(FiberTest, FiberQuotaRejectsSynsOverRate) {
+  Wait();
+
+  const uint32_t max_syn_per_second = 2;
+  const uint32_t number_of_connections = 6;
+
+  auto p_quotas = demux_server_.quotas();
+  ASSERT_TRUE(!!p_quotas) << "Quotas should be available once fiberized";
+  fiber_demux::quota_limits_type limits;
+  limits.max_syn_per_second = max_syn_per_second;
+  p_quotas->set_limits(limits);
+
+  fiber_acceptor fib_acceptor(io_service_server_);
+  std::vector<std::unique_ptr<fiber>> server_fibers;
+  std::vector<std::unique_ptr<fiber>> client_fibers;
+
+  boost::system::error_code acceptor_ec;
+  fiber_endpoint fib_server_endpoint(
+      boost::asio::fiber::stream_fiber<socket>::v1(), demux_server_, 3);
+  fib_acceptor.open(fib_server_endpoint.protocol());
+  fib_acceptor.bind(fib_server_endpoint, acceptor_ec);
+  fib_acceptor.listen();
+  ASSERT_EQ(acceptor_ec.value(), 0) << "Acceptor should be bound";
+
+  auto connect = [&]() {
+    server_fibers.emplace_back(new fiber(io_service_server_));
+    fib_acceptor.async_accept(*server_fibers.back(),
+                              [](const boost::system::error_code&) {});
+
+    std::promise<boost::system::error_code> connected;
+    client_fibers.emplace_back(new fiber(io_service_client_));
+    fiber_endpoint fib_client_endpoint(
+        boost::asio::fiber::stream_fiber<socket>::v1(), demux_client_, 3);
+    client_fibers.back()->async_connect(
+        fib_client_endpoint,
+        [&connected](const boost::system::error_code& ec) {
+          connected.set_value(ec);
+        });
+    return !connected.get_future().get();
+  };
+
+  // A burst spans at most two one second windows
+  uint32_t number_of_connected = 0;
+  for (uint32_t i = 0; i < number_of_connections; ++i) {
+    if (connect()) {
+      ++number_of_connected;
+    }
+  }
+  EXPECT_LE(number_of_connected, 2 * max_syn_per_second)
+      << "Connection requests over the rate should be refused";
+  EXPECT_EQ(p_quotas->rejected_syns(),
+            static_cast<uint64_t>(number_of_connections - number_of_connected));
+
+  // The next window accepts connections again
+  std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+  EXPECT_TRUE(connect()) << "The rate limit should reset every second";
+
+  boost::system::error_code ec;
+  for (auto& p_fiber : client_fibers) {
+    p_fiber->close(ec);
+  }
+  for (auto& p_fiber : server_fibers) {
+    p_fiber->close(ec);
+  }
+  fib_acceptor.close(ec);
+}
+
+//-----------------------------------------------------------------------------
+TEST_F(FiberTest, FiberQuotaDropsDatagramsOverBufferedBytes) {
+  Wait();
+
+  const uint64_t max_buffered_bytes = 4 * 1024;
+  const std::size_t datagram_size = 1024;
+  const uint32_t number_of_datagrams = 20;
+  const uint32_t port = (1 << 16) + 5;
+
+  auto p_quotas = demux_server_.quotas();
+  ASSERT_TRUE(!!p_quotas) << "Quotas should be available once fiberized";
+  fiber_demux::quota_limits_type limits;
+  limits.max_buffered_bytes = max_buffered_bytes;
+  p_quotas->set_limits(limits);
+
+  dgr_fiber_endpoint endpoint_server_local_port(
+      boost::asio::fiber::datagram_fiber<socket>::v1(), demux_server_, port);
+  dgr_fiber_endpoint endpoint_client_remote_port(
+      boost::asio::fiber::datagram_fiber<socket>::v1(), demux_client_, port);
+  dgr_fiber dgr_f_server(io_service_server_);
+  dgr_fiber dgr_f_client(io_service_client_);
+
+  boost::system::error_code ec;
+  dgr_f_server.open(endpoint_server_local_port.protocol(), ec);
+  dgr_f_server.bind(endpoint_server_local_port, ec);
+  ASSERT_EQ(ec.value(), 0);
+
+  // The server does not read while the datagrams are sent
+  std::vector<uint8_t> buffer_client(datagram_size, 1);
+  for (uint32_t i = 0; i < number_of_datagrams; ++i) {
+    std::promise<boost::system::error_code> sent;
+    dgr_f_client.async_send_to(
+        boost::asio::buffer(buffer_client), endpoint_client_remote_port,
+        [&sent](const boost::system::error_code& sent_ec, std::size_t) {
+          sent.set_value(sent_ec);
+        });
+    EXPECT_EQ(sent.get_future().get().value(), 0);
+  }
+
+  boost::asio::fiber::datagram_queue_stats stats;
+  for (int retry = 0; retry < 100; ++retry) {
+    dgr_f_server.get_option(stats, ec);
+    if (stats.received() == number_of_datagrams) {
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(stats.received(), number_of_datagrams);
+  EXPECT_GT(stats.dropped(), 0U) << "Datagrams over the quota are dropped";
+  EXPECT_EQ(p_quotas->dropped_datagrams(), stats.dropped());
+  EXPECT_LE(p_quotas->buffered_bytes(), max_buffered_bytes + datagram_size)
+      << "Buffered datagrams should stay within the quota";
+
+  // The datagrams kept can still be read
+  dgr_fiber_endpoint endpoint_server_from(
+      boost::asio::fiber::datagram_fiber<socket>::v1(), demux_server_);
+  std::vector<uint8_t> buffer_server(datagram_size);
+  std::promise<std::size_t> received;
+  dgr_f_server.async_receive_from(
+      boost::asio::buffer(buffer_server), endpoint_server_from,
+      [&received](const boost::system::error_code& received_ec,
+                  std::size_t length) {
+        received.set_value(received_ec ? 0 : length);
+      });
+  EXPECT_EQ(received.get_future().get(), datagram_size);
+
+  dgr_f_client.close();
+  dgr_f_server.close();
+}
+
+//-----------------------------------------------------------------------------
+TEST_F(FiberTest, FiberQuotaContainsNoisyClient) {
+  Wait();
+
+  // The fixture demuxes carry the noisy client, a second connection to the
+  // same server io_service carries the quiet one
+  const uint64_t max_buffered_bytes = 1024 * 1024;
+  const std::size_t flood_size = 64 * 1024 * 1024;
+  const uint32_t number_of_round_trips = 50;
+
+  auto p_noisy_quotas = demux_server_.quotas();
+  ASSERT_TRUE(!!p_noisy_quotas) << "Quotas should be available once fiberized";
+  fiber_demux::quota_limits_type limits;
+  limits.max_buffered_bytes = max_buffered_bytes;
+  p_noisy_quotas->set_limits(limits);
+
+  boost::asio::ip::tcp::endpoint quiet_endpoint(
+      boost::asio::ip::address_v4::loopback(), 9012);
+  boost::asio::ip::tcp::acceptor quiet_acceptor(io_service_server_,
+                                                quiet_endpoint);
+  boost::asio::ip::tcp::socket quiet_server_socket(io_service_server_);
+  boost::asio::ip::tcp::socket quiet_client_socket(io_service_client_);
+  std::promise<boost::system::error_code> quiet_accepted;
+  quiet_acceptor.async_accept(
+      quiet_server_socket,
+      [&quiet_accepted](const boost::system::error_code& ec) {
+        quiet_accepted.set_value(ec);
+      });
+  boost::system::error_code quiet_ec;
+  quiet_client_socket.connect(quiet_endpoint, quiet_ec);
+  ASSERT_EQ(quiet_ec.value(), 0);
+  ASSERT_EQ(quiet_accepted.get_future().get().value(), 0);
+
+  fiber_demux quiet_demux_server(io_service_server_);
+  fiber_demux quiet_demux_client(io_service_client_);
+  quiet_demux_server.fiberize(std::move(quiet_server_socket));
+  quiet_demux_client.fiberize(std::move(quiet_client_socket));
+
+  // Connect one fiber on each demux
+  auto connect_fibers = [](fiber_demux& demux_server, fiber_demux& demux_client,
+                           fiber_acceptor& fib_acceptor, fiber& fib_server,
+                           fiber& fib_client) {
+    std::promise<boost::system::error_code> accepted;
+    std::promise<boost::system::error_code> connected;
+    boost::system::error_code acceptor_ec;
+    fiber_endpoint server_endpoint(
+        boost::asio::fiber::stream_fiber<socket>::v1(), demux_server, 4);
+    fib_acceptor.open(server_endpoint.protocol(), acceptor_ec);
+    fib_acceptor.bind(server_endpoint, acceptor_ec);
+    fib_acceptor.listen(boost::asio::socket_base::max_connections,
+                        acceptor_ec);
+    fib_acceptor.async_accept(fib_server,
+                              [&accepted](const boost::system::error_code& ec) {
+                                accepted.set_value(ec);
+                              });
+
+    fiber_endpoint client_endpoint(
+        boost::asio::fiber::stream_fiber<socket>::v1(), demux_client, 4);
+    fib_client.async_connect(client_endpoint,
+                             [&connected](const boost::system::error_code& ec) {
+                               connected.set_value(ec);
+                             });
+    return !connected.get_future().get() && !accepted.get_future().get();
+  };
+
+  fiber_acceptor noisy_acceptor(io_service_server_);
+  fiber noisy_server(io_service_server_);
+  fiber noisy_client(io_service_client_);
+  ASSERT_TRUE(connect_fibers(demux_server_, demux_client_, noisy_acceptor,
+                             noisy_server, noisy_client));
+
+  fiber_acceptor quiet_acceptor_fiber(io_service_server_);
+  fiber quiet_server(io_service_server_);
+  fiber quiet_client(io_service_client_);
+  ASSERT_TRUE(connect_fibers(quiet_demux_server, quiet_demux_client,
+                             quiet_acceptor_fiber, quiet_server, quiet_client));
+
+  // The noisy client floods a fiber which is never read
+  auto p_flood = std::make_shared<std::vector<uint8_t>>(flood_size, 1);
+  boost::asio::async_write(
+      noisy_client, boost::asio::buffer(*p_flood),
+      [p_flood](const boost::system::error_code&, std::size_t) {});
+
+  // The quiet server echoes
+  std::array<uint8_t, 4> echo_buffer;
+  std::function<void(const boost::system::error_code&, std::size_t)> echo_h;
+  echo_h = [&](const boost::system::error_code& ec, std::size_t) {
+    if (ec) {
+      return;
+    }
+    boost::asio::async_write(
+        quiet_server, boost::asio::buffer(echo_buffer),
+        [&](const boost::system::error_code& ec, std::size_t) {
+          if (!ec) {
+            boost::asio::async_read(quiet_server,
+                                    boost::asio::buffer(echo_buffer), echo_h);
+          }
+        });
+  };
+  boost::asio::async_read(quiet_server, boost::asio::buffer(echo_buffer),
+                          echo_h);
+
+  // The quiet client round trips are not slowed down by the flood
+  std::array<uint8_t, 4> request = {{1, 2, 3, 4}};
+  std::array<uint8_t, 4> reply;
+  auto max_round_trip = std::chrono::steady_clock::duration::zero();
+  uint32_t round_trips = 0;
+  for (; round_trips < number_of_round_trips; ++round_trips) {
+    auto start = std::chrono::steady_clock::now();
+    std::promise<boost::system::error_code> replied;
+    boost::asio::async_write(
+        quiet_client, boost::asio::buffer(request),
+        [&](const boost::system::error_code& ec, std::size_t) {
+          if (ec) {
+            replied.set_value(ec);
+            return;
+          }
+          boost::asio::async_read(
+              quiet_client, boost::asio::buffer(reply),
+              [&replied](const boost::system::error_code& ec, std::size_t) {
+                replied.set_value(ec);
+              });
+        });
+    auto replied_future = replied.get_future();
+    if (replied_future.wait_for(std::chrono::seconds(5)) ==
+            std::future_status::timeout ||
+        replied_future.get()) {
+      break;
+    }
+    max_round_trip =
+        std::max(max_round_trip, std::chrono::steady_clock::now() - start);
+    EXPECT_EQ(reply, request);
+  }
+
+  EXPECT_EQ(round_trips, number_of_round_trips)
+      << "The quiet client should be served during the flood";
+  EXPECT_LT(max_round_trip, std::chrono::milliseconds(500))
+      << "The flood should not delay the quiet client";
+  EXPECT_GT(p_noisy_quotas->throttled_fibers(), 0U)
+      << "The noisy client should be throttled";
+  EXPECT_LT(p_noisy_quotas->buffered_bytes(), static_cast<uint64_t>(flood_size))
+      << "The noisy client should not buffer its whole flood";
+
+  boost::system::error_code close_ec;
+  quiet_client.close(close_ec);
+  quiet_server.close(close_ec);
+  quiet_acceptor_fiber.close(close_ec);
+  noisy_client.close(close_ec);
+  noisy_server.close(close_ec);
+  noisy_acceptor.close(close_ec);
+  quiet_demux_client.close();
+  quiet_demux_server.close();
+  quiet_acceptor.close(close_ec);
+}
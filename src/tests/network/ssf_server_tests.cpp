@@ -1,3 +1,5 @@
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
 
@@ -98,3 +100,58 @@ TEST_F(SSFFixtureTest, buggyConnectionTest) {
   StopClient();
   StopServer();
 }
+
+TEST_F(SSFFixtureTest, drainServerTest) {
+  int server_port = 8500;
+  boost::system::error_code server_ec;
+  StartServer("127.0.0.1", std::to_string(server_port), server_ec);
+  ASSERT_EQ(0, server_ec.value());
+
+  boost::system::error_code timer_ec;
+  auto timer_callback = [this](const boost::system::error_code& ec) {
+    EXPECT_NE(0, ec.value()) << "Timer should be canceled. Drain is hanging";
+    if (!ec) {
+      SendNotification(false);
+    }
+  };
+  StartTimer(std::chrono::seconds(10), timer_callback, timer_ec);
+  ASSERT_EQ(0, timer_ec.value()) << "Could not start timer";
+
+  std::atomic<bool> draining(false);
+  auto on_drained = [this, &draining]() { SendNotification(draining); };
+
+  auto client_callback = [this, &draining, &on_drained](ssf::Status status) {
+    switch (status) {
+      case ssf::Status::kEndpointNotResolvable:
+      case ssf::Status::kServerUnreachable:
+      case ssf::Status::kServerNotSupported:
+        SSF_LOG("test", critical, "Client initialization failed");
+        SendNotification(false);
+        break;
+      case ssf::Status::kRunning:
+        if (!draining) {
+          p_ssf_server_->Drain(std::chrono::seconds(5), on_drained);
+        }
+        break;
+      case ssf::Status::kDraining:
+        SSF_LOG("test", info, "client: server draining");
+        draining = true;
+        break;
+      default:
+        break;
+    }
+  };
+
+  boost::system::error_code run_ec;
+  StartClient(std::to_string(server_port), client_callback, run_ec);
+  ASSERT_EQ(0, run_ec.value());
+
+  WaitNotification();
+
+  EXPECT_TRUE(IsNotificationSuccess())
+      << "Client not notified or connection not drained";
+
+  StopTimer();
+  StopClient();
+  StopServer();
+}
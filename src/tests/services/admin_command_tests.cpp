@@ -0,0 +1,88 @@
+#include <map>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "services/admin/admin_command.h"
+#include "services/admin/binary_codec.h"
+#include "services/admin/requests/create_service_request.h"
+#include "services/admin/requests/service_status.h"
+
+namespace {
+
+// Requests are only encoded and decoded, no demux is needed
+struct NoDemux {};
+
+const char* Data(const std::string& buffer) { return buffer.data(); }
+
+}  // unnamed namespace
+
+TEST(AdminCommandTests, HeaderTest) {
+  using ssf::services::admin::AdminCommand;
+  using ssf::services::admin::CommandHeader;
+
+  AdminCommand command(0x01020304, 2, std::string("abc"));
+  ASSERT_EQ(command.size(), CommandHeader::kSize + 3u);
+
+  std::string wire(
+      boost::asio::buffer_cast<const char*>(command.const_buffer()),
+      command.size());
+  ASSERT_EQ(wire[0], 0x01) << "serial is not big endian";
+  ASSERT_EQ(wire.substr(CommandHeader::kSize), "abc");
+
+  auto header = CommandHeader::Decode(Data(wire));
+  ASSERT_EQ(header.serial, 0x01020304u);
+  ASSERT_EQ(header.command_id, 2u);
+  ASSERT_EQ(header.size, 3u);
+}
+
+TEST(AdminCommandTests, TruncatedParametersTest) {
+  using ssf::services::admin::BinaryReader;
+  using ssf::services::admin::BinaryWriter;
+
+  std::string buffer;
+  BinaryWriter writer(&buffer);
+  writer.WriteStringMap({{"addr", "127.0.0.1"}, {"port", "8080"}});
+
+  std::map<std::string, std::string> values;
+  for (std::size_t size = 0; size < buffer.size(); ++size) {
+    BinaryReader reader(Data(buffer), size);
+    ASSERT_FALSE(reader.ReadStringMap(&values)) << "decoded " << size
+                                                << " bytes";
+    ASSERT_TRUE(reader.failed());
+  }
+
+  BinaryReader reader(Data(buffer), buffer.size());
+  ASSERT_TRUE(reader.ReadStringMap(&values));
+  ASSERT_EQ(values.size(), 2u);
+  ASSERT_EQ(values["addr"], "127.0.0.1");
+  ASSERT_EQ(values["port"], "8080");
+}
+
+TEST(AdminCommandTests, RequestsTest) {
+  using CreateServiceRequest =
+      ssf::services::admin::CreateServiceRequest<NoDemux>;
+  using ServiceStatus = ssf::services::admin::ServiceStatus<NoDemux>;
+
+  CreateServiceRequest request(7);
+  request.add_parameter("local_port", "9000");
+  request.add_parameter("remote_addr", "");
+  auto serialized_request = request.OnSending();
+
+  CreateServiceRequest decoded_request;
+  ASSERT_TRUE(decoded_request.Decode(Data(serialized_request),
+                                     serialized_request.size()));
+  ASSERT_EQ(decoded_request.service_id(), 7u);
+  ASSERT_EQ(decoded_request.parameters(), request.parameters());
+
+  ServiceStatus status(12, 7, 0, {{"local_port", "9000"}});
+  auto serialized_status = status.OnSending();
+
+  ServiceStatus decoded_status;
+  ASSERT_TRUE(
+      decoded_status.Decode(Data(serialized_status), serialized_status.size()));
+  ASSERT_EQ(decoded_status.id(), 12u);
+  ASSERT_EQ(decoded_status.service_id(), 7u);
+  ASSERT_EQ(decoded_status.error_code_value(), 0u);
+  ASSERT_EQ(decoded_status.parameters(), status.parameters());
+}
@@ -0,0 +1,161 @@
+#include <istream>
+#include <string>
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/asio/read_until.hpp>
+#include <boost/asio/streambuf.hpp>
+#include <boost/asio/write.hpp>
+
+#include <json.hpp>
+
+#include "core/client/control_api.h"
+#include "core/command_line/user_service_option_factory.h"
+#include "services/user_services/port_forwarding.h"
+
+#include "tests/services/service_fixture_test.h"
+
+class ControlApiTest
+    : public ServiceFixtureTest<ssf::services::PortForwarding> {
+ public:
+  using Json = nlohmann::json;
+  using Protocol = boost::asio::local::stream_protocol;
+
+ public:
+  ControlApiTest()
+      : api_path_("./control_api_test.sock"),
+        io_service_(),
+        socket_(io_service_),
+        replies_() {}
+
+ protected:
+  ssf::UserServiceParameters CreateUserServiceParameters(
+      boost::system::error_code& ec) override {
+    return {{ServiceTested::GetParseName(),
+             {{{"from_addr", ""},
+               {"from_port", "7480"},
+               {"to_addr", "127.0.0.1"},
+               {"to_port", "7580"}}}}};
+  }
+
+  void StartApi(boost::system::error_code& ec) {
+    option_factory_.Register<ServiceTested>();
+    p_api_ = ssf::ControlApi::Create(p_ssf_client_.get(), &option_factory_,
+                                     api_path_);
+    p_api_->Start(ec);
+    if (ec) {
+      return;
+    }
+    socket_.connect(Protocol::endpoint(api_path_), ec);
+  }
+
+  void StopApi() {
+    boost::system::error_code ec;
+    socket_.close(ec);
+    if (p_api_) {
+      p_api_->Stop();
+    }
+  }
+
+  void Send(const std::string& lines) {
+    boost::system::error_code ec;
+    boost::asio::write(socket_, boost::asio::buffer(lines), ec);
+    ASSERT_EQ(ec.value(), 0) << "Fail to write to the API socket";
+  }
+
+  Json Receive() {
+    boost::system::error_code ec;
+    boost::asio::read_until(socket_, replies_, '\n', ec);
+    if (ec) {
+      return Json();
+    }
+
+    std::istream replies_stream(&replies_);
+    std::string line;
+    std::getline(replies_stream, line);
+    return Json::parse(line);
+  }
+
+  // Count the listed services forwarding from_port
+  std::size_t CountListed(const Json& reply, const std::string& from_port) {
+    std::size_t count = 0;
+    auto services_it = reply.find("services");
+    if (services_it == reply.end()) {
+      return count;
+    }
+
+    for (const auto& service : *services_it) {
+      auto parameters_it = service.find("parameters");
+      if (service.value("service", "") == ServiceTested::GetParseName() &&
+          parameters_it != service.end() &&
+          parameters_it->value("from_port", "") == from_port) {
+        ++count;
+      }
+    }
+    return count;
+  }
+
+ protected:
+  std::string api_path_;
+  ssf::UserServiceOptionFactory option_factory_;
+  ssf::ControlApi::ControlApiPtr p_api_;
+  boost::asio::io_service io_service_;
+  Protocol::socket socket_;
+  boost::asio::streambuf replies_;
+};
+
+TEST_F(ControlApiTest, AddRemoveListWatch) {
+  ASSERT_TRUE(Wait());
+
+  boost::system::error_code ec;
+  StartApi(ec);
+  ASSERT_EQ(ec.value(), 0) << "Could not start the control API";
+
+  // pipelined requests get their replies in order
+  Send(
+      "{\"id\": 1, \"op\": \"add\", \"service\": \"L\", "
+      "\"value\": \"7481:127.0.0.1:7580\"}\n"
+      "{\"id\": 2, \"op\": \"list\"}\n"
+      "{\"id\": 3, \"op\": \"remove\", \"service\": \"tcp-forward\", "
+      "\"value\": \"7481:127.0.0.1:7580\"}\n"
+      "{\"id\": 4, \"op\": \"remove\", \"service\": \"L\", "
+      "\"value\": \"7481:127.0.0.1:7580\"}\n"
+      "{\"id\": 5, \"op\": \"list\"}\n");
+
+  auto reply = Receive();
+  EXPECT_EQ(reply["id"], 1);
+  EXPECT_EQ(reply["ok"], true) << "The service should be added";
+
+  reply = Receive();
+  EXPECT_EQ(reply["id"], 2);
+  EXPECT_EQ(reply["services"].size(), 2U);
+  EXPECT_EQ(CountListed(reply, "7480"), 1U);
+  EXPECT_EQ(CountListed(reply, "7481"), 1U);
+
+  reply = Receive();
+  EXPECT_EQ(reply["id"], 3);
+  EXPECT_EQ(reply["ok"], true) << "The service should be removed";
+
+  reply = Receive();
+  EXPECT_EQ(reply["id"], 4);
+  EXPECT_EQ(reply["ok"], false) << "The service was already removed";
+
+  reply = Receive();
+  EXPECT_EQ(reply["id"], 5);
+  EXPECT_EQ(reply["services"].size(), 1U);
+  EXPECT_EQ(CountListed(reply, "7480"), 1U);
+
+  Send("{\"id\": 6, \"op\": \"watch\", \"interval_ms\": 10}\n");
+  reply = Receive();
+  EXPECT_EQ(reply["id"], 6);
+  EXPECT_EQ(reply["ok"], true);
+
+  reply = Receive();
+  EXPECT_EQ(reply["event"], "metrics");
+  EXPECT_EQ(reply["metrics"]["connected"], true);
+  EXPECT_EQ(reply["metrics"]["services"]["running"], 1);
+
+  Send("{\"id\": 7, \"op\": \"unwatch\"}\n");
+
+  StopApi();
+}
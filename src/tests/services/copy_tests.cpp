@@ -1,5 +1,8 @@
 #include "tests/services/copy_fixture_test.h"
 
+#include "core/client/control_client.h"
+#include "core/client/control_master.h"
+
 TEST_F(CopyFixtureTest, CopyNoFileFromClientToServerTest) {
   std::string server_port("6050");
   StartServer(server_port);
@@ -441,4 +444,40 @@ TEST_F(CopyFixtureTest, InvalidResumeCopyFromServerToClientTest) {
   ASSERT_TRUE(WaitClose());
 
   ASSERT_FALSE(AreFilesEqual(input_file, output_file));
-}
\ No newline at end of file
+}
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+TEST_F(CopyFixtureTest, CopyThroughControlMasterTest) {
+  std::string server_port("6600");
+
+  StartServer(server_port);
+  StartClient(server_port);
+
+  ASSERT_TRUE(Wait());
+
+  auto control_path = boost::filesystem::temp_directory_path() /
+                      boost::filesystem::unique_path("ssf_ctl_%%%%-%%%%");
+  auto p_control_master =
+      ssf::ControlMaster::Create(p_ssf_client_.get(), control_path.string());
+  boost::system::error_code ec;
+  p_control_master->Start(ec);
+  ASSERT_FALSE(ec) << "control master not started: " << ec.message();
+
+  ssf::Path file(GenerateRandomFile(GetInputDirectory().GetString(),
+                                    "test_file", ".txt", 1024 * 1024));
+  auto output_file = GetOutputDirectory();
+  output_file /= "output_file.txt";
+
+  ssf::services::copy::CopyRequest req(
+      false, false, false, true, 1, file.GetString(), output_file.GetString());
+  boost::system::error_code copy_ec;
+  ASSERT_TRUE(ssf::CopyThroughControlMaster(control_path.string(), true, req,
+                                            copy_ec, ec))
+      << "control master not reached: " << ec.message();
+  ASSERT_FALSE(copy_ec) << copy_ec.message();
+  ASSERT_TRUE(AreFilesEqual(file.GetString(), output_file.GetString()));
+
+  p_control_master->Stop();
+  ASSERT_FALSE(boost::filesystem::exists(control_path));
+}
+#endif
@@ -1,6 +1,8 @@
 #ifndef TESTS_SERVICES_DATAGRAM_FIXTURE_TEST_H_
 #define TESTS_SERVICES_DATAGRAM_FIXTURE_TEST_H_
 
+#include <algorithm>
+#include <chrono>
 #include <functional>
 #include <list>
 #include <mutex>
@@ -15,12 +17,19 @@
 template <template <typename> class TServiceTested>
 class DatagramFixtureTest : public ServiceFixtureTest<TServiceTested> {
  protected:
-  void Run(const std::string& in_port, const std::string& server_port) {
+  // Run clients_count clients in parallel, client i downloading i * size_step
+  // bytes one datagram at a time
+  // Returns the longest round trip of a datagram seen by the clients
+  std::chrono::microseconds Run(const std::string& in_port,
+                                const std::string& server_port,
+                                int clients_count = 6,
+                                size_t size_step = 1024 * 1024) {
     std::list<std::promise<bool>> clients_finish;
 
     std::recursive_mutex mutex;
+    std::chrono::microseconds max_round_trip(0);
 
-    auto download = [&mutex, &in_port, &server_port](
+    auto download = [&mutex, &in_port, &server_port, &max_round_trip](
         size_t size, std::promise<bool>& test_client) {
       tests::udp::DummyClient client("127.0.0.1", in_port, size);
       auto initiated = client.Init();
@@ -35,6 +44,7 @@ class DatagramFixtureTest : public ServiceFixtureTest<TServiceTested> {
       {
         std::unique_lock<std::recursive_mutex> lock(mutex);
         EXPECT_TRUE(received);
+        max_round_trip = std::max(max_round_trip, client.max_round_trip());
       }
 
       client.Stop();
@@ -46,11 +56,11 @@ class DatagramFixtureTest : public ServiceFixtureTest<TServiceTested> {
 
     std::vector<std::thread> client_test_threads;
 
-    for (int i = 0; i < 6; ++i) {
+    for (int i = 0; i < clients_count; ++i) {
       clients_finish.emplace_front();
       std::promise<bool>& client_finish = clients_finish.front();
       client_test_threads.emplace_back(
-          std::bind<void>(download, 1024 * 1024 * i, std::ref(client_finish)));
+          std::bind<void>(download, size_step * i, std::ref(client_finish)));
     }
 
     for (auto& thread : client_test_threads) {
@@ -64,6 +74,8 @@ class DatagramFixtureTest : public ServiceFixtureTest<TServiceTested> {
     }
 
     serv.Stop();
+
+    return max_round_trip;
   }
 };
 
@@ -20,6 +20,18 @@ TEST_F(UdpForwardTest, MultiDatagrams) {
   Run("8484", "8585");
 }
 
+// Many clients at once keep datagrams queued on every fiber of the forwarding
+// path: the bounded fiber queues must keep the round trips short
+TEST_F(UdpForwardTest, ManyDatagramsLatency) {
+  ASSERT_TRUE(Wait());
+
+  auto max_round_trip = Run("8484", "8585", 48, 256 * 1024);
+
+  SSF_LOG("test", info, "udp forward: max round trip {} us",
+          max_round_trip.count());
+  EXPECT_LT(max_round_trip, std::chrono::seconds(2));
+}
+
 class UdpForwardWildcardTest : public UdpForwardTest {
   void SetServerConfig(ssf::config::Config& config) override {
     const char* new_config = R"RAWSTRING(
@@ -0,0 +1,161 @@
+#include <signal.h>
+
+#include <cerrno>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/connect.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+
+#include <gtest/gtest.h>
+
+#include "services/exec/frame.h"
+#include "services/user_services/exec.h"
+
+#include "tests/services/service_fixture_test.h"
+
+class ExecTest : public ServiceFixtureTest<ssf::services::Exec> {
+  void SetServerConfig(ssf::config::Config& config) override {
+    boost::system::error_code ec;
+
+    const char* new_config = R"RAWSTRING(
+{
+    "ssf": {
+        "services" : {
+            "exec": { "enable": true }
+        }
+    }
+}
+)RAWSTRING";
+
+    config.UpdateFromString(new_config, ec);
+    ASSERT_EQ(ec.value(), 0) << "Could not update server config from string "
+                             << new_config;
+  }
+
+  ssf::UserServiceParameters CreateUserServiceParameters(
+      boost::system::error_code& ec) override {
+    return {
+        {ServiceTested::GetParseName(), {{{"addr", ""}, {"port", "9091"}}}}};
+  }
+
+ protected:
+  // Run the command and gather its outputs until its exit status
+  void RunCommand(const std::string& command, std::string* p_out,
+                  std::string* p_err, uint32_t* p_exit_status) {
+    using ssf::services::exec::FrameHeader;
+    using ssf::services::exec::FrameType;
+
+    ASSERT_TRUE(this->Wait());
+
+    boost::asio::io_service io_service;
+    boost::asio::ip::tcp::socket socket(io_service);
+    boost::asio::ip::tcp::resolver r(io_service);
+    boost::asio::ip::tcp::resolver::query q("127.0.0.1", "9091");
+    boost::system::error_code ec;
+
+    boost::asio::connect(socket, r.resolve(q), ec);
+    ASSERT_EQ(ec.value(), 0) << "Fail to connect to client socket";
+
+    boost::asio::write(socket, boost::asio::buffer(command + "\n"), ec);
+    ASSERT_EQ(ec.value(), 0) << "Fail to write command";
+
+    while (true) {
+      FrameHeader header;
+      boost::asio::read(socket, header.GetMutBuf(), ec);
+      ASSERT_EQ(ec.value(), 0) << "Fail to read frame header";
+
+      std::vector<uint8_t> payload(header.length());
+      boost::asio::read(socket, boost::asio::buffer(payload), ec);
+      ASSERT_EQ(ec.value(), 0) << "Fail to read frame payload";
+
+      switch (header.type()) {
+        case FrameType::kStdout:
+          p_out->append(payload.begin(), payload.end());
+          break;
+        case FrameType::kStderr:
+          p_err->append(payload.begin(), payload.end());
+          break;
+        case FrameType::kExitStatus:
+          ASSERT_EQ(payload.size(), 4u);
+          *p_exit_status = FrameHeader::DecodeUint32(payload.data());
+          return;
+        default:
+          FAIL() << "Unknown frame type";
+      }
+    }
+  }
+};
+
+TEST_F(ExecTest, SeparateOutputsAndExitStatusTest) {
+  std::string out;
+  std::string err;
+  uint32_t exit_status = 0;
+
+  RunCommand("echo ssf_out; echo ssf_err >&2; exit 3", &out, &err,
+             &exit_status);
+
+  ASSERT_EQ(out, "ssf_out\n");
+  ASSERT_EQ(err, "ssf_err\n");
+  ASSERT_EQ(exit_status, 3u);
+}
+
+TEST_F(ExecTest, LargeOutputTest) {
+  std::string out;
+  std::string err;
+  uint32_t exit_status = 1;
+
+  RunCommand("head -c 4000000 /dev/zero", &out, &err, &exit_status);
+
+  ASSERT_EQ(out.size(), 4000000u);
+  ASSERT_TRUE(err.empty());
+  ASSERT_EQ(exit_status, 0u);
+}
+
+TEST_F(ExecTest, CommandIgnoringSigtermIsKilledTest) {
+  using ssf::services::exec::FrameHeader;
+  using ssf::services::exec::FrameType;
+
+  ASSERT_TRUE(this->Wait());
+
+  boost::asio::io_service io_service;
+  boost::asio::ip::tcp::socket socket(io_service);
+  boost::asio::ip::tcp::resolver r(io_service);
+  boost::asio::ip::tcp::resolver::query q("127.0.0.1", "9091");
+  boost::system::error_code ec;
+
+  boost::asio::connect(socket, r.resolve(q), ec);
+  ASSERT_EQ(ec.value(), 0) << "Fail to connect to client socket";
+
+  boost::asio::write(socket,
+                     boost::asio::buffer(std::string(
+                         "trap '' TERM; echo $$; exec sleep 30\n")),
+                     ec);
+  ASSERT_EQ(ec.value(), 0) << "Fail to write command";
+
+  FrameHeader header;
+  boost::asio::read(socket, header.GetMutBuf(), ec);
+  ASSERT_EQ(ec.value(), 0) << "Fail to read frame header";
+  ASSERT_EQ(header.type(), FrameType::kStdout);
+  std::string pid_line(header.length(), '\0');
+  boost::asio::read(socket, boost::asio::buffer(&pid_line[0], pid_line.size()),
+                    ec);
+  ASSERT_EQ(ec.value(), 0) << "Fail to read frame payload";
+  pid_t command_pid = static_cast<pid_t>(std::stoi(pid_line));
+
+  // stopping the session must not wait for the command, which is killed
+  // and reaped in the background
+  socket.close(ec);
+
+  bool reaped = false;
+  for (int retry = 0; retry < 100 && !reaped; ++retry) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    reaped = kill(command_pid, 0) != 0 && errno == ESRCH;
+  }
+  ASSERT_TRUE(reaped) << "The command should be killed and reaped";
+}
@@ -0,0 +1,99 @@
+#include <signal.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/io_service.hpp>
+
+#include <gtest/gtest.h>
+
+#include "services/process/posix/process_pool.h"
+
+class ProcessPoolTest : public ::testing::Test {
+ public:
+  using ProcessPool = ssf::services::process::posix::ProcessPool;
+  using ProcessPoolPtr = ssf::services::process::posix::ProcessPoolPtr;
+  using PtyProcess = ssf::services::process::posix::PtyProcess;
+
+ public:
+  ProcessPoolTest()
+      : io_service_(),
+        p_worker_(new boost::asio::io_service::work(io_service_)),
+        thread_() {}
+
+ protected:
+  void SetUp() override {
+    thread_ = std::thread([this]() { io_service_.run(); });
+  }
+
+  void TearDown() override {
+    p_worker_.reset();
+    thread_.join();
+  }
+
+  // Each test gets its own pool: pools are shared per binary and arguments
+  ProcessPoolPtr GetPool(const std::string& binary_args, uint32_t size) {
+    return ProcessPool::Get(io_service_, "/bin/sh", binary_args, size);
+  }
+
+  // Wait for the pool to hold the given number of idle processes
+  bool WaitIdle(ProcessPoolPtr p_pool, std::size_t count) {
+    for (int retry = 0; retry < 100; ++retry) {
+      if (p_pool->IdleProcesses().size() == count) {
+        return true;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    return false;
+  }
+
+  void Release(PtyProcess* p_process) {
+    ssf::services::process::posix::KillPtyProcess(io_service_, p_process);
+  }
+
+ protected:
+  boost::asio::io_service io_service_;
+  std::unique_ptr<boost::asio::io_service::work> p_worker_;
+  std::thread thread_;
+};
+
+TEST_F(ProcessPoolTest, TakeAndRefill) {
+  auto p_pool = GetPool("-i", 2);
+  ASSERT_TRUE(WaitIdle(p_pool, 2)) << "The pool should be filled";
+  auto idle = p_pool->IdleProcesses();
+
+  PtyProcess process;
+  ASSERT_TRUE(p_pool->Take(&process));
+  EXPECT_EQ(process.pid, idle.front()) << "The oldest process is taken";
+  EXPECT_NE(process.master_tty, -1);
+  EXPECT_EQ(kill(process.pid, 0), 0) << "The taken process should run";
+
+  EXPECT_TRUE(WaitIdle(p_pool, 2)) << "The pool should be refilled";
+  auto refilled = p_pool->IdleProcesses();
+  EXPECT_EQ(std::count(refilled.begin(), refilled.end(), process.pid), 0);
+
+  Release(&process);
+}
+
+TEST_F(ProcessPoolTest, ExitedIdleProcessIsSkipped) {
+  auto p_pool = GetPool("-i -s", 2);
+  ASSERT_TRUE(WaitIdle(p_pool, 2)) << "The pool should be filled";
+  auto idle = p_pool->IdleProcesses();
+
+  // an idle process killed from outside is reaped and never handed out
+  ASSERT_EQ(kill(idle.front(), SIGKILL), 0);
+  ASSERT_TRUE(WaitIdle(p_pool, 1)) << "The exited process should be reaped";
+
+  PtyProcess process;
+  ASSERT_TRUE(p_pool->Take(&process));
+  EXPECT_EQ(process.pid, idle.back());
+  EXPECT_EQ(kill(process.pid, 0), 0) << "The taken process should run";
+
+  EXPECT_TRUE(WaitIdle(p_pool, 2)) << "The pool should be refilled on take";
+
+  Release(&process);
+}
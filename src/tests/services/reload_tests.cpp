@@ -0,0 +1,185 @@
+#include <array>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/connect.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+
+#include "common/config/config.h"
+#include "services/user_services/port_forwarding.h"
+
+#include "tests/services/service_fixture_test.h"
+
+class ReloadTest : public ServiceFixtureTest<ssf::services::PortForwarding> {
+ public:
+  using Tcp = boost::asio::ip::tcp;
+
+ public:
+  ReloadTest() : io_service_(), acceptor_(io_service_) {}
+
+ protected:
+  ssf::UserServiceParameters CreateUserServiceParameters(
+      boost::system::error_code& ec) override {
+    return ForwardParameters({"7490", "7491"});
+  }
+
+  // Forward each local port to the target acceptor
+  ssf::UserServiceParameters ForwardParameters(
+      const std::vector<std::string>& from_ports) {
+    ssf::UserServiceParameters parameters;
+    auto& bags = parameters[ServiceTested::GetParseName()];
+    for (const auto& from_port : from_ports) {
+      bags.push_back({{"from_addr", ""},
+                      {"from_port", from_port},
+                      {"to_addr", "127.0.0.1"},
+                      {"to_port", "7590"}});
+    }
+    return parameters;
+  }
+
+  void Reload(const std::vector<std::string>& from_ports,
+              boost::system::error_code& ec) {
+    ssf::config::Config ssf_config;
+    ssf_config.Init();
+    p_ssf_client_->Reload(ForwardParameters(from_ports), ssf_config.services(),
+                          ec);
+  }
+
+  void ListenTarget(boost::system::error_code& ec) {
+    Tcp::endpoint endpoint(boost::asio::ip::address_v4::loopback(), 7590);
+    acceptor_.open(endpoint.protocol(), ec);
+    if (!ec) {
+      acceptor_.set_option(boost::asio::socket_base::reuse_address(true), ec);
+    }
+    if (!ec) {
+      acceptor_.bind(endpoint, ec);
+    }
+    if (!ec) {
+      acceptor_.listen(boost::asio::socket_base::max_connections, ec);
+    }
+  }
+
+  // Open a forwarded connection and accept it on the target side
+  bool Connect(const std::string& from_port, Tcp::socket* p_local,
+               Tcp::socket* p_target) {
+    boost::system::error_code ec;
+    Tcp::resolver r(io_service_);
+    Tcp::resolver::query q("127.0.0.1", from_port);
+    boost::asio::connect(*p_local, r.resolve(q), ec);
+    if (ec) {
+      return false;
+    }
+    acceptor_.accept(*p_target, ec);
+    return !ec;
+  }
+
+  // Send a few bytes from the local side and read them on the target side
+  bool Exchange(Tcp::socket* p_local, Tcp::socket* p_target) {
+    boost::system::error_code ec;
+    std::array<char, 4> request = {{'p', 'i', 'n', 'g'}};
+    boost::asio::write(*p_local, boost::asio::buffer(request), ec);
+    if (ec) {
+      return false;
+    }
+
+    std::array<char, 4> received;
+    boost::asio::read(*p_target, boost::asio::buffer(received), ec);
+    return !ec && received == request;
+  }
+
+  // Wait for the service forwarding from_port to reach the expected state
+  bool WaitService(const std::string& from_port, bool expect_running) {
+    for (int retry = 0; retry < 100; ++retry) {
+      bool running = false;
+      for (const auto& user_service : p_ssf_client_->GetUserServices()) {
+        auto port_it = user_service.parameters.find("from_port");
+        if (port_it != user_service.parameters.end() &&
+            port_it->second == from_port &&
+            user_service.state == ssf::Client::UserServiceState::kRunning) {
+          running = true;
+        }
+      }
+      if (running == expect_running) {
+        return true;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    return false;
+  }
+
+  // Wait for the local port to be closed
+  bool WaitClosed(const std::string& from_port) {
+    for (int retry = 0; retry < 100; ++retry) {
+      boost::system::error_code ec;
+      Tcp::socket probe(io_service_);
+      probe.connect(Tcp::endpoint(boost::asio::ip::address_v4::loopback(),
+                                  static_cast<uint16_t>(std::stoi(from_port))),
+                    ec);
+      if (ec) {
+        return true;
+      }
+      probe.close(ec);
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    return false;
+  }
+
+ protected:
+  boost::asio::io_service io_service_;
+  Tcp::acceptor acceptor_;
+};
+
+TEST_F(ReloadTest, AddRemoveKeepUnchanged) {
+  ASSERT_TRUE(Wait());
+  ASSERT_TRUE(WaitService("7490", true));
+  ASSERT_TRUE(WaitService("7491", true));
+
+  boost::system::error_code ec;
+  ListenTarget(ec);
+  ASSERT_EQ(ec.value(), 0) << "Could not listen on the target port";
+
+  // a connection through the service kept by the reload
+  Tcp::socket local(io_service_);
+  Tcp::socket target(io_service_);
+  ASSERT_TRUE(Connect("7490", &local, &target));
+  ASSERT_TRUE(Exchange(&local, &target));
+
+  // 7490 unchanged, 7491 removed, 7492 added
+  Reload({"7490", "7492"}, ec);
+  ASSERT_EQ(ec.value(), 0) << "Reload failed";
+
+  EXPECT_TRUE(WaitService("7492", true)) << "Added service not running";
+  EXPECT_TRUE(WaitClosed("7491")) << "Removed service still listening";
+  EXPECT_TRUE(Exchange(&local, &target))
+      << "The fiber of the unchanged service should stay up";
+
+  Tcp::socket added_local(io_service_);
+  Tcp::socket added_target(io_service_);
+  EXPECT_TRUE(Connect("7492", &added_local, &added_target));
+  EXPECT_TRUE(Exchange(&added_local, &added_target));
+
+  // 7493 is removed while its remote services may still be starting
+  Reload({"7490", "7492", "7493"}, ec);
+  ASSERT_EQ(ec.value(), 0) << "Reload failed";
+  Reload({"7490", "7492"}, ec);
+  ASSERT_EQ(ec.value(), 0) << "Reload failed";
+
+  // let the start of 7493 complete
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  EXPECT_TRUE(WaitService("7493", false));
+  EXPECT_TRUE(WaitClosed("7493")) << "Service removed during its start";
+  EXPECT_EQ(p_ssf_client_->GetUserServices().size(), 2U);
+  EXPECT_TRUE(Exchange(&local, &target))
+      << "The fiber of the unchanged service should stay up";
+
+  local.close(ec);
+  target.close(ec);
+  added_local.close(ec);
+  added_target.close(ec);
+  acceptor_.close(ec);
+}
@@ -2,6 +2,7 @@
 #define TESTS_SERVICES_SERVICE_FIXTURE_TEST_H_
 
 #include <functional>
+#include <mutex>
 #include <random>
 #include <utility>
 
@@ -184,8 +185,10 @@ class ServiceFixtureTest : public ::testing::Test {
       SSF_LOG("test", critical, "user_service[{}] initialization failed",
               p_user_service->GetName());
     }
+    // services of the same type may be added later in the session
     if (p_user_service->GetName() == ServiceTested::GetParseName()) {
-      service_set_.set_value(!ec);
+      std::call_once(service_set_once_,
+                     [this, &ec]() { service_set_.set_value(!ec); });
     }
   }
 
@@ -199,6 +202,7 @@ class ServiceFixtureTest : public ::testing::Test {
   std::promise<bool> network_set_;
   std::promise<bool> transport_set_;
   std::promise<bool> service_set_;
+  std::once_flag service_set_once_;
 };
 
 #endif  // TESTS_SERVICES_SERVICE_FIXTURE_TEST_H_
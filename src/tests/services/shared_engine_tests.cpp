@@ -0,0 +1,236 @@
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <boost/asio/connect.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+
+#include <gtest/gtest.h>
+
+#include "common/config/config.h"
+#include "core/async_engine.h"
+#include "core/client/client.h"
+#include "core/client/status.h"
+#include "core/network_protocol.h"
+#include "core/server/server.h"
+#include "core/transport_virtual_layer_policies/transport_protocol_policy.h"
+#include "services/user_services/port_forwarding.h"
+
+#include "tests/tls_config_helper.h"
+
+// Sessions of several clients on one engine, as run from the sessions of the
+// config file
+class SharedEngineTest : public ::testing::Test {
+ public:
+  using Tcp = boost::asio::ip::tcp;
+  using NetworkProtocol = ssf::network::NetworkProtocol;
+  using Client = ssf::Client;
+  using Server =
+      ssf::SSFServer<NetworkProtocol::Protocol, ssf::TransportProtocolPolicy>;
+  using Demux = Client::Demux;
+  using PortForwarding = ssf::services::PortForwarding<Demux>;
+
+ public:
+  SharedEngineTest()
+      : async_engine_(),
+        p_server_(),
+        stalled_io_service_(),
+        stalled_acceptor_(stalled_io_service_),
+        stalled_socket_(stalled_io_service_),
+        stalled_thread_(),
+        p_stalled_client_(),
+        p_healthy_client_(),
+        stalled_client_running_(false),
+        healthy_running_(),
+        healthy_service_(),
+        healthy_service_once_() {}
+
+ protected:
+  void TearDown() override {
+    boost::system::error_code ec;
+    for (auto p_client : {p_stalled_client_.get(), p_healthy_client_.get()}) {
+      if (p_client) {
+        p_client->Stop(ec);
+      }
+    }
+    async_engine_.Stop();
+    for (auto p_client : {p_stalled_client_.get(), p_healthy_client_.get()}) {
+      if (p_client) {
+        p_client->Deinit();
+      }
+    }
+    if (p_server_) {
+      p_server_->Stop();
+    }
+
+    stalled_socket_.close(ec);
+    stalled_acceptor_.close(ec);
+    if (stalled_thread_.joinable()) {
+      stalled_thread_.join();
+    }
+  }
+
+  bool StartServer(const std::string& port) {
+    ssf::config::Config ssf_config;
+    ssf_config.Init();
+    ssf::tests::SetServerTlsConfig(&ssf_config);
+    auto endpoint_query =
+        NetworkProtocol::GenerateServerQuery("127.0.0.1", port, ssf_config);
+
+    p_server_.reset(new Server(ssf_config.services()));
+    boost::system::error_code ec;
+    p_server_->Run(endpoint_query, ec);
+    return !ec;
+  }
+
+  // Accept one connection and never answer: the TLS handshake stalls
+  bool StartStalledServer(uint16_t port) {
+    boost::system::error_code ec;
+    Tcp::endpoint endpoint(boost::asio::ip::address_v4::loopback(), port);
+    stalled_acceptor_.open(endpoint.protocol(), ec);
+    if (!ec) {
+      stalled_acceptor_.set_option(
+          boost::asio::socket_base::reuse_address(true), ec);
+    }
+    if (!ec) {
+      stalled_acceptor_.bind(endpoint, ec);
+    }
+    if (!ec) {
+      stalled_acceptor_.listen(boost::asio::socket_base::max_connections, ec);
+    }
+    if (ec) {
+      return false;
+    }
+
+    stalled_acceptor_.async_accept(stalled_socket_,
+                                   [](const boost::system::error_code&) {});
+    stalled_thread_ = std::thread([this]() { stalled_io_service_.run(); });
+    return true;
+  }
+
+  std::unique_ptr<Client> StartClient(const std::string& server_port,
+                                      const std::string& from_port,
+                                      Client::OnStatusCb on_status) {
+    ssf::config::Config ssf_config;
+    ssf_config.Init();
+    ssf::tests::SetClientTlsConfig(&ssf_config);
+    auto endpoint_query = NetworkProtocol::GenerateClientQuery(
+        "127.0.0.1", server_port, ssf_config, {});
+
+    ssf::UserServiceParameters parameters = {
+        {PortForwarding::GetParseName(),
+         {{{"from_addr", ""},
+           {"from_port", from_port},
+           {"to_addr", "127.0.0.1"},
+           {"to_port", "8313"}}}}};
+
+    std::unique_ptr<Client> p_client(new Client(&async_engine_));
+    p_client->Register<PortForwarding>();
+    boost::system::error_code ec;
+    p_client->Init(
+        endpoint_query, 1, 0, false, parameters, ssf_config.services(),
+        on_status,
+        [this](Client::UserServicePtr p_service,
+               const boost::system::error_code& ec) {
+          std::call_once(healthy_service_once_,
+                         [this, &ec]() { healthy_service_.set_value(!ec); });
+        },
+        ec);
+    if (!ec) {
+      p_client->Run(ec);
+    }
+    if (ec) {
+      return nullptr;
+    }
+    return p_client;
+  }
+
+ protected:
+  ssf::AsyncEngine async_engine_;
+  std::unique_ptr<Server> p_server_;
+
+  boost::asio::io_service stalled_io_service_;
+  Tcp::acceptor stalled_acceptor_;
+  Tcp::socket stalled_socket_;
+  std::thread stalled_thread_;
+
+  std::unique_ptr<Client> p_stalled_client_;
+  std::unique_ptr<Client> p_healthy_client_;
+  std::atomic<bool> stalled_client_running_;
+  std::promise<bool> healthy_running_;
+  std::promise<bool> healthy_service_;
+  std::once_flag healthy_service_once_;
+};
+
+TEST_F(SharedEngineTest, StalledServerDoesNotBlockOtherSession) {
+  ASSERT_TRUE(StartServer("8310")) << "Could not start the server";
+  ASSERT_TRUE(StartStalledServer(8311)) << "Could not start the stalled server";
+
+  // The first session hangs in its handshake on the shared engine
+  p_stalled_client_ =
+      StartClient("8311", "8314", [this](ssf::Status status) {
+        if (status == ssf::Status::kRunning) {
+          stalled_client_running_ = true;
+        }
+      });
+  ASSERT_TRUE(!!p_stalled_client_) << "Could not start the stalled client";
+
+  std::once_flag running_once;
+  p_healthy_client_ =
+      StartClient("8310", "8312", [this, &running_once](ssf::Status status) {
+        if (status == ssf::Status::kRunning ||
+            status == ssf::Status::kServerUnreachable ||
+            status == ssf::Status::kServerNotSupported) {
+          std::call_once(running_once, [this, status]() {
+            healthy_running_.set_value(status == ssf::Status::kRunning);
+          });
+        }
+      });
+  ASSERT_TRUE(!!p_healthy_client_) << "Could not start the healthy client";
+
+  auto running_future = healthy_running_.get_future();
+  ASSERT_EQ(running_future.wait_for(std::chrono::seconds(10)),
+            std::future_status::ready)
+      << "The healthy session should not wait for the stalled one";
+  ASSERT_TRUE(running_future.get());
+  auto service_future = healthy_service_.get_future();
+  ASSERT_EQ(service_future.wait_for(std::chrono::seconds(10)),
+            std::future_status::ready);
+  ASSERT_TRUE(service_future.get());
+
+  // Traffic flows through the healthy session
+  boost::asio::io_service io_service;
+  Tcp::acceptor target_acceptor(
+      io_service, Tcp::endpoint(boost::asio::ip::address_v4::loopback(), 8313));
+  Tcp::socket local(io_service);
+  Tcp::socket target(io_service);
+  boost::system::error_code ec;
+  local.connect(Tcp::endpoint(boost::asio::ip::address_v4::loopback(), 8312),
+                ec);
+  ASSERT_EQ(ec.value(), 0) << "Fail to connect to the forwarded port";
+  target_acceptor.accept(target, ec);
+  ASSERT_EQ(ec.value(), 0) << "Fail to accept the forwarded connection";
+
+  std::array<char, 4> request = {{'p', 'i', 'n', 'g'}};
+  std::array<char, 4> received;
+  boost::asio::write(local, boost::asio::buffer(request), ec);
+  ASSERT_EQ(ec.value(), 0);
+  boost::asio::read(target, boost::asio::buffer(received), ec);
+  ASSERT_EQ(ec.value(), 0);
+  EXPECT_EQ(received, request);
+
+  EXPECT_FALSE(stalled_client_running_.load())
+      << "The stalled session should still be in its handshake";
+
+  local.close(ec);
+  target.close(ec);
+  target_acceptor.close(ec);
+}
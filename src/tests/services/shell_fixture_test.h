@@ -1,8 +1,11 @@
 #ifndef TESTS_SERVICES_SHELL_FIXTURE_TEST_H_
 #define TESTS_SERVICES_SHELL_FIXTURE_TEST_H_
 
+#include <algorithm>
 #include <array>
+#include <functional>
 #include <iostream>
+#include <string>
 #include <thread>
 
 #include <boost/asio/connect.hpp>
@@ -104,6 +107,78 @@ class ShellFixtureTest : public ServiceFixtureTest<TServiceTested> {
       t.join();
     }
   }
+
+  // Print a large known output in the interactive shell and compare it byte
+  // for byte
+  void ExecuteLargeOutputCmd(const std::string& shell_port) {
+    ASSERT_TRUE(this->Wait());
+
+    boost::asio::io_service io_service;
+    boost::asio::steady_timer timer(io_service);
+    boost::asio::ip::tcp::socket socket(io_service);
+
+    boost::asio::ip::tcp::resolver r(io_service);
+    boost::asio::ip::tcp::resolver::query q("127.0.0.1", shell_port);
+    boost::system::error_code ec;
+
+    boost::asio::connect(socket, r.resolve(q), ec);
+    ASSERT_EQ(ec.value(), 0) << "Fail to connect to client socket";
+
+    const uint32_t lines_count = 200000;
+    // the quotes keep the markers out of the echoed command line
+    std::string command = "printf 'BE''GIN\\n'; seq 1 " +
+                          std::to_string(lines_count) +
+                          "; printf 'E''ND\\n'\n";
+    // the pty turns each \n into \r\n
+    std::string expected = "BEGIN\r\n";
+    for (uint32_t i = 1; i <= lines_count; ++i) {
+      expected += std::to_string(i) + "\r\n";
+    }
+    const std::string end_marker = "END\r\n";
+    expected += end_marker;
+
+    boost::asio::write(socket, boost::asio::buffer(command), ec);
+    ASSERT_EQ(ec.value(), 0) << "Fail to write to socket";
+
+    std::string output;
+    std::array<char, 4096> response_data;
+    std::function<void(const boost::system::error_code&, std::size_t)> on_read;
+    on_read = [&](const boost::system::error_code& read_ec,
+                  std::size_t read_bytes) {
+      auto searched = output.size() >= end_marker.size()
+                          ? output.size() - end_marker.size()
+                          : 0;
+      output.append(response_data.data(), read_bytes);
+      if (read_ec || output.find(end_marker, searched) != std::string::npos) {
+        timer.cancel();
+        return;
+      }
+      socket.async_read_some(boost::asio::buffer(response_data), on_read);
+    };
+    socket.async_read_some(boost::asio::buffer(response_data), on_read);
+
+    timer.expires_from_now(std::chrono::seconds(60));
+    timer.async_wait([&socket](const boost::system::error_code& timer_ec) {
+      if (!timer_ec) {
+        boost::system::error_code close_ec;
+        socket.close(close_ec);
+      }
+    });
+
+    io_service.run();
+
+    auto begin = output.find("BEGIN\r\n");
+    ASSERT_NE(begin, std::string::npos) << "Output start not received";
+    ASSERT_GE(output.size() - begin, expected.size()) << "Output truncated";
+
+    auto mismatch = std::mismatch(expected.begin(), expected.end(),
+                                  output.begin() + begin);
+    EXPECT_TRUE(mismatch.first == expected.end())
+        << "Output differs at byte "
+        << std::distance(expected.begin(), mismatch.first);
+
+    socket.close(ec);
+  }
 };
 
 #endif  // TESTS_SERVICES_SHELL_FIXTURE_TEST_H_
@@ -12,6 +12,10 @@ class ShellTest : public ShellFixtureTest<ssf::services::Shell> {
 
 TEST_F(ShellTest, ExecuteCmdTest) { ExecuteCmd("9071"); }
 
+#if !defined(BOOST_ASIO_WINDOWS)
+TEST_F(ShellTest, LargeOutputTest) { ExecuteLargeOutputCmd("9071"); }
+#endif
+
 class ShellWildcardTest : public ShellTest {
   void SetServerConfig(ssf::config::Config& config) override {
     const char* new_config = R"RAWSTRING(
@@ -1,3 +1,10 @@
+#include <array>
+#include <chrono>
+#include <thread>
+
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+
 #include "services/user_services/port_forwarding.h"
 
 #include "tests/services/stream_fixture_test.h"
@@ -69,4 +76,104 @@ TEST_F(StreamForwardWildcardTest, MultiStreams) {
   ASSERT_TRUE(Wait());
 
   Run("7676", "7777");
-}
\ No newline at end of file
+}
+class StreamForwardOutboundQuotaTest : public StreamForwardTest {
+ public:
+  using Tcp = boost::asio::ip::tcp;
+
+ protected:
+  void SetServerConfig(ssf::config::Config& config) override {
+    const char* new_config = R"RAWSTRING(
+{
+    "ssf": {
+        "quotas" : {
+            "max_outbound_sockets": 1
+        }
+    }
+}
+)RAWSTRING";
+
+    boost::system::error_code ec;
+    config.UpdateFromString(new_config, ec);
+    ASSERT_EQ(ec.value(), 0) << "Could not update server config from string "
+                             << new_config;
+  }
+
+  ssf::UserServiceParameters CreateUserServiceParameters(
+      boost::system::error_code& ec) override {
+    return {{ServiceTested::GetParseName(),
+             {{{"from_addr", ""},
+               {"from_port", "7880"},
+               {"to_addr", "127.0.0.1"},
+               {"to_port", "7881"}}}}};
+  }
+
+  void ConnectLocal(Tcp::socket* p_local, boost::system::error_code& ec) {
+    p_local->connect(
+        Tcp::endpoint(boost::asio::ip::address_v4::loopback(), 7880), ec);
+  }
+
+  // Send a few bytes from the local side and read them on the target side
+  bool Exchange(Tcp::socket* p_local, Tcp::socket* p_target) {
+    boost::system::error_code ec;
+    std::array<char, 4> request = {{'p', 'i', 'n', 'g'}};
+    boost::asio::write(*p_local, boost::asio::buffer(request), ec);
+    if (ec) {
+      return false;
+    }
+
+    std::array<char, 4> received;
+    boost::asio::read(*p_target, boost::asio::buffer(received), ec);
+    return !ec && received == request;
+  }
+};
+
+TEST_F(StreamForwardOutboundQuotaTest, ConnectionOverQuotaIsClosed) {
+  ASSERT_TRUE(Wait());
+
+  boost::asio::io_service io_service;
+  boost::system::error_code ec;
+  Tcp::acceptor target_acceptor(
+      io_service, Tcp::endpoint(boost::asio::ip::address_v4::loopback(), 7881));
+
+  Tcp::socket first_local(io_service);
+  Tcp::socket first_target(io_service);
+  ConnectLocal(&first_local, ec);
+  ASSERT_EQ(ec.value(), 0) << "Fail to connect to the forwarded port";
+  target_acceptor.accept(first_target, ec);
+  ASSERT_EQ(ec.value(), 0) << "The first connection should be forwarded";
+  EXPECT_TRUE(Exchange(&first_local, &first_target));
+
+  // The server has no outbound socket left: the fiber is closed
+  Tcp::socket second_local(io_service);
+  ConnectLocal(&second_local, ec);
+  ASSERT_EQ(ec.value(), 0) << "Fail to connect to the forwarded port";
+  std::array<char, 1> second_buffer;
+  boost::asio::read(second_local, boost::asio::buffer(second_buffer), ec);
+  EXPECT_NE(ec.value(), 0) << "The connection over the quota should be closed";
+
+  Tcp::socket second_target(io_service);
+  target_acceptor.non_blocking(true, ec);
+  target_acceptor.accept(second_target, ec);
+  EXPECT_EQ(ec, boost::asio::error::would_block)
+      << "The target should not see the connection over the quota";
+  target_acceptor.non_blocking(false, ec);
+
+  // Closing the first connection releases its outbound socket
+  first_local.close(ec);
+  first_target.close(ec);
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+  Tcp::socket third_local(io_service);
+  Tcp::socket third_target(io_service);
+  ConnectLocal(&third_local, ec);
+  ASSERT_EQ(ec.value(), 0) << "Fail to connect to the forwarded port";
+  target_acceptor.accept(third_target, ec);
+  ASSERT_EQ(ec.value(), 0) << "The released socket should be available";
+  EXPECT_TRUE(Exchange(&third_local, &third_target));
+
+  second_local.close(ec);
+  third_local.close(ec);
+  third_target.close(ec);
+  target_acceptor.close(ec);
+}
@@ -109,7 +109,8 @@ DummyClient::DummyClient(const std::string& target_addr,
       socket_(io_service_),
       target_addr_(target_addr),
       target_port_(target_port),
-      size_(size) {}
+      size_(size),
+      max_round_trip_(0) {}
 
 bool DummyClient::Init() {
   t_ = std::thread([&]() { io_service_.run(); });
@@ -138,6 +139,7 @@ bool DummyClient::ReceiveOneBuffer() {
   while (received < size_) {
     boost::system::error_code ec;
     size_t remaining_size = size_ - received;
+    auto sent_at = std::chrono::steady_clock::now();
     socket_.send(boost::asio::buffer(&remaining_size, sizeof(remaining_size)),
                  0, ec);
 
@@ -151,6 +153,12 @@ bool DummyClient::ReceiveOneBuffer() {
       return false;
     }
 
+    auto round_trip = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - sent_at);
+    if (round_trip > max_round_trip_) {
+      max_round_trip_ = round_trip;
+    }
+
     if (n == 0) {
       return false;
     } else {
@@ -1,6 +1,8 @@
 #ifndef TESTS_SERVICES_UDP_HELPERS_H_
 #define TESTS_SERVICES_UDP_HELPERS_H_
 
+#include <array>
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -61,6 +63,9 @@ class DummyClient {
 
   void Stop();
 
+  // Longest time between a request and its reply in ReceiveOneBuffer
+  std::chrono::microseconds max_round_trip() const { return max_round_trip_; }
+
  private:
   void ResetBuffer();
 
@@ -76,6 +81,7 @@ class DummyClient {
   std::string target_port_;
   size_t size_;
   std::array<uint8_t, 10240> one_buffer_;
+  std::chrono::microseconds max_round_trip_;
 };
 
 }  // udp
@@ -0,0 +1,160 @@
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/udp.hpp>
+
+#include <gtest/gtest.h>
+
+#include "services/fibers_to_datagrams/udp_relay.h"
+
+// Fiber side of the relay: records the datagrams sent to each flow
+class FakeFiberEndpoint {
+ public:
+  using port_type = uint32_t;
+
+  explicit FakeFiberEndpoint(port_type port) : port_(port) {}
+
+  port_type port() const { return port_; }
+
+ private:
+  port_type port_;
+};
+
+class FakeFiberDatagram {
+ public:
+  using Datagram = std::pair<uint32_t, std::string>;
+
+  explicit FakeFiberDatagram(boost::asio::io_service& io_service)
+      : io_service_(io_service), mutex_(), datagrams_() {}
+
+  template <typename ConstBufferSequence, typename Handler>
+  void async_send_to(const ConstBufferSequence& buffers,
+                     const FakeFiberEndpoint& destination, Handler handler) {
+    std::size_t length = boost::asio::buffer_size(buffers);
+    std::string data(length, '\0');
+    boost::asio::buffer_copy(boost::asio::buffer(&data[0], length), buffers);
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      datagrams_.emplace_back(destination.port(), std::move(data));
+    }
+    io_service_.post([handler, length]() mutable {
+      handler(boost::system::error_code(), length);
+    });
+  }
+
+  std::vector<Datagram> datagrams() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return datagrams_;
+  }
+
+ private:
+  boost::asio::io_service& io_service_;
+  std::mutex mutex_;
+  std::vector<Datagram> datagrams_;
+};
+
+class UdpRelayTest : public ::testing::Test {
+ public:
+  using Udp = boost::asio::ip::udp;
+  using Relay = ssf::services::fibers_to_datagrams::UdpRelay<FakeFiberDatagram,
+                                                             FakeFiberEndpoint>;
+
+ public:
+  UdpRelayTest()
+      : io_service_(),
+        p_worker_(new boost::asio::io_service::work(io_service_)),
+        thread_(),
+        fiber_(io_service_),
+        target_(io_service_, Udp::endpoint(
+                                 boost::asio::ip::address_v4::loopback(), 0)),
+        p_relay_() {}
+
+ protected:
+  void SetUp() override {
+    thread_ = std::thread([this]() { io_service_.run(); });
+    // flows expire after kIdleTicks ticks of 10ms
+    p_relay_ = Relay::Create(io_service_, fiber_, target_.local_endpoint(),
+                             std::chrono::milliseconds(10));
+    p_relay_->Start();
+  }
+
+  void TearDown() override {
+    p_relay_->Stop();
+    p_relay_.reset();
+    p_worker_.reset();
+    thread_.join();
+  }
+
+  // Send a datagram from a fiber flow and receive it on the target
+  Udp::endpoint SendFromFlow(uint32_t port, const std::string& data) {
+    p_relay_->Send(FakeFiberEndpoint(port), boost::asio::buffer(data));
+
+    std::string received(data.size(), '\0');
+    Udp::endpoint flow_endpoint;
+    target_.receive_from(boost::asio::buffer(&received[0], received.size()),
+                         flow_endpoint);
+    EXPECT_EQ(received, data);
+    return flow_endpoint;
+  }
+
+  bool WaitFlowsExpired() {
+    for (int retry = 0; retry < 300; ++retry) {
+      if (p_relay_->flows_count() == 0) {
+        return true;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+  }
+
+ protected:
+  boost::asio::io_service io_service_;
+  std::unique_ptr<boost::asio::io_service::work> p_worker_;
+  std::thread thread_;
+  FakeFiberDatagram fiber_;
+  Udp::socket target_;
+  Relay::UdpRelayPtr p_relay_;
+};
+
+TEST_F(UdpRelayTest, IdleFlowSocketIsPooled) {
+  SendFromFlow(1, "request");
+  EXPECT_EQ(p_relay_->flows_count(), 1U);
+  EXPECT_EQ(p_relay_->pooled_sockets_count(), 0U);
+
+  ASSERT_TRUE(WaitFlowsExpired()) << "The idle flow should expire";
+  EXPECT_EQ(p_relay_->pooled_sockets_count(), 1U)
+      << "The socket of the expired flow should be pooled";
+}
+
+TEST_F(UdpRelayTest, ReusedSocketDropsStaleDatagrams) {
+  auto first_endpoint = SendFromFlow(1, "request");
+  ASSERT_TRUE(WaitFlowsExpired()) << "The idle flow should expire";
+
+  // a late reply to the expired flow waits in the pooled socket
+  target_.send_to(boost::asio::buffer(std::string("stale")), first_endpoint);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  auto second_endpoint = SendFromFlow(2, "request");
+  EXPECT_EQ(second_endpoint, first_endpoint)
+      << "The new flow should reuse the pooled socket";
+  EXPECT_EQ(p_relay_->pooled_sockets_count(), 0U);
+
+  target_.send_to(boost::asio::buffer(std::string("fresh")), second_endpoint);
+  for (int retry = 0; retry < 100 && fiber_.datagrams().empty(); ++retry) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  auto datagrams = fiber_.datagrams();
+  ASSERT_EQ(datagrams.size(), 1U) << "Only the fresh reply should be relayed";
+  EXPECT_EQ(datagrams.front().first, 2U);
+  EXPECT_EQ(datagrams.front().second, "fresh");
+}